@@ -1,6 +1,9 @@
 #include "BitmapImage.h"
-#include "SkStream.h"
+#include "CanvasETC1.h"
+#include "SkData.h"
+#include "SkDecodingImageGenerator.h"
 #include "SkImageDecoder.h"
+#include "SkImageGenerator.h"
 
 BitmapImage::BitmapImage()
 {
@@ -15,13 +18,56 @@ BitmapImage::~BitmapImage()
 void BitmapImage::src( std::string src )
 {
 	m_imagesrc = src;
-	SkFILEStream stream( src.c_str());
-	if ( !stream.isValid() )
+	if (!decodeFile(src, &m_bitmap, 0))
 	{
-		return;
+		m_bitmap.reset();
 	}
-	
-	SkImageDecoder * code = SkImageDecoder::Factory(&stream);
-	code->decode(&stream, &m_bitmap, SkColorType::kRGBA_8888_SkColorType, SkImageDecoder::kDecodePixels_Mode);
-	return;
+}
+
+bool BitmapImage::decodeFile(const std::string& src, SkBitmap* bitmap, unsigned flags)
+{
+	SkAutoTUnref<SkData> data(SkData::NewFromFileName(src.c_str()));
+	if (!data)
+	{
+		return false;
+	}
+
+	bool etc1 = Canvas2D::CanvasETC1::isETC1(data);
+	if (!etc1 && (flags & kCompressETC1_DecodeFlag))
+	{
+		SkBitmap decoded;
+		if (SkImageDecoder::DecodeMemory(data->data(), data->size(), &decoded, kN32_SkColorType, SkImageDecoder::kDecodePixels_Mode))
+		{
+			SkData* compressed = Canvas2D::CanvasETC1::encode(decoded);
+			if (compressed)
+			{
+				data.reset(compressed);
+				etc1 = true;
+			}
+		}
+	}
+	if (etc1)
+	{
+		// Decoding would only cost time and memory: the GPU device uploads
+		// the ETC1 data of an image whose pixels are not locked.
+		return SkInstallDiscardablePixelRef(Canvas2D::CanvasETC1::createGenerator(data), bitmap);
+	}
+
+	// Only the header is read here; the pixels are decoded when locked.
+	SkDecodingImageGenerator::Options options(1, true, kN32_SkColorType);
+	if (!SkInstallDiscardablePixelRef(SkDecodingImageGenerator::Create(data, options), bitmap))
+	{
+		return false;
+	}
+	if (flags & kPredecode_DecodeFlag)
+	{
+		SkAutoLockPixels lock(*bitmap);
+		return bitmap->getPixels() != 0;
+	}
+	return true;
+}
+
+void BitmapImage::purgeDecodedPixels()
+{
+	SkPurgeGlobalDiscardableMemoryPool();
 }
@@ -6,8 +6,11 @@
 #include "RefCounted.h"
 #include "passrefptr.h"
 
+class BitmapImageDecoder;
+
 class BitmapImage : public RefCounted<BitmapImage >
 {
+	friend class BitmapImageDecoder;
 public:
 	BitmapImage();
 	~BitmapImage();	
@@ -15,8 +18,29 @@ public:
 	{
 		return adoptRef(new BitmapImage());
 	}
+	enum DecodeFlags
+	{
+		// Decode the pixels now rather than on first draw.
+		kPredecode_DecodeFlag = 1 << 0,
+		// Re-encode opaque images as ETC1, so the GPU keeps them compressed.
+		// Lossy, and the encode is slow: meant for BitmapImageDecoder.
+		kCompressETC1_DecodeFlag = 1 << 1
+	};
+
+	// Reads the file and installs a pixel ref that decodes it on first draw.
+	// The decoded pixels live in Skia's discardable memory pool, so they can
+	// be purged when memory runs short and are decoded again when next drawn.
+	// PKM and KTX/ETC1 files are left compressed; see CanvasETC1.
+	// Use BitmapImageDecoder to do the read and decode off the main thread.
 	void src(std::string src);
+	const std::string& currentSrc() const { return m_imagesrc; }
 	SkBitmap &bitmap() { return m_bitmap; }
+
+	// Decodes |src| into |bitmap| as src() does, as modified by |flags|, a
+	// combination of DecodeFlags. Safe to call from any thread.
+	static bool decodeFile(const std::string& src, SkBitmap* bitmap, unsigned flags);
+	// Drops the decoded pixels of every image not being drawn right now.
+	static void purgeDecodedPixels();
 private:
 	std::string m_imagesrc;
 	SkBitmap m_bitmap;
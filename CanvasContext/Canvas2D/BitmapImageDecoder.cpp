@@ -0,0 +1,122 @@
+#include "BitmapImageDecoder.h"
+
+// Only the worker touches m_bitmap and m_success until the job is finished;
+// the image itself, whose ref count is not thread safe, is only touched on
+// the main thread.
+class BitmapImageDecoder::Job : public SkRunnable
+{
+public:
+	Job(BitmapImageDecoder* decoder, PassRefPtr<BitmapImage> image, const std::string& src, Client* client, unsigned flags)
+		: m_decoder(decoder)
+		, m_image(image)
+		, m_src(src)
+		, m_client(client)
+		, m_flags(flags)
+		, m_success(false)
+	{
+	}
+
+	virtual void run()
+	{
+		m_success = BitmapImage::decodeFile(m_src, &m_bitmap, m_flags);
+		m_decoder->jobDidFinish(this);
+	}
+
+	BitmapImageDecoder* m_decoder;
+	RefPtr<BitmapImage> m_image;
+	std::string m_src;
+	Client* m_client;
+	unsigned m_flags;
+	bool m_success;
+	SkBitmap m_bitmap;
+};
+
+BitmapImageDecoder::BitmapImageDecoder(int threads)
+	: m_pool(threads)
+	, m_pending(0)
+{
+}
+
+BitmapImageDecoder::~BitmapImageDecoder()
+{
+	m_pool.wait();
+	for (size_t i = 0; i < m_finished.size(); i++)
+	{
+		delete m_finished[i];
+	}
+}
+
+void BitmapImageDecoder::decode(PassRefPtr<BitmapImage> image, const std::string& src, Client* client, unsigned flags)
+{
+	RefPtr<BitmapImage> protect = image;
+	if (!protect)
+	{
+		return;
+	}
+	protect->m_imagesrc = src;
+	m_pending++;
+	m_pool.add(new Job(this, protect.release(), src, client, flags));
+}
+
+void BitmapImageDecoder::jobDidFinish(Job* job)
+{
+	m_finishedCond.lock();
+	m_finished.push_back(job);
+	m_finishedCond.signal();
+	m_finishedCond.unlock();
+}
+
+int BitmapImageDecoder::dispatchCompletions()
+{
+	std::vector<Job*> finished;
+	m_finishedCond.lock();
+	finished.swap(m_finished);
+	m_finishedCond.unlock();
+
+	for (size_t i = 0; i < finished.size(); i++)
+	{
+		Job* job = finished[i];
+		BitmapImage* image = job->m_image.get();
+		m_pending--;
+		// A later src() or decode() on the same image wins.
+		if (image->m_imagesrc != job->m_src)
+		{
+			m_stats.m_superseded++;
+		}
+		else
+		{
+			if (job->m_success)
+			{
+				image->m_bitmap = job->m_bitmap;
+				m_stats.m_decoded++;
+			}
+			else
+			{
+				image->m_bitmap.reset();
+				m_stats.m_failed++;
+			}
+			if (job->m_client)
+			{
+				job->m_client->imageDidDecode(image, job->m_success);
+			}
+		}
+		delete job;
+	}
+	return static_cast<int>(finished.size());
+}
+
+int BitmapImageDecoder::waitForAll()
+{
+	int dispatched = 0;
+	while (m_pending > 0)
+	{
+		m_finishedCond.lock();
+		while (m_finished.empty())
+		{
+			m_finishedCond.wait();
+		}
+		m_finishedCond.unlock();
+		dispatched += dispatchCompletions();
+	}
+	return dispatched;
+}
@@ -0,0 +1,72 @@
+#ifndef BitmapImageDecoder_h
+#define BitmapImageDecoder_h
+
+#include "BitmapImage.h"
+#include "Noncopyable.h"
+#include "RefPtr.h"
+#include "SkCondVar.h"
+#include "SkThreadPool.h"
+#include "vector"
+
+// Loads BitmapImages on a pool of worker threads. Reading the file and
+// decoding the pixels happen on a worker; the decoded bitmap is handed to its
+// image on the main thread, from dispatchCompletions(), which also tells the
+// client. A level that references hundreds of images can queue them all and
+// keep running its loop while they load.
+//
+// Images are decoded into discardable memory (see BitmapImage::src), so the
+// pixels of images that are not drawn can still be purged later.
+class BitmapImageDecoder
+{
+	WTF_MAKE_NONCOPYABLE(BitmapImageDecoder);
+public:
+	class Client
+	{
+	public:
+		virtual ~Client() { }
+		// Called on the thread that calls dispatchCompletions().
+		virtual void imageDidDecode(BitmapImage*, bool success) = 0;
+	};
+
+	struct Stats
+	{
+		Stats() : m_decoded(0), m_failed(0), m_superseded(0) { }
+		unsigned m_decoded;
+		unsigned m_failed;
+		// Finished after a newer src was given to the image; dropped.
+		unsigned m_superseded;
+	};
+
+	// SkThreadPool::kThreadPerCore starts one worker per core.
+	explicit BitmapImageDecoder(int threads = SkThreadPool::kThreadPerCore);
+	// Waits for queued decodes to finish; their clients are not called.
+	~BitmapImageDecoder();
+
+	// Sets the image's src at once and queues the decode. The image keeps
+	// its current bitmap until the decode is dispatched. |flags| are
+	// BitmapImage::DecodeFlags; by default the worker decodes the pixels as
+	// well, so the first draw does not.
+	void decode(PassRefPtr<BitmapImage>, const std::string& src, Client* = 0, unsigned flags = BitmapImage::kPredecode_DecodeFlag);
+
+	// Installs finished decodes into their images and calls their clients.
+	// Call from the main loop. Returns the number dispatched.
+	int dispatchCompletions();
+	// Blocks until everything queued has finished, then dispatches it.
+	int waitForAll();
+
+	int pendingCount() const { return m_pending; }
+	const Stats& stats() const { return m_stats; }
+
+private:
+	class Job;
+	void jobDidFinish(Job*);
+
+	SkThreadPool m_pool;
+	SkCondVar m_finishedCond;
+	// Guarded by m_finishedCond.
+	std::vector<Job*> m_finished;
+	int m_pending;
+	Stats m_stats;
+};
+
+#endif // BitmapImageDecoder_h
@@ -0,0 +1,57 @@
+#include "CanvasBackingStore.h"
+#include "SkCanvas.h"
+#include "SkRegion.h"
+#include "SkSurface.h"
+
+namespace Canvas2D {
+
+PassOwnPtr<CanvasBackingStore> CanvasBackingStore::create(SkCanvas* target, int width, int height)
+{
+	SkImageInfo info = SkImageInfo::MakeN32Premul(width, height);
+	SkSurface* surface = target->newSurface(info);
+	if (!surface)
+	{
+		return PassOwnPtr<CanvasBackingStore>();
+	}
+	return adoptPtr(new CanvasBackingStore(target, surface, width, height));
+}
+
+CanvasBackingStore::CanvasBackingStore(SkCanvas* target, SkSurface* surface, int width, int height)
+	: m_target(target)
+	, m_surface(surface)
+	, m_width(width)
+	, m_height(height)
+{
+}
+
+CanvasBackingStore::~CanvasBackingStore()
+{
+	m_surface->unref();
+}
+
+SkCanvas* CanvasBackingStore::canvas()
+{
+	return m_surface->getCanvas();
+}
+
+void CanvasBackingStore::present(const SkRegion& damage)
+{
+	if (damage.isEmpty())
+	{
+		return;
+	}
+	SkPaint paint;
+	paint.setXfermodeMode(SkXfermode::kSrc_Mode);
+
+	SkAutoCanvasRestore restore(m_target, true);
+	m_target->resetMatrix();
+	m_target->clipRegion(damage);
+	m_surface->draw(m_target, 0, 0, &paint);
+}
+
+void CanvasBackingStore::presentAll()
+{
+	present(SkRegion(SkIRect::MakeWH(m_width, m_height)));
+}
+
+} // namespace Canvas2D
@@ -0,0 +1,45 @@
+#ifndef CanvasBackingStore_h
+#define CanvasBackingStore_h
+
+#include "Noncopyable.h"
+#include "PassOwnPtr.h"
+
+class SkCanvas;
+class SkRegion;
+class SkSurface;
+
+namespace Canvas2D
+{
+
+// Retained offscreen copy of a canvas for partial redraw. The context draws
+// into canvas() instead of the target, so pixels outside this frame's damage
+// are still there from earlier frames; present() then copies only the damaged
+// region to the target instead of the whole surface.
+class CanvasBackingStore
+{
+	WTF_MAKE_NONCOPYABLE(CanvasBackingStore);
+public:
+	// Returns 0 if |target| cannot make a compatible surface.
+	static PassOwnPtr<CanvasBackingStore> create(SkCanvas* target, int width, int height);
+	~CanvasBackingStore();
+
+	SkCanvas* canvas();
+	int width() const { return m_width; }
+	int height() const { return m_height; }
+
+	// |damage| is in device space; the target's matrix and clip are ignored.
+	void present(const SkRegion& damage);
+	void presentAll();
+
+private:
+	CanvasBackingStore(SkCanvas* target, SkSurface*, int width, int height);
+
+	SkCanvas* m_target;
+	SkSurface* m_surface;
+	int m_width;
+	int m_height;
+};
+
+} // namespace Canvas2D
+
+#endif // CanvasBackingStore_h
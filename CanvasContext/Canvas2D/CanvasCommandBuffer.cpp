@@ -0,0 +1,354 @@
+#include "CanvasCommandBuffer.h"
+#include "algorithm"
+#include <string.h>
+
+namespace Canvas2D {
+
+CanvasCommandObjectTable::CanvasCommandObjectTable()
+{
+	// Slot 0 is the null handle.
+	m_entries.resize(1);
+}
+
+CanvasCommandObjectTable::~CanvasCommandObjectTable()
+{
+}
+
+uint32_t CanvasCommandObjectTable::allocate()
+{
+	if (!m_freeHandles.empty())
+	{
+		uint32_t handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+		return handle;
+	}
+	m_entries.push_back(Entry());
+	return static_cast<uint32_t>(m_entries.size() - 1);
+}
+
+void CanvasCommandObjectTable::markDirty(uint32_t handle)
+{
+	if (!handle)
+	{
+		return;
+	}
+	if (m_isDirty.size() <= handle)
+	{
+		m_isDirty.resize(handle + 1);
+	}
+	if (!m_isDirty[handle])
+	{
+		m_isDirty[handle] = true;
+		m_dirtyHandles.push_back(handle);
+	}
+}
+
+void CanvasCommandObjectTable::takeDirtyHandles(std::vector<uint32_t>& handles)
+{
+	handles.clear();
+	handles.swap(m_dirtyHandles);
+	for (size_t i = 0; i < handles.size(); i++)
+	{
+		m_isDirty[handles[i]] = false;
+	}
+}
+
+uint32_t CanvasCommandObjectTable::add(PassRefPtr<BitmapImage> image)
+{
+	uint32_t handle = allocate();
+	m_entries[handle].m_image = image;
+	markDirty(handle);
+	return handle;
+}
+
+uint32_t CanvasCommandObjectTable::add(PassRefPtr<CanvasStyle> style)
+{
+	uint32_t handle = allocate();
+	m_entries[handle].m_style = style;
+	markDirty(handle);
+	return handle;
+}
+
+uint32_t CanvasCommandObjectTable::add(PassRefPtr<ImageData> imageData)
+{
+	uint32_t handle = allocate();
+	m_entries[handle].m_imageData = imageData;
+	markDirty(handle);
+	return handle;
+}
+
+uint32_t CanvasCommandObjectTable::add(PassRefPtr<CanvasPath> path)
+{
+	uint32_t handle = allocate();
+	m_entries[handle].m_path = path;
+	markDirty(handle);
+	return handle;
+}
+
+void CanvasCommandObjectTable::remove(uint32_t handle)
+{
+	if (!handle || handle >= m_entries.size())
+	{
+		return;
+	}
+	Entry& e = m_entries[handle];
+	if (!e.m_image && !e.m_style && !e.m_imageData && !e.m_path)
+	{
+		return;
+	}
+	e.m_image.clear();
+	e.m_style.clear();
+	e.m_imageData.clear();
+	e.m_path.clear();
+	m_freeHandles.push_back(handle);
+	markDirty(handle);
+}
+
+CanvasCommandObjectTable::Entry* CanvasCommandObjectTable::slot(uint32_t handle)
+{
+	if (!handle)
+	{
+		return 0;
+	}
+	while (m_entries.size() <= handle)
+	{
+		m_freeHandles.push_back(static_cast<uint32_t>(m_entries.size()));
+		m_entries.push_back(Entry());
+	}
+	std::vector<uint32_t>::iterator it = std::find(m_freeHandles.begin(), m_freeHandles.end(), handle);
+	if (it != m_freeHandles.end())
+	{
+		m_freeHandles.erase(it);
+	}
+	Entry* e = &m_entries[handle];
+	*e = Entry();
+	markDirty(handle);
+	return e;
+}
+
+void CanvasCommandObjectTable::set(uint32_t handle, PassRefPtr<BitmapImage> image)
+{
+	if (Entry* e = slot(handle))
+	{
+		e->m_image = image;
+	}
+}
+
+void CanvasCommandObjectTable::set(uint32_t handle, PassRefPtr<CanvasStyle> style)
+{
+	if (Entry* e = slot(handle))
+	{
+		e->m_style = style;
+	}
+}
+
+void CanvasCommandObjectTable::set(uint32_t handle, PassRefPtr<ImageData> imageData)
+{
+	if (Entry* e = slot(handle))
+	{
+		e->m_imageData = imageData;
+	}
+}
+
+void CanvasCommandObjectTable::set(uint32_t handle, PassRefPtr<CanvasPath> path)
+{
+	if (Entry* e = slot(handle))
+	{
+		e->m_path = path;
+	}
+}
+
+void CanvasCommandObjectTable::clear()
+{
+	for (uint32_t handle = 1; handle < m_entries.size(); handle++)
+	{
+		markDirty(handle);
+	}
+	m_entries.clear();
+	m_entries.resize(1);
+	m_freeHandles.clear();
+}
+
+const CanvasCommandObjectTable::Entry* CanvasCommandObjectTable::entry(uint32_t handle) const
+{
+	if (!handle || handle >= m_entries.size())
+	{
+		return 0;
+	}
+	return &m_entries[handle];
+}
+
+BitmapImage* CanvasCommandObjectTable::image(uint32_t handle) const
+{
+	const Entry* e = entry(handle);
+	return e ? e->m_image.get() : 0;
+}
+
+CanvasStyle* CanvasCommandObjectTable::style(uint32_t handle) const
+{
+	const Entry* e = entry(handle);
+	return e ? e->m_style.get() : 0;
+}
+
+ImageData* CanvasCommandObjectTable::imageData(uint32_t handle) const
+{
+	const Entry* e = entry(handle);
+	return e ? e->m_imageData.get() : 0;
+}
+
+CanvasPath* CanvasCommandObjectTable::path(uint32_t handle) const
+{
+	const Entry* e = entry(handle);
+	return e ? e->m_path.get() : 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool CanvasCommandReader::require(size_t bytes)
+{
+	if (m_failed || static_cast<size_t>(m_end - m_data) < bytes)
+	{
+		m_failed = true;
+		m_data = m_end;
+		return false;
+	}
+	return true;
+}
+
+uint8_t CanvasCommandReader::readByte()
+{
+	if (!require(1))
+	{
+		return 0;
+	}
+	return *m_data++;
+}
+
+float CanvasCommandReader::readFloat()
+{
+	float value = 0;
+	if (require(sizeof(value)))
+	{
+		memcpy(&value, m_data, sizeof(value));
+		m_data += sizeof(value);
+	}
+	return value;
+}
+
+uint32_t CanvasCommandReader::readUInt()
+{
+	uint32_t value = 0;
+	if (require(sizeof(value)))
+	{
+		memcpy(&value, m_data, sizeof(value));
+		m_data += sizeof(value);
+	}
+	return value;
+}
+
+const char* CanvasCommandReader::readString(uint32_t& length)
+{
+	length = readUInt();
+	if (!require(length))
+	{
+		length = 0;
+		return "";
+	}
+	const char* s = reinterpret_cast<const char*>(m_data);
+	m_data += length;
+	return s;
+}
+
+void CanvasCommandReader::readString(std::string& out)
+{
+	uint32_t length;
+	const char* s = readString(length);
+	out.assign(s, length);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void CanvasCommandWriter::writeBytes(const void* bytes, size_t length)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(bytes);
+	m_buffer.insert(m_buffer.end(), p, p + length);
+}
+
+void CanvasCommandWriter::writeFloat(float value)
+{
+	writeBytes(&value, sizeof(value));
+}
+
+void CanvasCommandWriter::writeUInt(uint32_t value)
+{
+	writeBytes(&value, sizeof(value));
+}
+
+void CanvasCommandWriter::writeString(const char* s, size_t length)
+{
+	writeUInt(static_cast<uint32_t>(length));
+	writeBytes(s, length);
+}
+
+void CanvasCommandWriter::writeRect(CanvasCommandOpcode op, float x, float y, float width, float height)
+{
+	writeOpcode(op);
+	writeFloat(x);
+	writeFloat(y);
+	writeFloat(width);
+	writeFloat(height);
+}
+
+void CanvasCommandWriter::setTransform(float m11, float m12, float m21, float m22, float dx, float dy)
+{
+	writeOpcode(CanvasOpSetTransform);
+	writeFloat(m11);
+	writeFloat(m12);
+	writeFloat(m21);
+	writeFloat(m22);
+	writeFloat(dx);
+	writeFloat(dy);
+}
+
+void CanvasCommandWriter::arc(float x, float y, float radius, float startAngle, float endAngle, bool anticlockwise)
+{
+	writeOpcode(CanvasOpArc);
+	writeFloat(x);
+	writeFloat(y);
+	writeFloat(radius);
+	writeFloat(startAngle);
+	writeFloat(endAngle);
+	writeBool(anticlockwise);
+}
+
+void CanvasCommandWriter::drawImage(uint32_t image, float x, float y)
+{
+	writeOpcode(CanvasOpDrawImage);
+	writeUInt(image);
+	writeFloat(x);
+	writeFloat(y);
+}
+
+void CanvasCommandWriter::drawImage(uint32_t image, float sx, float sy, float sw, float sh, float dx, float dy, float dw, float dh)
+{
+	writeOpcode(CanvasOpDrawImageSubRect);
+	writeUInt(image);
+	writeFloat(sx);
+	writeFloat(sy);
+	writeFloat(sw);
+	writeFloat(sh);
+	writeFloat(dx);
+	writeFloat(dy);
+	writeFloat(dw);
+	writeFloat(dh);
+}
+
+void CanvasCommandWriter::fillText(const std::string& text, float x, float y)
+{
+	writeOpcode(CanvasOpFillText);
+	writeString(text);
+	writeFloat(x);
+	writeFloat(y);
+}
+
+} // namespace Canvas2D
@@ -0,0 +1,261 @@
+#ifndef CanvasCommandBuffer_h
+#define CanvasCommandBuffer_h
+
+#include "Noncopyable.h"
+#include "RefPtr.h"
+#include "passrefptr.h"
+#include "CanvasStyle.h"
+#include "ImageData.h"
+#include "BitmapImage.h"
+#include "CanvasPath.h"
+#include "string"
+#include "vector"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Canvas2D
+{
+
+// Binary command stream consumed by CanvasContext2D::executeCommands().
+//
+// Every command is a one byte opcode followed by its arguments, packed with
+// no padding:
+//   f  float32
+//   u  uint32 (object handles, counts)
+//   b  uint8 boolean
+//   s  uint32 byte length followed by that many bytes of UTF-8, no terminator
+// Multi-byte values are stored in host byte order, which is little-endian on
+// every platform we ship. The opcode values are part of the format and must
+// never be renumbered; append new commands at the end.
+//
+// Objects (images, styles, image data, paths) are referenced by handles obtained
+// from CanvasCommandObjectTable so a script never hands raw pointers to native
+// code.
+enum CanvasCommandOpcode
+{
+	CanvasOpSave = 1,                        //
+	CanvasOpRestore = 2,                     //
+	CanvasOpReset = 3,                       //
+
+	CanvasOpSetStrokeStyle = 10,             // u
+	CanvasOpSetFillStyle = 11,               // u
+	CanvasOpSetLineWidth = 12,               // f
+	CanvasOpSetLineCap = 13,                 // s
+	CanvasOpSetLineJoin = 14,                // s
+	CanvasOpSetMiterLimit = 15,              // f
+	CanvasOpSetLineDash = 16,                // u count, f * count
+	CanvasOpSetLineDashOffset = 17,          // f
+	CanvasOpSetShadowOffsetX = 18,           // f
+	CanvasOpSetShadowOffsetY = 19,           // f
+	CanvasOpSetShadowBlur = 20,              // f
+	CanvasOpSetShadowColor = 21,             // s
+	CanvasOpSetGlobalAlpha = 22,             // f
+	CanvasOpSetGlobalCompositeOperation = 23,// s
+	CanvasOpSetImageSmoothingEnabled = 24,   // b
+
+	CanvasOpScale = 30,                      // f sx, f sy
+	CanvasOpRotate = 31,                     // f angle
+	CanvasOpTranslate = 32,                  // f tx, f ty
+	CanvasOpTransform = 33,                  // f m11, f m12, f m21, f m22, f dx, f dy
+	CanvasOpSetTransform = 34,               // f m11, f m12, f m21, f m22, f dx, f dy
+	CanvasOpResetTransform = 35,             //
+	CanvasOpSetCurrentTransform = 36,        // f a, f b, f c, f d, f e, f f
+
+	CanvasOpSetStrokeColor = 40,             // s
+	CanvasOpSetStrokeColorGray = 41,         // f gray
+	CanvasOpSetStrokeColorAlpha = 42,        // s, f alpha
+	CanvasOpSetStrokeColorGrayAlpha = 43,    // f gray, f alpha
+	CanvasOpSetStrokeColorRGBA = 44,         // f r, f g, f b, f a
+	CanvasOpSetStrokeColorCMYKA = 45,        // f c, f m, f y, f k, f a
+	CanvasOpSetFillColor = 46,               // s
+	CanvasOpSetFillColorGray = 47,           // f gray
+	CanvasOpSetFillColorAlpha = 48,          // s, f alpha
+	CanvasOpSetFillColorGrayAlpha = 49,      // f gray, f alpha
+	CanvasOpSetFillColorRGBA = 50,           // f r, f g, f b, f a
+	CanvasOpSetFillColorCMYKA = 51,          // f c, f m, f y, f k, f a
+
+	CanvasOpBeginPath = 60,                  //
+	CanvasOpClosePath = 61,                  //
+	CanvasOpMoveTo = 62,                     // f x, f y
+	CanvasOpLineTo = 63,                     // f x, f y
+	CanvasOpQuadraticCurveTo = 64,           // f cpx, f cpy, f x, f y
+	CanvasOpBezierCurveTo = 65,              // f cp1x, f cp1y, f cp2x, f cp2y, f x, f y
+	CanvasOpArcTo = 66,                      // f x1, f y1, f x2, f y2, f radius
+	CanvasOpArc = 67,                        // f x, f y, f radius, f start, f end, b anticlockwise
+	CanvasOpEllipse = 68,                    // f x, f y, f rx, f ry, f rotation, f start, f end, b anticlockwise
+	CanvasOpRect = 69,                       // f x, f y, f w, f h
+
+	CanvasOpFill = 80,                       // s winding
+	CanvasOpStroke = 81,                     //
+	CanvasOpClip = 82,                       // s winding
+	CanvasOpClearRect = 83,                  // f x, f y, f w, f h
+	CanvasOpFillRect = 84,                   // f x, f y, f w, f h
+	CanvasOpStrokeRect = 85,                 // f x, f y, f w, f h
+	CanvasOpDrawImage = 86,                  // u image, f x, f y
+	CanvasOpPutImageData = 87,               // u imageData, f dx, f dy
+	CanvasOpFillPath = 88,                   // u path, s winding
+	CanvasOpStrokePath = 89,                 // u path
+	CanvasOpClipPath = 90,                   // u path, s winding
+	CanvasOpDrawImageRect = 91,              // u image, f dx, f dy, f dw, f dh
+	CanvasOpDrawImageSubRect = 92,           // u image, f sx, f sy, f sw, f sh, f dx, f dy, f dw, f dh
+
+	CanvasOpSetFont = 100,                   // s
+	CanvasOpSetTextAlign = 101,              // s
+	CanvasOpSetTextBaseline = 102,           // s
+	CanvasOpFillText = 103,                  // s text, f x, f y
+	CanvasOpStrokeText = 104                 // s text, f x, f y
+};
+
+// Handles used by the command stream to refer to native objects. Handle 0 is
+// never issued and always resolves to null. Released handles are recycled.
+//
+// The table remembers which handles changed since takeDirtyHandles() was last
+// called, so a CanvasSessionRecorder only writes those objects again. Adding,
+// setting, removing and clearing mark handles by themselves; an object changed
+// in place behind its handle has to be marked with markDirty().
+class CanvasCommandObjectTable
+{
+	WTF_MAKE_NONCOPYABLE(CanvasCommandObjectTable);
+public:
+	CanvasCommandObjectTable();
+	~CanvasCommandObjectTable();
+
+	uint32_t add(PassRefPtr<BitmapImage>);
+	uint32_t add(PassRefPtr<CanvasStyle>);
+	uint32_t add(PassRefPtr<ImageData>);
+	uint32_t add(PassRefPtr<CanvasPath>);
+	void remove(uint32_t handle);
+	void clear();
+
+	// Puts an object at a given handle, replacing whatever was there. Used to
+	// replay recorded sessions, whose buffers name the recorded handles.
+	void set(uint32_t handle, PassRefPtr<BitmapImage>);
+	void set(uint32_t handle, PassRefPtr<CanvasStyle>);
+	void set(uint32_t handle, PassRefPtr<ImageData>);
+	void set(uint32_t handle, PassRefPtr<CanvasPath>);
+	// One more than the highest handle in use; handles below it may be empty.
+	uint32_t handleLimit() const { return static_cast<uint32_t>(m_entries.size()); }
+
+	// Call after changing the object behind |handle| without going through
+	// the table: giving an image a new src, editing a retained path, or
+	// writing an ImageData's pixels through data().
+	void markDirty(uint32_t handle);
+	// Moves the handles marked since the last call into |handles|, each
+	// once. Handles at or past handleLimit() were cleared.
+	void takeDirtyHandles(std::vector<uint32_t>& handles);
+
+	BitmapImage* image(uint32_t handle) const;
+	CanvasStyle* style(uint32_t handle) const;
+	ImageData* imageData(uint32_t handle) const;
+	CanvasPath* path(uint32_t handle) const;
+
+private:
+	struct Entry
+	{
+		RefPtr<BitmapImage> m_image;
+		RefPtr<CanvasStyle> m_style;
+		RefPtr<ImageData> m_imageData;
+		RefPtr<CanvasPath> m_path;
+	};
+
+	uint32_t allocate();
+	Entry* slot(uint32_t handle);
+	const Entry* entry(uint32_t handle) const;
+
+	std::vector<Entry> m_entries;
+	std::vector<uint32_t> m_freeHandles;
+	std::vector<uint32_t> m_dirtyHandles;
+	// Indexed by handle; kept across clear() so a handle is listed once.
+	std::vector<bool> m_isDirty;
+};
+
+// Bounds checked decoder for the format above. Any read past the end of the
+// buffer marks the reader as failed and returns zeroed values.
+class CanvasCommandReader
+{
+public:
+	CanvasCommandReader(const uint8_t* data, size_t length)
+		: m_data(data)
+		, m_end(data + length)
+		, m_failed(false)
+	{
+	}
+
+	bool atEnd() const { return m_data >= m_end; }
+	bool failed() const { return m_failed; }
+
+	uint8_t readOpcode() { return readByte(); }
+	float readFloat();
+	uint32_t readUInt();
+	bool readBool() { return readByte() != 0; }
+	// Returns a pointer into the buffer, valid for the reader's lifetime.
+	const char* readString(uint32_t& length);
+	// Copies the string into |out|, reusing its storage when possible.
+	void readString(std::string& out);
+
+private:
+	uint8_t readByte();
+	bool require(size_t bytes);
+
+	const uint8_t* m_data;
+	const uint8_t* m_end;
+	bool m_failed;
+};
+
+// Encoder for the format above. Used by native callers and the benchmarks;
+// script bindings are expected to produce the same bytes.
+class CanvasCommandWriter
+{
+public:
+	CanvasCommandWriter() { }
+
+	const uint8_t* data() const { return m_buffer.empty() ? 0 : &m_buffer[0]; }
+	size_t size() const { return m_buffer.size(); }
+	void reset() { m_buffer.clear(); }
+
+	void writeOpcode(CanvasCommandOpcode op) { m_buffer.push_back(static_cast<uint8_t>(op)); }
+	void writeFloat(float);
+	void writeUInt(uint32_t);
+	void writeBool(bool b) { m_buffer.push_back(b ? 1 : 0); }
+	void writeString(const char*, size_t length);
+	void writeString(const std::string& s) { writeString(s.data(), s.length()); }
+
+	void save() { writeOpcode(CanvasOpSave); }
+	void restore() { writeOpcode(CanvasOpRestore); }
+	void setFillColor(const std::string& color) { writeOpcode(CanvasOpSetFillColor); writeString(color); }
+	void setStrokeColor(const std::string& color) { writeOpcode(CanvasOpSetStrokeColor); writeString(color); }
+	void setFillStyle(uint32_t style) { writeOpcode(CanvasOpSetFillStyle); writeUInt(style); }
+	void setStrokeStyle(uint32_t style) { writeOpcode(CanvasOpSetStrokeStyle); writeUInt(style); }
+	void setLineWidth(float width) { writeOpcode(CanvasOpSetLineWidth); writeFloat(width); }
+	void setGlobalAlpha(float alpha) { writeOpcode(CanvasOpSetGlobalAlpha); writeFloat(alpha); }
+	void translate(float tx, float ty) { writeOpcode(CanvasOpTranslate); writeFloat(tx); writeFloat(ty); }
+	void rotate(float angle) { writeOpcode(CanvasOpRotate); writeFloat(angle); }
+	void scale(float sx, float sy) { writeOpcode(CanvasOpScale); writeFloat(sx); writeFloat(sy); }
+	void setTransform(float m11, float m12, float m21, float m22, float dx, float dy);
+	void beginPath() { writeOpcode(CanvasOpBeginPath); }
+	void closePath() { writeOpcode(CanvasOpClosePath); }
+	void moveTo(float x, float y) { writeOpcode(CanvasOpMoveTo); writeFloat(x); writeFloat(y); }
+	void lineTo(float x, float y) { writeOpcode(CanvasOpLineTo); writeFloat(x); writeFloat(y); }
+	void arc(float x, float y, float radius, float startAngle, float endAngle, bool anticlockwise);
+	void rect(float x, float y, float width, float height) { writeRect(CanvasOpRect, x, y, width, height); }
+	void fill() { writeOpcode(CanvasOpFill); writeString("nonzero", 7); }
+	void stroke() { writeOpcode(CanvasOpStroke); }
+	void fillPath(uint32_t path) { writeOpcode(CanvasOpFillPath); writeUInt(path); writeString("nonzero", 7); }
+	void strokePath(uint32_t path) { writeOpcode(CanvasOpStrokePath); writeUInt(path); }
+	void clearRect(float x, float y, float width, float height) { writeRect(CanvasOpClearRect, x, y, width, height); }
+	void fillRect(float x, float y, float width, float height) { writeRect(CanvasOpFillRect, x, y, width, height); }
+	void strokeRect(float x, float y, float width, float height) { writeRect(CanvasOpStrokeRect, x, y, width, height); }
+	void drawImage(uint32_t image, float x, float y);
+	void drawImage(uint32_t image, float sx, float sy, float sw, float sh, float dx, float dy, float dw, float dh);
+	void fillText(const std::string& text, float x, float y);
+
+private:
+	void writeBytes(const void*, size_t);
+	void writeRect(CanvasCommandOpcode, float x, float y, float width, float height);
+
+	std::vector<uint8_t> m_buffer;
+};
+
+} // namespace Canvas2D
+
+#endif // CanvasCommandBuffer_h
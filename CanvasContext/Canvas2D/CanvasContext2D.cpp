@@ -8,6 +8,7 @@
 #include "SkTypeface.h"
 #include "BitmapImage.h"
 #include "ImageData.h"
+#include "SkTraceEvent.h"
 #include <sstream>
 
 static const int defaultFontSize = 30;
@@ -20,96 +21,70 @@ static const char defaultFont[] = "10px sans-serif";
 //	return (c & 0x00FFFFFF) | (a << 24);
 //}
 
-static bool parseWinding(const std::string& windingRuleString, WindRule& windRule)
-{
-	if (windingRuleString == "nonzero")
-		windRule = RULE_NONZERO;
-	else if (windingRuleString == "evenodd")
-		windRule = RULE_EVENODD;
-	else
-		return false;
-
-	return true;
-}
-
-void canonicalizeAngle(float* startAngle, float* endAngle)
-{
-	// Make 0 <= startAngle < 2*PI
-	float newStartAngle = *startAngle;
-	if (newStartAngle < 0)
-		newStartAngle = twoPiFloat + fmodf(newStartAngle, -twoPiFloat);
-	else
-		newStartAngle = fmodf(newStartAngle, twoPiFloat);
-
-	float delta = newStartAngle - *startAngle;
-	*startAngle = newStartAngle;
-	*endAngle = *endAngle + delta;
-}
-
-
-float adjustEndAngle(float startAngle, float endAngle, bool anticlockwise)
-{
-	float newEndAngle = endAngle;
-	if (!anticlockwise && endAngle - startAngle >= twoPiFloat)
-		newEndAngle = startAngle + twoPiFloat;
-	else if (anticlockwise && startAngle - endAngle >= twoPiFloat)
-		newEndAngle = startAngle - twoPiFloat;
-	else if (!anticlockwise && startAngle > endAngle)
-		newEndAngle = startAngle + (twoPiFloat - fmodf(startAngle - endAngle, twoPiFloat));
-	else if (anticlockwise && startAngle < endAngle)
-		newEndAngle = startAngle - (twoPiFloat - fmodf(endAngle - startAngle, twoPiFloat));
-
-	return newEndAngle;
-}
-
 //////////////////////////////////////////////////////////////////////////
 
 CanvasContext2D::CanvasContext2D(SkCanvas*canvas )
 {	
 	m_pCanvas = canvas;
 	m_stateStack.resize(1);
-	m_strokePaint.setStyle(SkPaint::kStroke_Style);
-	m_strokePaint.setAntiAlias(true);
-	m_fillPaint.setStyle(SkPaint::kFill_Style);
-	m_fillPaint.setAntiAlias(true);
-	m_strokePaint.setStrokeWidth(1);
+	m_pathTransform.reset();
+	m_inversePathTransform.reset();
+	m_pathTransformInvertible = true;
+	m_tracksDamage = false;
+	m_imageAtlas = 0;
+	m_lastImageID = 0;
+	m_imageBindCount = 0;
+	m_sessionRecorder = 0;
 	modifiableState().m_globalAlpha = 256;
+	applyFont(m_fontCache.get(defaultFont));
 
 }
 
 CanvasContext2D::~CanvasContext2D()
 {
+	flush();
+	delete m_imageAtlas;
 	m_path.reset();
 }
 
 CanvasStyle *CanvasContext2D::strokeStyle() const
 {
-	return NULL;
+	return state().m_strokeStyle.get();
 }
 
 void CanvasContext2D::setStrokeStyle(PassRefPtr<CanvasStyle>prpStyle)
 {
-
+	RefPtr<CanvasStyle> style = prpStyle;
+	if (!style)
+	{
+		return;
+	}
+	applyStokeColor(style);
 }
 
-void CanvasContext2D::applyStokeColor(PassRefPtr<CanvasStyle>style)
+void CanvasContext2D::applyStokeColor(PassRefPtr<CanvasStyle>prpStyle)
 {
-	m_strokeColor = style->getRgba();
+	RefPtr<CanvasStyle> style = prpStyle;
+	State& s = modifiableState();
+	s.m_strokeStyle = style;
+	s.m_strokeColor = style->getRgba();
 	switch (style->getType())
 	{
 	case CanvasStyle::RGBA:
-		m_strokePaint.setColor(style->getRgba());
+		s.m_strokePaint.setColor(style->getRgba());
+		s.m_strokePaint.setShader(NULL);
 		break;
 	case CanvasStyle::CMYKA:
-		m_strokePaint.setColor(style->getRgba());
+		s.m_strokePaint.setColor(style->getRgba());
+		s.m_strokePaint.setShader(NULL);
 		break;
 	case CanvasStyle::Gradient:
-		m_strokePaint.setColor(0xff000000);
-		m_strokePaint.setShader(style->canvasGradient()->gradient()->shader());
+		s.m_strokePaint.setColor(0xff000000);
+		s.m_strokePaint.setShader(style->canvasGradient()->gradient()->shader(&m_gradientCache));
 		break;
 	case  CanvasStyle::ImagePattern:
-		m_strokePaint.setColor(0xff000000);
-		m_strokePaint.setShader(style->canvasPattern()->pattern()->shader());
+		s.m_strokePaint.setColor(0xff000000);
+		s.m_strokePaint.setShader(style->canvasPattern()->pattern()->shader());
 		break;
 	default:
 		break;
@@ -118,7 +93,7 @@ void CanvasContext2D::applyStokeColor(PassRefPtr<CanvasStyle>style)
 
 CanvasStyle* CanvasContext2D::fillStyle() const
 {
-	return NULL;
+	return state().m_fillStyle.get();
 }
 void CanvasContext2D::setFillStyle(PassRefPtr<CanvasStyle> prpStyle)
 {
@@ -130,24 +105,29 @@ void CanvasContext2D::setFillStyle(PassRefPtr<CanvasStyle> prpStyle)
 	applyFillColor(style);
 }
 
-void CanvasContext2D::applyFillColor(PassRefPtr<CanvasStyle> style )
+void CanvasContext2D::applyFillColor(PassRefPtr<CanvasStyle> prpStyle )
 {
-	m_fillColor = style->getRgba();
+	RefPtr<CanvasStyle> style = prpStyle;
+	State& s = modifiableState();
+	s.m_fillStyle = style;
+	s.m_fillColor = style->getRgba();
 	switch (style->getType())
 	{
 	case CanvasStyle::RGBA:	
-		m_fillPaint.setColor(applyAlpha(style->getRgba()));
+		s.m_fillPaint.setColor(applyAlpha(style->getRgba()));
+		s.m_fillPaint.setShader(NULL);
 		break;
 	case CanvasStyle::CMYKA:
-		m_fillPaint.setColor(applyAlpha(style->getRgba()));
+		s.m_fillPaint.setColor(applyAlpha(style->getRgba()));
+		s.m_fillPaint.setShader(NULL);
 		break;
 	case CanvasStyle::Gradient:
-		m_fillPaint.setColor(0xff000000);
-		m_fillPaint.setShader(style->canvasGradient()->gradient()->shader());
+		s.m_fillPaint.setColor(0xff000000);
+		s.m_fillPaint.setShader(style->canvasGradient()->gradient()->shader(&m_gradientCache));
 		break;
 	case  CanvasStyle::ImagePattern:
-		m_fillPaint.setColor(0xff000000);
-		m_fillPaint.setShader(style->canvasPattern()->pattern()->shader());
+		s.m_fillPaint.setColor(0xff000000);
+		s.m_fillPaint.setShader(style->canvasPattern()->pattern()->shader());
 		break;
 	default:
 		break;
@@ -160,7 +140,7 @@ float CanvasContext2D::lineWidth() const
 }
 void CanvasContext2D::setLineWidth(float thickness )
 {
-	m_strokePaint.setStrokeWidth(thickness);
+	modifiableState().m_strokePaint.setStrokeWidth(thickness);
 }
 
 std::string CanvasContext2D::lineCap() const
@@ -175,12 +155,17 @@ void CanvasContext2D::setLineCap(const std::string& s)
 	{
 		return;
 	}
-	if ( m_strokePaint.getStrokeCap() == cap )
+	setLineCap(cap);
+}
+void CanvasContext2D::setLineCap(LineCap cap)
+{
+	if ( state().m_strokePaint.getStrokeCap() == cap )
 	{
 		return;
 	}
-	modifiableState().m_lineCap = cap;
-	m_strokePaint.setStrokeCap((SkPaint::Cap)cap);
+	State& s = modifiableState();
+	s.m_lineCap = cap;
+	s.m_strokePaint.setStrokeCap((SkPaint::Cap)cap);
 }
 
 std::string CanvasContext2D::lineJoin() const
@@ -196,12 +181,17 @@ void CanvasContext2D::setLineJoin(const std::string&s)
 	{
 		return;
 	}
-	if ( m_strokePaint.getStrokeJoin() == join )
+	setLineJoin(join);
+}
+void CanvasContext2D::setLineJoin(LineJoin join)
+{
+	if ( state().m_strokePaint.getStrokeJoin() == join )
 	{
 		return;
 	}
-	modifiableState().m_lineJoin = join;
-	m_strokePaint.setStrokeJoin((SkPaint::Join)join);
+	State& s = modifiableState();
+	s.m_lineJoin = join;
+	s.m_strokePaint.setStrokeJoin((SkPaint::Join)join);
 }
 
 float CanvasContext2D::miterLimit() const
@@ -210,7 +200,7 @@ float CanvasContext2D::miterLimit() const
 }
 void CanvasContext2D::setMiterLimit(float miterLimit)
 {
-	m_strokePaint.setStrokeMiter(miterLimit);
+	modifiableState().m_strokePaint.setStrokeMiter(miterLimit);
 }
 
 const std::vector<float>& CanvasContext2D::getLineDash() const
@@ -294,11 +284,15 @@ std::string CanvasContext2D::shadowColor() const
 }
 void CanvasContext2D::setShadowColor(const std::string& color )
 {
-	RGBA32 rgba;
-	if (!parseColorOrCurrentColor(rgba, color))
+	setShadowColorFromCache(m_styleCache.get(color));
+}
+void CanvasContext2D::setShadowColorFromCache(CanvasStyle* style)
+{
+	if ( !style )
 	{
 		return;
 	}
+	RGBA32 rgba = style->isCurrentColor() ? currentColor() : style->getRgba();
 	if ( state().m_shadowColor == rgba )
 	{
 		return;
@@ -322,16 +316,14 @@ void CanvasContext2D::setGlobalAlpha(float alpha)
 		return;
 	}
 
-	modifiableState().m_globalAlpha = roundf(alpha * 256 );
-
-	float fa = modifiableState().m_globalAlpha;
-	fa += 0;
+	State& s = modifiableState();
+	s.m_globalAlpha = roundf(alpha * 256 );
 
-	SkColor strokeColor = applyAlpha(m_strokeColor.rgb());
-	m_strokePaint.setColor(strokeColor);
+	SkColor strokeColor = applyAlpha(s.m_strokeColor.rgb());
+	s.m_strokePaint.setColor(strokeColor);
 
-	SkColor fillColor = applyAlpha(m_fillColor.rgb());
-	m_fillPaint.setColor(fillColor);
+	SkColor fillColor = applyAlpha(s.m_fillColor.rgb());
+	s.m_fillPaint.setColor(fillColor);
 
 	
 	 
@@ -347,28 +339,65 @@ void CanvasContext2D::setGlobalCompositeOperation(const std::string&operation)
 	WebBlendMode blendMode =WebBlendModeNormal;
 	if (!parseCompositeAndBlendOperator(operation, op, blendMode))
 		return;
+	setGlobalCompositeOperation(op, blendMode);
+}
+void CanvasContext2D::setGlobalCompositeOperation(CompositeOperator op, WebBlendMode blendMode)
+{
 	if ((state().m_globalComposite == op) && (state().m_globalBlend == blendMode))
 		return;
-	modifiableState().m_globalComposite = op;
-	modifiableState().m_globalBlend = blendMode;
+	State& s = modifiableState();
+	s.m_globalComposite = op;
+	s.m_globalBlend = blendMode;
 	RefPtr<SkXfermode>xferMode = WebCoreCompositeToSkiaComposite(op, blendMode);
-	m_strokePaint.setXfermode(xferMode.get());
-	m_fillPaint.setXfermode(xferMode.get());
+	s.m_strokePaint.setXfermode(xferMode.get());
+	s.m_fillPaint.setXfermode(xferMode.get());
 }
 
 void CanvasContext2D::save()
 {
-	m_pCanvas->save();
+	m_stateStack.back().m_unrealizedSaveCount++;
 }
 void CanvasContext2D::restore()
 {
+	if (state().m_unrealizedSaveCount)
+	{
+		// Nothing changed since the matching save().
+		m_stateStack.back().m_unrealizedSaveCount--;
+		return;
+	}
+	if (m_stateStack.size() <= 1)
+	{
+		return;
+	}
+	// Queued sprites were clipped by the state being popped.
+	flush();
+	m_stateStack.pop_back();
 	m_pCanvas->restore();
 }
 
-
-void CanvasContext2D::setCurrentTransform(PassRefPtr<AffineTransform>)
+void CanvasContext2D::realizeSaves()
 {
+	if (!m_stateStack.back().m_unrealizedSaveCount)
+	{
+		return;
+	}
+	m_stateStack.back().m_unrealizedSaveCount--;
+	// Copy first; push_back may reallocate the storage back() points into.
+	State newState(m_stateStack.back());
+	newState.m_unrealizedSaveCount = 0;
+	m_stateStack.push_back(newState);
+	m_pCanvas->save();
+}
+
 
+void CanvasContext2D::setCurrentTransform(PassRefPtr<AffineTransform> prpTransform)
+{
+	AffineTransform* transform = prpTransform.get();
+	if ( !transform )
+	{
+		return;
+	}
+	setTransform(transform->a(), transform->b(), transform->c(), transform->d(), transform->e(), transform->f());
 }
 
 void CanvasContext2D::scale(float sx, float sy)
@@ -377,8 +406,13 @@ void CanvasContext2D::scale(float sx, float sy)
 	{
 		return;
 	}
-	SkMatrix mat = affineTransformToSkMatrix(AffineTransform().scaleNonUniform(1.0f / sx, 1.0f / sy));
-	m_path.transform(mat);
+	AffineTransform newTransform = state().m_transform;
+	newTransform.scaleNonUniform(sx, sy);
+	if ( state().m_transform == newTransform )
+	{
+		return;
+	}
+	modifiableState().m_transform = newTransform;
 	m_pCanvas->scale(sx, sy);
 }
 
@@ -392,14 +426,22 @@ void CanvasContext2D::rotate(float angleInRadians)
 	}
 	modifiableState().m_transform = newTransform;
 	m_pCanvas->rotate(angleInRadians * ( 180 / M_PI));
-	AffineTransform trans = AffineTransform().rotateRadians(-angleInRadians);
-	m_path.transform(affineTransformToSkMatrix(trans));
 	return;
 }
 
 void CanvasContext2D::translate(float tx, float ty)
 {
-
+	if ( !std::isfinite( tx ) | !std::isfinite( ty ))
+	{
+		return;
+	}
+	AffineTransform newTransform = state().m_transform;
+	newTransform.translate(tx, ty);
+	if ( state().m_transform == newTransform )
+	{
+		return;
+	}
+	modifiableState().m_transform = newTransform;
 	m_pCanvas->translate(tx, ty);
 }
 void CanvasContext2D::transform(float m11, float m12, float m21, float m22, float dx, float dy)
@@ -414,7 +456,6 @@ void CanvasContext2D::transform(float m11, float m12, float m21, float m22, floa
 	}
 	modifiableState().m_transform = newTransform;
 	m_pCanvas->concat(affineTransformToSkMatrix(transform));
-	m_path.transform(affineTransformToSkMatrix(transform.inverse()));
 	return;
 }
 void CanvasContext2D::setTransform(float m11, float m12, float m21, float m22, float dx, float dy)
@@ -428,28 +469,74 @@ void CanvasContext2D::setTransform(float m11, float m12, float m21, float m22, f
 }
 void CanvasContext2D::resetTransform()
 {
-	AffineTransform ctm = state().m_transform;
-	bool invertribleCTM = state().m_invertibleCTM;
-	if (ctm.isIdentity())
+	if (state().m_transform.isIdentity())
 	{
 		return;
 	}
 	modifiableState().m_transform.makeIdentity();
 	m_pCanvas->setMatrix(affineTransformToSkMatrix(AffineTransform()));
-	if (invertribleCTM)
+}
+
+void CanvasContext2D::updatePathTransform()
+{
+	const AffineTransform& ctm = state().m_transform;
+	if (ctm == m_pathTransformCTM)
 	{
-		m_path.transform(affineTransformToSkMatrix(ctm));
+		return;
 	}
+	m_pathTransformCTM = ctm;
+	m_pathTransform = affineTransformToSkMatrix(ctm);
+	m_pathTransformInvertible = m_pathTransform.invert(&m_inversePathTransform);
+}
+
+const SkMatrix* CanvasContext2D::pathTransform()
+{
+	updatePathTransform();
+	return m_pathTransform.isIdentity() ? NULL : &m_pathTransform;
+}
+
+const SkMatrix* CanvasContext2D::inversePathTransform()
+{
+	updatePathTransform();
+	return m_pathTransform.isIdentity() || !m_pathTransformInvertible ? NULL : &m_inversePathTransform;
+}
+
+// Drawing and clipping go through the canvas matrix, so m_path has to be
+// brought back into user space first; that also keeps shaders, line widths
+// and dashes in user space. Returns NULL if the CTM cannot be inverted.
+const SkPath* CanvasContext2D::userSpacePath(SkPath& storage)
+{
+	if (!pathTransform())
+	{
+		return &m_path;
+	}
+	const SkMatrix* inverse = inversePathTransform();
+	if (!inverse)
+	{
+		return NULL;
+	}
+	m_path.transform(*inverse, &storage);
+	return &storage;
 }
 
 void CanvasContext2D::setStrokeColor(const std::string& color)
 {
-	RefPtr<CanvasStyle> style = CanvasStyle::createFromString(color);
+	setStrokeColorFromCache(m_styleCache.get(color));
+}
+void CanvasContext2D::setStrokeColorFromCache(CanvasStyle* style)
+{
 	if (!style)
 	{
 		return;
 	}
-	applyStokeColor(style);;
+	// Scripts tend to set the same color before every stroke; leave the
+	// paint alone when nothing would change.
+	CanvasStyle* current = state().m_strokeStyle.get();
+	if (current == style || (current && style->isEquivalentColor(*current)))
+	{
+		return;
+	}
+	applyStokeColor(style);
 }
 void CanvasContext2D::setStrokeColor(float grayLevel)
 {
@@ -474,11 +561,19 @@ void CanvasContext2D::setStrokeColor(float c, float m, float y, float k, float a
 
 void CanvasContext2D::setFillColor(const std::string &color)
 {
-	RefPtr<CanvasStyle> style = CanvasStyle::createFromString(color);
+	setFillColorFromCache(m_styleCache.get(color));
+}
+void CanvasContext2D::setFillColorFromCache(CanvasStyle* style)
+{
 	if ( !style )
 	{
 		return;
 	}
+	CanvasStyle* current = state().m_fillStyle.get();
+	if (current == style || (current && style->isEquivalentColor(*current)))
+	{
+		return;
+	}
 	applyFillColor(style);
 }
 void CanvasContext2D::setFillColor(float grayLevel)
@@ -507,254 +602,456 @@ void CanvasContext2D::beginPath()
 	m_path.reset();
 }
 
-void CanvasContext2D::closePath()
+void CanvasContext2D::fill(const std::string& winding)
 {
-	if ( m_path.isEmpty() )
+	WindRule windRule = RULE_NONZERO;
+	if ( !parseWindRule( winding, windRule ))
 	{
 		return;
 	}
-	m_path.close();
+	fill(windRule);
 }
-
-void CanvasContext2D::moveTo(float x, float y)
+void CanvasContext2D::fill(WindRule windRule)
 {
-	if (!std::isfinite(x) || !std::isfinite(y))
-		return;
-	if (!isTransformInvertible())
-		return;
-	m_path.moveTo(x, y);
+	SkPath storage;
+	if (const SkPath* path = userSpacePath(storage))
+	{
+		fillInternal(*path, windRule);
+	}
 }
 
-void CanvasContext2D::lineTo(float x, float y)
+void CanvasContext2D::fill(CanvasPath* path, const std::string& winding)
 {
-	if (!std::isfinite(x) || !std::isfinite(y))
-		return;
-	if (!isTransformInvertible())
-		return;
-	SkPoint p1 = SkPoint::Make(x, y);
-	if (! hasCurrentPoint())
+	WindRule windRule = RULE_NONZERO;
+	if (!path || !parseWindRule(winding, windRule))
 	{
-		m_path.moveTo(x, y);
+		return;
 	}
-	else if (p1 != currentPoint())
+	fillInternal(path->path(), windRule);
+}
+void CanvasContext2D::fill(CanvasPath* path, WindRule windRule)
+{
+	if (!path)
 	{
-		m_path.lineTo(x, y);
+		return;
 	}
-
-
+	fillInternal(path->path(), windRule);
 }
 
-void CanvasContext2D::quadraticCurveTo(float cpx, float cpy, float x, float y)
+void CanvasContext2D::fillInternal(const SkPath& path, WindRule windRule)
 {
-	if (!std::isfinite(cpx) || !std::isfinite(cpy) || !std::isfinite(x) || !std::isfinite(y))
-		return;
-	if ( !hasCurrentPoint() )
+	TRACE_EVENT0("canvas", "CanvasContext2D::fill");
+	if (path.isEmpty())
 	{
-		m_path.moveTo(cpx, cpy);
+		return;
 	}
-	SkPoint p1 = SkPoint::Make(x, y);
-	SkPoint cp = SkPoint::Make(cpx, cpy);
-	if ( p1 != currentPoint()  || p1 != cp )
+	flush();
+	// Fill type changes keep the generation ID, so a retained path drawn with
+	// either rule still hits caches keyed on it.
+	SkPath::FillType fillType = windRule == RULE_EVENODD ? SkPath::kEvenOdd_FillType : SkPath::kWinding_FillType;
+	didDraw(path.getBounds(), &state().m_fillPaint);
+	if (path.getFillType() == fillType)
 	{
-		m_path.quadTo(cp, p1);
+		m_pCanvas->drawPath(path, state().m_fillPaint);
+		return;
 	}
+	SkPath filled(path);
+	filled.setFillType(fillType);
+	m_pCanvas->drawPath(filled, state().m_fillPaint);
 }
-void CanvasContext2D::bezierCurveTo(float cp1x, float cp1y, float cp2x, float cp2y, float x, float y)
+
+
+void CanvasContext2D::stroke()
 {
-	if (!std::isfinite(cp1x) || !std::isfinite(cp1y) || !std::isfinite(cp2x) || !std::isfinite(cp2y) || !std::isfinite(x) || !std::isfinite(y))
-		return;
-	if ( ! hasCurrentPoint() )
-	{
-		m_path.moveTo(cp1x, cp1y);
-	}
-	SkPoint p1 = SkPoint::Make(x, y);
-	SkPoint cp1 = SkPoint::Make(cp1x, cp1y);
-	SkPoint cp2 = SkPoint::Make(cp2x, cp2y);
-	if ( p1 != currentPoint() || p1 != cp1 || p1 != cp2 )
+	SkPath storage;
+	if (const SkPath* path = userSpacePath(storage))
 	{
-		m_path.cubicTo(cp1, cp2, p1);
+		strokeInternal(*path);
 	}
-	return;
 }
 
-void CanvasContext2D::arcTo(float x1, float y1, float x2, float y2, float radius)
+void CanvasContext2D::stroke(CanvasPath* path)
 {
-	if (!std::isfinite(x1) || !std::isfinite(y1) || !std::isfinite(x2) || !std::isfinite(y2) || !std::isfinite(radius))
-		return;
-
-	if (radius< 0) {
+	if (!path)
+	{
 		return;
 	}
+	strokeInternal(path->path());
+}
 
-	if (!isTransformInvertible())
-		return;
-
-	SkPoint p1 = SkPoint::Make(x1, y1);
-	SkPoint p2 = SkPoint::Make(x2, y2);
-	if ( ! hasCurrentPoint() )
+void CanvasContext2D::strokeInternal(const SkPath& path)
+{
+	TRACE_EVENT0("canvas", "CanvasContext2D::stroke");
+	if (path.isEmpty())
 	{
-		m_path.moveTo(x1, y1);
+		return;
 	}
-	else if (p1 == currentPoint() || p1 == p2 || !radius)
+	flush();
+	didDraw(path.getBounds(), &state().m_strokePaint);
+	m_pCanvas->drawPath(path, state().m_strokePaint);
+}
+
+void CanvasContext2D::clip(const std::string& winding)
+{
+	WindRule newWindRule = RULE_NONZERO;
+	if ( ! parseWindRule( winding, newWindRule ))
 	{
-		lineTo(x1, y1);
+		return;
 	}
-	else
+	clip(newWindRule);
+}
+void CanvasContext2D::clip(WindRule newWindRule)
+{
+	SkPath storage;
+	if (const SkPath* path = userSpacePath(storage))
 	{
-		m_path.arcTo(x1, y1, x2, y2, radius);
+		clipInternal(*path, newWindRule);
 	}
 }
 
-void CanvasContext2D::arc(float x, float y, float radius, float startAngle, float endAngle, bool anticlockwise)
+void CanvasContext2D::clip(CanvasPath* path, const std::string& winding)
 {
-	if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(radius) || !std::isfinite(startAngle) || !std::isfinite(endAngle))
-		return;
-
-	if (radius < 0) {
+	WindRule newWindRule = RULE_NONZERO;
+	if (!path || !parseWindRule(winding, newWindRule))
+	{
 		return;
 	}
-
-	if (!isTransformInvertible())
-		return;
-
-	if (!radius || startAngle == endAngle) {
-		// The arc is empty but we still need to draw the connecting line.
-		lineTo(x + radius * cosf(startAngle), y + radius * sinf(startAngle));
+	clipInternal(path->path(), newWindRule);
+}
+void CanvasContext2D::clip(CanvasPath* path, WindRule newWindRule)
+{
+	if (!path)
+	{
 		return;
 	}
-
-	canonicalizeAngle(&startAngle, &endAngle);
-	float adjustedEndAngle = adjustEndAngle(startAngle, endAngle, anticlockwise);
-	addEllipse(FloatPoint(x, y), radius, radius, startAngle, adjustedEndAngle, anticlockwise);
-
+	clipInternal(path->path(), newWindRule);
 }
 
-void CanvasContext2D::ellipse(float x, float y, float radiusX, float radiusY, float rotation, float startAngle, float endAngle, bool anticlockwise)
+void CanvasContext2D::clipInternal(const SkPath& path, WindRule newWindRule)
 {
-
+	// The clip lives on the canvas, so a pending save has to reach it first.
+	// Sprites queued before the clip must not be clipped by it.
+	realizeSaves();
+	flush();
+	Clip clip;
+	clip.m_path = path;
+	clip.m_path.setFillType(newWindRule == RULE_EVENODD ? SkPath::kEvenOdd_FillType : SkPath::kWinding_FillType);
+	clip.m_transform = affineTransformToSkMatrix(state().m_transform);
+	m_pCanvas->clipPath(clip.m_path);
+	modifiableState().m_clips.push_back(clip);
 }
 
-void CanvasContext2D::rect(float x, float y, float width, float height)
+bool CanvasContext2D::isPointInPath(const float x, const float y, const std::string& winding)
 {
-	if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(width) || !std::isfinite(height))
-		return;
-	if ( !width && !height )
-	{
-		m_path.moveTo(x, y);
-	}
-	m_path.addRect(x, y, x + width, y + height);
+	WindRule windRule = RULE_NONZERO;
+	if (!parseWindRule(winding, windRule))
+		return false;
+	return isPointInPath(x, y, windRule);
+}
+bool CanvasContext2D::isPointInPath(const float x, const float y, WindRule windRule)
+{
+	// m_path is already in device space, which is where (x, y) is given.
+	if (!std::isfinite(x) || !std::isfinite(y))
+		return false;
+	return SkPathContainsPoint(m_path, SkPoint::Make(x, y), windRule == RULE_NONZERO ? SkPath::kWinding_FillType : SkPath::kEvenOdd_FillType);
 }
 
+bool CanvasContext2D::isPointInPath(CanvasPath* path, const float x, const float y, const std::string& winding)
+{
+	WindRule windRule = RULE_NONZERO;
+	if (!path || !parseWindRule(winding, windRule))
+		return false;
+	return isPointInPathInternal(path->path(), x, y, windRule);
+}
+bool CanvasContext2D::isPointInPath(CanvasPath* path, const float x, const float y, WindRule windRule)
+{
+	if (!path)
+		return false;
+	return isPointInPathInternal(path->path(), x, y, windRule);
+}
 
-void CanvasContext2D::addEllipse(const FloatPoint& p, float radiusX, float radiusY, float startAngle, float endAngle, bool anticlockwise)
+bool CanvasContext2D::isPointInPathInternal(const SkPath& path, float x, float y, WindRule windRule)
 {
-	SkScalar cx = (p.x());
-	SkScalar cy = (p.y());
-	SkScalar radiusXScalar = (radiusX);
-	SkScalar radiusYScalar = (radiusY);
+	FloatPoint point(x, y);
+	AffineTransform ctm = state().m_transform;
+	FloatPoint transformedPoint = ctm.inverse().mapPoint(point);
+	if (!std::isfinite(transformedPoint.x()) || !std::isfinite(transformedPoint.y()))
+		return false;
 
-	SkRect oval;
-	oval.set(cx - radiusXScalar, cy - radiusYScalar, cx + radiusXScalar, cy + radiusYScalar);
+	// Retained paths are in user space, so test the point mapped into it.
+	return SkPathContainsPoint(path, transformedPoint, windRule == RULE_NONZERO ? SkPath::kWinding_FillType : SkPath::kEvenOdd_FillType);
+}
 
-	float sweep = endAngle - startAngle;
-	SkScalar startDegrees = (startAngle * 180 / piFloat);
-	SkScalar sweepDegrees = (sweep * 180 / piFloat);
-	SkScalar s360 = SkIntToScalar(360);
+void CanvasContext2D::clearRect(float x, float y, float width, float height)
+{
+	flush();
+	SkRect r = SkRect::MakeXYWH(x, y, width, height);
+	SkPaint paint(state().m_fillPaint);
+	paint.setXfermodeMode(SkXfermode::kClear_Mode);
+	didDraw(r, &paint);
+	m_pCanvas->drawRect(r, paint);
 
-	// We can't use SkPath::addOval(), because addOval() makes new sub-path. addOval() calls moveTo() and close() internally.
+}
 
-	// Use s180, not s360, because SkPath::arcTo(oval, angle, s360, false) draws nothing.
-	SkScalar s180 = SkIntToScalar(180);
-	if (SkScalarNearlyEqual(sweepDegrees, s360)) {
-		// SkPath::arcTo can't handle the sweepAngle that is equal to or greater than 2Pi.
-		m_path.arcTo(oval, startDegrees, s180, false);
-		m_path.arcTo(oval, startDegrees + s180, s180, false);
-		return;
-	}
-	if (SkScalarNearlyEqual(sweepDegrees, -s360)) {
-		m_path.arcTo(oval, startDegrees, -s180, false);
-		m_path.arcTo(oval, startDegrees - s180, -s180, false);
-		return;
-	}
+void CanvasContext2D::fillRect(float x, float y, float width, float height)
+{
+	TRACE_EVENT0("canvas", "CanvasContext2D::fillRect");
+	flush();
+	SkRect r = SkRect::MakeXYWH(x, y, width, height);
+	didDraw(r, &state().m_fillPaint);
+	m_pCanvas->drawRect(r, state().m_fillPaint );
+	return;
+}
 
-	m_path.arcTo(oval, startDegrees, sweepDegrees, false);
+void CanvasContext2D::strokeRect(float x, float y, float width, float height)
+{
+	flush();
+	SkRect r = SkRect::MakeXYWH(x, y, width, height);
+	didDraw(r, &state().m_strokePaint);
+	m_pCanvas->drawRect(r, state().m_strokePaint);
 }
 
-void CanvasContext2D::fill(const std::string& winding)
+void CanvasContext2D::drawImage(BitmapImage* image, float x, float y)
 {
-	if ( m_path.isEmpty())
+	if (!image)
 	{
 		return;
 	}
-	m_pCanvas->drawPath(m_path, m_fillPaint);
+	const SkBitmap& bitmap = image->bitmap();
+	drawImage(image, 0, 0, bitmap.width(), bitmap.height(), x, y, bitmap.width(), bitmap.height());
 }
 
-
-void CanvasContext2D::stroke()
+void CanvasContext2D::drawImage(BitmapImage* image, float x, float y, float width, float height)
 {
-	//m_path.moveTo(-10, -10);
-	if (m_path.isEmpty())
+	if (!image)
 	{
 		return;
 	}
-	m_pCanvas->drawPath(m_path, m_strokePaint);
+	const SkBitmap& bitmap = image->bitmap();
+	drawImage(image, 0, 0, bitmap.width(), bitmap.height(), x, y, width, height);
 }
 
-void CanvasContext2D::clip(const std::string& winding)
+void CanvasContext2D::drawImage(BitmapImage* image, float sx, float sy, float sw, float sh, float dx, float dy, float dw, float dh)
 {
-	WindRule newWindRule = RULE_NONZERO;
-	if ( ! parseWinding( winding, newWindRule ))
+	TRACE_EVENT0("canvas", "CanvasContext2D::drawImage");
+	if (!image)
 	{
 		return;
 	}
-	SkPath::FillType previousFillType = m_path.getFillType();
-	SkPath::FillType temporaryFillType = newWindRule == RULE_EVENODD ? SkPath::kEvenOdd_FillType : SkPath::kWinding_FillType;
-	m_path.setFillType(temporaryFillType);
-	m_pCanvas->clipPath(m_path);
-	m_path.setFillType(previousFillType);
-	return;
+	if (!std::isfinite(sx) || !std::isfinite(sy) || !std::isfinite(sw) || !std::isfinite(sh)
+		|| !std::isfinite(dx) || !std::isfinite(dy) || !std::isfinite(dw) || !std::isfinite(dh))
+	{
+		return;
+	}
+	const SkBitmap& bitmap = image->bitmap();
+	if (bitmap.drawsNothing())
+	{
+		return;
+	}
+
+	SkRect src = SkRect::MakeXYWH(sx, sy, sw, sh);
+	SkRect dst = SkRect::MakeXYWH(dx, dy, dw, dh);
+	src.sort();
+	dst.sort();
+	if (src.isEmpty() || dst.isEmpty())
+	{
+		return;
+	}
+	// Trim the source to the image and shrink the destination to match.
+	SkRect bounds = SkRect::MakeWH(SkIntToScalar(bitmap.width()), SkIntToScalar(bitmap.height()));
+	if (!bounds.contains(src))
+	{
+		SkRect clipped = src;
+		if (!clipped.intersect(bounds))
+		{
+			return;
+		}
+		SkScalar scaleX = dst.width() / src.width();
+		SkScalar scaleY = dst.height() / src.height();
+		dst.setXYWH(dst.fLeft + (clipped.fLeft - src.fLeft) * scaleX, dst.fTop + (clipped.fTop - src.fTop) * scaleY,
+			clipped.width() * scaleX, clipped.height() * scaleY);
+		src = clipped;
+	}
+
+	const SkBitmap* source = &bitmap;
+	SkBitmap page;
+	SkIPoint offset;
+	if (m_imageAtlas && m_imageAtlas->find(bitmap, &page, &offset))
+	{
+		source = &page;
+		src.offset(SkIntToScalar(offset.fX), SkIntToScalar(offset.fY));
+	}
+	if (source->getGenerationID() != m_lastImageID)
+	{
+		m_lastImageID = source->getGenerationID();
+		m_imageBindCount++;
+	}
+
+	SkPaint paint;
+	imagePaint(paint);
+	updatePathTransform();
+	// Only a GPU canvas gains from batching; raster sprite blits are already
+	// cheaper than rasterizing triangles. Shadows need the looper per image,
+	// and rotated or skewed images need the antialiased edges the batch's
+	// triangles do not get.
+	if (!m_pCanvas->getGrContext() || paint.getLooper() || !m_pathTransform.rectStaysRect())
+	{
+		flush();
+		didDraw(dst, &paint);
+		m_pCanvas->drawBitmapRectToRect(*source, &src, dst, &paint);
+		return;
+	}
+
+	if (!m_spriteBatch.canAppend(*source, paint))
+	{
+		flush();
+	}
+	SkPoint quad[4];
+	dst.toQuad(quad);
+	m_pathTransform.mapPoints(quad, 4);
+	if (m_tracksDamage)
+	{
+		SkRect deviceBounds;
+		deviceBounds.set(quad, 4);
+		didDrawDeviceRect(deviceBounds);
+	}
+	m_spriteBatch.append(*source, paint, quad, src);
+	if (m_spriteBatch.isFull())
+	{
+		flush();
+	}
 }
 
-bool CanvasContext2D::isPointInPath(const float x, const float y, const std::string& winding)
+void CanvasContext2D::imagePaint(SkPaint& paint) const
 {
-	FloatPoint point(x, y);
-	AffineTransform ctm = state().m_transform;
-	FloatPoint transformedPoint = ctm.inverse().mapPoint(point);
-	if (!std::isfinite(transformedPoint.x()) || !std::isfinite(transformedPoint.y()))
-		return false;
-	WindRule windRule = RULE_NONZERO;
-	if (!parseWinding(winding, windRule))
-		return false;
+	// Images take the composite mode and shadow from the fill paint, but not
+	// its color or shader.
+	paint = state().m_fillPaint;
+	paint.setShader(NULL);
+	paint.setColor(applyAlpha(SK_ColorBLACK));
+	paint.setFilterLevel(state().m_imageSmoothingEnabled ? SkPaint::kLow_FilterLevel : SkPaint::kNone_FilterLevel);
+}
 
-	return SkPathContainsPoint(m_path, point, windRule == RULE_NONZERO ? SkPath::kWinding_FillType : SkPath::kEvenOdd_FillType);
+void CanvasContext2D::flush()
+{
+	TRACE_EVENT0("canvas", "CanvasContext2D::flush");
+	m_spriteBatch.flush(m_pCanvas);
+}
 
+void CanvasContext2D::setCanvas(SkCanvas* canvas)
+{
+	if (canvas == m_pCanvas)
+	{
+		return;
+	}
+	flush();
+	m_pCanvas = canvas;
+	if (m_pCanvas)
+	{
+		restoreCanvasMatrixClipStack();
+		if (m_tracksDamage)
+		{
+			SkISize size = m_pCanvas->getBaseLayerSize();
+			m_damage.setSize(size.width(), size.height());
+		}
+	}
 }
 
-void CanvasContext2D::clearRect(float x, float y, float width, float height)
+void CanvasContext2D::setTracksDamage(bool tracksDamage)
 {
-	SkRect r = SkRect::MakeXYWH(x, y, width, height);
-	SkPaint paint(m_fillPaint);
-	paint.setXfermodeMode(SkXfermode::kClear_Mode);
-	m_pCanvas->drawRect(r, paint);
+	m_tracksDamage = tracksDamage;
+	if (m_tracksDamage && m_pCanvas)
+	{
+		SkISize size = m_pCanvas->getBaseLayerSize();
+		m_damage.setSize(size.width(), size.height());
+	}
+	m_damage.reset();
+}
 
+void CanvasContext2D::setUsesImageAtlas(bool usesImageAtlas)
+{
+	if (usesImageAtlas == !!m_imageAtlas)
+	{
+		return;
+	}
+	// Queued sprites may come from the pages.
+	flush();
+	if (usesImageAtlas)
+	{
+		m_imageAtlas = new CanvasImageAtlas();
+		// Drawing straight onto a GPU canvas, new images are uploaded into the
+		// pages a rect at a time.
+		m_imageAtlas->setGrContext(m_pCanvas ? m_pCanvas->getGrContext() : 0);
+	}
+	else
+	{
+		delete m_imageAtlas;
+		m_imageAtlas = 0;
+	}
 }
 
-void CanvasContext2D::fillRect(float x, float y, float width, float height)
+void CanvasContext2D::didDraw(const SkRect& bounds, const SkPaint* paint)
 {
-	SkRect r = SkRect::MakeXYWH(x, y, width, height);
-	m_pCanvas->drawRect(r, m_fillPaint );
-	return;
+	if (!m_tracksDamage || m_damage.isFull())
+	{
+		return;
+	}
+	// fillRect and friends take negative sizes.
+	SkRect deviceBounds = bounds;
+	deviceBounds.sort();
+	if (paint)
+	{
+		// Paths with effects or inverse fills cannot be bounded cheaply.
+		if (!paint->canComputeFastBounds())
+		{
+			m_damage.addAll();
+			return;
+		}
+		SkRect storage;
+		deviceBounds = paint->computeFastBounds(bounds, &storage);
+	}
+	m_pCanvas->getTotalMatrix().mapRect(&deviceBounds);
+	didDrawDeviceRect(deviceBounds);
 }
 
-void CanvasContext2D::strokeRect(float x, float y, float width, float height)
+void CanvasContext2D::didDrawDeviceRect(const SkRect& bounds)
 {
-	SkRect r = SkRect::MakeXYWH(x, y, width, height);
-	m_pCanvas->drawRect(r, m_strokePaint);
+	SkIRect clip;
+	if (!m_pCanvas->getClipDeviceBounds(&clip))
+	{
+		return;
+	}
+	// Antialiasing can touch the pixel just outside the geometry.
+	SkRect outset = bounds;
+	outset.outset(SK_Scalar1, SK_Scalar1);
+	SkIRect rect;
+	outset.roundOut(&rect);
+	if (rect.intersect(clip))
+	{
+		m_damage.add(rect);
+	}
 }
 
-void CanvasContext2D::drawImage(BitmapImage* image, float x, float y)
+void CanvasContext2D::restoreCanvasMatrixClipStack()
 {
-	m_pCanvas->drawBitmap(image->bitmap(), x, y, NULL);
+	// One canvas save per realized state, each followed by the clips that
+	// state added on top of the one below it.
+	for (size_t i = 0; i < m_stateStack.size(); i++)
+	{
+		const State& s = m_stateStack[i];
+		size_t firstClip = 0;
+		if (i)
+		{
+			m_pCanvas->save();
+			firstClip = m_stateStack[i - 1].m_clips.size();
+		}
+		for (size_t j = firstClip; j < s.m_clips.size(); j++)
+		{
+			m_pCanvas->setMatrix(s.m_clips[j].m_transform);
+			m_pCanvas->clipPath(s.m_clips[j].m_path);
+		}
+	}
+	m_pCanvas->setMatrix(affineTransformToSkMatrix(state().m_transform));
 }
 
 PassRefPtr<CanvasGradient> CanvasContext2D::createLinearGradient(float x0, float y0, float x1, float y1)
@@ -787,30 +1084,72 @@ PassRefPtr<ImageData> CanvasContext2D::createImageData(float width, float height
 
 PassRefPtr<ImageData> CanvasContext2D::getImageData(float sx, float sy, float sw, float sh) const
 {
-	SkBitmap destBitmap;
-	SkImageInfo info = SkImageInfo::MakeN32Premul(sw, sh);
-	destBitmap.allocPixels(info);
-	m_pCanvas->readPixels(&destBitmap, sx, sy);
-
+	int x = static_cast<int>(sx);
+	int y = static_cast<int>(sy);
 	RefPtr<ImageData> data = ImageData::create(sw, sh);
-	memcpy(data->data(), destBitmap.getPixels(), sw * sh *4);
+	if (data->width() <= 0 || data->height() <= 0)
+	{
+		return data.release();
+	}
+
+	// Read straight into the ImageData buffer; SkCanvas unpremultiplies while
+	// copying. Pixels outside the canvas are left untouched, so clear first
+	// unless the whole rect is covered.
+	// getImageData is const, but the pixels it reads have to include any
+	// queued sprites.
+	const_cast<CanvasContext2D*>(this)->flush();
+	SkISize size = m_pCanvas->getBaseLayerSize();
+	bool inside = x >= 0 && y >= 0 && x + data->width() <= size.width() && y + data->height() <= size.height();
+	if (!inside)
+	{
+		data->zeroFill();
+	}
+	SkImageInfo info = SkImageInfo::Make(data->width(), data->height(), kRGBA_8888_SkColorType, kUnpremul_SkAlphaType);
+	if (!m_pCanvas->readPixels(info, data->data(), info.minRowBytes(), x, y) && inside)
+	{
+		data->zeroFill();
+	}
 	return data.release();
 }
-
 void CanvasContext2D::putImageData(PassRefPtr<ImageData> data , float dx, float dy)
 {
-	SkBitmap destBitmap;
-	SkImageInfo info = SkImageInfo::MakeN32Premul(data->width(), data->height());
-	destBitmap.allocPixels(info);
-	destBitmap.setPixels(data->data());
-	m_pCanvas->writePixels(destBitmap, dx, dy);
-	//m_pCanvas->writePixels(info, data->data(), data->length(), dx, dy);
-	return;
+	if (!data || data->width() <= 0 || data->height() <= 0)
+	{
+		return;
+	}
+	// Written straight from the ImageData buffer; SkCanvas premultiplies while
+	// copying and clips to the canvas bounds.
+	flush();
+	SkImageInfo info = SkImageInfo::Make(data->width(), data->height(), kRGBA_8888_SkColorType, kUnpremul_SkAlphaType);
+	m_pCanvas->writePixels(info, data->data(), info.minRowBytes(), static_cast<int>(dx), static_cast<int>(dy));
+	if (m_tracksDamage)
+	{
+		// writePixels ignores the matrix and clip.
+		m_damage.add(SkIRect::MakeXYWH(static_cast<int>(dx), static_cast<int>(dy), data->width(), data->height()));
+	}
 }
-
 void CanvasContext2D::reset()
 {
-
+	// Back to how a new context starts: the saves are unwound and the
+	// transform, clip, path and drawing attributes return to their defaults.
+	flush();
+	size_t realizedSaves = m_stateStack.size() - 1;
+	m_stateStack.resize(1);
+	m_stateStack.back() = State();
+	if (m_pCanvas)
+	{
+		for (size_t i = 0; i < realizedSaves; i++)
+		{
+			m_pCanvas->restore();
+		}
+		m_pCanvas->resetMatrix();
+		// Clips made with no save pending went onto the canvas's own state.
+		SkISize size = m_pCanvas->getBaseLayerSize();
+		m_pCanvas->clipRect(SkRect::MakeWH(SkIntToScalar(size.width()), SkIntToScalar(size.height())), SkRegion::kReplace_Op);
+	}
+	modifiableState().m_globalAlpha = 256;
+	applyFont(m_fontCache.get(defaultFont));
+	m_path.reset();
 }
 
 std::string CanvasContext2D::font() const
@@ -839,9 +1178,32 @@ std::string CanvasContext2D::font() const
 
 void CanvasContext2D::setFont(const std::string& newFont)
 {
-	FontDescription &fontDes = modifiableState().m_FontDescription;
-	fontDes.parseFontDes(newFont);
-	return;
+	if ( state().m_realizedFont && newFont == state().m_unparsedFont )
+	{
+		return;
+	}
+	CanvasFont* font = m_fontCache.get(newFont);
+	if ( !font )
+	{
+		return;
+	}
+	State& s = modifiableState();
+	s.m_unparsedFont = newFont;
+	s.m_realizedFont = true;
+	applyFont(font);
+}
+
+void CanvasContext2D::applyFont(CanvasFont* font)
+{
+	State& s = modifiableState();
+	s.m_font = font;
+	s.m_FontDescription = font->description();
+	SkTypeface* face = font->paint().getTypeface();
+	SkScalar size = font->paint().getTextSize();
+	s.m_fillPaint.setTypeface(face);
+	s.m_fillPaint.setTextSize(size);
+	s.m_strokePaint.setTypeface(face);
+	s.m_strokePaint.setTextSize(size);
 }
 
 std::string CanvasContext2D::textAlign() const
@@ -857,6 +1219,10 @@ void CanvasContext2D::setTextAlign(const std::string& s)
 	{
 		return;
 	}
+	setTextAlign(align);
+}
+void CanvasContext2D::setTextAlign(TextAlign align)
+{
 	if ( state().m_textAlign == align )
 	{
 		return;
@@ -877,6 +1243,10 @@ void CanvasContext2D::setTextBaseline(const std::string& s)
 	{
 		return;
 	}
+	setTextBaseline(baseline);
+}
+void CanvasContext2D::setTextBaseline(TextBaseline baseline)
+{
 	if ( state().m_textBaseline == baseline )
 	{
 		return;
@@ -887,56 +1257,81 @@ void CanvasContext2D::setTextBaseline(const std::string& s)
 
 void CanvasContext2D::fillText(const char *text, float x, float y)
 {
-	const FontDescription &fontDes = state().m_FontDescription;
-	
-	int style = 0;
-	if (fontDes.style() == FontStyleItalic )
+	const CanvasTextRun* run = layoutText(text);
+	if ( !run )
 	{
-		style |= SkTypeface::Style::kItalic;
+		return;
 	}
-	if (fontDes.lighterWeight() != FontWeightNormal)
+	drawTextRun(*run, x, y + getFontBaseline(state().m_font->metrics()), state().m_fillPaint);
+}
+
+void CanvasContext2D::strokeText(const char* text, float x, float y)
+{
+	const CanvasTextRun* run = layoutText(text);
+	if ( !run )
 	{
-		style |= SkTypeface::Style::kBold;
+		return;
 	}
+	drawTextRun(*run, x, y + getFontBaseline(state().m_font->metrics()), state().m_strokePaint);
+}
 
-	//SkTypeface *face = SkTypeface::RefDefault((SkTypeface::Style)style);
-	SkTypeface *face = SkTypeface::CreateFromName(fontDes.m_fontName.c_str(), (SkTypeface::Style)style);
-	if ( face )
+const CanvasTextRun* CanvasContext2D::layoutText(const char* text)
+{
+	const State& s = state();
+	if ( !s.m_font )
 	{
-		m_fillPaint.setTypeface(face);
+		return NULL;
 	}
-	m_fillPaint.setTextSize(fontDes.specifiedSize());
-	m_fillPaint.setTextAlign((SkPaint::Align)(state().m_textAlign));
-	
-	//m_strokePaint.setVerticalText(true);
-	//m_strokePaint.setUnderlineText(true);
-	int ilen = strlen(text);
-	m_pCanvas->drawText(text, ilen, x, y +getFontBaseline(m_fillPaint), m_fillPaint);
+	return m_textLayoutCache.get(text, strlen(text), s.m_font.get(), s.m_textAlign);
 }
 
-void CanvasContext2D::strokeText(const char* text, float x, float y)
+void CanvasContext2D::drawTextRun(const CanvasTextRun& run, float x, float y, const SkPaint& paint)
 {
-	const FontDescription &fontDes = state().m_FontDescription;
-	m_strokePaint.setTextSize(fontDes.specifiedSize());
-	//m_strokePaint.setVerticalText(true);
-	//m_strokePaint.setUnderlineText(true);
-	int ilen = strlen(text);
-	m_pCanvas->drawText(text, ilen, x, y + getFontBaseline(m_fillPaint), m_strokePaint);
+	TRACE_EVENT0("canvas", "CanvasContext2D::drawText");
+	size_t count = run.m_glyphs.size();
+	if ( !count )
+	{
+		return;
+	}
+	// The state paints are left aligned glyph id paints; the run already
+	// holds aligned positions relative to the origin.
+	flush();
+	m_textPositions.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		m_textPositions[i] = run.m_xpos[i] + x;
+	}
+	if (m_tracksDamage)
+	{
+		SkRect bounds = run.m_bounds;
+		bounds.offset(x, y);
+		didDraw(bounds, &paint);
+	}
+	m_pCanvas->drawPosTextH(&run.m_glyphs[0], count * sizeof(uint16_t), &m_textPositions[0], y, paint);
 }
 
 float CanvasContext2D::measureText(const std::string& text)
 {
-	const FontDescription &fontDes = state().m_FontDescription;
-	SkPaint paint;
-	paint.setTextSize(fontDes.specifiedSize());
-	float re = paint.measureText(text.c_str(), text.length());
-	return re;
+	const CanvasTextRun* run = layoutText(text.c_str());
+	return run ? run->m_width : 0;
 }
 
-int CanvasContext2D::getFontBaseline(const SkPaint& paint) const
+bool CanvasContext2D::imageSmoothingEnabled() const
+{
+	return state().m_imageSmoothingEnabled;
+}
+
+void CanvasContext2D::setImageSmoothingEnabled(bool enabled)
+{
+	if (enabled == state().m_imageSmoothingEnabled)
+	{
+		return;
+	}
+	modifiableState().m_imageSmoothingEnabled = enabled;
+}
+
+int CanvasContext2D::getFontBaseline(const SkPaint::FontMetrics& fontmet) const
 {
-	SkPaint::FontMetrics fontmet;
-	paint.getFontMetrics(&fontmet, 0.0);
 
 	switch (state().m_textBaseline) {
 	case TopTextBaseline:
@@ -962,26 +1357,9 @@ bool CanvasContext2D::isAccelerated() const
 	return true;
 }
 
-bool CanvasContext2D::hasCurrentPoint() const
-{
-	return m_path.getPoints(0, 0);
-}
-
-SkPoint CanvasContext2D::currentPoint() const
-{
-	if ( m_path.countPoints() > 0 )
-	{
-		SkPoint skResult;
-		m_path.getLastPt(&skResult);
-		return skResult;
-	}
-	float quietNan = std::numeric_limits<float>::quiet_NaN();
-	return SkPoint::Make(quietNan, quietNan);
-}
-
 SkColor CanvasContext2D::applyAlpha(SkColor c) const
 {
-	int a = SkAlphaMul(SkColorGetA(c), state().m_globalAlpha);
+	int a = SkAlphaMul(SkColorGetA(c), static_cast<int>(state().m_globalAlpha));
 	return (c & 0x00FFFFFF) | (a << 24);
 }
 
@@ -994,13 +1372,15 @@ void CanvasContext2D::applyShadow()
 			DrawLooperBuilder::ShadowIgnoresTransforms, DrawLooperBuilder::ShadowRespectsAlpha);
 		drawLooper.addUnmodifiedContent();
 		RefPtr<SkDrawLooper> looper = drawLooper.detachDrawLooper();
-		m_strokePaint.setLooper(looper.get());
-		m_fillPaint.setLooper(looper.get());
+		State& s = modifiableState();
+		s.m_strokePaint.setLooper(looper.get());
+		s.m_fillPaint.setLooper(looper.get());
 	}
 	else
 	{
-		m_strokePaint.setLooper(0);
-		m_fillPaint.setLooper(0);
+		State& s = modifiableState();
+		s.m_strokePaint.setLooper(0);
+		s.m_fillPaint.setLooper(0);
 	}
 }
 
@@ -1009,6 +1389,448 @@ bool CanvasContext2D::shouldDrawShadows() const
 	return alphaChannel(state().m_shadowColor) && (state().m_shadowBlur || !state().m_shadowOffset.isZero());
 }
 
+// Keyword arguments are looked up straight from the buffer, without copying
+// them into a std::string first.
+static CanvasKeyword readKeyword(CanvasCommandReader& reader)
+{
+	uint32_t length;
+	const char* s = reader.readString(length);
+	return lookupCanvasKeyword(s, length);
+}
+
+CanvasStyle* CanvasContext2D::readColor(CanvasCommandReader& reader)
+{
+	uint32_t length;
+	const char* s = reader.readString(length);
+	return m_styleCache.get(s, length);
+}
+
+bool CanvasContext2D::executeCommands(const uint8_t* data, size_t length)
+{
+	if (m_sessionRecorder)
+	{
+		m_sessionRecorder->recordCommands(m_commandObjects, data, length);
+	}
+	CanvasCommandReader reader(data, length);
+	// Reused across commands so string arguments only allocate when they
+	// outgrow the previous one.
+	std::string str;
+	float f[8];
+
+	while (!reader.atEnd())
+	{
+		uint8_t op = reader.readOpcode();
+		switch (op)
+		{
+		case CanvasOpSave:
+			save();
+			break;
+		case CanvasOpRestore:
+			restore();
+			break;
+		case CanvasOpReset:
+			reset();
+			break;
+
+		case CanvasOpSetStrokeStyle:
+			setStrokeStyle(m_commandObjects.style(reader.readUInt()));
+			break;
+		case CanvasOpSetFillStyle:
+			setFillStyle(m_commandObjects.style(reader.readUInt()));
+			break;
+		case CanvasOpSetLineWidth:
+			setLineWidth(reader.readFloat());
+			break;
+		case CanvasOpSetLineCap:
+			{
+				LineCap cap;
+				if (keywordToLineCap(readKeyword(reader), cap))
+				{
+					setLineCap(cap);
+				}
+			}
+			break;
+		case CanvasOpSetLineJoin:
+			{
+				LineJoin join;
+				if (keywordToLineJoin(readKeyword(reader), join))
+				{
+					setLineJoin(join);
+				}
+			}
+			break;
+		case CanvasOpSetMiterLimit:
+			setMiterLimit(reader.readFloat());
+			break;
+		case CanvasOpSetLineDash:
+			{
+				uint32_t count = reader.readUInt();
+				if (count > length / sizeof(float))
+				{
+					return false;
+				}
+				std::vector<float> dash(count);
+				for (uint32_t i = 0; i < count; i++)
+				{
+					dash[i] = reader.readFloat();
+				}
+				setLineDash(dash);
+			}
+			break;
+		case CanvasOpSetLineDashOffset:
+			setLineDashOffset(reader.readFloat());
+			break;
+		case CanvasOpSetShadowOffsetX:
+			setShadowOffsetX(reader.readFloat());
+			break;
+		case CanvasOpSetShadowOffsetY:
+			setShadowOffsetY(reader.readFloat());
+			break;
+		case CanvasOpSetShadowBlur:
+			setShadowBlur(reader.readFloat());
+			break;
+		case CanvasOpSetShadowColor:
+			setShadowColorFromCache(readColor(reader));
+			break;
+		case CanvasOpSetGlobalAlpha:
+			setGlobalAlpha(reader.readFloat());
+			break;
+		case CanvasOpSetGlobalCompositeOperation:
+			{
+				CompositeOperator compositeOp;
+				WebBlendMode blendMode;
+				if (keywordToCompositeAndBlendOperator(readKeyword(reader), compositeOp, blendMode))
+				{
+					setGlobalCompositeOperation(compositeOp, blendMode);
+				}
+			}
+			break;
+		case CanvasOpSetImageSmoothingEnabled:
+			setImageSmoothingEnabled(reader.readBool());
+			break;
+
+		case CanvasOpScale:
+			f[0] = reader.readFloat();
+			f[1] = reader.readFloat();
+			scale(f[0], f[1]);
+			break;
+		case CanvasOpRotate:
+			rotate(reader.readFloat());
+			break;
+		case CanvasOpTranslate:
+			f[0] = reader.readFloat();
+			f[1] = reader.readFloat();
+			translate(f[0], f[1]);
+			break;
+		case CanvasOpTransform:
+		case CanvasOpSetTransform:
+		case CanvasOpSetCurrentTransform:
+			for (int i = 0; i < 6; i++)
+			{
+				f[i] = reader.readFloat();
+			}
+			if (op == CanvasOpTransform)
+			{
+				transform(f[0], f[1], f[2], f[3], f[4], f[5]);
+			}
+			else if (op == CanvasOpSetTransform)
+			{
+				setTransform(f[0], f[1], f[2], f[3], f[4], f[5]);
+			}
+			else
+			{
+				setCurrentTransform(adoptRef(new AffineTransform(f[0], f[1], f[2], f[3], f[4], f[5])));
+			}
+			break;
+		case CanvasOpResetTransform:
+			resetTransform();
+			break;
+
+		case CanvasOpSetStrokeColor:
+			setStrokeColorFromCache(readColor(reader));
+			break;
+		case CanvasOpSetStrokeColorGray:
+			setStrokeColor(reader.readFloat());
+			break;
+		case CanvasOpSetStrokeColorAlpha:
+			reader.readString(str);
+			setStrokeColor(str, reader.readFloat());
+			break;
+		case CanvasOpSetStrokeColorGrayAlpha:
+			f[0] = reader.readFloat();
+			f[1] = reader.readFloat();
+			setStrokeColor(f[0], f[1]);
+			break;
+		case CanvasOpSetStrokeColorRGBA:
+			for (int i = 0; i < 4; i++)
+			{
+				f[i] = reader.readFloat();
+			}
+			setStrokeColor(f[0], f[1], f[2], f[3]);
+			break;
+		case CanvasOpSetStrokeColorCMYKA:
+			for (int i = 0; i < 5; i++)
+			{
+				f[i] = reader.readFloat();
+			}
+			setStrokeColor(f[0], f[1], f[2], f[3], f[4]);
+			break;
+		case CanvasOpSetFillColor:
+			setFillColorFromCache(readColor(reader));
+			break;
+		case CanvasOpSetFillColorGray:
+			setFillColor(reader.readFloat());
+			break;
+		case CanvasOpSetFillColorAlpha:
+			reader.readString(str);
+			setFillColor(str, reader.readFloat());
+			break;
+		case CanvasOpSetFillColorGrayAlpha:
+			f[0] = reader.readFloat();
+			f[1] = reader.readFloat();
+			setFillColor(f[0], f[1]);
+			break;
+		case CanvasOpSetFillColorRGBA:
+			for (int i = 0; i < 4; i++)
+			{
+				f[i] = reader.readFloat();
+			}
+			setFillColor(f[0], f[1], f[2], f[3]);
+			break;
+		case CanvasOpSetFillColorCMYKA:
+			for (int i = 0; i < 5; i++)
+			{
+				f[i] = reader.readFloat();
+			}
+			setFillColor(f[0], f[1], f[2], f[3], f[4]);
+			break;
+
+		case CanvasOpBeginPath:
+			beginPath();
+			break;
+		case CanvasOpClosePath:
+			closePath();
+			break;
+		case CanvasOpMoveTo:
+			f[0] = reader.readFloat();
+			f[1] = reader.readFloat();
+			moveTo(f[0], f[1]);
+			break;
+		case CanvasOpLineTo:
+			f[0] = reader.readFloat();
+			f[1] = reader.readFloat();
+			lineTo(f[0], f[1]);
+			break;
+		case CanvasOpQuadraticCurveTo:
+			for (int i = 0; i < 4; i++)
+			{
+				f[i] = reader.readFloat();
+			}
+			quadraticCurveTo(f[0], f[1], f[2], f[3]);
+			break;
+		case CanvasOpBezierCurveTo:
+			for (int i = 0; i < 6; i++)
+			{
+				f[i] = reader.readFloat();
+			}
+			bezierCurveTo(f[0], f[1], f[2], f[3], f[4], f[5]);
+			break;
+		case CanvasOpArcTo:
+			for (int i = 0; i < 5; i++)
+			{
+				f[i] = reader.readFloat();
+			}
+			arcTo(f[0], f[1], f[2], f[3], f[4]);
+			break;
+		case CanvasOpArc:
+			for (int i = 0; i < 5; i++)
+			{
+				f[i] = reader.readFloat();
+			}
+			arc(f[0], f[1], f[2], f[3], f[4], reader.readBool());
+			break;
+		case CanvasOpEllipse:
+			for (int i = 0; i < 7; i++)
+			{
+				f[i] = reader.readFloat();
+			}
+			ellipse(f[0], f[1], f[2], f[3], f[4], f[5], f[6], reader.readBool());
+			break;
+		case CanvasOpRect:
+		case CanvasOpClearRect:
+		case CanvasOpFillRect:
+		case CanvasOpStrokeRect:
+			for (int i = 0; i < 4; i++)
+			{
+				f[i] = reader.readFloat();
+			}
+			if (op == CanvasOpRect)
+			{
+				rect(f[0], f[1], f[2], f[3]);
+			}
+			else if (op == CanvasOpClearRect)
+			{
+				clearRect(f[0], f[1], f[2], f[3]);
+			}
+			else if (op == CanvasOpFillRect)
+			{
+				fillRect(f[0], f[1], f[2], f[3]);
+			}
+			else
+			{
+				strokeRect(f[0], f[1], f[2], f[3]);
+			}
+			break;
+
+		case CanvasOpFill:
+		case CanvasOpClip:
+			{
+				WindRule windRule;
+				if (keywordToWindRule(readKeyword(reader), windRule))
+				{
+					if (op == CanvasOpFill)
+					{
+						fill(windRule);
+					}
+					else
+					{
+						clip(windRule);
+					}
+				}
+			}
+			break;
+		case CanvasOpStroke:
+			stroke();
+			break;
+		case CanvasOpDrawImage:
+			{
+				BitmapImage* image = m_commandObjects.image(reader.readUInt());
+				f[0] = reader.readFloat();
+				f[1] = reader.readFloat();
+				if (image)
+				{
+					drawImage(image, f[0], f[1]);
+				}
+			}
+			break;
+		case CanvasOpDrawImageRect:
+			{
+				BitmapImage* image = m_commandObjects.image(reader.readUInt());
+				for (int i = 0; i < 4; i++)
+				{
+					f[i] = reader.readFloat();
+				}
+				if (image)
+				{
+					drawImage(image, f[0], f[1], f[2], f[3]);
+				}
+			}
+			break;
+		case CanvasOpDrawImageSubRect:
+			{
+				BitmapImage* image = m_commandObjects.image(reader.readUInt());
+				for (int i = 0; i < 8; i++)
+				{
+					f[i] = reader.readFloat();
+				}
+				if (image)
+				{
+					drawImage(image, f[0], f[1], f[2], f[3], f[4], f[5], f[6], f[7]);
+				}
+			}
+			break;
+		case CanvasOpPutImageData:
+			{
+				ImageData* imageData = m_commandObjects.imageData(reader.readUInt());
+				f[0] = reader.readFloat();
+				f[1] = reader.readFloat();
+				if (imageData)
+				{
+					putImageData(imageData, f[0], f[1]);
+				}
+			}
+			break;
+		case CanvasOpFillPath:
+		case CanvasOpClipPath:
+			{
+				CanvasPath* path = m_commandObjects.path(reader.readUInt());
+				WindRule windRule;
+				if (keywordToWindRule(readKeyword(reader), windRule) && path)
+				{
+					if (op == CanvasOpFillPath)
+					{
+						fill(path, windRule);
+					}
+					else
+					{
+						clip(path, windRule);
+					}
+				}
+			}
+			break;
+		case CanvasOpStrokePath:
+			{
+				CanvasPath* path = m_commandObjects.path(reader.readUInt());
+				if (path)
+				{
+					stroke(path);
+				}
+			}
+			break;
+
+		case CanvasOpSetFont:
+			reader.readString(str);
+			setFont(str);
+			break;
+		case CanvasOpSetTextAlign:
+			{
+				TextAlign align;
+				if (keywordToTextAlign(readKeyword(reader), align))
+				{
+					setTextAlign(align);
+				}
+			}
+			break;
+		case CanvasOpSetTextBaseline:
+			{
+				TextBaseline baseline;
+				if (keywordToTextBaseline(readKeyword(reader), baseline))
+				{
+					setTextBaseline(baseline);
+				}
+			}
+			break;
+		case CanvasOpFillText:
+		case CanvasOpStrokeText:
+			reader.readString(str);
+			f[0] = reader.readFloat();
+			f[1] = reader.readFloat();
+			if (reader.failed())
+			{
+				return false;
+			}
+			if (op == CanvasOpFillText)
+			{
+				fillText(str.c_str(), f[0], f[1]);
+			}
+			else
+			{
+				strokeText(str.c_str(), f[0], f[1]);
+			}
+			break;
+
+		default:
+			return false;
+		}
+
+		if (reader.failed())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 CanvasContext2D::State::State()
 	: m_unrealizedSaveCount(0)	
 	, m_lineWidth(1)
@@ -1030,6 +1852,14 @@ CanvasContext2D::State::State()
 {
 	m_strokeStyle = (CanvasStyle::createFromRGBA(Color::black));
 	m_fillStyle = (CanvasStyle::createFromRGBA(Color::black));
+	m_strokePaint.setStyle(SkPaint::kStroke_Style);
+	m_strokePaint.setAntiAlias(true);
+	m_strokePaint.setStrokeWidth(1);
+	m_fillPaint.setStyle(SkPaint::kFill_Style);
+	m_fillPaint.setAntiAlias(true);
+	// Text is drawn from cached glyph runs; see drawTextRun.
+	m_strokePaint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+	m_fillPaint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
 }
 
 CanvasContext2D::State::State(const State& other)
@@ -1050,13 +1880,21 @@ CanvasContext2D::State::State(const State& other)
 	, m_globalBlend(other.m_globalBlend)
 	, m_transform(other.m_transform)
 	, m_invertibleCTM(other.m_invertibleCTM)
+	, m_lineDash(other.m_lineDash)
 	, m_lineDashOffset(other.m_lineDashOffset)
 	, m_imageSmoothingEnabled(other.m_imageSmoothingEnabled)
+	, m_clips(other.m_clips)
 	, m_textAlign(other.m_textAlign)
 	, m_textBaseline(other.m_textBaseline)
 	, m_unparsedFont(other.m_unparsedFont)
+	, m_FontDescription(other.m_FontDescription)
+	, m_font(other.m_font)
 	//, m_font(other.m_font)
 	, m_realizedFont(other.m_realizedFont)
+	, m_fillColor(other.m_fillColor)
+	, m_strokeColor(other.m_strokeColor)
+	, m_strokePaint(other.m_strokePaint)
+	, m_fillPaint(other.m_fillPaint)
 {
 	
 }
@@ -1083,12 +1921,21 @@ CanvasContext2D::State& CanvasContext2D::State::operator=(const State& other)
 	m_globalBlend = other.m_globalBlend;
 	m_transform = other.m_transform;
 	m_invertibleCTM = other.m_invertibleCTM;
+	m_lineDash = other.m_lineDash;
+	m_lineDashOffset = other.m_lineDashOffset;
 	m_imageSmoothingEnabled = other.m_imageSmoothingEnabled;
+	m_clips = other.m_clips;
 	m_textAlign = other.m_textAlign;
 	m_textBaseline = other.m_textBaseline;
 	m_unparsedFont = other.m_unparsedFont;
+	m_FontDescription = other.m_FontDescription;
+	m_font = other.m_font;
 	//m_font = other.m_font;
 	m_realizedFont = other.m_realizedFont;
+	m_fillColor = other.m_fillColor;
+	m_strokeColor = other.m_strokeColor;
+	m_strokePaint = other.m_strokePaint;
+	m_fillPaint = other.m_fillPaint;
 
 	return *this;
 }
@@ -12,11 +12,22 @@
 #include "PassOwnPtr.h"
 #include "FontDescription.h"
 #include "ImageData.h"
+#include "CanvasCommandBuffer.h"
+#include "CanvasStyleCache.h"
+#include "GradientShaderCache.h"
+#include "CanvasFontCache.h"
+#include "CanvasTextLayoutCache.h"
+#include "CanvasPathMethods.h"
+#include "CanvasPath.h"
+#include "CanvasSpriteBatch.h"
+#include "CanvasDamageTracker.h"
+#include "CanvasImageAtlas.h"
+#include "CanvasSession.h"
 
 using namespace Canvas2D;
 class BitmapImage;
 
-class CanvasContext2D
+class CanvasContext2D : public CanvasPathMethods
 {
 public:
 	void deref() {};
@@ -40,10 +51,12 @@ public:
 
 	std::string lineCap() const;
 	void setLineCap(const std::string&);
+	void setLineCap(LineCap);
 	LineCap getLineCap() const { return state().m_lineCap; }
 	
 	std::string lineJoin() const;
 	void setLineJoin(const std::string&);
+	void setLineJoin(LineJoin);
 	LineJoin getLineJoin() const { return state().m_lineJoin; }
 
 	float miterLimit() const;
@@ -72,6 +85,7 @@ public:
 
 	std::string globalCompositeOperation() const;
 	void setGlobalCompositeOperation(const std::string&);
+	void setGlobalCompositeOperation(CompositeOperator, WebBlendMode = WebBlendModeNormal);
 
 	void save();
 	void restore();
@@ -104,26 +118,27 @@ public:
 	void setFillColor(float c, float m, float y, float k, float a);
 
 	void beginPath();
-	void closePath();
-	void moveTo(float x, float y);
-	void lineTo(float x, float y);
-	void quadraticCurveTo(float cpx, float cpy, float x, float y);
-	void bezierCurveTo(float cp1x, float cp1y, float cp2x, float cp2y, float x, float y);
-	void arcTo(float x1, float y1, float x2, float y2, float radius);
-	void arc(float x, float y, float radius, float startAngle, float endAngle, bool anticlockwise);
-	void ellipse(float x, float y, float radiusX, float radiusY, float rotation, float startAngle, float endAngle, bool anticlockwise);
-	void rect(float x, float y, float width, float height);
-
-	void addEllipse(const FloatPoint&, float radiusX, float radiusY, float startAngle, float endAngle, bool anticlockwise);
 
 	void fill(const std::string& winding = "nonzero");
+	void fill(WindRule);
+	void fill(CanvasPath*, const std::string& winding = "nonzero");
+	void fill(CanvasPath*, WindRule);
 	void stroke();
+	void stroke(CanvasPath*);
 	void clip(const std::string& winding = "nonzero");
+	void clip(WindRule);
+	void clip(CanvasPath*, const std::string& winding = "nonzero");
+	void clip(CanvasPath*, WindRule);
 	bool isPointInPath(const float x, const float y, const std::string& winding = "nonzero");
+	bool isPointInPath(const float x, const float y, WindRule);
+	bool isPointInPath(CanvasPath*, const float x, const float y, const std::string& winding = "nonzero");
+	bool isPointInPath(CanvasPath*, const float x, const float y, WindRule);
 	void clearRect(float x, float y, float width, float height);
 	void fillRect(float x, float y, float width, float height);
 	void strokeRect(float x, float y, float width, float height);
 	void drawImage(BitmapImage*, float x, float y);
+	void drawImage(BitmapImage*, float x, float y, float width, float height);
+	void drawImage(BitmapImage*, float sx, float sy, float sw, float sh, float dx, float dy, float dw, float dh);
 	PassRefPtr<CanvasGradient> createLinearGradient(float x0, float y0, float x1, float y1);
 	PassRefPtr<CanvasGradient> createRadialGradient(float x0, float y0, float r0, float x1, float y1, float r1);
 	PassRefPtr<CanvasPattern> createPattern(PassRefPtr<BitmapImage>, const std::string& repetitionType);
@@ -132,6 +147,8 @@ public:
 	PassRefPtr<ImageData> getImageData(float sx, float sy, float sw, float sh) const;
 	void putImageData(PassRefPtr<ImageData>, float dx, float dy);
 
+	// Unwinds every save and returns the transform, clip, path and attributes
+	// to the state of a newly created context.
 	void reset();
 
 	std::string font() const;
@@ -139,9 +156,11 @@ public:
 
 	std::string textAlign() const;
 	void setTextAlign(const std::string&);
+	void setTextAlign(TextAlign);
 
 	std::string textBaseline() const;
 	void setTextBaseline(const std::string&);
+	void setTextBaseline(TextBaseline);
 
 	void fillText(const char* text, float x, float y);
 	void strokeText( const char* text, float x, float y);
@@ -150,11 +169,69 @@ public:
 	bool imageSmoothingEnabled() const;
 	void setImageSmoothingEnabled(bool);
 
+	// Decodes and runs a buffer in the CanvasCommandBuffer.h format. Returns
+	// false if the buffer is truncated or holds an unknown opcode; commands
+	// before the bad one have already been applied.
+	bool executeCommands(const uint8_t* data, size_t length);
+	CanvasCommandObjectTable& commandObjects() { return m_commandObjects; }
+	// While set, every buffer executeCommands() runs is also written to the
+	// recorder, with the objects it refers to. The embedder owns the
+	// recorder and calls its endFrame() once per frame.
+	void setSessionRecorder(CanvasSessionRecorder* recorder) { m_sessionRecorder = recorder; }
+	CanvasSessionRecorder* sessionRecorder() const { return m_sessionRecorder; }
+
+	// Moves drawing to another canvas, e.g. the recording canvas of the next
+	// CanvasFrameRenderer frame. The saves, clips and transform of the state
+	// stack are rebuilt on it.
+	void setCanvas(SkCanvas*);
+	SkCanvas* canvas() const { return m_pCanvas; }
+
+	// Draws the sprites drawImage has queued. Every other draw, clip and
+	// readback flushes first, as does the destructor; callers drawing on the
+	// SkCanvas directly must flush before they do.
+	void flush();
+
+	// When enabled, the device-space bounds of every draw, clipped, are added
+	// to damage(). The embedder reads it at the end of a frame, passes it on
+	// to CanvasFrameRenderer::endFrame() or CanvasBackingStore::present(), and
+	// resets it.
+	void setTracksDamage(bool);
+	bool tracksDamage() const { return m_tracksDamage; }
+	const CanvasDamageTracker& damage() const { return m_damage; }
+	void resetDamage() { m_damage.reset(); }
+
+	// When enabled, drawImage packs small images into a CanvasImageAtlas and
+	// draws them from its pages, so sprites from different images can share
+	// a texture and a sprite batch. The embedder calls
+	// imageAtlas()->beginFrame() once per frame.
+	void setUsesImageAtlas(bool);
+	CanvasImageAtlas* imageAtlas() const { return m_imageAtlas; }
+	// Times drawImage changed the bitmap it draws from since the last reset.
+	// On the GPU each change is a texture bind.
+	unsigned imageBindCount() const { return m_imageBindCount; }
+	void resetImageBindCount() { m_imageBindCount = 0; }
+
+	const CanvasStyleCache& styleCache() const { return m_styleCache; }
+	GradientShaderCache& gradientCache() { return m_gradientCache; }
+	const CanvasSpriteBatch& spriteBatch() const { return m_spriteBatch; }
+	CanvasTextLayoutCache& textLayoutCache() { return m_textLayoutCache; }
+
 private:
-	bool hasCurrentPoint() const;
-	SkPoint currentPoint() const;
 	SkColor applyAlpha(SkColor c) const;
 
+	void setStrokeColorFromCache(CanvasStyle*);
+	void setFillColorFromCache(CanvasStyle*);
+	void setShadowColorFromCache(CanvasStyle*);
+	CanvasStyle* readColor(CanvasCommandReader&);
+
+	// A clip as applied to the canvas, kept so it can be replayed onto a new
+	// one by restoreCanvasMatrixClipStack().
+	struct Clip
+	{
+		SkPath m_path;
+		SkMatrix m_transform;
+	};
+
 	struct State
 	{
 		State();
@@ -184,6 +261,8 @@ private:
 		std::vector<float> m_lineDash;
 		float m_lineDashOffset;
 		bool m_imageSmoothingEnabled;
+		// Every clip in effect, including those inherited from earlier states.
+		std::vector<Clip> m_clips;
 
 		// Text state.
 		TextAlign m_textAlign;
@@ -191,17 +270,41 @@ private:
 
 		std::string m_unparsedFont;
 		FontDescription m_FontDescription;
+		RefPtr<CanvasFont> m_font;
 		bool m_realizedFont;
+
+		Color m_fillColor;
+		Color m_strokeColor;
+		SkPaint m_strokePaint;
+		SkPaint m_fillPaint;
 	};
 
-	State& modifiableState() { return m_stateStack.back(); }
+	// save() only counts; the state is copied (and the canvas saved) the
+	// first time something is about to change after it.
+	void realizeSaves();
+	State& modifiableState() { realizeSaves(); return m_stateStack.back(); }
 	const State& state() const { return m_stateStack.back(); }
 
 	void applyShadow();
+	void imagePaint(SkPaint&) const;
 	bool shouldDrawShadows() const;
 
-	int getFontBaseline(const SkPaint&) const;
+	int getFontBaseline(const SkPaint::FontMetrics&) const;
+	void applyFont(CanvasFont*);
+	const CanvasTextRun* layoutText(const char* text);
+	void drawTextRun(const CanvasTextRun&, float x, float y, const SkPaint&);
+
+	// |bounds| is in local space and is outset by the paint's stroke, blur and
+	// shadow; a null paint adds the bounds as they are.
+	void didDraw(const SkRect& bounds, const SkPaint*);
+	void didDrawDeviceRect(const SkRect&);
+
+	void fillInternal(const SkPath&, WindRule);
+	void strokeInternal(const SkPath&);
+	void clipInternal(const SkPath&, WindRule);
+	bool isPointInPathInternal(const SkPath&, float x, float y, WindRule);
 
+	void restoreCanvasMatrixClipStack();
 	void clearCanvas();
 	bool rectContainsTransformedRect(const FloatRect&, const FloatRect&) const;
 
@@ -214,6 +317,10 @@ private:
 	virtual bool hasAlpha() const { return m_hasAlpha; }
 
 	virtual bool isTransformInvertible() const { return state().m_invertibleCTM; }
+	virtual const SkMatrix* pathTransform();
+	virtual const SkMatrix* inversePathTransform();
+	void updatePathTransform();
+	const SkPath* userSpacePath(SkPath& storage);
 
 	std::vector<State> m_stateStack;
 	bool m_usesCSSCompatibilityParseMode;
@@ -223,11 +330,26 @@ private:
 	// add by hgl
 	SkCanvas *m_pCanvas;
 
-	SkPath m_path;
-	Color m_fillColor;
-	Color m_strokeColor;
-	SkPaint m_strokePaint;
-	SkPaint m_fillPaint;
+	// m_path is in device space. These cache the CTM last used to map into
+	// it, so transform calls stay O(1) however long the path is.
+	AffineTransform m_pathTransformCTM;
+	SkMatrix m_pathTransform;
+	SkMatrix m_inversePathTransform;
+	bool m_pathTransformInvertible;
+
+	CanvasCommandObjectTable m_commandObjects;
+	CanvasSessionRecorder* m_sessionRecorder;
+	CanvasStyleCache m_styleCache;
+	GradientShaderCache m_gradientCache;
+	CanvasFontCache m_fontCache;
+	CanvasTextLayoutCache m_textLayoutCache;
+	std::vector<SkScalar> m_textPositions;
+	CanvasSpriteBatch m_spriteBatch;
+	bool m_tracksDamage;
+	CanvasDamageTracker m_damage;
+	CanvasImageAtlas* m_imageAtlas;
+	uint32_t m_lastImageID;
+	unsigned m_imageBindCount;
 
 
 };
@@ -0,0 +1,131 @@
+#include "CanvasDamageTracker.h"
+#include "SkRegion.h"
+
+namespace Canvas2D {
+
+CanvasDamageTracker::CanvasDamageTracker()
+	: m_width(0)
+	, m_height(0)
+	, m_tilesX(0)
+	, m_tilesY(0)
+	, m_dirtyCount(0)
+{
+	m_bounds.setEmpty();
+}
+
+void CanvasDamageTracker::setSize(int width, int height)
+{
+	if (width == m_width && height == m_height)
+	{
+		return;
+	}
+	m_width = width > 0 ? width : 0;
+	m_height = height > 0 ? height : 0;
+	m_tilesX = (m_width + kTileSize - 1) / kTileSize;
+	m_tilesY = (m_height + kTileSize - 1) / kTileSize;
+	m_tiles.assign(m_tilesX * m_tilesY, 0);
+	m_dirtyCount = 0;
+	m_bounds.setEmpty();
+}
+
+void CanvasDamageTracker::add(const SkIRect& rect)
+{
+	SkIRect r = rect;
+	if (isFull() || !r.intersect(0, 0, m_width, m_height))
+	{
+		return;
+	}
+	m_bounds.join(r);
+
+	int left = r.fLeft / kTileSize;
+	int top = r.fTop / kTileSize;
+	int right = (r.fRight - 1) / kTileSize;
+	int bottom = (r.fBottom - 1) / kTileSize;
+	for (int y = top; y <= bottom; y++)
+	{
+		unsigned char* row = &m_tiles[y * m_tilesX];
+		for (int x = left; x <= right; x++)
+		{
+			if (!row[x])
+			{
+				row[x] = 1;
+				m_dirtyCount++;
+			}
+		}
+	}
+}
+
+void CanvasDamageTracker::addAll()
+{
+	m_tiles.assign(m_tiles.size(), 1);
+	m_dirtyCount = m_tiles.size();
+	m_bounds.set(0, 0, m_width, m_height);
+}
+
+void CanvasDamageTracker::reset()
+{
+	if (isEmpty())
+	{
+		return;
+	}
+	m_tiles.assign(m_tiles.size(), 0);
+	m_dirtyCount = 0;
+	m_bounds.setEmpty();
+}
+
+SkIRect CanvasDamageTracker::tileRect(int x, int y) const
+{
+	SkIRect r = SkIRect::MakeXYWH(x * kTileSize, y * kTileSize, kTileSize, kTileSize);
+	r.intersect(0, 0, m_width, m_height);
+	return r;
+}
+
+void CanvasDamageTracker::getRegion(SkRegion* region) const
+{
+	region->setEmpty();
+	if (isFull())
+	{
+		region->setRect(0, 0, m_width, m_height);
+		return;
+	}
+	// One rect per horizontal run of dirty tiles.
+	for (int y = 0; y < m_tilesY && !isEmpty(); y++)
+	{
+		int x = 0;
+		while (x < m_tilesX)
+		{
+			if (!isTileDirty(x, y))
+			{
+				x++;
+				continue;
+			}
+			int start = x;
+			while (x < m_tilesX && isTileDirty(x, y))
+			{
+				x++;
+			}
+			SkIRect run = tileRect(start, y);
+			run.fRight = tileRect(x - 1, y).fRight;
+			region->op(run, SkRegion::kUnion_Op);
+		}
+	}
+}
+
+int CanvasDamageTracker::dirtyPixelCount() const
+{
+	int pixels = 0;
+	for (int y = 0; y < m_tilesY && !isEmpty(); y++)
+	{
+		for (int x = 0; x < m_tilesX; x++)
+		{
+			if (isTileDirty(x, y))
+			{
+				SkIRect r = tileRect(x, y);
+				pixels += r.width() * r.height();
+			}
+		}
+	}
+	return pixels;
+}
+
+} // namespace Canvas2D
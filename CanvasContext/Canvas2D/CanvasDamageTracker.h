@@ -0,0 +1,59 @@
+#ifndef CanvasDamageTracker_h
+#define CanvasDamageTracker_h
+
+#include "SkRect.h"
+#include "vector"
+
+class SkRegion;
+
+namespace Canvas2D
+{
+
+// Device-space record of what a frame has drawn over, kept at tile
+// granularity: the canvas is split into kTileSize squares and a draw marks
+// every tile its bounds touch. Tiles keep a frame of scattered small updates
+// (a score counter in one corner, a sprite in another) from merging into one
+// bounding box that covers the screen.
+class CanvasDamageTracker
+{
+public:
+	enum { kTileSize = 64 };
+
+	CanvasDamageTracker();
+
+	void setSize(int width, int height);
+	int width() const { return m_width; }
+	int height() const { return m_height; }
+
+	void add(const SkIRect&);
+	void addAll();
+	void reset();
+
+	bool isEmpty() const { return !m_dirtyCount; }
+	bool isFull() const { return m_dirtyCount == m_tiles.size(); }
+	// Union of everything added, not rounded out to tiles.
+	const SkIRect& bounds() const { return m_bounds; }
+
+	int tilesX() const { return m_tilesX; }
+	int tilesY() const { return m_tilesY; }
+	bool isTileDirty(int x, int y) const { return m_tiles[y * m_tilesX + x] != 0; }
+	SkIRect tileRect(int x, int y) const;
+
+	// The dirty tiles, clipped to the canvas.
+	void getRegion(SkRegion*) const;
+	// Number of canvas pixels covered by dirty tiles.
+	int dirtyPixelCount() const;
+
+private:
+	int m_width;
+	int m_height;
+	int m_tilesX;
+	int m_tilesY;
+	std::vector<unsigned char> m_tiles;
+	size_t m_dirtyCount;
+	SkIRect m_bounds;
+};
+
+} // namespace Canvas2D
+
+#endif // CanvasDamageTracker_h
@@ -0,0 +1,227 @@
+#include "CanvasETC1.h"
+#include "SkBitmap.h"
+#include "SkColorPriv.h"
+#include "SkData.h"
+#include "SkImageGenerator.h"
+#include "SkPixelRef.h"
+
+#ifndef SK_IGNORE_ETC1_SUPPORT
+#include "etc1.h"
+#include "ktx.h"
+#endif
+
+namespace Canvas2D {
+
+#ifndef SK_IGNORE_ETC1_SUPPORT
+
+// Finds the size and the first ETC1 block of PKM or KTX/ETC1 data.
+static const uint8_t* etc1Blocks(SkData* data, int* width, int* height)
+{
+	if (!data)
+	{
+		return 0;
+	}
+	const uint8_t* bytes = data->bytes();
+	if (data->size() >= ETC_PKM_HEADER_SIZE && etc1_pkm_is_valid(bytes))
+	{
+		*width = etc1_pkm_get_width(bytes);
+		*height = etc1_pkm_get_height(bytes);
+		if (data->size() < ETC_PKM_HEADER_SIZE + etc1_get_encoded_data_size(*width, *height))
+		{
+			return 0;
+		}
+		return bytes + ETC_PKM_HEADER_SIZE;
+	}
+	if (data->size() >= 12 && SkKTXFile::is_ktx(bytes))
+	{
+		SkKTXFile ktx(data);
+		if (!ktx.valid() || !ktx.isETC1())
+		{
+			return 0;
+		}
+		*width = ktx.width();
+		*height = ktx.height();
+		return ktx.pixelData();
+	}
+	return 0;
+}
+
+class ETC1ImageGenerator : public SkImageGenerator
+{
+public:
+	ETC1ImageGenerator(SkData* data, int width, int height)
+		: m_data(SkRef(data))
+		, m_width(width)
+		, m_height(height)
+	{
+	}
+
+protected:
+	virtual SkData* onRefEncodedData()
+	{
+		return SkRef(m_data.get());
+	}
+
+	virtual bool onGetInfo(SkImageInfo* info)
+	{
+		*info = SkImageInfo::MakeN32(m_width, m_height, kOpaque_SkAlphaType);
+		return true;
+	}
+
+	virtual bool onGetPixels(const SkImageInfo& info, void* pixels, size_t rowBytes, SkPMColor[], int*)
+	{
+		if (info.width() != m_width || info.height() != m_height || info.colorType() != kN32_SkColorType)
+		{
+			return false;
+		}
+		SkBitmap bitmap;
+		bitmap.installPixels(info, pixels, rowBytes);
+		return CanvasETC1::decode(m_data, &bitmap);
+	}
+
+private:
+	SkAutoTUnref<SkData> m_data;
+	int m_width;
+	int m_height;
+};
+
+bool CanvasETC1::isETC1(SkData* data)
+{
+	int width, height;
+	return etc1Blocks(data, &width, &height) != 0;
+}
+
+bool CanvasETC1::isETC1(const SkBitmap& bitmap)
+{
+	if (!bitmap.pixelRef())
+	{
+		return false;
+	}
+	SkAutoTUnref<SkData> data(bitmap.pixelRef()->refEncodedData());
+	return isETC1(data);
+}
+
+SkData* CanvasETC1::encode(const SkBitmap& bitmap)
+{
+	if (!bitmap.isOpaque() || bitmap.drawsNothing())
+	{
+		return 0;
+	}
+	SkBitmap n32;
+	const SkBitmap* src = &bitmap;
+	if (bitmap.colorType() != kN32_SkColorType)
+	{
+		if (!bitmap.copyTo(&n32, kN32_SkColorType))
+		{
+			return 0;
+		}
+		src = &n32;
+	}
+	SkAutoLockPixels lock(*src);
+	if (!src->getPixels())
+	{
+		return 0;
+	}
+
+	int width = src->width();
+	int height = src->height();
+	SkAutoMalloc rgb(width * height * 3);
+	uint8_t* dst = static_cast<uint8_t*>(rgb.get());
+	for (int y = 0; y < height; y++)
+	{
+		const SkPMColor* row = src->getAddr32(0, y);
+		for (int x = 0; x < width; x++)
+		{
+			*dst++ = SkGetPackedR32(row[x]);
+			*dst++ = SkGetPackedG32(row[x]);
+			*dst++ = SkGetPackedB32(row[x]);
+		}
+	}
+
+	size_t size = ETC_PKM_HEADER_SIZE + etc1_get_encoded_data_size(width, height);
+	uint8_t* pkm = static_cast<uint8_t*>(sk_malloc_throw(size));
+	etc1_pkm_format_header(pkm, width, height);
+	if (etc1_encode_image(static_cast<const uint8_t*>(rgb.get()), width, height, 3, width * 3, pkm + ETC_PKM_HEADER_SIZE))
+	{
+		sk_free(pkm);
+		return 0;
+	}
+	return SkData::NewFromMalloc(pkm, size);
+}
+
+bool CanvasETC1::decode(SkData* data, SkBitmap* bitmap)
+{
+	int width, height;
+	const uint8_t* blocks = etc1Blocks(data, &width, &height);
+	if (!blocks)
+	{
+		return false;
+	}
+	if (bitmap->drawsNothing() && !bitmap->allocPixels(SkImageInfo::MakeN32(width, height, kOpaque_SkAlphaType)))
+	{
+		return false;
+	}
+	if (bitmap->width() != width || bitmap->height() != height || bitmap->colorType() != kN32_SkColorType)
+	{
+		return false;
+	}
+
+	SkAutoMalloc rgb(width * height * 3);
+	if (etc1_decode_image(blocks, static_cast<uint8_t*>(rgb.get()), width, height, 3, width * 3))
+	{
+		return false;
+	}
+	SkAutoLockPixels lock(*bitmap);
+	const uint8_t* src = static_cast<const uint8_t*>(rgb.get());
+	for (int y = 0; y < height; y++)
+	{
+		SkPMColor* row = bitmap->getAddr32(0, y);
+		for (int x = 0; x < width; x++, src += 3)
+		{
+			row[x] = SkPackARGB32(0xFF, src[0], src[1], src[2]);
+		}
+	}
+	bitmap->notifyPixelsChanged();
+	return true;
+}
+
+SkImageGenerator* CanvasETC1::createGenerator(SkData* data)
+{
+	int width, height;
+	if (!etc1Blocks(data, &width, &height))
+	{
+		return 0;
+	}
+	return new ETC1ImageGenerator(data, width, height);
+}
+
+#else
+
+bool CanvasETC1::isETC1(SkData*)
+{
+	return false;
+}
+
+bool CanvasETC1::isETC1(const SkBitmap&)
+{
+	return false;
+}
+
+SkData* CanvasETC1::encode(const SkBitmap&)
+{
+	return 0;
+}
+
+bool CanvasETC1::decode(SkData*, SkBitmap*)
+{
+	return false;
+}
+
+SkImageGenerator* CanvasETC1::createGenerator(SkData*)
+{
+	return 0;
+}
+
+#endif // SK_IGNORE_ETC1_SUPPORT
+
+} // namespace Canvas2D
@@ -0,0 +1,39 @@
+#ifndef CanvasETC1_h
+#define CanvasETC1_h
+
+class SkBitmap;
+class SkData;
+class SkImageGenerator;
+
+namespace Canvas2D
+{
+
+// ETC1 images for the canvas. An image backed by PKM or KTX/ETC1 data is
+// uploaded by the GPU device as a compressed texture, at 4 bits a pixel
+// instead of 16 or 32, as long as its pixels have not been decoded; raster
+// canvases, and GPUs without ETC1, decode it like any other image.
+//
+// Builds that define SK_IGNORE_ETC1_SUPPORT compile this to stubs that
+// never find or produce ETC1 data.
+class CanvasETC1
+{
+public:
+	// Whether |data| is a PKM file, or a KTX file holding ETC1 blocks.
+	static bool isETC1(SkData*);
+	// Whether |bitmap| is backed by ETC1 data and would upload compressed.
+	static bool isETC1(const SkBitmap&);
+
+	// Encodes an opaque bitmap as a PKM file. Returns null for bitmaps that
+	// are not opaque, since ETC1 has no alpha.
+	static SkData* encode(const SkBitmap&);
+	// Decodes PKM or KTX/ETC1 data into an opaque N32 bitmap.
+	static bool decode(SkData*, SkBitmap*);
+
+	// A generator whose pixel ref hands |data| to the GPU upload unchanged
+	// and decodes it for everything else. Returns null if |data| is not ETC1.
+	static SkImageGenerator* createGenerator(SkData*);
+};
+
+} // namespace Canvas2D
+
+#endif // CanvasETC1_h
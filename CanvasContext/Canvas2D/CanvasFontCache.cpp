@@ -0,0 +1,102 @@
+#include "CanvasFontCache.h"
+#include "SkTypeface.h"
+
+namespace Canvas2D {
+
+static bool isBold(const FontDescription& description)
+{
+	return description.weight() >= FontWeight600;
+}
+
+static bool isItalic(const FontDescription& description)
+{
+	return description.style() == FontStyleItalic;
+}
+
+CanvasFont::CanvasFont(const FontDescription& description)
+	: m_description(description)
+{
+	int style = SkTypeface::kNormal;
+	if (isBold(description))
+	{
+		style |= SkTypeface::kBold;
+	}
+	if (isItalic(description))
+	{
+		style |= SkTypeface::kItalic;
+	}
+
+	SkAutoTUnref<SkTypeface> face(SkTypeface::CreateFromName(description.m_fontName.c_str(), (SkTypeface::Style)style));
+	if (face.get())
+	{
+		m_paint.setTypeface(face.get());
+	}
+	m_paint.setTextSize(description.specifiedSize());
+	m_paint.getFontMetrics(&m_metrics, 0);
+}
+
+bool CanvasFontCache::Key::operator<(const Key& other) const
+{
+	if (m_size != other.m_size)
+	{
+		return m_size < other.m_size;
+	}
+	if (m_bold != other.m_bold)
+	{
+		return m_bold < other.m_bold;
+	}
+	if (m_italic != other.m_italic)
+	{
+		return m_italic < other.m_italic;
+	}
+	return m_family < other.m_family;
+}
+
+CanvasFont* CanvasFontCache::get(const std::string& font)
+{
+	std::map<std::string, RefPtr<CanvasFont> >::iterator it = m_fontsByString.find(font);
+	if (it != m_fontsByString.end())
+	{
+		return it->second.get();
+	}
+
+	// Parse into a fresh description; parseFontDes only sets what the string
+	// mentions.
+	FontDescription description;
+	description.parseFontDes(font);
+	if (description.specifiedSize() <= 0)
+	{
+		return 0;
+	}
+
+	Key key;
+	key.m_family = description.m_fontName;
+	key.m_size = description.specifiedSize();
+	key.m_bold = isBold(description);
+	key.m_italic = isItalic(description);
+
+	if (m_fontsByKey.size() >= kMaxFonts)
+	{
+		m_fontsByKey.clear();
+	}
+	RefPtr<CanvasFont>& resolved = m_fontsByKey[key];
+	if (!resolved)
+	{
+		resolved = CanvasFont::create(description);
+	}
+
+	if (m_fontsByString.size() >= kMaxFonts)
+	{
+		m_fontsByString.clear();
+	}
+	m_fontsByString[font] = resolved;
+	return resolved.get();
+}
+
+void CanvasFontCache::clear()
+{
+	m_fontsByString.clear();
+	m_fontsByKey.clear();
+}
+
+} // namespace Canvas2D
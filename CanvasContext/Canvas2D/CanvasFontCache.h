@@ -0,0 +1,74 @@
+#ifndef CanvasFontCache_h
+#define CanvasFontCache_h
+
+#include "Noncopyable.h"
+#include "RefCounted.h"
+#include "RefPtr.h"
+#include "passrefptr.h"
+#include "FontDescription.h"
+#include "SkPaint.h"
+#include "map"
+#include "string"
+
+namespace Canvas2D
+{
+
+// A font string resolved down to what Skia needs to draw it: the typeface,
+// the text size and the metrics used for baseline placement.
+class CanvasFont : public RefCounted<CanvasFont>
+{
+public:
+	static PassRefPtr<CanvasFont> create(const FontDescription& description)
+	{
+		return adoptRef(new CanvasFont(description));
+	}
+
+	const FontDescription& description() const { return m_description; }
+	// Holds only the typeface and text size; callers copy these onto their
+	// own paints.
+	const SkPaint& paint() const { return m_paint; }
+	const SkPaint::FontMetrics& metrics() const { return m_metrics; }
+
+private:
+	CanvasFont(const FontDescription&);
+
+	FontDescription m_description;
+	SkPaint m_paint;
+	SkPaint::FontMetrics m_metrics;
+};
+
+// Caches CanvasFont objects by font string and by the resolved description
+// (family, weight, style, size), so parsing and the typeface lookup happen
+// once per distinct font rather than once per text draw. Strings that
+// describe the same font share one CanvasFont.
+class CanvasFontCache
+{
+	WTF_MAKE_NONCOPYABLE(CanvasFontCache);
+public:
+	// When either map grows past this it is simply cleared. Fonts still in
+	// use by a context state stay alive through their RefPtr.
+	enum { kMaxFonts = 128 };
+
+	CanvasFontCache() { }
+
+	// Returns null if the string has no usable size.
+	CanvasFont* get(const std::string& font);
+	void clear();
+
+private:
+	struct Key
+	{
+		std::string m_family;
+		float m_size;
+		bool m_bold;
+		bool m_italic;
+		bool operator<(const Key&) const;
+	};
+
+	std::map<std::string, RefPtr<CanvasFont> > m_fontsByString;
+	std::map<Key, RefPtr<CanvasFont> > m_fontsByKey;
+};
+
+} // namespace Canvas2D
+
+#endif // CanvasFontCache_h
@@ -0,0 +1,221 @@
+#include "CanvasFrameRenderer.h"
+#include "CanvasTileRenderer.h"
+#include "SkCanvas.h"
+#include "SkRecord.h"
+#include "SkRecordDraw.h"
+#include "SkRecordOpts.h"
+#include "SkRecorder.h"
+#include "SkThreadUtils.h"
+
+namespace Canvas2D {
+
+CanvasFrameRenderer::CanvasFrameRenderer(SkCanvas* target, int width, int height, Client* client, bool threaded)
+	: m_target(target)
+	, m_tileRenderer(0)
+	, m_width(width)
+	, m_height(height)
+	, m_client(client)
+	, m_thread(0)
+	, m_record(0)
+	, m_recorder(0)
+	, m_pending(0)
+	, m_drawing(false)
+	, m_quit(false)
+{
+	if (threaded)
+	{
+		startRenderThread();
+	}
+}
+
+CanvasFrameRenderer::CanvasFrameRenderer(CanvasTileRenderer* tileRenderer, Client* client, bool threaded)
+	: m_target(0)
+	, m_tileRenderer(tileRenderer)
+	, m_width(tileRenderer->width())
+	, m_height(tileRenderer->height())
+	, m_client(client)
+	, m_thread(0)
+	, m_record(0)
+	, m_recorder(0)
+	, m_pending(0)
+	, m_drawing(false)
+	, m_quit(false)
+{
+	if (threaded)
+	{
+		startRenderThread();
+	}
+}
+
+CanvasFrameRenderer::~CanvasFrameRenderer()
+{
+	if (m_recorder)
+	{
+		m_recorder->forgetRecord();
+		m_recorder->unref();
+		SkDELETE(m_record);
+	}
+	finish();
+	if (m_thread)
+	{
+		m_condition.lock();
+		m_quit = true;
+		m_condition.broadcast();
+		m_condition.unlock();
+		m_thread->join();
+		SkDELETE(m_thread);
+	}
+}
+
+SkCanvas* CanvasFrameRenderer::beginFrame()
+{
+	if (!m_recorder)
+	{
+		m_record = SkNEW(SkRecord);
+		m_recorder = SkNEW_ARGS(SkRecorder, (m_record, m_width, m_height));
+	}
+	return m_recorder;
+}
+
+void CanvasFrameRenderer::endFrame(const SkRegion* damage)
+{
+	if (!m_recorder)
+	{
+		return;
+	}
+	SkRecord* record = m_record;
+	m_recorder->forgetRecord();
+	m_recorder->unref();
+	m_recorder = 0;
+	m_record = 0;
+	// Done here rather than on the render thread; it only touches the record
+	// and overlaps the previous frame's playback.
+	SkRecordOptimize(record);
+
+	SkRegion region;
+	if (damage)
+	{
+		region.op(*damage, SkIRect::MakeWH(m_width, m_height), SkRegion::kIntersect_Op);
+	}
+	else
+	{
+		region.setRect(0, 0, m_width, m_height);
+	}
+
+	if (!m_thread)
+	{
+		drawFrame(record, region);
+		m_stats.m_framesRecorded++;
+		m_stats.m_framesDrawn++;
+		return;
+	}
+
+	m_condition.lock();
+	m_stats.m_framesRecorded++;
+	if (m_pending || m_drawing)
+	{
+		m_stats.m_waits++;
+	}
+	while (m_pending || m_drawing)
+	{
+		m_condition.wait();
+	}
+	m_pending = record;
+	m_pendingDamage.swap(region);
+	m_condition.broadcast();
+	m_condition.unlock();
+}
+
+void CanvasFrameRenderer::finish()
+{
+	if (!m_thread)
+	{
+		return;
+	}
+	m_condition.lock();
+	while (m_pending || m_drawing)
+	{
+		m_condition.wait();
+	}
+	m_condition.unlock();
+}
+
+CanvasFrameRenderer::Stats CanvasFrameRenderer::stats()
+{
+	m_condition.lock();
+	Stats stats = m_stats;
+	m_condition.unlock();
+	return stats;
+}
+
+void CanvasFrameRenderer::startRenderThread()
+{
+	m_thread = SkNEW_ARGS(SkThread, (&CanvasFrameRenderer::renderThreadMain, this));
+	if (!m_thread->start())
+	{
+		SkDELETE(m_thread);
+		m_thread = 0;
+	}
+}
+
+void CanvasFrameRenderer::renderThreadMain(void* data)
+{
+	static_cast<CanvasFrameRenderer*>(data)->renderLoop();
+}
+
+void CanvasFrameRenderer::renderLoop()
+{
+	m_condition.lock();
+	for (;;)
+	{
+		while (!m_pending && !m_quit)
+		{
+			m_condition.wait();
+		}
+		if (!m_pending)
+		{
+			break;
+		}
+		SkRecord* record = m_pending;
+		SkRegion damage;
+		damage.swap(m_pendingDamage);
+		m_pending = 0;
+		m_drawing = true;
+		m_condition.unlock();
+
+		drawFrame(record, damage);
+
+		m_condition.lock();
+		m_drawing = false;
+		m_stats.m_framesDrawn++;
+		m_condition.broadcast();
+	}
+	m_condition.unlock();
+}
+
+void CanvasFrameRenderer::drawFrame(SkRecord* record, const SkRegion& damage)
+{
+	if (m_client)
+	{
+		m_client->willDrawFrame(damage);
+	}
+	if (m_tileRenderer)
+	{
+		m_tileRenderer->draw(*record, &damage);
+	}
+	else if (!damage.isEmpty())
+	{
+		// The context leaves its saves open across frames and rebuilds them
+		// at the start of each one; do not let them pile up on the target.
+		SkAutoCanvasRestore restore(m_target, true);
+		m_target->clipRegion(damage);
+		SkRecordDraw(*record, m_target);
+	}
+	if (m_client)
+	{
+		m_client->didDrawFrame(damage);
+	}
+	SkDELETE(record);
+}
+
+} // namespace Canvas2D
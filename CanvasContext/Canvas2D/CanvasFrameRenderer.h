@@ -0,0 +1,107 @@
+#ifndef CanvasFrameRenderer_h
+#define CanvasFrameRenderer_h
+
+#include "Noncopyable.h"
+#include "SkCondVar.h"
+#include "SkRegion.h"
+
+class SkCanvas;
+class SkRecord;
+class SkRecorder;
+class SkThread;
+
+namespace Canvas2D
+{
+
+class CanvasTileRenderer;
+
+// Deferred mode for CanvasContext2D. Each frame is recorded into an SkRecord,
+// optimized with SkRecordOptimize and played back into the target canvas with
+// SkRecordDraw on a render thread, so script can build frame N+1 while frame
+// N is drawn. At most one frame is in flight: endFrame() waits for the
+// previous playback to finish before queueing the next one.
+//
+// Typical frame:
+//
+//     context->setCanvas(renderer.beginFrame());
+//     ... run script ...
+//     renderer.endFrame();
+//
+// The canvas returned by beginFrame() is only valid until endFrame().
+// Readbacks (getImageData) cannot see pixels of a frame being recorded.
+//
+// When only part of the frame changed, pass the damage region to endFrame():
+// playback is clipped to it, so with a retained target (CanvasBackingStore)
+// everything outside keeps last frame's pixels.
+//
+// Without GL, give it a CanvasTileRenderer instead of a target canvas and
+// each frame is rasterized tile by tile on the tile renderer's workers.
+class CanvasFrameRenderer
+{
+	WTF_MAKE_NONCOPYABLE(CanvasFrameRenderer);
+public:
+	class Client
+	{
+	public:
+		virtual ~Client() { }
+		// Called on the thread that plays frames back, around each playback.
+		// A GPU target needs its GL context current on that thread, and
+		// typically flushes its GrContext and swaps buffers afterwards.
+		// |damage| is the device-space region the frame is clipped to.
+		virtual void willDrawFrame(const SkRegion& damage) { }
+		virtual void didDrawFrame(const SkRegion& damage) { }
+	};
+
+	struct Stats
+	{
+		Stats() : m_framesRecorded(0), m_framesDrawn(0), m_waits(0) { }
+		unsigned m_framesRecorded;
+		unsigned m_framesDrawn;
+		// endFrame() calls that had to wait for the previous frame.
+		unsigned m_waits;
+	};
+
+	// Plays frames back on a render thread when |threaded| is true, otherwise
+	// on the caller's thread inside endFrame(). Neither pointer is owned.
+	CanvasFrameRenderer(SkCanvas* target, int width, int height, Client* = 0, bool threaded = true);
+	CanvasFrameRenderer(CanvasTileRenderer*, Client* = 0, bool threaded = true);
+	~CanvasFrameRenderer();
+
+	SkCanvas* beginFrame();
+	// A null |damage| redraws the whole target.
+	void endFrame(const SkRegion* damage = 0);
+	// Blocks until every queued frame has been drawn.
+	void finish();
+
+	bool isThreaded() const { return m_thread != 0; }
+	Stats stats();
+
+private:
+	void startRenderThread();
+	static void renderThreadMain(void*);
+	void renderLoop();
+	void drawFrame(SkRecord*, const SkRegion& damage);
+
+	SkCanvas* m_target;
+	CanvasTileRenderer* m_tileRenderer;
+	int m_width;
+	int m_height;
+	Client* m_client;
+	SkThread* m_thread;
+
+	// Only touched by the recording thread.
+	SkRecord* m_record;
+	SkRecorder* m_recorder;
+
+	// Guarded by m_condition.
+	SkCondVar m_condition;
+	SkRecord* m_pending;
+	SkRegion m_pendingDamage;
+	bool m_drawing;
+	bool m_quit;
+	Stats m_stats;
+};
+
+} // namespace Canvas2D
+
+#endif // CanvasFrameRenderer_h
@@ -0,0 +1,303 @@
+#include "CanvasImageAtlas.h"
+#include "CanvasETC1.h"
+#include "GrContext.h"
+#include "GrRectanizer_skyline.h"
+#include "GrTexture.h"
+#include "SkCanvas.h"
+#include "SkGr.h"
+#include "SkPixelRef.h"
+#include "SkTraceEvent.h"
+
+namespace Canvas2D {
+
+class CanvasImageAtlas::Page
+{
+public:
+	Page()
+		: m_rects(kPageSize, kPageSize)
+		, m_lastUse(0)
+		, m_texture(0)
+	{
+		m_bitmap.allocN32Pixels(kPageSize, kPageSize);
+		m_bitmap.eraseColor(SK_ColorTRANSPARENT);
+	}
+
+	~Page()
+	{
+		if (m_texture)
+		{
+			GrUnlockAndUnrefCachedBitmapTexture(m_texture);
+		}
+	}
+
+	SkBitmap m_bitmap;
+	GrRectanizerSkyline m_rects;
+	unsigned m_lastUse;
+	// Locked in the GrContext's cache under m_bitmap's generation ID, which
+	// is where the GPU device looks when the page is drawn.
+	GrTexture* m_texture;
+};
+
+CanvasImageAtlas::Key::Key(const SkBitmap& bitmap)
+	: m_generationID(bitmap.getGenerationID())
+	, m_origin(bitmap.pixelRefOrigin())
+	, m_width(bitmap.width())
+	, m_height(bitmap.height())
+{
+}
+
+bool CanvasImageAtlas::Key::operator<(const Key& other) const
+{
+	if (m_generationID != other.m_generationID)
+	{
+		return m_generationID < other.m_generationID;
+	}
+	if (m_origin.fX != other.m_origin.fX)
+	{
+		return m_origin.fX < other.m_origin.fX;
+	}
+	if (m_origin.fY != other.m_origin.fY)
+	{
+		return m_origin.fY < other.m_origin.fY;
+	}
+	if (m_width != other.m_width)
+	{
+		return m_width < other.m_width;
+	}
+	return m_height < other.m_height;
+}
+
+CanvasImageAtlas::CanvasImageAtlas(int maxPages)
+	: m_maxPages(maxPages > 0 ? maxPages : 1)
+	, m_frame(0)
+	, m_context(0)
+{
+}
+
+CanvasImageAtlas::~CanvasImageAtlas()
+{
+	clear();
+}
+
+void CanvasImageAtlas::setGrContext(GrContext* context)
+{
+	if (context == m_context)
+	{
+		return;
+	}
+	clear();
+	m_context = context;
+}
+
+const SkBitmap& CanvasImageAtlas::page(int index) const
+{
+	return m_pages[index]->m_bitmap;
+}
+
+void CanvasImageAtlas::clear()
+{
+	for (size_t i = 0; i < m_pages.size(); i++)
+	{
+		delete m_pages[i];
+	}
+	m_pages.clear();
+	m_entries.clear();
+}
+
+bool CanvasImageAtlas::find(const SkBitmap& image, SkBitmap* page, SkIPoint* offset)
+{
+	if (!image.pixelRef() || image.width() > kMaxImageSize || image.height() > kMaxImageSize)
+	{
+		return false;
+	}
+	Key key(image);
+	EntryMap::iterator it = m_entries.find(key);
+	if (it == m_entries.end())
+	{
+		// Packing would decode an ETC1 image into a 32 bit page.
+		Entry entry;
+		if (CanvasETC1::isETC1(image) || !add(image, &entry))
+		{
+			m_stats.m_rejected++;
+			return false;
+		}
+		it = m_entries.insert(std::make_pair(key, entry)).first;
+		m_stats.m_packed++;
+	}
+	else
+	{
+		m_stats.m_hits++;
+	}
+	Page* p = m_pages[it->second.m_page];
+	p->m_lastUse = m_frame;
+	if (m_context && !p->m_texture)
+	{
+		// The one full upload of the page; later images go in by rect.
+		p->m_texture = GrLockAndRefCachedBitmapTexture(m_context, p->m_bitmap, 0);
+	}
+	*page = p->m_bitmap;
+	offset->set(it->second.m_location.fX + kPadding, it->second.m_location.fY + kPadding);
+	return true;
+}
+
+static void copyRect(SkCanvas& canvas, const SkBitmap& bitmap, int sx, int sy, int w, int h, int dx, int dy, const SkPaint& paint)
+{
+	SkRect src = SkRect::MakeXYWH(SkIntToScalar(sx), SkIntToScalar(sy), SkIntToScalar(w), SkIntToScalar(h));
+	SkRect dst = SkRect::MakeXYWH(SkIntToScalar(dx), SkIntToScalar(dy), SkIntToScalar(w), SkIntToScalar(h));
+	canvas.drawBitmapRectToRect(bitmap, &src, dst, &paint);
+}
+
+bool CanvasImageAtlas::add(const SkBitmap& image, Entry* entry)
+{
+	int width = image.width() + 2 * kPadding;
+	int height = image.height() + 2 * kPadding;
+
+	entry->m_page = -1;
+	for (size_t i = 0; i < m_pages.size() && entry->m_page < 0; i++)
+	{
+		if (m_pages[i]->m_rects.addRect(width, height, &entry->m_location))
+		{
+			entry->m_page = static_cast<int>(i);
+		}
+	}
+	if (entry->m_page < 0)
+	{
+		int index;
+		if (static_cast<int>(m_pages.size()) < m_maxPages)
+		{
+			index = static_cast<int>(m_pages.size());
+			m_pages.push_back(new Page());
+		}
+		else
+		{
+			index = evictablePage();
+			if (index < 0)
+			{
+				return false;
+			}
+			evictPage(index);
+		}
+		if (!m_pages[index]->m_rects.addRect(width, height, &entry->m_location))
+		{
+			return false;
+		}
+		entry->m_page = index;
+	}
+
+	// Lay the image and its padding out on their own, then copy them into
+	// the page: drawing on the page would give it a new generation ID and
+	// so lose its texture.
+	SkBitmap rect;
+	rect.allocN32Pixels(width, height);
+	SkCanvas canvas(rect);
+	SkPaint paint;
+	paint.setXfermodeMode(SkXfermode::kSrc_Mode);
+	int w = image.width();
+	int h = image.height();
+	int x = kPadding;
+	int y = kPadding;
+	copyRect(canvas, image, 0, 0, w, h, x, y, paint);
+	// Repeat the edges into the padding.
+	copyRect(canvas, image, 0, 0, 1, h, x - 1, y, paint);
+	copyRect(canvas, image, w - 1, 0, 1, h, x + w, y, paint);
+	copyRect(canvas, image, 0, 0, w, 1, x, y - 1, paint);
+	copyRect(canvas, image, 0, h - 1, w, 1, x, y + h, paint);
+	copyRect(canvas, image, 0, 0, 1, 1, x - 1, y - 1, paint);
+	copyRect(canvas, image, w - 1, 0, 1, 1, x + w, y - 1, paint);
+	copyRect(canvas, image, 0, h - 1, 1, 1, x - 1, y + h, paint);
+	copyRect(canvas, image, w - 1, h - 1, 1, 1, x + w, y + h, paint);
+
+	Page* page = m_pages[entry->m_page];
+	willModifyPage(page, true);
+	int left = entry->m_location.fX;
+	int top = entry->m_location.fY;
+	{
+		SkAutoLockPixels pageLock(page->m_bitmap);
+		for (int row = 0; row < height; row++)
+		{
+			memcpy(page->m_bitmap.getAddr32(left, top + row), rect.getAddr32(0, row), width * sizeof(SkPMColor));
+		}
+	}
+	if (page->m_texture)
+	{
+		page->m_texture->writePixels(left, top, width, height, SkImageInfo2GrPixelConfig(rect.info()),
+			rect.getPixels(), rect.rowBytes());
+		m_stats.m_uploadedPixels += width * height;
+	}
+	else
+	{
+		page->m_bitmap.notifyPixelsChanged();
+	}
+	return true;
+}
+
+void CanvasImageAtlas::willModifyPage(Page* page, bool keepPixels)
+{
+	// Drawing on this thread's GrContext, nothing else can be reading the
+	// page while we write to it.
+	if (m_context || page->m_bitmap.pixelRef()->unique())
+	{
+		return;
+	}
+	TRACE_EVENT0("canvas", "CanvasImageAtlas::copyPage");
+	SkBitmap pixels;
+	if (keepPixels)
+	{
+		page->m_bitmap.copyTo(&pixels);
+	}
+	else
+	{
+		pixels.allocN32Pixels(kPageSize, kPageSize);
+	}
+	page->m_bitmap.swap(pixels);
+	m_stats.m_copiedPages++;
+}
+
+int CanvasImageAtlas::evictablePage() const
+{
+	int oldest = -1;
+	for (size_t i = 0; i < m_pages.size(); i++)
+	{
+		unsigned lastUse = m_pages[i]->m_lastUse;
+		if (lastUse + 1 >= m_frame)
+		{
+			continue;
+		}
+		if (oldest < 0 || lastUse < m_pages[oldest]->m_lastUse)
+		{
+			oldest = static_cast<int>(i);
+		}
+	}
+	return oldest;
+}
+
+void CanvasImageAtlas::evictPage(int index)
+{
+	TRACE_EVENT_INSTANT1("canvas", "CanvasImageAtlas::evictPage", TRACE_EVENT_SCOPE_THREAD, "page", index);
+	EntryMap::iterator it = m_entries.begin();
+	while (it != m_entries.end())
+	{
+		if (it->second.m_page == index)
+		{
+			m_entries.erase(it++);
+		}
+		else
+		{
+			++it;
+		}
+	}
+	// Images still in use are packed again, next to each other, on their
+	// next draw.
+	Page* page = m_pages[index];
+	page->m_rects.reset();
+	// With a texture, each rect packed from now on is written and uploaded
+	// whole, padding included, so the stale pixels are never drawn.
+	if (!page->m_texture)
+	{
+		willModifyPage(page, false);
+		page->m_bitmap.eraseColor(SK_ColorTRANSPARENT);
+	}
+	m_stats.m_evictedPages++;
+}
+
+} // namespace Canvas2D
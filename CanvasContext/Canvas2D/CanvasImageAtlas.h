@@ -0,0 +1,118 @@
+#ifndef CanvasImageAtlas_h
+#define CanvasImageAtlas_h
+
+#include "Noncopyable.h"
+#include "SkBitmap.h"
+#include "SkPoint.h"
+#include "map"
+#include "vector"
+#include <stdint.h>
+
+class GrContext;
+
+namespace Canvas2D
+{
+
+// Packs small images into shared kPageSize square pages, so sprites cut from
+// different BitmapImages come from the same texture on the GPU. Sprites from
+// one page can then share a CanvasSpriteBatch and the frame binds a handful
+// of textures instead of one per image.
+//
+// Images are packed with GrRectanizerSkyline and surrounded by a one pixel
+// copy of their edge, so filtering at an image's edge reads the same colors
+// as it would from the image alone. An image whose pixels change gets a new
+// generation ID and is packed again; its old slot is reclaimed when its page
+// is evicted.
+//
+// Pages are copy on write: when a recorded frame still holds a page, adding
+// to it or evicting it moves the page onto new pixels, so a render thread
+// playing that frame back never sees them change. The moved page is uploaded
+// whole on its next GPU draw. With a GrContext set, the atlas instead keeps
+// each page's texture and uploads only the rect a new image went into.
+class CanvasImageAtlas
+{
+	WTF_MAKE_NONCOPYABLE(CanvasImageAtlas);
+public:
+	enum
+	{
+		kPageSize = 2048,
+		// Larger images are drawn from their own texture.
+		kMaxImageSize = 256,
+		kPadding = 1
+	};
+
+	struct Stats
+	{
+		Stats() : m_hits(0), m_packed(0), m_rejected(0), m_evictedPages(0), m_copiedPages(0), m_uploadedPixels(0) { }
+		unsigned m_hits;
+		unsigned m_packed;
+		// Too large, or no page had room and none could be evicted.
+		unsigned m_rejected;
+		unsigned m_evictedPages;
+		// Pages moved to new pixels because a frame still held them.
+		unsigned m_copiedPages;
+		// Texels written into page textures, padding included.
+		unsigned m_uploadedPixels;
+	};
+
+	explicit CanvasImageAtlas(int maxPages = 2);
+	~CanvasImageAtlas();
+
+	// Set when the atlas's pages are drawn onto a GPU canvas on this thread,
+	// to upload new images into the page textures a rect at a time. Drops
+	// every page when the context changes.
+	void setGrContext(GrContext*);
+
+	// Marks a frame boundary. A full atlas only evicts pages that were not
+	// drawn from in this frame or the one before, which may still be playing
+	// back on a render thread.
+	void beginFrame() { m_frame++; }
+
+	// If |image| is in the atlas, or can be added to it, sets |page| to its
+	// page and |offset| to where its top left pixel is, and returns true.
+	bool find(const SkBitmap& image, SkBitmap* page, SkIPoint* offset);
+
+	int pageCount() const { return static_cast<int>(m_pages.size()); }
+	const SkBitmap& page(int index) const;
+	const Stats& stats() const { return m_stats; }
+	void resetStats() { m_stats = Stats(); }
+
+	// Drops every page.
+	void clear();
+
+private:
+	class Page;
+
+	struct Key
+	{
+		Key(const SkBitmap&);
+		bool operator<(const Key&) const;
+		uint32_t m_generationID;
+		SkIPoint m_origin;
+		int m_width;
+		int m_height;
+	};
+
+	struct Entry
+	{
+		int m_page;
+		SkIPoint16 m_location;
+	};
+
+	bool add(const SkBitmap&, Entry*);
+	void willModifyPage(Page*, bool keepPixels);
+	int evictablePage() const;
+	void evictPage(int index);
+
+	typedef std::map<Key, Entry> EntryMap;
+	EntryMap m_entries;
+	std::vector<Page*> m_pages;
+	int m_maxPages;
+	unsigned m_frame;
+	GrContext* m_context;
+	Stats m_stats;
+};
+
+} // namespace Canvas2D
+
+#endif // CanvasImageAtlas_h
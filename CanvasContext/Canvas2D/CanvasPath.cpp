@@ -0,0 +1,25 @@
+#include "CanvasPath.h"
+#include "AffineTransform.h"
+#include "SkiaUtils.h"
+
+namespace Canvas2D {
+
+void CanvasPath::addPath(CanvasPath* path)
+{
+	if (!path)
+	{
+		return;
+	}
+	m_path.addPath(path->m_path);
+}
+
+void CanvasPath::addPath(CanvasPath* path, const AffineTransform& transform)
+{
+	if (!path || !transform.isInvertible())
+	{
+		return;
+	}
+	m_path.addPath(path->m_path, affineTransformToSkMatrix(transform));
+}
+
+} // namespace Canvas2D
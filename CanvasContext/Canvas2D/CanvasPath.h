@@ -0,0 +1,49 @@
+#ifndef CanvasPath_h
+#define CanvasPath_h
+
+#include "RefCounted.h"
+#include "passrefptr.h"
+#include "CanvasPathMethods.h"
+#include <stdint.h>
+
+namespace Canvas2D
+{
+
+class AffineTransform;
+
+// A retained path (Path2D) that can be filled, stroked or clipped any number
+// of times. Drawing it hands the same SkPath to the canvas every time, so as
+// long as the path is not edited its generation ID stays the same and GPU
+// path renderers that key on it (e.g. GrStencilAndCoverPathRenderer) reuse
+// their work from the previous frame.
+class CanvasPath : public RefCounted<CanvasPath>, public CanvasPathMethods
+{
+public:
+	static PassRefPtr<CanvasPath> create()
+	{
+		return adoptRef(new CanvasPath);
+	}
+	static PassRefPtr<CanvasPath> create(const CanvasPath& other)
+	{
+		return adoptRef(new CanvasPath(other.m_path));
+	}
+	static PassRefPtr<CanvasPath> create(const SkPath& path)
+	{
+		return adoptRef(new CanvasPath(path));
+	}
+
+	void addPath(CanvasPath*);
+	void addPath(CanvasPath*, const AffineTransform&);
+
+	const SkPath& path() const { return m_path; }
+	// Changes whenever the geometry changes; never 0.
+	uint32_t generationID() const { return m_path.getGenerationID(); }
+
+private:
+	CanvasPath() { }
+	explicit CanvasPath(const SkPath& path) { m_path = path; }
+};
+
+} // namespace Canvas2D
+
+#endif // CanvasPath_h
@@ -0,0 +1,333 @@
+#include "CanvasPathMethods.h"
+#include "MathExtras.h"
+#include <limits>
+
+namespace Canvas2D {
+
+static void canonicalizeAngle(float* startAngle, float* endAngle)
+{
+	// Make 0 <= startAngle < 2*PI
+	float newStartAngle = *startAngle;
+	if (newStartAngle < 0)
+		newStartAngle = twoPiFloat + fmodf(newStartAngle, -twoPiFloat);
+	else
+		newStartAngle = fmodf(newStartAngle, twoPiFloat);
+
+	float delta = newStartAngle - *startAngle;
+	*startAngle = newStartAngle;
+	*endAngle = *endAngle + delta;
+}
+
+
+static float adjustEndAngle(float startAngle, float endAngle, bool anticlockwise)
+{
+	float newEndAngle = endAngle;
+	if (!anticlockwise && endAngle - startAngle >= twoPiFloat)
+		newEndAngle = startAngle + twoPiFloat;
+	else if (anticlockwise && startAngle - endAngle >= twoPiFloat)
+		newEndAngle = startAngle - twoPiFloat;
+	else if (!anticlockwise && startAngle > endAngle)
+		newEndAngle = startAngle + (twoPiFloat - fmodf(startAngle - endAngle, twoPiFloat));
+	else if (anticlockwise && startAngle < endAngle)
+		newEndAngle = startAngle - (twoPiFloat - fmodf(endAngle - startAngle, twoPiFloat));
+
+	return newEndAngle;
+}
+
+SkPoint CanvasPathMethods::mapPoint(float x, float y)
+{
+	SkPoint p = SkPoint::Make(x, y);
+	if (const SkMatrix* transform = pathTransform())
+	{
+		transform->mapPoints(&p, 1);
+	}
+	return p;
+}
+
+SkPoint CanvasPathMethods::userCurrentPoint()
+{
+	SkPoint p = currentPoint();
+	if (const SkMatrix* inverse = inversePathTransform())
+	{
+		inverse->mapPoints(&p, 1);
+	}
+	return p;
+}
+
+// Appends |segment|, built in user space, through pathTransform(). A leading
+// moveTo is dropped when m_path already has a current point, so the segment
+// continues the last subpath the same way the SkPath call would have.
+void CanvasPathMethods::appendSegment(const SkPath& segment)
+{
+	const SkMatrix& transform = *pathTransform();
+	SkPath::RawIter iter(segment);
+	SkPoint pts[4];
+	SkPath::Verb verb;
+	bool first = true;
+	while ((verb = iter.next(pts)) != SkPath::kDone_Verb)
+	{
+		switch (verb)
+		{
+		case SkPath::kMove_Verb:
+			if (!first || !hasCurrentPoint())
+			{
+				transform.mapPoints(pts, 1);
+				m_path.moveTo(pts[0]);
+			}
+			break;
+		case SkPath::kLine_Verb:
+			transform.mapPoints(&pts[1], 1);
+			m_path.lineTo(pts[1]);
+			break;
+		case SkPath::kQuad_Verb:
+			transform.mapPoints(&pts[1], 2);
+			m_path.quadTo(pts[1], pts[2]);
+			break;
+		case SkPath::kConic_Verb:
+			transform.mapPoints(&pts[1], 2);
+			m_path.conicTo(pts[1], pts[2], iter.conicWeight());
+			break;
+		case SkPath::kCubic_Verb:
+			transform.mapPoints(&pts[1], 3);
+			m_path.cubicTo(pts[1], pts[2], pts[3]);
+			break;
+		case SkPath::kClose_Verb:
+			m_path.close();
+			break;
+		default:
+			break;
+		}
+		first = false;
+	}
+}
+
+void CanvasPathMethods::closePath()
+{
+	if ( m_path.isEmpty() )
+	{
+		return;
+	}
+	m_path.close();
+}
+
+void CanvasPathMethods::moveTo(float x, float y)
+{
+	if (!std::isfinite(x) || !std::isfinite(y))
+		return;
+	if (!isTransformInvertible())
+		return;
+	m_path.moveTo(mapPoint(x, y));
+}
+
+void CanvasPathMethods::lineTo(float x, float y)
+{
+	if (!std::isfinite(x) || !std::isfinite(y))
+		return;
+	if (!isTransformInvertible())
+		return;
+	SkPoint p1 = mapPoint(x, y);
+	if (! hasCurrentPoint())
+	{
+		m_path.moveTo(p1);
+	}
+	else if (p1 != currentPoint())
+	{
+		m_path.lineTo(p1);
+	}
+
+
+}
+
+void CanvasPathMethods::quadraticCurveTo(float cpx, float cpy, float x, float y)
+{
+	if (!std::isfinite(cpx) || !std::isfinite(cpy) || !std::isfinite(x) || !std::isfinite(y))
+		return;
+	if (!isTransformInvertible())
+		return;
+	SkPoint p1 = mapPoint(x, y);
+	SkPoint cp = mapPoint(cpx, cpy);
+	if ( !hasCurrentPoint() )
+	{
+		m_path.moveTo(cp);
+	}
+	if ( p1 != currentPoint()  || p1 != cp )
+	{
+		m_path.quadTo(cp, p1);
+	}
+}
+void CanvasPathMethods::bezierCurveTo(float cp1x, float cp1y, float cp2x, float cp2y, float x, float y)
+{
+	if (!std::isfinite(cp1x) || !std::isfinite(cp1y) || !std::isfinite(cp2x) || !std::isfinite(cp2y) || !std::isfinite(x) || !std::isfinite(y))
+		return;
+	if (!isTransformInvertible())
+		return;
+	SkPoint p1 = mapPoint(x, y);
+	SkPoint cp1 = mapPoint(cp1x, cp1y);
+	SkPoint cp2 = mapPoint(cp2x, cp2y);
+	if ( ! hasCurrentPoint() )
+	{
+		m_path.moveTo(cp1);
+	}
+	if ( p1 != currentPoint() || p1 != cp1 || p1 != cp2 )
+	{
+		m_path.cubicTo(cp1, cp2, p1);
+	}
+	return;
+}
+
+void CanvasPathMethods::arcTo(float x1, float y1, float x2, float y2, float radius)
+{
+	if (!std::isfinite(x1) || !std::isfinite(y1) || !std::isfinite(x2) || !std::isfinite(y2) || !std::isfinite(radius))
+		return;
+
+	if (radius< 0) {
+		return;
+	}
+
+	if (!isTransformInvertible())
+		return;
+
+	SkPoint p1 = mapPoint(x1, y1);
+	SkPoint p2 = mapPoint(x2, y2);
+	if ( ! hasCurrentPoint() )
+	{
+		m_path.moveTo(p1);
+	}
+	else if (p1 == currentPoint() || p1 == p2 || !radius)
+	{
+		lineTo(x1, y1);
+	}
+	else if (!pathTransform())
+	{
+		m_path.arcTo(x1, y1, x2, y2, radius);
+	}
+	else
+	{
+		// The tangent arc has to be worked out in user space.
+		SkPath segment;
+		segment.moveTo(userCurrentPoint());
+		segment.arcTo(x1, y1, x2, y2, radius);
+		appendSegment(segment);
+	}
+}
+
+void CanvasPathMethods::arc(float x, float y, float radius, float startAngle, float endAngle, bool anticlockwise)
+{
+	if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(radius) || !std::isfinite(startAngle) || !std::isfinite(endAngle))
+		return;
+
+	if (radius < 0) {
+		return;
+	}
+
+	if (!isTransformInvertible())
+		return;
+
+	if (!radius || startAngle == endAngle) {
+		// The arc is empty but we still need to draw the connecting line.
+		lineTo(x + radius * cosf(startAngle), y + radius * sinf(startAngle));
+		return;
+	}
+
+	canonicalizeAngle(&startAngle, &endAngle);
+	float adjustedEndAngle = adjustEndAngle(startAngle, endAngle, anticlockwise);
+	addEllipse(FloatPoint(x, y), radius, radius, startAngle, adjustedEndAngle, anticlockwise);
+
+}
+
+void CanvasPathMethods::ellipse(float x, float y, float radiusX, float radiusY, float rotation, float startAngle, float endAngle, bool anticlockwise)
+{
+
+}
+
+void CanvasPathMethods::rect(float x, float y, float width, float height)
+{
+	if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(width) || !std::isfinite(height))
+		return;
+	if (!isTransformInvertible())
+		return;
+	const SkMatrix* transform = pathTransform();
+	if (!transform)
+	{
+		if ( !width && !height )
+		{
+			m_path.moveTo(x, y);
+		}
+		m_path.addRect(x, y, x + width, y + height);
+		return;
+	}
+	SkPoint quad[4];
+	quad[0].set(x, y);
+	quad[1].set(x + width, y);
+	quad[2].set(x + width, y + height);
+	quad[3].set(x, y + height);
+	transform->mapPoints(quad, 4);
+	m_path.addPoly(quad, 4, true);
+}
+
+
+void CanvasPathMethods::addEllipse(const FloatPoint& p, float radiusX, float radiusY, float startAngle, float endAngle, bool anticlockwise)
+{
+	SkScalar cx = (p.x());
+	SkScalar cy = (p.y());
+	SkScalar radiusXScalar = (radiusX);
+	SkScalar radiusYScalar = (radiusY);
+
+	SkRect oval;
+	oval.set(cx - radiusXScalar, cy - radiusYScalar, cx + radiusXScalar, cy + radiusYScalar);
+
+	float sweep = endAngle - startAngle;
+	SkScalar startDegrees = (startAngle * 180 / piFloat);
+	SkScalar sweepDegrees = (sweep * 180 / piFloat);
+	SkScalar s360 = SkIntToScalar(360);
+
+	// We can't use SkPath::addOval(), because addOval() makes new sub-path. addOval() calls moveTo() and close() internally.
+
+	// With a path transform the arc is built in user space and mapped, since
+	// the oval may not stay axis aligned. The leading moveTo makes arcTo()
+	// connect to the current point as it would on m_path.
+	const SkMatrix* transform = pathTransform();
+	SkPath segment;
+	if (transform && hasCurrentPoint())
+	{
+		segment.moveTo(userCurrentPoint());
+	}
+	SkPath& path = transform ? segment : m_path;
+
+	// Use s180, not s360, because SkPath::arcTo(oval, angle, s360, false) draws nothing.
+	SkScalar s180 = SkIntToScalar(180);
+	if (SkScalarNearlyEqual(sweepDegrees, s360)) {
+		// SkPath::arcTo can't handle the sweepAngle that is equal to or greater than 2Pi.
+		path.arcTo(oval, startDegrees, s180, false);
+		path.arcTo(oval, startDegrees + s180, s180, false);
+	} else if (SkScalarNearlyEqual(sweepDegrees, -s360)) {
+		path.arcTo(oval, startDegrees, -s180, false);
+		path.arcTo(oval, startDegrees - s180, -s180, false);
+	} else {
+		path.arcTo(oval, startDegrees, sweepDegrees, false);
+	}
+
+	if (transform)
+	{
+		appendSegment(segment);
+	}
+}
+
+bool CanvasPathMethods::hasCurrentPoint() const
+{
+	return m_path.getPoints(0, 0);
+}
+
+SkPoint CanvasPathMethods::currentPoint() const
+{
+	if ( m_path.countPoints() > 0 )
+	{
+		SkPoint skResult;
+		m_path.getLastPt(&skResult);
+		return skResult;
+	}
+	float quietNan = std::numeric_limits<float>::quiet_NaN();
+	return SkPoint::Make(quietNan, quietNan);
+}
+
+} // namespace Canvas2D
@@ -0,0 +1,52 @@
+#ifndef CanvasPathMethods_h
+#define CanvasPathMethods_h
+
+#include "SkMatrix.h"
+#include "SkPath.h"
+#include "FloatPoint.h"
+
+namespace Canvas2D
+{
+
+// The path building half of the canvas API, shared by CanvasContext2D (its
+// current default path) and CanvasPath (retained path objects).
+class CanvasPathMethods
+{
+public:
+	virtual ~CanvasPathMethods() { }
+
+	void closePath();
+	void moveTo(float x, float y);
+	void lineTo(float x, float y);
+	void quadraticCurveTo(float cpx, float cpy, float x, float y);
+	void bezierCurveTo(float cp1x, float cp1y, float cp2x, float cp2y, float x, float y);
+	void arcTo(float x1, float y1, float x2, float y2, float radius);
+	void arc(float x, float y, float radius, float startAngle, float endAngle, bool anticlockwise);
+	void ellipse(float x, float y, float radiusX, float radiusY, float rotation, float startAngle, float endAngle, bool anticlockwise);
+	void rect(float x, float y, float width, float height);
+
+	virtual bool isTransformInvertible() const { return true; }
+
+protected:
+	CanvasPathMethods() { }
+
+	// Maps user space coordinates into the space m_path is stored in, and
+	// back. NULL means the two are the same. CanvasContext2D keeps its path
+	// in device space so that changing the transform never has to touch the
+	// points already added.
+	virtual const SkMatrix* pathTransform() { return NULL; }
+	virtual const SkMatrix* inversePathTransform() { return NULL; }
+
+	void addEllipse(const FloatPoint&, float radiusX, float radiusY, float startAngle, float endAngle, bool anticlockwise);
+	bool hasCurrentPoint() const;
+	SkPoint currentPoint() const;
+	SkPoint mapPoint(float x, float y);
+	SkPoint userCurrentPoint();
+	void appendSegment(const SkPath&);
+
+	SkPath m_path;
+};
+
+} // namespace Canvas2D
+
+#endif // CanvasPathMethods_h
@@ -0,0 +1,400 @@
+#include "CanvasSession.h"
+#include "CanvasContext2D.h"
+#include "SkData.h"
+#include "SkOSFile.h"
+#include "SkPath.h"
+#include "SkStream.h"
+#include <string.h>
+
+namespace Canvas2D {
+
+static const char kMagic[8] = { 'C', 'N', 'V', 'S', 'S', 'E', 'S', 'S' };
+static const size_t kHeaderSize = sizeof(kMagic) + 3 * sizeof(uint32_t);
+
+CanvasSessionRecorder::CanvasSessionRecorder(SkWStream* stream, int width, int height)
+	: m_stream(stream)
+	, m_frames(0)
+	, m_frameHasCommands(false)
+	, m_synced(false)
+{
+	m_stream->write(kMagic, sizeof(kMagic));
+	m_stream->write32(kVersion);
+	m_stream->write32(width);
+	m_stream->write32(height);
+}
+
+CanvasSessionRecorder::~CanvasSessionRecorder()
+{
+	if (m_frameHasCommands)
+	{
+		endFrame();
+	}
+	m_stream->flush();
+	delete m_stream;
+}
+
+CanvasSessionRecorder* CanvasSessionRecorder::create(const char* path, int width, int height)
+{
+	SkFILEWStream* stream = new SkFILEWStream(path);
+	if (!stream->isValid())
+	{
+		delete stream;
+		return 0;
+	}
+	return new CanvasSessionRecorder(stream, width, height);
+}
+
+void CanvasSessionRecorder::recordCommands(CanvasCommandObjectTable& objects, const uint8_t* data, size_t length)
+{
+	syncObjects(objects);
+	writeRecord(CanvasSessionCommands, data, length);
+	m_frameHasCommands = true;
+}
+
+void CanvasSessionRecorder::endFrame()
+{
+	writeRecord(CanvasSessionEndFrame, 0, 0);
+	m_frames++;
+	m_frameHasCommands = false;
+}
+
+void CanvasSessionRecorder::writeRecord(CanvasSessionTag tag, const uint8_t* payload, size_t length)
+{
+	m_stream->write8(tag);
+	m_stream->write32(static_cast<uint32_t>(length));
+	if (length)
+	{
+		m_stream->write(payload, length);
+	}
+}
+
+void CanvasSessionRecorder::writePath(const SkPath& path)
+{
+	m_payload.writeUInt(path.getFillType());
+	m_payload.writeUInt(path.countVerbs());
+	SkPath::RawIter iter(path);
+	SkPoint pts[4];
+	SkPath::Verb verb;
+	while ((verb = iter.next(pts)) != SkPath::kDone_Verb)
+	{
+		m_payload.writeUInt(verb);
+		// pts[0] is the start of every segment but a move.
+		int first = verb == SkPath::kMove_Verb ? 0 : 1;
+		int last = first;
+		switch (verb)
+		{
+		case SkPath::kQuad_Verb:
+		case SkPath::kConic_Verb:
+			last = 2;
+			break;
+		case SkPath::kCubic_Verb:
+			last = 3;
+			break;
+		case SkPath::kClose_Verb:
+			last = 0;
+			break;
+		default:
+			break;
+		}
+		for (int i = first; i <= last && verb != SkPath::kClose_Verb; i++)
+		{
+			m_payload.writeFloat(pts[i].fX);
+			m_payload.writeFloat(pts[i].fY);
+		}
+		if (verb == SkPath::kConic_Verb)
+		{
+			m_payload.writeFloat(iter.conicWeight());
+		}
+	}
+}
+
+void CanvasSessionRecorder::syncObjects(CanvasCommandObjectTable& objects)
+{
+	objects.takeDirtyHandles(m_dirtyHandles);
+	if (!m_synced)
+	{
+		// Recording started with objects already in the table; write them all.
+		m_synced = true;
+		for (uint32_t handle = 1; handle < objects.handleLimit(); handle++)
+		{
+			writeObject(objects, handle, false);
+		}
+		return;
+	}
+	for (size_t i = 0; i < m_dirtyHandles.size(); i++)
+	{
+		writeObject(objects, m_dirtyHandles[i], true);
+	}
+}
+
+void CanvasSessionRecorder::writeObject(const CanvasCommandObjectTable& objects, uint32_t handle, bool release)
+{
+	m_payload.reset();
+	m_payload.writeUInt(handle);
+	if (BitmapImage* image = objects.image(handle))
+	{
+		m_payload.writeString(image->currentSrc());
+		writeRecord(CanvasSessionImage);
+	}
+	else if (CanvasStyle* style = objects.style(handle))
+	{
+		if (style->getType() == CanvasStyle::RGBA || style->getType() == CanvasStyle::CMYKA)
+		{
+			m_payload.writeUInt(style->getRgba());
+			writeRecord(CanvasSessionColor);
+		}
+		else
+		{
+			writeRecord(CanvasSessionRelease);
+		}
+	}
+	else if (ImageData* imageData = objects.imageData(handle))
+	{
+		m_payload.writeUInt(imageData->width());
+		m_payload.writeUInt(imageData->height());
+		m_payload.writeString(reinterpret_cast<const char*>(imageData->data()), imageData->length());
+		writeRecord(CanvasSessionImageData);
+	}
+	else if (CanvasPath* path = objects.path(handle))
+	{
+		writePath(path->path());
+		writeRecord(CanvasSessionPath);
+	}
+	else if (release)
+	{
+		writeRecord(CanvasSessionRelease);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+static std::string resolvePath(const std::string& src, const char* resourceDir)
+{
+	if (!resourceDir || !*resourceDir || src.empty() || src[0] == '/' || src[0] == '\\'
+		|| (src.size() > 1 && src[1] == ':'))
+	{
+		return src;
+	}
+	return SkOSPath::SkPathJoin(resourceDir, src.c_str()).c_str();
+}
+
+static bool readPath(CanvasCommandReader& reader, SkPath* path)
+{
+	path->setFillType(static_cast<SkPath::FillType>(reader.readUInt() & 3));
+	uint32_t count = reader.readUInt();
+	float f[6];
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		uint32_t verb = reader.readUInt();
+		int floats = 0;
+		switch (verb)
+		{
+		case SkPath::kMove_Verb:
+		case SkPath::kLine_Verb:
+			floats = 2;
+			break;
+		case SkPath::kQuad_Verb:
+			floats = 4;
+			break;
+		case SkPath::kConic_Verb:
+			floats = 5;
+			break;
+		case SkPath::kCubic_Verb:
+			floats = 6;
+			break;
+		case SkPath::kClose_Verb:
+			break;
+		default:
+			return false;
+		}
+		for (int j = 0; j < floats; j++)
+		{
+			f[j] = reader.readFloat();
+		}
+		switch (verb)
+		{
+		case SkPath::kMove_Verb:
+			path->moveTo(f[0], f[1]);
+			break;
+		case SkPath::kLine_Verb:
+			path->lineTo(f[0], f[1]);
+			break;
+		case SkPath::kQuad_Verb:
+			path->quadTo(f[0], f[1], f[2], f[3]);
+			break;
+		case SkPath::kConic_Verb:
+			path->conicTo(f[0], f[1], f[2], f[3], f[4]);
+			break;
+		case SkPath::kCubic_Verb:
+			path->cubicTo(f[0], f[1], f[2], f[3], f[4], f[5]);
+			break;
+		default:
+			path->close();
+			break;
+		}
+	}
+	return !reader.failed();
+}
+
+CanvasSessionPlayer::CanvasSessionPlayer()
+	: m_data(0)
+	, m_width(0)
+	, m_height(0)
+{
+}
+
+CanvasSessionPlayer::~CanvasSessionPlayer()
+{
+	SkSafeUnref(m_data);
+}
+
+bool CanvasSessionPlayer::load(const char* path, const char* resourceDir)
+{
+	SkSafeUnref(m_data);
+	m_steps.clear();
+	m_frameEnds.clear();
+	m_data = SkData::NewFromFileName(path);
+	if (!m_data || m_data->size() < kHeaderSize || memcmp(m_data->data(), kMagic, sizeof(kMagic)))
+	{
+		return false;
+	}
+
+	CanvasCommandReader header(m_data->bytes() + sizeof(kMagic), kHeaderSize - sizeof(kMagic));
+	uint32_t version = header.readUInt();
+	m_width = header.readUInt();
+	m_height = header.readUInt();
+	if (version > CanvasSessionRecorder::kVersion)
+	{
+		return false;
+	}
+
+	// A record is a one byte tag followed by a length-prefixed payload, the
+	// same layout as an opcode with one string argument.
+	CanvasCommandReader reader(m_data->bytes() + kHeaderSize, m_data->size() - kHeaderSize);
+	while (!reader.atEnd())
+	{
+		uint8_t tag = reader.readOpcode();
+		uint32_t length;
+		const char* payload = reader.readString(length);
+		if (reader.failed() || !readStep(tag, reinterpret_cast<const uint8_t*>(payload), length, resourceDir))
+		{
+			return false;
+		}
+	}
+	// Keep the frame a recording that stopped mid-frame was cut off in.
+	if (m_steps.size() > (m_frameEnds.empty() ? 0 : m_frameEnds.back()))
+	{
+		m_frameEnds.push_back(m_steps.size());
+	}
+	return true;
+}
+
+bool CanvasSessionPlayer::readStep(uint8_t tag, const uint8_t* payload, size_t length, const char* resourceDir)
+{
+	if (tag == CanvasSessionEndFrame)
+	{
+		m_frameEnds.push_back(m_steps.size());
+		return true;
+	}
+
+	CanvasCommandReader reader(payload, length);
+	Step step;
+	step.m_tag = tag;
+	switch (tag)
+	{
+	case CanvasSessionCommands:
+		step.m_commands = payload;
+		step.m_length = length;
+		break;
+	case CanvasSessionImage:
+		{
+			step.m_handle = reader.readUInt();
+			std::string src;
+			reader.readString(src);
+			step.m_image = BitmapImage::create();
+			step.m_image->src(resolvePath(src, resourceDir));
+		}
+		break;
+	case CanvasSessionColor:
+		step.m_handle = reader.readUInt();
+		step.m_style = CanvasStyle::createFromRGBA(reader.readUInt());
+		break;
+	case CanvasSessionImageData:
+		{
+			step.m_handle = reader.readUInt();
+			uint32_t width = reader.readUInt();
+			uint32_t height = reader.readUInt();
+			uint32_t pixelLength;
+			const char* pixels = reader.readString(pixelLength);
+			if (reader.failed() || !width || !height || static_cast<uint64_t>(width) * height * 4 != pixelLength)
+			{
+				return false;
+			}
+			step.m_imageData = ImageData::create(width, height);
+			memcpy(step.m_imageData->data(), pixels, pixelLength);
+		}
+		break;
+	case CanvasSessionPath:
+		{
+			step.m_handle = reader.readUInt();
+			SkPath path;
+			if (!readPath(reader, &path))
+			{
+				return false;
+			}
+			step.m_path = CanvasPath::create(path);
+		}
+		break;
+	case CanvasSessionRelease:
+		step.m_handle = reader.readUInt();
+		break;
+	default:
+		// Written by a newer recorder; skip it.
+		return true;
+	}
+	if (reader.failed())
+	{
+		return false;
+	}
+	m_steps.push_back(step);
+	return true;
+}
+
+bool CanvasSessionPlayer::playFrame(int index, CanvasContext2D* context) const
+{
+	if (index < 0 || index >= frameCount())
+	{
+		return false;
+	}
+	CanvasCommandObjectTable& objects = context->commandObjects();
+	bool succeeded = true;
+	for (size_t i = index ? m_frameEnds[index - 1] : 0; i < m_frameEnds[index]; i++)
+	{
+		const Step& step = m_steps[i];
+		switch (step.m_tag)
+		{
+		case CanvasSessionCommands:
+			succeeded = context->executeCommands(step.m_commands, step.m_length) && succeeded;
+			break;
+		case CanvasSessionImage:
+			objects.set(step.m_handle, step.m_image);
+			break;
+		case CanvasSessionColor:
+			objects.set(step.m_handle, step.m_style);
+			break;
+		case CanvasSessionImageData:
+			objects.set(step.m_handle, step.m_imageData);
+			break;
+		case CanvasSessionPath:
+			objects.set(step.m_handle, step.m_path);
+			break;
+		case CanvasSessionRelease:
+			objects.remove(step.m_handle);
+			break;
+		}
+	}
+	context->flush();
+	return succeeded;
+}
+
+} // namespace Canvas2D
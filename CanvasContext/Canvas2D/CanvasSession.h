@@ -0,0 +1,134 @@
+#ifndef CanvasSession_h
+#define CanvasSession_h
+
+#include "CanvasCommandBuffer.h"
+#include "Noncopyable.h"
+#include "RefPtr.h"
+#include "vector"
+#include <stddef.h>
+#include <stdint.h>
+
+class CanvasContext2D;
+class SkData;
+class SkPath;
+class SkWStream;
+
+namespace Canvas2D
+{
+
+// A session file holds the command buffers a game ran through
+// CanvasContext2D::executeCommands(), split into frames, and the objects they
+// refer to, so the frames can be replayed without the game (see
+// skia/tools/bench_canvas_replay.cpp).
+//
+// The file starts with the 8 bytes "CNVSSESS" and then u version, u width and
+// u height. The rest is records of a one byte tag, a u byte length and that
+// many bytes of payload. Values are encoded as in CanvasCommandBuffer.h. As
+// with opcodes, tags are never renumbered, and readers skip tags they do not
+// know, so new records can be added without bumping the version.
+//
+// An object record is written before the first command buffer that may use
+// its handle, and again whenever the handle is marked dirty in the context's
+// CanvasCommandObjectTable. Objects changed in place are only written again
+// if whoever changed them called markDirty(). Gradient and pattern styles are
+// not recorded; their handles replay as null.
+//
+// Only command buffers are recorded. Drawing done by calling CanvasContext2D
+// directly, such as fillRect() or drawImage() from native code, is not in the
+// session, so a game that mixes the two replays only its buffered part.
+enum CanvasSessionTag
+{
+	CanvasSessionCommands = 1,   // command buffer bytes
+	CanvasSessionEndFrame = 2,   //
+	CanvasSessionImage = 3,      // u handle, s src
+	CanvasSessionColor = 4,      // u handle, u RGBA32
+	CanvasSessionImageData = 5,  // u handle, u width, u height, s RGBA pixels
+	CanvasSessionPath = 6,       // u handle, u fill type, u verb count, then per verb u SkPath::Verb, f * points
+	CanvasSessionRelease = 7     // u handle
+};
+
+class CanvasSessionRecorder
+{
+	WTF_MAKE_NONCOPYABLE(CanvasSessionRecorder);
+public:
+	enum { kVersion = 1 };
+
+	// Takes ownership of |stream|.
+	CanvasSessionRecorder(SkWStream*, int width, int height);
+	// Ends the last frame if it has commands.
+	~CanvasSessionRecorder();
+	// Returns null if |path| cannot be written.
+	static CanvasSessionRecorder* create(const char* path, int width, int height);
+
+	// Called by CanvasContext2D::executeCommands().
+	void recordCommands(CanvasCommandObjectTable&, const uint8_t* data, size_t length);
+	void endFrame();
+	unsigned frameCount() const { return m_frames; }
+
+private:
+	void syncObjects(CanvasCommandObjectTable&);
+	// Writes the object behind |handle|, or releases the handle if |release|
+	// and it is empty.
+	void writeObject(const CanvasCommandObjectTable&, uint32_t handle, bool release);
+	void writePath(const SkPath&);
+	void writeRecord(CanvasSessionTag, const uint8_t* payload, size_t length);
+	void writeRecord(CanvasSessionTag tag) { writeRecord(tag, m_payload.data(), m_payload.size()); }
+
+	SkWStream* m_stream;
+	CanvasCommandWriter m_payload;
+	std::vector<uint32_t> m_dirtyHandles;
+	unsigned m_frames;
+	bool m_frameHasCommands;
+	// Until the first buffer, the objects already in the table are unknown.
+	bool m_synced;
+};
+
+class CanvasSessionPlayer
+{
+	WTF_MAKE_NONCOPYABLE(CanvasSessionPlayer);
+public:
+	CanvasSessionPlayer();
+	~CanvasSessionPlayer();
+
+	// Reads the file and creates its objects. Images are loaded as
+	// BitmapImage::src does, so they decode on first draw. Relative image
+	// paths are resolved against |resourceDir| if given.
+	bool load(const char* path, const char* resourceDir = 0);
+
+	int width() const { return m_width; }
+	int height() const { return m_height; }
+	int frameCount() const { return static_cast<int>(m_frameEnds.size()); }
+
+	// Puts frame |index|'s objects into the context's command object table
+	// and runs its command buffers. To play the session again from frame 0,
+	// reset() the context and clear its table first. Returns false if a
+	// buffer was malformed.
+	bool playFrame(int index, CanvasContext2D*) const;
+
+private:
+	struct Step
+	{
+		Step() : m_tag(0), m_handle(0), m_commands(0), m_length(0) { }
+		uint8_t m_tag;
+		uint32_t m_handle;
+		const uint8_t* m_commands;
+		size_t m_length;
+		RefPtr<BitmapImage> m_image;
+		RefPtr<CanvasStyle> m_style;
+		RefPtr<ImageData> m_imageData;
+		RefPtr<CanvasPath> m_path;
+	};
+
+	bool readStep(uint8_t tag, const uint8_t* payload, size_t length, const char* resourceDir);
+
+	SkData* m_data;
+	int m_width;
+	int m_height;
+	std::vector<Step> m_steps;
+	// Index into m_steps one past each frame's last step.
+	std::vector<size_t> m_frameEnds;
+};
+
+} // namespace Canvas2D
+
+#endif // CanvasSession_h
@@ -0,0 +1,106 @@
+#include "CanvasSpriteBatch.h"
+#include "SkCanvas.h"
+#include "SkShader.h"
+
+namespace Canvas2D {
+
+CanvasSpriteBatch::CanvasSpriteBatch()
+{
+}
+
+CanvasSpriteBatch::~CanvasSpriteBatch()
+{
+}
+
+// Whether |quad| copies |src| texel for texel: an untransformed rect at whole
+// pixel offsets, so every pixel center samples a texel center.
+static bool isPixelAligned(const SkPoint quad[4], const SkRect& src)
+{
+	return SkScalarIsInt(quad[0].fX) && SkScalarIsInt(quad[0].fY)
+		&& SkScalarIsInt(src.fLeft) && SkScalarIsInt(src.fTop)
+		&& quad[1] == SkPoint::Make(quad[0].fX + src.width(), quad[0].fY)
+		&& quad[3] == SkPoint::Make(quad[0].fX, quad[0].fY + src.height());
+}
+
+bool CanvasSpriteBatch::canAppend(const SkBitmap& bitmap, const SkPaint& paint) const
+{
+	if (isEmpty())
+	{
+		return true;
+	}
+	return bitmap.pixelRef() == m_bitmap.pixelRef()
+		&& bitmap.pixelRefOrigin() == m_bitmap.pixelRefOrigin()
+		&& bitmap.width() == m_bitmap.width()
+		&& bitmap.height() == m_bitmap.height()
+		&& paint.getAlpha() == m_paint.getAlpha()
+		&& paint.getXfermode() == m_paint.getXfermode()
+		&& paint.getFilterLevel() == m_paint.getFilterLevel();
+}
+
+void CanvasSpriteBatch::append(const SkBitmap& bitmap, const SkPaint& paint, const SkPoint quad[4], const SkRect& src)
+{
+	if (isEmpty())
+	{
+		m_bitmap = bitmap;
+		m_paint = paint;
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		m_positions.push_back(quad[i]);
+	}
+	// The shader covers the whole bitmap, so a filtered sample near the edge
+	// of |src| would blend in the neighbouring sprite of an atlas. Keeping the
+	// coordinates half a texel inside |src| stops that; a pixel aligned copy
+	// only samples texel centers and needs no inset.
+	SkRect texRect = src;
+	if (paint.getFilterLevel() != SkPaint::kNone_FilterLevel && !isPixelAligned(quad, src))
+	{
+		texRect.inset(SkMinScalar(SK_ScalarHalf, src.width() / 2), SkMinScalar(SK_ScalarHalf, src.height() / 2));
+	}
+	m_texCoords.push_back(SkPoint::Make(texRect.fLeft, texRect.fTop));
+	m_texCoords.push_back(SkPoint::Make(texRect.fRight, texRect.fTop));
+	m_texCoords.push_back(SkPoint::Make(texRect.fRight, texRect.fBottom));
+	m_texCoords.push_back(SkPoint::Make(texRect.fLeft, texRect.fBottom));
+	m_stats.m_sprites++;
+}
+
+void CanvasSpriteBatch::flush(SkCanvas* canvas)
+{
+	if (isEmpty())
+	{
+		return;
+	}
+
+	int vertexCount = static_cast<int>(m_positions.size());
+	int indexCount = vertexCount / 4 * 6;
+	for (int quad = static_cast<int>(m_indices.size()) / 6; quad < vertexCount / 4; quad++)
+	{
+		uint16_t base = static_cast<uint16_t>(quad * 4);
+		m_indices.push_back(base);
+		m_indices.push_back(base + 1);
+		m_indices.push_back(base + 2);
+		m_indices.push_back(base);
+		m_indices.push_back(base + 2);
+		m_indices.push_back(base + 3);
+	}
+
+	// The texture coordinates are in bitmap pixels, which is the bitmap
+	// shader's local space.
+	SkPaint paint(m_paint);
+	SkShader* shader = SkShader::CreateBitmapShader(m_bitmap, SkShader::kClamp_TileMode, SkShader::kClamp_TileMode);
+	paint.setShader(shader)->unref();
+
+	canvas->save();
+	canvas->resetMatrix();
+	canvas->drawVertices(SkCanvas::kTriangles_VertexMode, vertexCount, &m_positions[0], &m_texCoords[0],
+		NULL, NULL, &m_indices[0], indexCount, paint);
+	canvas->restore();
+	m_stats.m_draws++;
+
+	m_positions.clear();
+	m_texCoords.clear();
+	m_bitmap.reset();
+	m_paint.reset();
+}
+
+} // namespace Canvas2D
@@ -0,0 +1,68 @@
+#ifndef CanvasSpriteBatch_h
+#define CanvasSpriteBatch_h
+
+#include "Noncopyable.h"
+#include "SkBitmap.h"
+#include "SkPaint.h"
+#include "SkRect.h"
+#include "vector"
+#include <stdint.h>
+
+class SkCanvas;
+
+namespace Canvas2D
+{
+
+// Collects consecutive drawImage calls that sample the same bitmap with the
+// same paint and draws them as one indexed triangle list, so a frame of
+// sprites from one atlas costs a single drawVertices instead of one
+// drawBitmapRectToRect per sprite. Quads are stored in device space, which
+// lets sprites drawn under different transforms share a batch.
+//
+// Triangles get no edge antialiasing, so callers should only batch quads
+// whose edges stay axis aligned.
+class CanvasSpriteBatch
+{
+	WTF_MAKE_NONCOPYABLE(CanvasSpriteBatch);
+public:
+	// Keeps vertex indices within uint16_t.
+	enum { kMaxSprites = 4096 };
+
+	struct Stats
+	{
+		Stats() : m_sprites(0), m_draws(0) { }
+		unsigned m_sprites;
+		unsigned m_draws;
+	};
+
+	CanvasSpriteBatch();
+	~CanvasSpriteBatch();
+
+	bool isEmpty() const { return m_positions.empty(); }
+	bool isFull() const { return m_positions.size() >= kMaxSprites * 4; }
+
+	// Whether a sprite from |bitmap| drawn with |paint| may join the sprites
+	// already queued. Always true for an empty batch.
+	bool canAppend(const SkBitmap& bitmap, const SkPaint& paint) const;
+	// |quad| is the destination in device space, clockwise from the top left
+	// corner; |src| is in bitmap pixels. Filtered sprites sample from |src|
+	// inset by half a texel unless they are drawn pixel aligned.
+	void append(const SkBitmap&, const SkPaint&, const SkPoint quad[4], const SkRect& src);
+	void flush(SkCanvas*);
+
+	const Stats& stats() const { return m_stats; }
+	void resetStats() { m_stats = Stats(); }
+
+private:
+	SkBitmap m_bitmap;
+	SkPaint m_paint;
+	std::vector<SkPoint> m_positions;
+	std::vector<SkPoint> m_texCoords;
+	// Grows to the largest batch seen; the pattern never changes.
+	std::vector<uint16_t> m_indices;
+	Stats m_stats;
+};
+
+} // namespace Canvas2D
+
+#endif // CanvasSpriteBatch_h
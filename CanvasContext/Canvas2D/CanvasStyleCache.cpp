@@ -0,0 +1,79 @@
+#include "CanvasStyleCache.h"
+#include "graphicstypes.h"
+#include <string.h>
+
+namespace Canvas2D {
+
+CanvasStyleCache::CanvasStyleCache()
+	: m_clock(0)
+{
+}
+
+CanvasStyleCache::~CanvasStyleCache()
+{
+}
+
+CanvasStyle* CanvasStyleCache::get(const char* color, size_t length)
+{
+	if (length > kMaxKeyLength)
+	{
+		m_stats.m_misses++;
+		m_uncached = CanvasStyle::createFromString(std::string(color, length));
+		return m_uncached.get();
+	}
+
+	unsigned hash = canvasHash(color, length);
+	Entry* set = &m_entries[(hash % kSetCount) * kWays];
+	Entry* victim = set;
+	for (int i = 0; i < kWays; ++i)
+	{
+		Entry& e = set[i];
+		if (e.m_style && e.m_hash == hash && e.m_key.length() == length && !memcmp(e.m_key.data(), color, length))
+		{
+			m_stats.m_hits++;
+			e.m_lastUse = ++m_clock;
+			return e.m_style.get();
+		}
+		if (!e.m_style)
+		{
+			if (victim->m_style)
+			{
+				victim = &e;
+			}
+		}
+		else if (victim->m_style && e.m_lastUse < victim->m_lastUse)
+		{
+			victim = &e;
+		}
+	}
+
+	m_stats.m_misses++;
+	std::string key(color, length);
+	RefPtr<CanvasStyle> style = CanvasStyle::createFromString(key);
+	if (!style)
+	{
+		// Invalid strings are not cached; scripts rarely repeat them.
+		return 0;
+	}
+	if (victim->m_style)
+	{
+		m_stats.m_evictions++;
+	}
+	victim->m_hash = hash;
+	victim->m_lastUse = ++m_clock;
+	victim->m_key.swap(key);
+	victim->m_style = style.release();
+	return victim->m_style.get();
+}
+
+void CanvasStyleCache::clear()
+{
+	for (int i = 0; i < kSetCount * kWays; ++i)
+	{
+		m_entries[i] = Entry();
+	}
+	m_uncached.clear();
+	m_clock = 0;
+}
+
+} // namespace Canvas2D
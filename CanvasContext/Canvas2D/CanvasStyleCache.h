@@ -0,0 +1,77 @@
+#ifndef CanvasStyleCache_h
+#define CanvasStyleCache_h
+
+#include "Noncopyable.h"
+#include "RefPtr.h"
+#include "CanvasStyle.h"
+#include "string"
+#include <stddef.h>
+
+namespace Canvas2D
+{
+
+// Maps color strings to parsed CanvasStyle objects so that scripts setting
+// the same few colors over and over only parse each one once. The returned
+// styles are shared between callers and must be treated as immutable.
+//
+// The cache is a fixed number of small sets; a color hashes to one set and
+// evicts the least recently used entry of that set when it is full, so memory
+// stays bounded no matter how many distinct strings a script produces.
+class CanvasStyleCache
+{
+	WTF_MAKE_NONCOPYABLE(CanvasStyleCache);
+public:
+	enum
+	{
+		kSetCount = 64,
+		kWays = 4,
+		// Longer strings are parsed every time rather than cached.
+		kMaxKeyLength = 64
+	};
+
+	struct Stats
+	{
+		Stats() : m_hits(0), m_misses(0), m_evictions(0) { }
+		unsigned m_hits;
+		unsigned m_misses;
+		unsigned m_evictions;
+		float hitRate() const
+		{
+			unsigned lookups = m_hits + m_misses;
+			return lookups ? static_cast<float>(m_hits) / lookups : 0;
+		}
+	};
+
+	CanvasStyleCache();
+	~CanvasStyleCache();
+
+	// Returns null if the string is not a valid color.
+	CanvasStyle* get(const char* color, size_t length);
+	CanvasStyle* get(const std::string& color) { return get(color.data(), color.length()); }
+
+	void clear();
+
+	const Stats& stats() const { return m_stats; }
+	void resetStats() { m_stats = Stats(); }
+
+private:
+	struct Entry
+	{
+		Entry() : m_hash(0), m_lastUse(0) { }
+		unsigned m_hash;
+		unsigned m_lastUse;
+		std::string m_key;
+		RefPtr<CanvasStyle> m_style;
+	};
+
+	Entry m_entries[kSetCount * kWays];
+	unsigned m_clock;
+	Stats m_stats;
+	// Holds the result of the last uncacheable lookup so the returned pointer
+	// stays valid until the next call.
+	RefPtr<CanvasStyle> m_uncached;
+};
+
+} // namespace Canvas2D
+
+#endif // CanvasStyleCache_h
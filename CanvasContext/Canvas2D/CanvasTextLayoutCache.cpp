@@ -0,0 +1,124 @@
+#include "CanvasTextLayoutCache.h"
+
+namespace Canvas2D {
+
+bool CanvasTextLayoutCache::Key::operator<(const Key& other) const
+{
+	if (m_font != other.m_font)
+	{
+		return m_font < other.m_font;
+	}
+	if (m_align != other.m_align)
+	{
+		return m_align < other.m_align;
+	}
+	return m_text < other.m_text;
+}
+
+CanvasTextLayoutCache::CanvasTextLayoutCache()
+	: m_budget(kDefaultBudget)
+	, m_bytesUsed(0)
+{
+	m_lookupKey.m_font = 0;
+	m_lookupKey.m_align = 0;
+}
+
+CanvasTextLayoutCache::~CanvasTextLayoutCache()
+{
+}
+
+void CanvasTextLayoutCache::layout(const char* text, size_t length, const CanvasFont& font, TextAlign align, CanvasTextRun& run)
+{
+	SkPaint paint(font.paint());
+	paint.setTextEncoding(SkPaint::kUTF8_TextEncoding);
+	int count = paint.textToGlyphs(text, length, NULL);
+	if (count <= 0)
+	{
+		return;
+	}
+	run.m_glyphs.resize(count);
+	paint.textToGlyphs(text, length, &run.m_glyphs[0]);
+
+	paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+	size_t byteLength = count * sizeof(uint16_t);
+	run.m_xpos.resize(count);
+	paint.getTextWidths(&run.m_glyphs[0], byteLength, &run.m_xpos[0]);
+	run.m_width = paint.measureText(&run.m_glyphs[0], byteLength, &run.m_bounds);
+
+	// Turn advances into positions, shifted for the alignment.
+	SkScalar offset = 0;
+	if (align == CenterTextAlign)
+	{
+		offset = -SkScalarHalf(run.m_width);
+	}
+	else if (align == RightTextAlign)
+	{
+		offset = -run.m_width;
+	}
+	SkScalar x = offset;
+	for (int i = 0; i < count; ++i)
+	{
+		SkScalar advance = run.m_xpos[i];
+		run.m_xpos[i] = x;
+		x += advance;
+	}
+	run.m_bounds.offset(offset, 0);
+}
+
+const CanvasTextRun* CanvasTextLayoutCache::get(const char* text, size_t length, CanvasFont* font, TextAlign align)
+{
+	m_lookupKey.m_text.assign(text, length);
+	m_lookupKey.m_font = font;
+	m_lookupKey.m_align = align;
+
+	EntryMap::iterator it = m_index.find(m_lookupKey);
+	if (it != m_index.end())
+	{
+		m_stats.m_hits++;
+		m_entries.splice(m_entries.begin(), m_entries, it->second);
+		return &it->second->m_run;
+	}
+
+	m_stats.m_misses++;
+	m_entries.push_front(Entry());
+	Entry& entry = m_entries.front();
+	entry.m_key = m_lookupKey;
+	entry.m_font = font;
+	layout(text, length, *font, align, entry.m_run);
+	entry.m_bytes = sizeof(Entry) + length
+		+ entry.m_run.m_glyphs.size() * sizeof(uint16_t)
+		+ entry.m_run.m_xpos.size() * sizeof(SkScalar);
+	m_bytesUsed += entry.m_bytes;
+	m_index[entry.m_key] = m_entries.begin();
+
+	purgeToBudget();
+	return &entry.m_run;
+}
+
+void CanvasTextLayoutCache::purgeToBudget()
+{
+	// Never evict the entry that was just added.
+	while (m_bytesUsed > m_budget && m_entries.size() > 1)
+	{
+		Entry& victim = m_entries.back();
+		m_bytesUsed -= victim.m_bytes;
+		m_index.erase(victim.m_key);
+		m_entries.pop_back();
+		m_stats.m_evictions++;
+	}
+}
+
+void CanvasTextLayoutCache::setBudget(size_t bytes)
+{
+	m_budget = bytes;
+	purgeToBudget();
+}
+
+void CanvasTextLayoutCache::clear()
+{
+	m_index.clear();
+	m_entries.clear();
+	m_bytesUsed = 0;
+}
+
+} // namespace Canvas2D
@@ -0,0 +1,106 @@
+#ifndef CanvasTextLayoutCache_h
+#define CanvasTextLayoutCache_h
+
+#include "Noncopyable.h"
+#include "RefPtr.h"
+#include "CanvasFontCache.h"
+#include "graphicstypes.h"
+#include "SkRect.h"
+#include "list"
+#include "map"
+#include "string"
+#include "vector"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Canvas2D
+{
+
+// A string converted to glyphs and laid out on a single line. Positions are
+// relative to the draw origin with the text alignment already applied, so a
+// run can be drawn with drawPosTextH and a left aligned paint.
+struct CanvasTextRun
+{
+	CanvasTextRun() : m_width(0) { m_bounds.setEmpty(); }
+
+	std::vector<uint16_t> m_glyphs;
+	std::vector<SkScalar> m_xpos;
+	SkScalar m_width;
+	SkRect m_bounds;
+};
+
+// Keeps recently drawn strings shaped, keyed by text, font and alignment, so
+// HUD and score text that repeats every frame skips UTF-8 conversion and
+// measuring. Entries are evicted least recently used first once the cache
+// holds more than its byte budget.
+class CanvasTextLayoutCache
+{
+	WTF_MAKE_NONCOPYABLE(CanvasTextLayoutCache);
+public:
+	enum { kDefaultBudget = 256 * 1024 };
+
+	struct Stats
+	{
+		Stats() : m_hits(0), m_misses(0), m_evictions(0) { }
+		unsigned m_hits;
+		unsigned m_misses;
+		unsigned m_evictions;
+		float hitRate() const
+		{
+			unsigned lookups = m_hits + m_misses;
+			return lookups ? static_cast<float>(m_hits) / lookups : 0;
+		}
+	};
+
+	CanvasTextLayoutCache();
+	~CanvasTextLayoutCache();
+
+	// The returned run stays valid until the next call on the cache.
+	const CanvasTextRun* get(const char* text, size_t length, CanvasFont*, TextAlign);
+
+	void setBudget(size_t bytes);
+	size_t budget() const { return m_budget; }
+	size_t bytesUsed() const { return m_bytesUsed; }
+	size_t count() const { return m_entries.size(); }
+	void clear();
+
+	const Stats& stats() const { return m_stats; }
+	void resetStats() { m_stats = Stats(); }
+
+private:
+	struct Key
+	{
+		std::string m_text;
+		const CanvasFont* m_font;
+		int m_align;
+		bool operator<(const Key&) const;
+	};
+
+	struct Entry
+	{
+		Key m_key;
+		// Keeps the font alive so its address stays a unique key.
+		RefPtr<CanvasFont> m_font;
+		CanvasTextRun m_run;
+		size_t m_bytes;
+	};
+
+	typedef std::list<Entry> EntryList;
+	typedef std::map<Key, EntryList::iterator> EntryMap;
+
+	static void layout(const char* text, size_t length, const CanvasFont&, TextAlign, CanvasTextRun&);
+	void purgeToBudget();
+
+	// Most recently used first.
+	EntryList m_entries;
+	EntryMap m_index;
+	// Reused for lookups so a hit does not allocate.
+	Key m_lookupKey;
+	size_t m_budget;
+	size_t m_bytesUsed;
+	Stats m_stats;
+};
+
+} // namespace Canvas2D
+
+#endif // CanvasTextLayoutCache_h
@@ -0,0 +1,124 @@
+#include "CanvasTileRenderer.h"
+#include "SkCanvas.h"
+#include "SkRecord.h"
+#include "SkRecordDraw.h"
+#include "SkRegion.h"
+
+namespace Canvas2D {
+
+class CanvasTileRenderer::Worker : public SkRunnable
+{
+public:
+	explicit Worker(CanvasTileRenderer* renderer)
+		: m_renderer(renderer)
+		, m_tilesDrawn(0)
+		, m_tilesSkipped(0)
+	{
+	}
+
+	virtual void run()
+	{
+		CanvasTileRenderer* r = m_renderer;
+		SkCanvas canvas(r->m_target);
+		int32_t count = static_cast<int32_t>(r->m_tiles.size());
+		for (;;)
+		{
+			int32_t index = sk_atomic_inc(&r->m_nextTile);
+			if (index >= count)
+			{
+				break;
+			}
+			const SkIRect& tile = r->m_tiles[index];
+			if (r->m_damage && !r->m_damage->intersects(tile))
+			{
+				m_tilesSkipped++;
+				continue;
+			}
+			// The context leaves its saves open at the end of a frame.
+			SkAutoCanvasRestore restore(&canvas, true);
+			canvas.clipRect(SkRect::Make(tile));
+			if (r->m_damage)
+			{
+				canvas.clipRegion(*r->m_damage, SkRegion::kIntersect_Op);
+			}
+			SkRecordDraw(*r->m_record, &canvas);
+			m_tilesDrawn++;
+		}
+		r->m_countdown.run();
+	}
+
+	CanvasTileRenderer* m_renderer;
+	unsigned m_tilesDrawn;
+	unsigned m_tilesSkipped;
+};
+
+CanvasTileRenderer::CanvasTileRenderer(const SkBitmap& target, int threads, int tileWidth, int tileHeight)
+	: m_target(target)
+	, m_threadCount(threads < 0 ? num_cores() : threads)
+	, m_pool(m_threadCount)
+	, m_countdown(0)
+	, m_record(0)
+	, m_damage(0)
+	, m_nextTile(0)
+{
+	tileWidth = SkMax32(tileWidth, 1);
+	tileHeight = SkMax32(tileHeight, 1);
+	for (int y = 0; y < m_target.height(); y += tileHeight)
+	{
+		for (int x = 0; x < m_target.width(); x += tileWidth)
+		{
+			SkIRect tile = SkIRect::MakeXYWH(x, y, tileWidth, tileHeight);
+			tile.intersect(0, 0, m_target.width(), m_target.height());
+			m_tiles.push_back(tile);
+		}
+	}
+	// With no pool threads the single worker runs inside add().
+	int workers = SkMax32(m_threadCount, 1);
+	for (int i = 0; i < workers; i++)
+	{
+		m_workers.push_back(SkNEW_ARGS(Worker, (this)));
+	}
+}
+
+CanvasTileRenderer::~CanvasTileRenderer()
+{
+	m_pool.wait();
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		SkDELETE(m_workers[i]);
+	}
+}
+
+void CanvasTileRenderer::draw(const SkRecord& record, const SkRegion* damage)
+{
+	if (damage && damage->isEmpty())
+	{
+		m_stats.m_frames++;
+		m_stats.m_tilesSkipped += tileCount();
+		return;
+	}
+	SkAutoLockPixels lock(m_target);
+	m_record = &record;
+	m_damage = damage;
+	m_nextTile = 0;
+
+	m_countdown.reset(static_cast<int32_t>(m_workers.size()));
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_pool.add(m_workers[i]);
+	}
+	m_countdown.wait();
+
+	m_stats.m_frames++;
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_stats.m_tilesDrawn += m_workers[i]->m_tilesDrawn;
+		m_stats.m_tilesSkipped += m_workers[i]->m_tilesSkipped;
+		m_workers[i]->m_tilesDrawn = 0;
+		m_workers[i]->m_tilesSkipped = 0;
+	}
+	m_record = 0;
+	m_damage = 0;
+}
+
+} // namespace Canvas2D
@@ -0,0 +1,74 @@
+#ifndef CanvasTileRenderer_h
+#define CanvasTileRenderer_h
+
+#include "Noncopyable.h"
+#include "SkBitmap.h"
+#include "SkCountdown.h"
+#include "SkThreadPool.h"
+#include "vector"
+
+class SkRecord;
+class SkRegion;
+
+namespace Canvas2D
+{
+
+// Raster playback for devices without usable GL. The target bitmap is split
+// into tiles and a recorded frame is played into each one, clipped to the
+// tile, by a fixed set of SkThreadPool workers that take the next undrawn
+// tile until none are left. The record is only read during playback, so all
+// workers share it.
+class CanvasTileRenderer
+{
+	WTF_MAKE_NONCOPYABLE(CanvasTileRenderer);
+public:
+	enum { kDefaultTileSize = 256 };
+
+	struct Stats
+	{
+		Stats() : m_frames(0), m_tilesDrawn(0), m_tilesSkipped(0) { }
+		unsigned m_frames;
+		unsigned m_tilesDrawn;
+		// Tiles outside the damage region passed to draw().
+		unsigned m_tilesSkipped;
+	};
+
+	// |threads| of 0 draws every tile on the caller's thread, and
+	// SkThreadPool::kThreadPerCore starts one worker per core. The bitmap's
+	// pixels are shared, not copied.
+	CanvasTileRenderer(const SkBitmap& target, int threads, int tileWidth = kDefaultTileSize, int tileHeight = kDefaultTileSize);
+	~CanvasTileRenderer();
+
+	const SkBitmap& target() const { return m_target; }
+	int width() const { return m_target.width(); }
+	int height() const { return m_target.height(); }
+	int threadCount() const { return m_threadCount; }
+	int tileCount() const { return static_cast<int>(m_tiles.size()); }
+
+	// Returns once every tile has been drawn. Tiles that miss |damage| are
+	// left untouched.
+	void draw(const SkRecord&, const SkRegion* damage = 0);
+
+	const Stats& stats() const { return m_stats; }
+
+private:
+	class Worker;
+
+	SkBitmap m_target;
+	int m_threadCount;
+	std::vector<SkIRect> m_tiles;
+	std::vector<Worker*> m_workers;
+	SkThreadPool m_pool;
+	SkCountdown m_countdown;
+
+	// Set for the duration of draw().
+	const SkRecord* m_record;
+	const SkRegion* m_damage;
+	int32_t m_nextTile;
+
+	Stats m_stats;
+};
+
+} // namespace Canvas2D
+
+#endif // CanvasTileRenderer_h
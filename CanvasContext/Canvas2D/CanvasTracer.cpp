@@ -0,0 +1,394 @@
+#include "CanvasTracer.h"
+#include "SkStream.h"
+#include "SkString.h"
+#include "SkTraceEvent.h"
+#include <string.h>
+
+#if defined(SK_BUILD_FOR_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+namespace Canvas2D {
+
+static const char kDisabledByDefaultPrefix[] = "disabled-by-default-";
+
+// Sequence numbers count modulo 2^31, which is a multiple of any ring size,
+// so a sequence's slot is the same before and after the wrap.
+static const uint32_t kSequenceMask = 0x7FFFFFFF;
+
+static CanvasTracer* s_installed = 0;
+
+static int64_t nowMicros()
+{
+#if defined(SK_BUILD_FOR_WIN32)
+	static LARGE_INTEGER frequency;
+	if (!frequency.QuadPart)
+	{
+		QueryPerformanceFrequency(&frequency);
+	}
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart * 1000000 / frequency.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+static uint64_t currentThread()
+{
+#if defined(SK_BUILD_FOR_WIN32)
+	return GetCurrentThreadId();
+#else
+	return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(reinterpret_cast<void*>(pthread_self())));
+#endif
+}
+
+static void writeEscaped(SkWStream* stream, const char* text)
+{
+	stream->writeText("\"");
+	for (const char* c = text; c && *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+		{
+			stream->write("\\", 1);
+		}
+		if (static_cast<unsigned char>(*c) >= 0x20)
+		{
+			stream->write(c, 1);
+		}
+	}
+	stream->writeText("\"");
+}
+
+static void writeArg(SkWStream* stream, uint8_t type, uint64_t value)
+{
+	SkString text;
+	switch (type)
+	{
+	case TRACE_VALUE_TYPE_BOOL:
+		text.set(value ? "true" : "false");
+		break;
+	case TRACE_VALUE_TYPE_UINT:
+		text.printf("%llu", static_cast<unsigned long long>(value));
+		break;
+	case TRACE_VALUE_TYPE_INT:
+		text.printf("%lld", static_cast<long long>(value));
+		break;
+	case TRACE_VALUE_TYPE_DOUBLE:
+		{
+			double d;
+			memcpy(&d, &value, sizeof(d));
+			text.printf("%g", d);
+		}
+		break;
+	case TRACE_VALUE_TYPE_POINTER:
+		text.printf("\"0x%llx\"", static_cast<unsigned long long>(value));
+		break;
+	case TRACE_VALUE_TYPE_STRING:
+		writeEscaped(stream, reinterpret_cast<const char*>(static_cast<uintptr_t>(value)));
+		return;
+	default:
+		// Copied strings are not kept, and convertables are not supported.
+		text.set("\"\"");
+		break;
+	}
+	stream->writeText(text.c_str());
+}
+
+CanvasTracer::CanvasTracer(int capacity)
+	: m_next(0)
+	, m_frameStart(0)
+	, m_frames(0)
+	, m_epoch(nowMicros())
+	, m_categoryCount(0)
+	, m_enabled(true)
+	, m_includesDisabledByDefault(false)
+{
+	uint32_t size = 1;
+	while (size < static_cast<uint32_t>(capacity) && size <= kSequenceMask / 2)
+	{
+		size <<= 1;
+	}
+	m_mask = size - 1;
+	m_events = new Event[size];
+	clear();
+}
+
+CanvasTracer::~CanvasTracer()
+{
+	if (s_installed == this)
+	{
+		s_installed = 0;
+	}
+	delete[] m_events;
+}
+
+CanvasTracer* CanvasTracer::install(int capacity)
+{
+	// Trace points keep pointers into the tracer's categories, so it is
+	// never replaced once installed.
+	if (!s_installed)
+	{
+		s_installed = new CanvasTracer(capacity);
+		SkEventTracer::SetInstance(s_installed);
+	}
+	return s_installed;
+}
+
+uint8_t CanvasTracer::enabledFlagFor(const char* name) const
+{
+	if (!m_enabled)
+	{
+		return 0;
+	}
+	if (!m_includesDisabledByDefault && !strncmp(name, kDisabledByDefaultPrefix, sizeof(kDisabledByDefaultPrefix) - 1))
+	{
+		return 0;
+	}
+	return kEnabledForRecording_CategoryGroupEnabledFlags;
+}
+
+void CanvasTracer::setEnabled(bool enabled)
+{
+	SkAutoMutexAcquire lock(m_categoryMutex);
+	m_enabled = enabled;
+	for (int i = 0; i < m_categoryCount; i++)
+	{
+		m_categories[i].m_enabled = enabledFlagFor(m_categories[i].m_name);
+	}
+}
+
+void CanvasTracer::setIncludesDisabledByDefault(bool includes)
+{
+	{
+		SkAutoMutexAcquire lock(m_categoryMutex);
+		m_includesDisabledByDefault = includes;
+	}
+	setEnabled(m_enabled);
+}
+
+const uint8_t* CanvasTracer::getCategoryGroupEnabled(const char* name)
+{
+	static uint8_t disabled = 0;
+	SkAutoMutexAcquire lock(m_categoryMutex);
+	for (int i = 0; i < m_categoryCount; i++)
+	{
+		if (!strcmp(m_categories[i].m_name, name))
+		{
+			return &m_categories[i].m_enabled;
+		}
+	}
+	if (m_categoryCount == kMaxCategories)
+	{
+		return &disabled;
+	}
+	Category& category = m_categories[m_categoryCount++];
+	category.m_name = name;
+	category.m_enabled = enabledFlagFor(name);
+	return &category.m_enabled;
+}
+
+const char* CanvasTracer::categoryName(const uint8_t* categoryEnabledFlag) const
+{
+	for (int i = 0; i < m_categoryCount; i++)
+	{
+		if (&m_categories[i].m_enabled == categoryEnabledFlag)
+		{
+			return m_categories[i].m_name;
+		}
+	}
+	return "unknown";
+}
+
+const char* CanvasTracer::getCategoryGroupName(const uint8_t* categoryEnabledFlag)
+{
+	SkAutoMutexAcquire lock(m_categoryMutex);
+	return categoryName(categoryEnabledFlag);
+}
+
+CanvasTracer::Event* CanvasTracer::append(char phase, const uint8_t* category, const char* name, uint32_t* sequence)
+{
+	// An atomic increment would overflow m_next after 2^31 events, so wrap
+	// it by hand.
+	int32_t next;
+	do
+	{
+		next = m_next;
+	}
+	while (!sk_atomic_cas(&m_next, next, static_cast<int32_t>((next + 1u) & kSequenceMask)));
+	*sequence = static_cast<uint32_t>(next);
+	Event* event = &m_events[*sequence & m_mask];
+	// Mark the slot as being written until the event is complete.
+	event->m_sequence = ~*sequence;
+	event->m_phase = phase;
+	event->m_numArgs = 0;
+	event->m_category = category;
+	event->m_name = name;
+	event->m_thread = currentThread();
+	event->m_timestamp = nowMicros() - m_epoch;
+	event->m_duration = -1;
+	return event;
+}
+
+SkEventTracer::Handle CanvasTracer::addTraceEvent(char phase, const uint8_t* categoryEnabledFlag, const char* name, uint64_t,
+	int32_t numArgs, const char** argNames, const uint8_t* argTypes, const uint64_t* argValues, uint8_t flags)
+{
+	uint32_t sequence;
+	Event* event = append(phase, categoryEnabledFlag, (flags & TRACE_EVENT_FLAG_COPY) ? "(copied name)" : name, &sequence);
+	event->m_numArgs = static_cast<uint8_t>(SkTMin(numArgs, 2));
+	for (int i = 0; i < event->m_numArgs; i++)
+	{
+		event->m_argNames[i] = argNames[i];
+		event->m_argTypes[i] = argTypes[i];
+		event->m_argValues[i] = argValues[i];
+	}
+	event->m_sequence = sequence;
+	return static_cast<SkEventTracer::Handle>(sequence) + 1;
+}
+
+void CanvasTracer::updateTraceEventDuration(const uint8_t*, const char*, SkEventTracer::Handle handle)
+{
+	if (!handle)
+	{
+		return;
+	}
+	uint32_t sequence = static_cast<uint32_t>(handle - 1);
+	Event& event = m_events[sequence & m_mask];
+	// Skip zones the ring has already overwritten.
+	if (event.m_sequence == sequence)
+	{
+		event.m_duration = nowMicros() - m_epoch - event.m_timestamp;
+	}
+}
+
+void CanvasTracer::markFrame()
+{
+	m_frames++;
+	if (!m_enabled)
+	{
+		return;
+	}
+
+	// Count the frame's events by name, then record the counts after them.
+	enum { kMaxNames = 64 };
+	const char* names[kMaxNames];
+	const uint8_t* categories[kMaxNames];
+	unsigned counts[kMaxNames];
+	int nameCount = 0;
+
+	uint32_t end = static_cast<uint32_t>(m_next);
+	uint32_t start = m_frameStart;
+	if (((end - start) & kSequenceMask) > m_mask + 1)
+	{
+		start = (end - (m_mask + 1)) & kSequenceMask;
+	}
+	for (uint32_t sequence = start; sequence != end; sequence = (sequence + 1) & kSequenceMask)
+	{
+		const Event& event = m_events[sequence & m_mask];
+		if (event.m_sequence != sequence || event.m_phase == TRACE_EVENT_PHASE_COUNTER)
+		{
+			continue;
+		}
+		int i = 0;
+		while (i < nameCount && names[i] != event.m_name)
+		{
+			i++;
+		}
+		if (i == nameCount)
+		{
+			if (nameCount == kMaxNames)
+			{
+				continue;
+			}
+			names[i] = event.m_name;
+			categories[i] = event.m_category;
+			counts[i] = 0;
+			nameCount++;
+		}
+		counts[i]++;
+	}
+
+	static const char* countName = "count";
+	static const uint8_t countType = TRACE_VALUE_TYPE_UINT;
+	for (int i = 0; i < nameCount; i++)
+	{
+		uint64_t count = counts[i];
+		addTraceEvent(TRACE_EVENT_PHASE_COUNTER, categories[i], names[i], 0, 1, &countName, &countType, &count, 0);
+	}
+	m_frameStart = static_cast<uint32_t>(m_next);
+}
+
+void CanvasTracer::clear()
+{
+	for (uint32_t i = 0; i <= m_mask; i++)
+	{
+		// No event has this sequence number until the ring has wrapped.
+		m_events[i].m_sequence = ~i;
+	}
+	m_frameStart = static_cast<uint32_t>(m_next);
+	m_frames = 0;
+}
+
+bool CanvasTracer::writeJSON(SkWStream* stream) const
+{
+	SkAutoMutexAcquire lock(m_categoryMutex);
+	uint32_t end = static_cast<uint32_t>(m_next);
+	// Slots not written since clear() never match their sequence, so this
+	// also works before the ring first fills.
+	uint32_t start = (end - m_mask) & kSequenceMask;
+	bool first = true;
+
+	stream->writeText("{\"traceEvents\":[");
+	for (uint32_t sequence = start; sequence != end; sequence = (sequence + 1) & kSequenceMask)
+	{
+		const Event& event = m_events[sequence & m_mask];
+		if (event.m_sequence != sequence)
+		{
+			continue;
+		}
+		SkString text;
+		text.printf("%s\n{\"ph\":\"%c\",\"pid\":1,\"tid\":%llu,\"ts\":%lld,", first ? "" : ",", event.m_phase,
+			static_cast<unsigned long long>(event.m_thread), static_cast<long long>(event.m_timestamp));
+		if (event.m_phase == TRACE_EVENT_PHASE_COMPLETE)
+		{
+			text.appendf("\"dur\":%lld,", static_cast<long long>(SkTMax<int64_t>(event.m_duration, 0)));
+		}
+		if (event.m_phase == TRACE_EVENT_PHASE_INSTANT)
+		{
+			text.append("\"s\":\"t\",");
+		}
+		stream->writeText(text.c_str());
+		stream->writeText("\"cat\":");
+		writeEscaped(stream, categoryName(event.m_category));
+		stream->writeText(",\"name\":");
+		writeEscaped(stream, event.m_name);
+		stream->writeText(",\"args\":{");
+		for (int i = 0; i < event.m_numArgs; i++)
+		{
+			if (i)
+			{
+				stream->writeText(",");
+			}
+			writeEscaped(stream, event.m_argNames[i]);
+			stream->writeText(":");
+			writeArg(stream, event.m_argTypes[i], event.m_argValues[i]);
+		}
+		stream->writeText("}}");
+		first = false;
+	}
+	stream->writeText("\n]}\n");
+	return true;
+}
+
+bool CanvasTracer::writeJSON(const char* path) const
+{
+	SkFILEWStream stream(path);
+	return stream.isValid() && writeJSON(&stream);
+}
+
+} // namespace Canvas2D
@@ -0,0 +1,120 @@
+#ifndef CanvasTracer_h
+#define CanvasTracer_h
+
+#include "Noncopyable.h"
+#include "SkEventTracer.h"
+#include "SkThread.h"
+#include "SkTypes.h"
+#include <stdint.h>
+
+class SkWStream;
+
+namespace Canvas2D
+{
+
+// An SkEventTracer that keeps the last kDefaultCapacity events in a ring and
+// writes them out as Chrome trace JSON (load it in chrome://tracing). The
+// zones come from the TRACE_EVENT macros in SkTraceEvent.h, which Skia and
+// this library use:
+//
+//   "game"      EgretGame::update and render, one frame each
+//   "canvas"    CanvasContext2D draws and flushes, atlas evictions
+//   "skia"      glyph cache misses
+//   "skia.gpu"  GrContext flushes, the path renderer each path went to,
+//               texture uploads, glyph atlas evictions
+//
+// GrTraceMarker zones are in "disabled-by-default-skia.gpu" and are only
+// recorded after setIncludesDisabledByDefault(true).
+//
+// While the tracer is disabled each trace point is a load and a branch. While
+// it is enabled, recording an event is an atomic compare and swap and a
+// store into the ring, with no locks or allocation, so it can stay on in
+// release builds.
+// markFrame() also counts the events of each name in the frame and records
+// the totals as counters.
+class CanvasTracer : public SkEventTracer
+{
+	WTF_MAKE_NONCOPYABLE(CanvasTracer);
+public:
+	enum
+	{
+		kDefaultCapacity = 16384,
+		kMaxCategories = 64
+	};
+
+	// |capacity| is rounded up to a power of two.
+	explicit CanvasTracer(int capacity = kDefaultCapacity);
+	virtual ~CanvasTracer();
+
+	// Makes a new tracer Skia's SkEventTracer instance, which deletes it at
+	// exit; later calls return the same tracer. Trace points that ran before
+	// this keep the old tracer's categories, so install early.
+	static CanvasTracer* install(int capacity = kDefaultCapacity);
+
+	void setEnabled(bool);
+	bool isEnabled() const { return m_enabled; }
+	void setIncludesDisabledByDefault(bool);
+
+	// Call at the end of each frame.
+	void markFrame();
+	unsigned frameCount() const { return m_frames; }
+
+	// Write the events still in the ring. Call between frames; events
+	// recorded while writing may be torn.
+	bool writeJSON(SkWStream*) const;
+	bool writeJSON(const char* path) const;
+	// Drops the events in the ring and resets frameCount().
+	void clear();
+
+	virtual const uint8_t* getCategoryGroupEnabled(const char* name);
+	virtual const char* getCategoryGroupName(const uint8_t* categoryEnabledFlag);
+	virtual SkEventTracer::Handle addTraceEvent(char phase, const uint8_t* categoryEnabledFlag, const char* name, uint64_t id,
+		int32_t numArgs, const char** argNames, const uint8_t* argTypes, const uint64_t* argValues, uint8_t flags);
+	virtual void updateTraceEventDuration(const uint8_t* categoryEnabledFlag, const char* name, SkEventTracer::Handle);
+
+private:
+	struct Event
+	{
+		uint32_t m_sequence;
+		char m_phase;
+		uint8_t m_numArgs;
+		uint8_t m_argTypes[2];
+		const uint8_t* m_category;
+		const char* m_name;
+		const char* m_argNames[2];
+		uint64_t m_argValues[2];
+		uint64_t m_thread;
+		int64_t m_timestamp;
+		int64_t m_duration;
+	};
+
+	struct Category
+	{
+		const char* m_name;
+		uint8_t m_enabled;
+	};
+
+	uint8_t enabledFlagFor(const char* name) const;
+	Event* append(char phase, const uint8_t* category, const char* name, uint32_t* sequence);
+	const char* categoryName(const uint8_t*) const;
+
+	Event* m_events;
+	uint32_t m_mask;
+	// The next sequence number. It wraps to 0 after kSequenceMask, so
+	// sequences never have the top bit set; a slot being written holds the
+	// complement of its sequence, which always does.
+	int32_t m_next;
+	uint32_t m_frameStart;
+	unsigned m_frames;
+	int64_t m_epoch;
+
+	mutable SkMutex m_categoryMutex;
+	Category m_categories[kMaxCategories];
+	int m_categoryCount;
+	bool m_enabled;
+	bool m_includesDisabledByDefault;
+};
+
+} // namespace Canvas2D
+
+#endif // CanvasTracer_h
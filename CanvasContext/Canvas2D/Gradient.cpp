@@ -6,6 +6,7 @@
 #include "SkShader.h"
 #include "SkGradientShader.h"
 #include "SkiaUtils.h"
+#include "GradientShaderCache.h"
 
 namespace Canvas2D {
 
@@ -90,12 +91,11 @@ bool Gradient::hasAlpha() const
 
 void Gradient::setSpreadMethod(GradientSpreadMethod spreadMethod)
 {
-    // FIXME: Should it become necessary, allow calls to this method after m_gradient has been set.
-
     if (m_spreadMethod == spreadMethod)
         return;
 
     m_spreadMethod = spreadMethod;
+    m_gradient.clear();
 }
 
 void Gradient::setDrawsInPMColorSpace(bool drawInPMColorSpace)
@@ -113,8 +113,9 @@ void Gradient::setGradientSpaceTransform(const AffineTransform& gradientSpaceTra
         return;
 
     m_gradientSpaceTransformation = gradientSpaceTransformation;
-    if (m_gradient)
-        m_gradient->setLocalMatrix(affineTransformToSkMatrix(m_gradientSpaceTransformation));
+    // The shader may be shared through the cache, so make a new one rather
+    // than changing its matrix.
+    m_gradient.clear();
 }
 
 static inline U8CPU F2B(float x)
@@ -181,7 +182,7 @@ static void fillStops(const Gradient::ColorStop* stopData,
     }
 }
 
-SkShader* Gradient::shader()
+SkShader* Gradient::shader(GradientShaderCache* cache)
 {
     if (m_gradient)
         return m_gradient.get();
@@ -213,39 +214,67 @@ SkShader* Gradient::shader()
     }
 
     uint32_t shouldDrawInPMColorSpace = m_drawInPMColorSpace ? SkGradientShader::kInterpolateColorsInPremul_Flag : 0;
+    // Since the two-point radial gradient is slower than the plain radial,
+    // only use it if we have to.
+    bool simpleRadial = m_radial && m_p0 == m_p1 && m_r0 <= 0.0f;
+
+    SkMatrix localMatrix = affineTransformToSkMatrix(m_gradientSpaceTransformation);
+    if (m_radial && aspectRatio() != 1) {
+        // CSS3 elliptical gradients: apply the elliptical scaling at the
+        // gradient center point.
+        localMatrix.preTranslate(m_p0.fX, m_p0.fY);
+        localMatrix.preScale(1, 1 / aspectRatio());
+        localMatrix.preTranslate(-m_p0.fX, -m_p0.fY);
+    }
+
+    GradientShaderCache::Key key;
+    if (cache) {
+        key.add(m_radial ? (simpleRadial ? 1 : 2) : 0);
+        key.addFloat(m_p0.fX);
+        key.addFloat(m_p0.fY);
+        key.addFloat(m_p1.fX);
+        key.addFloat(m_p1.fY);
+        key.addFloat(m_r0);
+        key.addFloat(m_r1);
+        key.add(tile);
+        key.add(shouldDrawInPMColorSpace);
+        for (int i = 0; i < 9; i++)
+            key.addFloat(localMatrix[i]);
+        for (size_t i = 0; i < countUsed; i++) {
+            key.add(colors[i]);
+            key.addFloat(pos[i]);
+        }
+        if (SkShader* shader = cache->find(key)) {
+            m_gradient = shader;
+            return m_gradient.get();
+        }
+    }
+
     if (m_radial) {
-        // Since the two-point radial gradient is slower than the plain radial,
-        // only use it if we have to.
-        if (m_p0 == m_p1 && m_r0 <= 0.0f) {
-			m_gradient = (SkGradientShader::CreateRadial(m_p1, m_r1, colors, pos, static_cast<int>(countUsed), tile, 0, shouldDrawInPMColorSpace, NULL));
+        if (simpleRadial) {
+            m_gradient = adoptRef(SkGradientShader::CreateRadial(m_p1, m_r1, colors, pos, static_cast<int>(countUsed), tile, 0, shouldDrawInPMColorSpace, NULL));
         } else {
             // The radii we give to Skia must be positive. If we're given a
             // negative radius, ask for zero instead.
             SkScalar radius0 = m_r0 >= 0.0f ? WebCoreFloatToSkScalar(m_r0) : 0;
             SkScalar radius1 = m_r1 >= 0.0f ? WebCoreFloatToSkScalar(m_r1) : 0;
-            m_gradient = (SkGradientShader::CreateTwoPointConical(m_p0, radius0, m_p1, radius1, colors, pos, static_cast<int>(countUsed), tile, 0, shouldDrawInPMColorSpace, NULL));
-        }
-
-        if (aspectRatio() != 1) {
-            // CSS3 elliptical gradients: apply the elliptical scaling at the
-            // gradient center point.
-            m_gradientSpaceTransformation.translate(m_p0.fX, m_p0.fY);
-            m_gradientSpaceTransformation.scale(1, 1 / aspectRatio());
-            m_gradientSpaceTransformation.translate(-m_p0.fX, -m_p0.fY);
+            m_gradient = adoptRef(SkGradientShader::CreateTwoPointConical(m_p0, radius0, m_p1, radius1, colors, pos, static_cast<int>(countUsed), tile, 0, shouldDrawInPMColorSpace, NULL));
         }
     } 
 	else
 	{
         SkPoint pts[2] = { m_p0, m_p1 };
-        m_gradient = (SkGradientShader::CreateLinear(pts, colors, pos, static_cast<int>(countUsed), tile, 0, shouldDrawInPMColorSpace, NULL ));
+        m_gradient = adoptRef(SkGradientShader::CreateLinear(pts, colors, pos, static_cast<int>(countUsed), tile, 0, shouldDrawInPMColorSpace, NULL ));
     }
 
     if (!m_gradient) {
         // use last color, since our "geometry" was degenerate (e.g. radius==0)
-        m_gradient = (new SkColorShader(colors[countUsed - 1]));
+        m_gradient = adoptRef(new SkColorShader(colors[countUsed - 1]));
     } else {
-        m_gradient->setLocalMatrix(affineTransformToSkMatrix(m_gradientSpaceTransformation));
+        m_gradient->setLocalMatrix(localMatrix);
     }
+    if (cache)
+        cache->add(key, m_gradient.get());
     return m_gradient.get();
 }
 
@@ -2,6 +2,7 @@
 #define Gradient_h
 
 #include "SkPoint.h"
+#include "SkShader.h"
 #include "passrefptr.h"
 #include "RefCounted.h"
 #include "RefPtr.h"
@@ -9,13 +10,12 @@
 #include "AffineTransform.h"
 #include "vector"
 
-class SkShader;
-
 namespace Canvas2D 
 {
 
 class Color;
 class FloatRect;
+class GradientShaderCache;
 class IntSize;
 
 class Gradient : public RefCounted<Gradient> {
@@ -58,6 +58,7 @@ public:
             return;
 
         m_p0 = p;
+        m_gradient.clear();
     }
 
     void setP1(const SkPoint& p)
@@ -66,6 +67,7 @@ public:
             return;
 
         m_p1 = p;
+        m_gradient.clear();
     }
 
     float startRadius() const { return m_r0; }
@@ -77,6 +79,7 @@ public:
             return;
 
         m_r0 = r;
+        m_gradient.clear();
     }
 
     void setEndRadius(float r)
@@ -85,11 +88,14 @@ public:
             return;
 
         m_r1 = r;
+        m_gradient.clear();
     }
 
     float aspectRatio() const { return m_aspectRatio; }
 
-    SkShader* shader();
+    // With a cache, an identical gradient built earlier (typically last
+    // frame's) hands back its shader instead of a new one being made.
+    SkShader* shader(GradientShaderCache* = 0);
 
     void setStopsSorted(bool s) { m_stopsSorted = s; }
 
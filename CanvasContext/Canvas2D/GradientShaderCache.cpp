@@ -0,0 +1,85 @@
+#include "GradientShaderCache.h"
+#include "graphicstypes.h"
+#include <string.h>
+
+namespace Canvas2D {
+
+unsigned GradientShaderCache::Key::hash() const
+{
+	return m_data.empty() ? 0 : canvasHash(&m_data[0], m_data.size() * sizeof(uint32_t));
+}
+
+void GradientShaderCache::Key::addFloat(float value)
+{
+	// +0 and -0 draw the same gradient.
+	if (value == 0)
+	{
+		value = 0;
+	}
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	add(bits);
+}
+
+GradientShaderCache::GradientShaderCache()
+	: m_clock(0)
+{
+}
+
+GradientShaderCache::~GradientShaderCache()
+{
+}
+
+SkShader* GradientShaderCache::find(const Key& key)
+{
+	Entry* set = &m_entries[(key.hash() % kSetCount) * kWays];
+	for (int i = 0; i < kWays; ++i)
+	{
+		Entry& e = set[i];
+		if (e.m_shader && e.m_key == key)
+		{
+			m_stats.m_hits++;
+			e.m_lastUse = ++m_clock;
+			return e.m_shader.get();
+		}
+	}
+	m_stats.m_misses++;
+	return 0;
+}
+
+void GradientShaderCache::add(const Key& key, SkShader* shader)
+{
+	Entry* set = &m_entries[(key.hash() % kSetCount) * kWays];
+	Entry* victim = set;
+	for (int i = 0; i < kWays; ++i)
+	{
+		Entry& e = set[i];
+		if (!e.m_shader)
+		{
+			victim = &e;
+			break;
+		}
+		if (e.m_lastUse < victim->m_lastUse)
+		{
+			victim = &e;
+		}
+	}
+	if (victim->m_shader)
+	{
+		m_stats.m_evictions++;
+	}
+	victim->m_lastUse = ++m_clock;
+	victim->m_key = key;
+	victim->m_shader = shader;
+}
+
+void GradientShaderCache::clear()
+{
+	for (int i = 0; i < kSetCount * kWays; ++i)
+	{
+		m_entries[i] = Entry();
+	}
+	m_clock = 0;
+}
+
+} // namespace Canvas2D
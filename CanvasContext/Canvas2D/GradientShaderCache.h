@@ -0,0 +1,86 @@
+#ifndef GradientShaderCache_h
+#define GradientShaderCache_h
+
+#include "Noncopyable.h"
+#include "RefPtr.h"
+#include "SkShader.h"
+#include "vector"
+#include <stdint.h>
+
+namespace Canvas2D
+{
+
+// Shares SkShaders between gradients with the same geometry, stops, spread
+// and local matrix. Scripts tend to call createLinearGradient and
+// addColorStop every frame; with this cache the shader, its color table and,
+// on the GPU, its row in the gradient texture atlas are built once instead of
+// for every draw. Returned shaders are shared and must not be modified.
+//
+// Organized like CanvasStyleCache: a fixed number of small sets with least
+// recently used eviction within a set.
+class GradientShaderCache
+{
+	WTF_MAKE_NONCOPYABLE(GradientShaderCache);
+public:
+	enum
+	{
+		kSetCount = 16,
+		kWays = 4
+	};
+
+	class Key
+	{
+	public:
+		void add(uint32_t value) { m_data.push_back(value); }
+		void addFloat(float);
+
+		unsigned hash() const;
+		bool operator==(const Key& other) const { return m_data == other.m_data; }
+
+	private:
+		std::vector<uint32_t> m_data;
+	};
+
+	struct Stats
+	{
+		Stats() : m_hits(0), m_misses(0), m_evictions(0) { }
+		unsigned m_hits;
+		unsigned m_misses;
+		unsigned m_evictions;
+		float hitRate() const
+		{
+			unsigned lookups = m_hits + m_misses;
+			return lookups ? static_cast<float>(m_hits) / lookups : 0;
+		}
+	};
+
+	GradientShaderCache();
+	~GradientShaderCache();
+
+	// Returns null on a miss.
+	SkShader* find(const Key&);
+	// The cache takes a ref.
+	void add(const Key&, SkShader*);
+
+	void clear();
+
+	const Stats& stats() const { return m_stats; }
+	void resetStats() { m_stats = Stats(); }
+
+private:
+	struct Entry
+	{
+		Entry() : m_lastUse(0) { }
+		unsigned m_lastUse;
+		Key m_key;
+		RefPtr<SkShader> m_shader;
+	};
+
+	Entry m_entries[kSetCount * kWays];
+	unsigned m_clock;
+	Stats m_stats;
+};
+
+} // namespace Canvas2D
+
+#endif // GradientShaderCache_h
@@ -25,6 +25,9 @@
  */
 
 #include "graphicstypes.h"
+#include "SkChecksum.h"
+#include "SkTypes.h"
+#include <string.h>
 
 
 namespace Canvas2D
@@ -69,24 +72,7 @@ const int numBlendOperatorNames = sizeof(blendOperatorNames) / sizeof(blendOpera
 
 bool parseCompositeAndBlendOperator(const std::string& s, CompositeOperator& op, WebBlendMode& blendOp)
 {
-    for (int i = 0; i < numCompositeOperatorNames; i++) {
-        if (s == compositeOperatorNames[i]) {
-            op = static_cast<CompositeOperator>(i);
-            blendOp = WebBlendModeNormal;
-            return true;
-        }
-    }
-
-    for (int i = 0; i < numBlendOperatorNames; i++) {
-        if (s == blendOperatorNames[i]) {
-            blendOp = static_cast<WebBlendMode>(i+1);
-            // For now, blending will always assume source-over. This will be fixed in the future
-            op = CompositeSourceOver;
-            return true;
-        }
-    }
-
-    return false;
+    return keywordToCompositeAndBlendOperator(lookupCanvasKeyword(s), op, blendOp);
 }
 
 // FIXME: when we support blend modes in combination with compositing other than source-over
@@ -104,19 +90,7 @@ std::string compositeOperatorName(CompositeOperator op, WebBlendMode blendOp)
 
 bool parseLineCap(const std::string& s, LineCap& cap)
 {
-    if (s == "butt") {
-        cap = ButtCap;
-        return true;
-    }
-    if (s == "round") {
-        cap = RoundCap;
-        return true;
-    }
-    if (s == "square") {
-        cap = SquareCap;
-        return true;
-    }
-    return false;
+    return keywordToLineCap(lookupCanvasKeyword(s), cap);
 }
 
 std::string lineCapName(LineCap cap)
@@ -129,19 +103,7 @@ std::string lineCapName(LineCap cap)
 
 bool parseLineJoin(const std::string& s, LineJoin& join)
 {
-    if (s == "miter") {
-        join = MiterJoin;
-        return true;
-    }
-    if (s == "round") {
-        join = RoundJoin;
-        return true;
-    }
-    if (s == "bevel") {
-        join = BevelJoin;
-        return true;
-    }
-    return false;
+    return keywordToLineJoin(lookupCanvasKeyword(s), join);
 }
 
 std::string lineJoinName(LineJoin join)
@@ -162,64 +124,264 @@ std::string textAlignName(TextAlign align)
 
 bool parseTextAlign(const std::string& s, TextAlign& align)
 {
-    if (s == "start") {
-        align = StartTextAlign;
-        return true;
+    return keywordToTextAlign(lookupCanvasKeyword(s), align);
+}
+
+std::string textBaselineName(TextBaseline baseline)
+{
+	SkASSERT(baseline >= 0);
+	SkASSERT(baseline < 6);
+    const char* const names[6] = { "alphabetic", "top", "middle", "bottom", "ideographic", "hanging" };
+    return names[baseline];
+}
+
+bool parseTextBaseline(const std::string& s, TextBaseline& baseline)
+{
+    return keywordToTextBaseline(lookupCanvasKeyword(s), baseline);
+}
+
+bool parseWindRule(const std::string& s, WindRule& windRule)
+{
+    return keywordToWindRule(lookupCanvasKeyword(s), windRule);
+}
+
+static const char* const canvasKeywordNames[CanvasKeywordCount] = {
+    "",
+    "butt",
+    "round",
+    "square",
+    "miter",
+    "bevel",
+    "clear",
+    "copy",
+    "source-over",
+    "source-in",
+    "source-out",
+    "source-atop",
+    "destination-over",
+    "destination-in",
+    "destination-out",
+    "destination-atop",
+    "xor",
+    "darker",
+    "lighter",
+    "multiply",
+    "screen",
+    "overlay",
+    "darken",
+    "lighten",
+    "color-dodge",
+    "color-burn",
+    "hard-light",
+    "soft-light",
+    "difference",
+    "exclusion",
+    "hue",
+    "saturation",
+    "color",
+    "luminosity",
+    "start",
+    "end",
+    "left",
+    "center",
+    "right",
+    "alphabetic",
+    "top",
+    "middle",
+    "bottom",
+    "ideographic",
+    "hanging",
+    "nonzero",
+    "evenodd"
+};
+
+// Open addressed table of the keyword names, hashed once on first use.
+class CanvasKeywordTable {
+public:
+    enum { kSize = 128, kMaxLength = 32 };
+
+    CanvasKeywordTable()
+    {
+        memset(m_slots, 0, sizeof(m_slots));
+        for (int k = 1; k < CanvasKeywordCount; ++k) {
+            size_t length = strlen(canvasKeywordNames[k]);
+            unsigned hash = canvasHash(canvasKeywordNames[k], length);
+            unsigned index = hash & (kSize - 1);
+            while (m_slots[index].keyword)
+                index = (index + 1) & (kSize - 1);
+            m_slots[index].hash = hash;
+            m_slots[index].length = static_cast<unsigned char>(length);
+            m_slots[index].keyword = static_cast<unsigned char>(k);
+        }
     }
-    if (s == "end") {
-        align = EndTextAlign;
+
+    CanvasKeyword find(const char* s, size_t length) const
+    {
+        if (!length || length > kMaxLength)
+            return CanvasKeywordUnknown;
+        unsigned hash = canvasHash(s, length);
+        for (unsigned index = hash & (kSize - 1); m_slots[index].keyword; index = (index + 1) & (kSize - 1)) {
+            const Slot& slot = m_slots[index];
+            if (slot.hash == hash && slot.length == length && !memcmp(canvasKeywordNames[slot.keyword], s, length))
+                return static_cast<CanvasKeyword>(slot.keyword);
+        }
+        return CanvasKeywordUnknown;
+    }
+
+private:
+    struct Slot {
+        unsigned hash;
+        unsigned char length;
+        unsigned char keyword;
+    };
+    Slot m_slots[kSize];
+};
+
+CanvasKeyword lookupCanvasKeyword(const char* s, size_t length)
+{
+    static const CanvasKeywordTable table;
+    return table.find(s, length);
+}
+
+const char* canvasKeywordName(CanvasKeyword keyword)
+{
+    SkASSERT(keyword >= 0);
+    SkASSERT(keyword < CanvasKeywordCount);
+    return canvasKeywordNames[keyword];
+}
+
+bool keywordToLineCap(CanvasKeyword keyword, LineCap& cap)
+{
+    switch (keyword) {
+    case CanvasKeywordButt:
+        cap = ButtCap;
         return true;
+    case CanvasKeywordRound:
+        cap = RoundCap;
+        return true;
+    case CanvasKeywordSquare:
+        cap = SquareCap;
+        return true;
+    default:
+        return false;
     }
-    if (s == "left") {
-        align = LeftTextAlign;
+}
+
+bool keywordToLineJoin(CanvasKeyword keyword, LineJoin& join)
+{
+    switch (keyword) {
+    case CanvasKeywordMiter:
+        join = MiterJoin;
+        return true;
+    case CanvasKeywordRound:
+        join = RoundJoin;
         return true;
+    case CanvasKeywordBevel:
+        join = BevelJoin;
+        return true;
+    default:
+        return false;
     }
-    if (s == "center") {
-        align = CenterTextAlign;
+}
+
+bool keywordToCompositeAndBlendOperator(CanvasKeyword keyword, CompositeOperator& op, WebBlendMode& blendOp)
+{
+    if (keyword >= CanvasKeywordClear && keyword <= CanvasKeywordLighter) {
+        op = static_cast<CompositeOperator>(keyword - CanvasKeywordClear);
+        blendOp = WebBlendModeNormal;
         return true;
     }
-    if (s == "right") {
-        align = RightTextAlign;
+    if (keyword >= CanvasKeywordMultiply && keyword <= CanvasKeywordLuminosity) {
+        blendOp = static_cast<WebBlendMode>(keyword - CanvasKeywordMultiply + 1);
+        // For now, blending will always assume source-over. This will be fixed in the future
+        op = CompositeSourceOver;
         return true;
     }
     return false;
 }
 
-std::string textBaselineName(TextBaseline baseline)
+bool keywordToTextAlign(CanvasKeyword keyword, TextAlign& align)
 {
-	SkASSERT(baseline >= 0);
-	SkASSERT(baseline < 6);
-    const char* const names[6] = { "alphabetic", "top", "middle", "bottom", "ideographic", "hanging" };
-    return names[baseline];
+    switch (keyword) {
+    case CanvasKeywordStart:
+        align = StartTextAlign;
+        return true;
+    case CanvasKeywordEnd:
+        align = EndTextAlign;
+        return true;
+    case CanvasKeywordLeft:
+        align = LeftTextAlign;
+        return true;
+    case CanvasKeywordCenter:
+        align = CenterTextAlign;
+        return true;
+    case CanvasKeywordRight:
+        align = RightTextAlign;
+        return true;
+    default:
+        return false;
+    }
 }
 
-bool parseTextBaseline(const std::string& s, TextBaseline& baseline)
+bool keywordToTextBaseline(CanvasKeyword keyword, TextBaseline& baseline)
 {
-    if (s == "alphabetic") {
+    switch (keyword) {
+    case CanvasKeywordAlphabetic:
         baseline = AlphabeticTextBaseline;
         return true;
-    }
-    if (s == "top") {
+    case CanvasKeywordTop:
         baseline = TopTextBaseline;
         return true;
-    }
-    if (s == "middle") {
+    case CanvasKeywordMiddle:
         baseline = MiddleTextBaseline;
         return true;
-    }
-    if (s == "bottom") {
+    case CanvasKeywordBottom:
         baseline = BottomTextBaseline;
         return true;
-    }
-    if (s == "ideographic") {
+    case CanvasKeywordIdeographic:
         baseline = IdeographicTextBaseline;
         return true;
-    }
-    if (s == "hanging") {
+    case CanvasKeywordHanging:
         baseline = HangingTextBaseline;
         return true;
+    default:
+        return false;
     }
-    return false;
+}
+
+bool keywordToWindRule(CanvasKeyword keyword, WindRule& windRule)
+{
+    switch (keyword) {
+    case CanvasKeywordNonzero:
+        windRule = RULE_NONZERO;
+        return true;
+    case CanvasKeywordEvenodd:
+        windRule = RULE_EVENODD;
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint32_t canvasHash(const void* data, size_t length)
+{
+    // Murmur3 reads whole aligned words, so feed it the bytes through a
+    // buffer, zero padding the last chunk. Seeding with the length keeps
+    // strings that differ only in trailing zeros apart.
+    const char* bytes = static_cast<const char*>(data);
+    uint32_t words[16];
+    uint32_t hash = static_cast<uint32_t>(length);
+    do {
+        size_t chunk = SkTMin(length, sizeof(words));
+        size_t padded = SkAlign4(chunk);
+        if (padded != chunk)
+            words[padded / 4 - 1] = 0;
+        memcpy(words, bytes, chunk);
+        hash = SkChecksum::Murmur3(words, padded, hash);
+        bytes += chunk;
+        length -= chunk;
+    } while (length);
+    return hash;
 }
 
 }
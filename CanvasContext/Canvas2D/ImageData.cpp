@@ -1,4 +1,6 @@
 #include "ImageData.h"
+#include "ImageDataBufferPool.h"
+#include "SkChecksum.h"
 
 namespace Canvas2D {
 
@@ -9,14 +11,20 @@ PassRefPtr<ImageData> ImageData::create(int w, int h)
 
 ImageData::~ImageData()
 {
-	delete[]m_data;
+	ImageDataBufferPool::release(m_data, length());
+}
+
+uint32_t ImageData::checksum() const
+{
+	// Buffers come from new[], and length() is a multiple of 4.
+	return SkChecksum::Murmur3(reinterpret_cast<const uint32_t*>(m_data), length());
 }
 
 ImageData::ImageData(int w, int h)
     : m_width(w)
 	, m_height( h)
 {
-	m_data = new unsigned char[m_width * m_height * 4];
+	m_data = ImageDataBufferPool::acquire(length());
 }
 
 }
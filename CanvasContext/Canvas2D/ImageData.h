@@ -3,6 +3,8 @@
 
 #include "RefCounted.h"
 #include "RefPtr.h"
+#include <stdint.h>
+#include <string.h>
 
 namespace Canvas2D {
 
@@ -14,8 +16,14 @@ public:
 	int width() const	{ return m_width; }
     int height() const	{ return m_height; }
 	int length() const	{ return m_width * m_height * 4; }
+	// Pixels are RGBA, unpremultiplied, rows packed at width() * 4 bytes.
     unsigned char* data()const { return m_data; }
 	void zeroFill(){ memset(m_data, 0, m_width * m_height * 4); };
+	// A 32 bit hash of the pixels. Different pixels can hash the same, so a
+	// changed checksum proves the pixels changed but an equal one does not
+	// prove they did not. Reads every pixel, so callers should not ask for it
+	// per draw.
+	uint32_t checksum() const;
 	~ImageData();
 private:
 	ImageData(int w, int h);
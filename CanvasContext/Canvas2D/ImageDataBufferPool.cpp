@@ -0,0 +1,109 @@
+#include "ImageDataBufferPool.h"
+#include "SkThread.h"
+
+namespace Canvas2D {
+
+namespace {
+
+struct Bucket
+{
+	unsigned char* m_buffers[ImageDataBufferPool::kMaxBuffersPerBucket];
+	int m_count;
+};
+
+Bucket gBuckets[ImageDataBufferPool::kBucketCount];
+size_t gRetainedBytes;
+unsigned gHits;
+unsigned gMisses;
+
+SK_DECLARE_STATIC_MUTEX(gPoolMutex);
+
+// Returns -1 if |bytes| is too large to pool.
+int bucketIndex(size_t bytes)
+{
+	int shift = ImageDataBufferPool::kMinBucketShift;
+	while ((static_cast<size_t>(1) << shift) < bytes)
+	{
+		if (++shift > ImageDataBufferPool::kMaxBucketShift)
+		{
+			return -1;
+		}
+	}
+	return shift - ImageDataBufferPool::kMinBucketShift;
+}
+
+size_t bucketSize(int index)
+{
+	return static_cast<size_t>(1) << (index + ImageDataBufferPool::kMinBucketShift);
+}
+
+} // namespace
+
+unsigned char* ImageDataBufferPool::acquire(size_t bytes)
+{
+	int index = bucketIndex(bytes);
+	if (index < 0)
+	{
+		return new unsigned char[bytes];
+	}
+	{
+		SkAutoMutexAcquire lock(gPoolMutex);
+		Bucket& bucket = gBuckets[index];
+		if (bucket.m_count)
+		{
+			gHits++;
+			gRetainedBytes -= bucketSize(index);
+			return bucket.m_buffers[--bucket.m_count];
+		}
+		gMisses++;
+	}
+	return new unsigned char[bucketSize(index)];
+}
+
+void ImageDataBufferPool::release(unsigned char* buffer, size_t bytes)
+{
+	if (!buffer)
+	{
+		return;
+	}
+	int index = bucketIndex(bytes);
+	if (index >= 0)
+	{
+		SkAutoMutexAcquire lock(gPoolMutex);
+		Bucket& bucket = gBuckets[index];
+		size_t size = bucketSize(index);
+		if (bucket.m_count < kMaxBuffersPerBucket && gRetainedBytes + size <= kMaxRetainedBytes)
+		{
+			bucket.m_buffers[bucket.m_count++] = buffer;
+			gRetainedBytes += size;
+			return;
+		}
+	}
+	delete[] buffer;
+}
+
+void ImageDataBufferPool::purge()
+{
+	SkAutoMutexAcquire lock(gPoolMutex);
+	for (int i = 0; i < kBucketCount; i++)
+	{
+		Bucket& bucket = gBuckets[i];
+		while (bucket.m_count)
+		{
+			delete[] bucket.m_buffers[--bucket.m_count];
+		}
+	}
+	gRetainedBytes = 0;
+}
+
+ImageDataBufferPool::Stats ImageDataBufferPool::stats()
+{
+	SkAutoMutexAcquire lock(gPoolMutex);
+	Stats stats;
+	stats.m_hits = gHits;
+	stats.m_misses = gMisses;
+	stats.m_retainedBytes = gRetainedBytes;
+	return stats;
+}
+
+} // namespace Canvas2D
@@ -0,0 +1,43 @@
+#ifndef ImageDataBufferPool_h
+#define ImageDataBufferPool_h
+
+#include <stddef.h>
+
+namespace Canvas2D
+{
+
+// Recycles ImageData pixel buffers so per-frame pixel effects do not hit
+// malloc for every getImageData/createImageData. Requests are rounded up to a
+// power of two bucket; each bucket keeps a few free buffers, up to an overall
+// cap. Requests larger than the biggest bucket bypass the pool.
+class ImageDataBufferPool
+{
+public:
+	enum
+	{
+		kMinBucketShift = 12,           // 4KB
+		kMaxBucketShift = 24,           // 16MB
+		kBucketCount = kMaxBucketShift - kMinBucketShift + 1,
+		kMaxBuffersPerBucket = 4,
+		kMaxRetainedBytes = 32 * 1024 * 1024
+	};
+
+	struct Stats
+	{
+		unsigned m_hits;
+		unsigned m_misses;
+		size_t m_retainedBytes;
+	};
+
+	// |bytes| must be passed unchanged to release().
+	static unsigned char* acquire(size_t bytes);
+	static void release(unsigned char* buffer, size_t bytes);
+
+	// Frees every buffer currently held by the pool.
+	static void purge();
+	static Stats stats();
+};
+
+} // namespace Canvas2D
+
+#endif // ImageDataBufferPool_h
@@ -134,6 +134,88 @@ enum ColorFilter {
  std::string textBaselineName(TextBaseline);
  bool parseTextBaseline(const  std::string&, TextBaseline&);
 
+ bool parseWindRule(const  std::string&, WindRule&);
+
+// Interned ids for every keyword the string-typed canvas setters accept.
+// Bindings can resolve a string once with lookupCanvasKeyword(), cache the
+// id, and convert it with the keywordTo* helpers below instead of handing a
+// std::string to the context on every call. The composite and blend ranges
+// follow the order of CompositeOperator and WebBlendMode.
+enum CanvasKeyword
+{
+	CanvasKeywordUnknown = 0,
+
+	CanvasKeywordButt,
+	CanvasKeywordRound,
+	CanvasKeywordSquare,
+	CanvasKeywordMiter,
+	CanvasKeywordBevel,
+
+	CanvasKeywordClear,
+	CanvasKeywordCopy,
+	CanvasKeywordSourceOver,
+	CanvasKeywordSourceIn,
+	CanvasKeywordSourceOut,
+	CanvasKeywordSourceAtop,
+	CanvasKeywordDestinationOver,
+	CanvasKeywordDestinationIn,
+	CanvasKeywordDestinationOut,
+	CanvasKeywordDestinationAtop,
+	CanvasKeywordXor,
+	CanvasKeywordDarker,
+	CanvasKeywordLighter,
+
+	CanvasKeywordMultiply,
+	CanvasKeywordScreen,
+	CanvasKeywordOverlay,
+	CanvasKeywordDarken,
+	CanvasKeywordLighten,
+	CanvasKeywordColorDodge,
+	CanvasKeywordColorBurn,
+	CanvasKeywordHardLight,
+	CanvasKeywordSoftLight,
+	CanvasKeywordDifference,
+	CanvasKeywordExclusion,
+	CanvasKeywordHue,
+	CanvasKeywordSaturation,
+	CanvasKeywordColor,
+	CanvasKeywordLuminosity,
+
+	CanvasKeywordStart,
+	CanvasKeywordEnd,
+	CanvasKeywordLeft,
+	CanvasKeywordCenter,
+	CanvasKeywordRight,
+
+	CanvasKeywordAlphabetic,
+	CanvasKeywordTop,
+	CanvasKeywordMiddle,
+	CanvasKeywordBottom,
+	CanvasKeywordIdeographic,
+	CanvasKeywordHanging,
+
+	CanvasKeywordNonzero,
+	CanvasKeywordEvenodd,
+
+	CanvasKeywordCount
+};
+
+ CanvasKeyword lookupCanvasKeyword(const char*, size_t length);
+ inline CanvasKeyword lookupCanvasKeyword(const std::string& s) { return lookupCanvasKeyword(s.data(), s.length()); }
+ const char* canvasKeywordName(CanvasKeyword);
+
+ bool keywordToLineCap(CanvasKeyword, LineCap&);
+ bool keywordToLineJoin(CanvasKeyword, LineJoin&);
+ bool keywordToCompositeAndBlendOperator(CanvasKeyword, CompositeOperator&, WebBlendMode&);
+ bool keywordToTextAlign(CanvasKeyword, TextAlign&);
+ bool keywordToTextBaseline(CanvasKeyword, TextBaseline&);
+ bool keywordToWindRule(CanvasKeyword, WindRule&);
+
+// Hash shared by the canvas's small lookup tables: keyword names, color
+// strings and gradient keys. SkChecksum::Murmur3 over the bytes, which need
+// not be aligned or a whole number of words.
+ uint32_t canvasHash(const void* data, size_t length);
+
 } // namespace WebCore
 
 #endif
@@ -18,6 +18,12 @@ LOCAL_C_INCLUDES := $../../CanvasContext/Canvas2D \
 					$../../skia/include/config \
 					$../../skia/include/effects \
 					$../../skia/include/gpu \
+					$../../skia/include/images \
+					$../../skia/src/core \
+					$../../skia/src/gpu \
+					$../../skia/src/utils \
+					$../../skia/third_party/etc1 \
+					$../../skia/third_party/ktx \
 					$../thirdparty/v8 \
 				
 
@@ -38,10 +44,26 @@ LOCAL_SRC_FILES	+=  \
 					../../../CanvasContext/geometry/LayoutRect.cpp \
 					../../../CanvasContext/geometry/RoundedRect.cpp \
 					../../../CanvasContext/Canvas2D/BitmapImage.cpp \
+					../../../CanvasContext/Canvas2D/BitmapImageDecoder.cpp \
+					../../../CanvasContext/Canvas2D/CanvasBackingStore.cpp \
+					../../../CanvasContext/Canvas2D/CanvasCommandBuffer.cpp \
 					../../../CanvasContext/Canvas2D/CanvasContext2D.cpp \
+					../../../CanvasContext/Canvas2D/CanvasDamageTracker.cpp \
+					../../../CanvasContext/Canvas2D/CanvasETC1.cpp \
+					../../../CanvasContext/Canvas2D/CanvasFontCache.cpp \
+					../../../CanvasContext/Canvas2D/CanvasFrameRenderer.cpp \
 					../../../CanvasContext/Canvas2D/CanvasGradient.cpp \
+					../../../CanvasContext/Canvas2D/CanvasImageAtlas.cpp \
+					../../../CanvasContext/Canvas2D/CanvasPath.cpp \
+					../../../CanvasContext/Canvas2D/CanvasPathMethods.cpp \
 					../../../CanvasContext/Canvas2D/CanvasPattern.cpp \
+					../../../CanvasContext/Canvas2D/CanvasSession.cpp \
+					../../../CanvasContext/Canvas2D/CanvasSpriteBatch.cpp \
 					../../../CanvasContext/Canvas2D/CanvasStyle.cpp \
+					../../../CanvasContext/Canvas2D/CanvasStyleCache.cpp \
+					../../../CanvasContext/Canvas2D/CanvasTextLayoutCache.cpp \
+					../../../CanvasContext/Canvas2D/CanvasTileRenderer.cpp \
+					../../../CanvasContext/Canvas2D/CanvasTracer.cpp \
 					../../../CanvasContext/Canvas2D/Color.cpp \
 					../../../CanvasContext/Canvas2D/ColorData.cpp \
 					../../../CanvasContext/Canvas2D/CSSParserMode.cpp \
@@ -49,7 +71,9 @@ LOCAL_SRC_FILES	+=  \
 					../../../CanvasContext/Canvas2D/FontDescription.cpp \
 					../../../CanvasContext/Canvas2D/DrawLooperBuilder.cpp \
 					../../../CanvasContext/Canvas2D/Gradient.cpp \
+					../../../CanvasContext/Canvas2D/GradientShaderCache.cpp \
 					../../../CanvasContext/Canvas2D/GraphicsTypes.cpp \
+					../../../CanvasContext/Canvas2D/ImageDataBufferPool.cpp \
 					../../../CanvasContext/Canvas2D/ImageData.cpp \
 					../../../CanvasContext/Canvas2D/Pattern.cpp \
 				
@@ -36,6 +36,7 @@
 namespace egret {
 
 #define IMG_NAME "egret_icon.png"
+#define PROGRAM_BINARIES_NAME "gl_programs.bin"
 
 SkiaApp * SkiaApp::_instance = NULL;
 std::string SkiaApp::filesDir;
@@ -75,6 +76,9 @@ void SkiaApp::windowChanged(int width,int height){
 	const GrGLInterface *fCurIntf = GrGLCreateNativeInterface();
 	fCurContext = GrContext::Create( (GrBackendContext) fCurIntf);
 	LOGE("%s, %d, %d", __FUNCTION__, __LINE__, (int)fCurContext );
+	if (!fCurContext->setProgramBinaryCachePath((filesDir+PROGRAM_BINARIES_NAME).c_str())) {
+		LOGD("%s:program binaries are not supported",__func__);
+	}
 	GrBackendRenderTargetDesc desc;
 	desc.fWidth = SkScalarRoundToInt(width);
 	desc.fHeight = SkScalarRoundToInt(height);
@@ -158,7 +162,10 @@ void SkiaApp::initApp(int width , int height){
 }
 
 void SkiaApp::pauseApp(){
-
+	// the process may be killed while paused, so keep the programs built so far
+	if (fCurContext) {
+		fCurContext->saveProgramBinaries();
+	}
 }
 
 void SkiaApp::resumeApp(){
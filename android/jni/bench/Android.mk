@@ -0,0 +1,56 @@
+LOCAL_PATH := $(call my-dir)
+
+
+include $(CLEAR_VARS)
+
+LOCAL_ARM_MODE := arm
+
+# Skia's bench runner with the Canvas2D benches. GrContextFactory in this
+# tree still calls the two argument GrContext::Create, so the runner is
+# built raster only; the GPU configs are unavailable on device.
+LOCAL_MODULE := skia_bench
+
+LOCAL_CFLAGS += -DSK_SUPPORT_GPU=0 \
+				-DSK_FONTHOST_DOES_NOT_USE_FONTMGR \
+				-DSK_BUILD_JSON_WRITER \
+				-fexceptions
+
+LOCAL_C_INCLUDES := $../../skia/bench \
+					$../../skia/gm \
+					$../../skia/tools \
+					$../../skia/tools/flags \
+					$../../skia/third_party/externals/jsoncpp/include \
+
+LOCAL_SRC_FILES	+=  \
+					../../../skia/bench/benchmain.cpp \
+					../../../skia/bench/Benchmark.cpp \
+					../../../skia/bench/BenchLogger.cpp \
+					../../../skia/bench/BenchTimer.cpp \
+					../../../skia/bench/BenchSysTimer_posix.cpp \
+					../../../skia/bench/GMBench.cpp \
+					../../../skia/bench/ResultsWriter.cpp \
+					../../../skia/gm/gm.cpp \
+					../../../skia/tools/CrashHandler.cpp \
+					../../../skia/tools/flags/SkCommandLineFlags.cpp \
+					../../../skia/third_party/externals/jsoncpp/src/lib_json/json_reader.cpp \
+					../../../skia/third_party/externals/jsoncpp/src/lib_json/json_value.cpp \
+					../../../skia/third_party/externals/jsoncpp/src/lib_json/json_writer.cpp \
+
+#Canvas2D
+LOCAL_SRC_FILES	+=  \
+					../../../skia/bench/CanvasCommandBench.cpp \
+					../../../skia/bench/CanvasDamageBench.cpp \
+					../../../skia/bench/CanvasGradientBench.cpp \
+					../../../skia/bench/CanvasImageAtlasBench.cpp \
+					../../../skia/bench/CanvasPathBench.cpp \
+					../../../skia/bench/CanvasTextBench.cpp \
+
+LOCAL_STATIC_LIBRARIES := canvascontext2d
+LOCAL_STATIC_LIBRARIES += skia
+LOCAL_STATIC_LIBRARIES += png
+LOCAL_STATIC_LIBRARIES += jpeg
+LOCAL_STATIC_LIBRARIES += freetype
+
+LOCAL_LDLIBS    := -llog -lGLESv2 -lEGL -lz
+
+include $(BUILD_EXECUTABLE)
@@ -10,7 +10,6 @@ LOCAL_MODULE := skia
 LOCAL_CFLAGS += \
 				-DSK_SUPPORT_GPU \
 				-DSK_FONTHOST_DOES_NOT_USE_FONTMGR \
-				-DSK_IGNORE_ETC1_SUPPORT \
 				-DGL_GLEXT_PROTOTYPES \
 				-fexceptions
 #				-fshort-wchar	
@@ -128,6 +127,7 @@ LOCAL_SRC_FILES	+=  \
 	../../../skia/src/core/SkLineClipper.cpp \
 	../../../skia/src/core/SkMallocPixelRef.cpp \
 	../../../skia/src/core/SkMask.cpp \
+	../../../skia/src/core/SkMaskCache.cpp \
 	../../../skia/src/core/SkMaskFilter.cpp \
 	../../../skia/src/core/SkMaskGamma.cpp \
 	../../../skia/src/core/SkMath.cpp \
@@ -174,6 +174,7 @@ LOCAL_SRC_FILES	+=  \
 	../../../skia/src/core/SkScalar.cpp \
 	../../../skia/src/core/SkScalerContext.cpp \
 	../../../skia/src/core/SkScan.cpp \
+	../../../skia/src/core/SkScan_AAAPath.cpp \
 	../../../skia/src/core/SkScan_AntiPath.cpp \
 	../../../skia/src/core/SkScan_Antihair.cpp \
 	../../../skia/src/core/SkScan_Hairline.cpp \
@@ -445,6 +446,7 @@ LOCAL_SRC_FILES	+=  \
 	../../../skia/src/gpu/gl/GrGLPath.cpp \
 	../../../skia/src/gpu/gl/GrGLProgram.cpp \
 	../../../skia/src/gpu/gl/GrGLProgramDesc.cpp \
+	../../../skia/src/gpu/gl/GrGLProgramBinaryCache.cpp \
 	../../../skia/src/gpu/gl/GrGLProgramEffects.cpp \
 	../../../skia/src/gpu/gl/GrGLRenderTarget.cpp \
 	../../../skia/src/gpu/gl/GrGLShaderBuilder.cpp \
@@ -489,6 +491,23 @@ LOCAL_SRC_FILES	+=  \
 	#../../../skia/src/images/SkImageDecoder_libpng.cpp \
 					
 
+ifneq ($(filter x86 x86_64,$(TARGET_ARCH_ABI)),)
+# The x86 ABIs guarantee SSSE3, so those files build with the default flags;
+# opts_check_x86.cpp picks the AVX2 procs of skia_opts_avx2 at run time.
+LOCAL_SRC_FILES += \
+	../../../skia/src/opts/opts_check_x86.cpp \
+	../../../skia/src/opts/SkBitmapFilter_opts_SSE2.cpp \
+	../../../skia/src/opts/SkBitmapProcState_opts_SSE2.cpp \
+	../../../skia/src/opts/SkBitmapProcState_opts_SSSE3.cpp \
+	../../../skia/src/opts/SkBlitRect_opts_SSE2.cpp \
+	../../../skia/src/opts/SkBlitRow_opts_SSE2.cpp \
+	../../../skia/src/opts/SkBlurImage_opts_SSE2.cpp \
+	../../../skia/src/opts/SkMorphology_opts_SSE2.cpp \
+	../../../skia/src/opts/SkUtils_opts_SSE2.cpp \
+	../../../skia/src/opts/SkXfermode_opts_SSE2.cpp
+
+LOCAL_STATIC_LIBRARIES += skia_opts_avx2
+else
 LOCAL_SRC_FILES += \
 	../../../skia/src/opts/SkBitmapProcState_opts_none.cpp \
 	../../../skia/src/opts/SkBlitMask_opts_none.cpp \
@@ -497,6 +516,7 @@ LOCAL_SRC_FILES += \
 	../../../skia/src/opts/SkMorphology_opts_none.cpp \
 	../../../skia/src/opts/SkUtils_opts_none.cpp \
 	../../../skia/src/opts/SkXfermode_opts_none.cpp
+endif
 	
 	
 
@@ -509,5 +529,26 @@ LOCAL_SRC_FILES += \
 #LOCAL_LDLIBS := $(MY_LIBRARY)
 
 include $(BUILD_STATIC_LIBRARY)
+
+ifneq ($(filter x86 x86_64,$(TARGET_ARCH_ABI)),)
+# Only these files may be built with -mavx2; see opts_check_x86.cpp.
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := skia_opts_avx2
+
+LOCAL_CFLAGS += -mavx2
+
+LOCAL_C_INCLUDES := $../../skia/include/core \
+					$../../skia/include/config \
+					$../../skia/src/core \
+					$../../skia/src/opts
+
+LOCAL_SRC_FILES := \
+	../../../skia/src/opts/SkBitmapProcState_opts_AVX2.cpp \
+	../../../skia/src/opts/SkBlitRow_opts_AVX2.cpp \
+	../../../skia/src/opts/SkXfermode_opts_AVX2.cpp
+
+include $(BUILD_STATIC_LIBRARY)
+endif
 $(call import-add-path,$(LOCAL_PATH)/..)
 
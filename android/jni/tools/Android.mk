@@ -0,0 +1,77 @@
+LOCAL_PATH := $(call my-dir)
+
+# Command line tools for the Canvas2D work. Each one links the same
+# flags and timer sources.
+TOOL_C_INCLUDES := $../../skia/bench \
+					$../../skia/tools \
+					$../../skia/tools/flags \
+
+TOOL_SRC_FILES := \
+					../../../skia/tools/flags/SkCommandLineFlags.cpp \
+					../../../skia/bench/BenchTimer.cpp \
+					../../../skia/bench/BenchSysTimer_posix.cpp \
+					../../../skia/bench/BenchGpuTimer_gl.cpp \
+
+
+include $(CLEAR_VARS)
+
+LOCAL_ARM_MODE := arm
+
+LOCAL_MODULE := bench_canvas_tiles
+
+LOCAL_CFLAGS += -DSK_SUPPORT_GPU \
+				-DSK_FONTHOST_DOES_NOT_USE_FONTMGR \
+				-fexceptions
+
+LOCAL_C_INCLUDES := $(TOOL_C_INCLUDES)
+
+LOCAL_SRC_FILES := $(TOOL_SRC_FILES) \
+					../../../skia/tools/bench_canvas_tiles.cpp \
+
+LOCAL_STATIC_LIBRARIES := canvascontext2d skia png jpeg freetype
+
+LOCAL_LDLIBS    := -llog -lGLESv2 -lEGL -lz
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_ARM_MODE := arm
+
+LOCAL_MODULE := canvas_etc1
+
+LOCAL_CFLAGS += -DSK_SUPPORT_GPU \
+				-DSK_FONTHOST_DOES_NOT_USE_FONTMGR \
+				-fexceptions
+
+LOCAL_C_INCLUDES := $(TOOL_C_INCLUDES)
+
+LOCAL_SRC_FILES := $(TOOL_SRC_FILES) \
+					../../../skia/tools/canvas_etc1.cpp \
+
+LOCAL_STATIC_LIBRARIES := canvascontext2d skia png jpeg freetype
+
+LOCAL_LDLIBS    := -llog -lGLESv2 -lEGL -lz
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_ARM_MODE := arm
+
+LOCAL_MODULE := bench_canvas_replay
+
+LOCAL_CFLAGS += -DSK_SUPPORT_GPU \
+				-DSK_FONTHOST_DOES_NOT_USE_FONTMGR \
+				-fexceptions
+
+LOCAL_C_INCLUDES := $(TOOL_C_INCLUDES)
+
+LOCAL_SRC_FILES := $(TOOL_SRC_FILES) \
+					../../../skia/tools/bench_canvas_replay.cpp \
+
+LOCAL_STATIC_LIBRARIES := canvascontext2d skia png jpeg freetype
+
+LOCAL_LDLIBS    := -llog -lGLESv2 -lEGL -lz
+
+include $(BUILD_EXECUTABLE)
@@ -14,7 +14,9 @@
 #include "SkImageDecoder.h"
 #include "SkForceLinking.h"
 #include "BitmapImage.h"
-#include "CanvasPattern.h"
+#include "CanvasPattern.h"
+#include "CanvasTracer.h"
+#include "SkTraceEvent.h"
 #include "JSEngine.h"
 #include "include/v8.h"
 #include "include/libplatform/libplatform.h"
@@ -28,6 +30,10 @@ EgretGame game;
 
 SkCanvas *gCanvas;
 
+// Press T to start tracing, and T again to write the recent frames to
+// trace.json for chrome://tracing.
+CanvasTracer *gTracer;
+
 
 EgretGame::EgretGame()
 {
@@ -36,14 +42,35 @@ EgretGame::EgretGame()
 
 void EgretGame::initialize()
 {
+	// Install before any trace point runs, but record nothing until asked.
+	gTracer = CanvasTracer::install();
+	gTracer->setEnabled(false);
+
 	// Display the gameplay splash screen for at least 1 second.
-	displayScreen(this, &EgretGame::drawSplash, NULL, 1000L);
+	const long splashTime = 1000L;
+	double splashStart = getGameTime();
+	displayScreen(this, &EgretGame::drawSplash, NULL, splashTime);
 
 	int iw = getWidth();
 	int ih = getHeight();
 	glViewport(0, 0, iw, ih);
 	const GrGLInterface *fCurIntf = GrGLCreateNativeInterface();
 	fCurContext = GrContext::Create((GrBackendContext)fCurIntf);
+
+	// Link the programs the last run used from their binaries while the splash screen is still
+	// up, so the first frames skip the driver's compile and link. Skia still generates each
+	// program's shader source on its first draw. The displayer only sleeps for what is left of
+	// its second, so warm-up gets that time and no more; programs it does not reach are loaded
+	// from their binaries on first use. It runs here rather than on a shared-context thread
+	// because GrContext and its binary cache are single-threaded.
+	std::string programPath = FileSystem::getResourcePath();
+	programPath += "gl_programs.bin";
+	if (fCurContext->setProgramBinaryCachePath(programPath.c_str()))
+	{
+		double elapsed = getGameTime() - splashStart;
+		SkMSec budget = elapsed < splashTime ? (SkMSec)(splashTime - elapsed) : 0;
+		print("Warmed up %d GL programs in at most %u ms.\n", fCurContext->warmUpPrograms(budget), budget);
+	}
 	GrBackendRenderTargetDesc desc;
 	desc.fWidth = iw;
 	desc.fHeight = ih;
@@ -68,6 +95,7 @@ void EgretGame::initialize()
 
 void EgretGame::update(float elapsedTime)
 {
+	TRACE_EVENT0("game", "EgretGame::update");
 	clear(CLEAR_COLOR_DEPTH, Vector4(1, 1, 1, 1), 1.0f, 0);
 	mJSEngine.update(elapsedTime);
 
@@ -92,8 +120,12 @@ void EgretGame::update(float elapsedTime)
 
 void EgretGame::render(float elapsedTime)
 {
-	mJSEngine.render( elapsedTime );
-	fCurContext->flush();
+	{
+		TRACE_EVENT0("game", "EgretGame::render");
+		mJSEngine.render( elapsedTime );
+		fCurContext->flush();
+	}
+	gTracer->markFrame();
 }
 
 void EgretGame::finalize()
@@ -160,6 +192,34 @@ void EgretGame::keyEvent(Keyboard::KeyEvent evt, int key)
         case Keyboard::KEY_C:
         case Keyboard::KEY_CAPITAL_C:
             break;
+        case Keyboard::KEY_T:
+        case Keyboard::KEY_CAPITAL_T:
+            if (!gTracer->isEnabled())
+            {
+                gTracer->clear();
+                gTracer->setEnabled(true);
+                print("Tracing; press T again to write trace.json.\n");
+            }
+            else
+            {
+                gTracer->setEnabled(false);
+                std::string path = FileSystem::getResourcePath();
+                path += "trace.json";
+                if (gTracer->writeJSON(path.c_str()))
+                {
+                    print("Wrote %u frames of trace events to %s.\n", gTracer->frameCount(), path.c_str());
+                }
+            }
+            break;
+        case Keyboard::KEY_P:
+        case Keyboard::KEY_CAPITAL_P:
+            {
+                GrContext::ProgramStats stats;
+                fCurContext->getProgramStats(&stats);
+                print("Programs: %d cache hits, %d warm-up hits (%d warmed up), %d binary hits, %d compiles.\n",
+                      stats.fCacheHits, stats.fWarmUpHits, stats.fWarmedUp, stats.fBinaryHits, stats.fCompiles);
+            }
+            break;
         }
     }
     else if (evt == Keyboard::KEY_RELEASE)
@@ -11,6 +11,7 @@
 #include "SkCanvas.h"
 #include "SkColorFilter.h"
 #include "SkLayerDrawLooper.h"
+#include "SkMaskCache.h"
 #include "SkPaint.h"
 #include "SkPath.h"
 #include "SkPoint.h"
@@ -21,13 +22,33 @@
 
 // Large blurred RR appear frequently on web pages. This benchmark measures our
 // performance in this case.
+//
+// The path variants draw the same shape as an SkPath, the way a 2D canvas
+// builds rounded buttons, so it takes the general blur path instead of the
+// nine-patch. The uncached variants purge SkMaskCache before every draw to
+// show what each repeated shadow costs without it.
 class BlurRoundRectBench : public Benchmark {
 public:
-    BlurRoundRectBench(int width, int height, int cornerRadius)
-        : fName("blurroundrect") {
+    enum Shape {
+        kRRect_Shape,
+        kPath_Shape
+    };
+
+    BlurRoundRectBench(int width, int height, int cornerRadius,
+                       Shape shape = kRRect_Shape, bool cached = true)
+        : fName("blurroundrect")
+        , fShape(shape)
+        , fCached(cached) {
         fName.appendf("_WH[%ix%i]_cr[%i]", width, height, cornerRadius);
+        if (kPath_Shape == shape) {
+            fName.append("_path");
+        }
+        if (!cached) {
+            fName.append("_uncached");
+        }
         SkRect r = SkRect::MakeWH(SkIntToScalar(width), SkIntToScalar(height));
         fRRect.setRectXY(r, SkIntToScalar(cornerRadius), SkIntToScalar(cornerRadius));
+        fPath.addRRect(fRRect);
     }
 
     virtual const char* onGetName() SK_OVERRIDE {
@@ -72,14 +93,24 @@ public:
         loopedPaint.setColor(SK_ColorCYAN);
 
         for (int i = 0; i < loops; i++) {
+            if (!fCached) {
+                SkMaskCache::Purge();
+            }
             canvas->drawRect(fRRect.rect(), dullPaint);
-            canvas->drawRRect(fRRect, loopedPaint);
+            if (kPath_Shape == fShape) {
+                canvas->drawPath(fPath, loopedPaint);
+            } else {
+                canvas->drawRRect(fRRect, loopedPaint);
+            }
         }
     }
 
 private:
     SkString    fName;
     SkRRect     fRRect;
+    SkPath      fPath;
+    Shape       fShape;
+    bool        fCached;
 
     typedef     Benchmark INHERITED;
 };
@@ -91,3 +122,7 @@ DEF_BENCH(return new BlurRoundRectBench(100, 100, 6);)
 // Other radii options
 DEF_BENCH(return new BlurRoundRectBench(100, 100, 30);)
 DEF_BENCH(return new BlurRoundRectBench(100, 100, 90);)
+// A button-sized shadow, drawn with and without the mask cache
+DEF_BENCH(return new BlurRoundRectBench(100, 100, 6, BlurRoundRectBench::kRRect_Shape, false);)
+DEF_BENCH(return new BlurRoundRectBench(100, 100, 6, BlurRoundRectBench::kPath_Shape);)
+DEF_BENCH(return new BlurRoundRectBench(100, 100, 6, BlurRoundRectBench::kPath_Shape, false);)
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "CanvasContext2D.h"
+#include "SkCanvas.h"
+#include "SkString.h"
+
+/**
+ * Compares driving CanvasContext2D one method call at a time (the way the
+ * script bindings do today) against replaying the same frame from a
+ * pre-encoded command buffer through executeCommands(). Each frame is a run
+ * of small filled and stroked shapes with per-shape color and transform
+ * changes, which is the call pattern that dominates a typical game frame.
+ */
+class CanvasCommandBench : public Benchmark {
+public:
+    enum { kShapesPerFrame = 500 };
+
+    CanvasCommandBench(bool batched) : fBatched(batched) {
+        fName.printf("canvas_command_%s", batched ? "batched" : "direct");
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        static const char* gColors[] = { "#ff0000", "#00ff00", "#0000ff", "rgba(0,0,0,0.5)" };
+
+        fWriter.reset();
+        for (int i = 0; i < kShapesPerFrame; ++i) {
+            float x = SkIntToScalar(i % 25) * 16;
+            float y = SkIntToScalar(i / 25) * 16;
+            fWriter.save();
+            fWriter.translate(x, y);
+            fWriter.setFillColor(gColors[i & 3]);
+            fWriter.fillRect(0, 0, 12, 12);
+            fWriter.setStrokeColor(gColors[(i + 1) & 3]);
+            fWriter.setLineWidth(2);
+            fWriter.beginPath();
+            fWriter.moveTo(0, 0);
+            fWriter.lineTo(12, 12);
+            fWriter.stroke();
+            fWriter.restore();
+        }
+    }
+
+    virtual void onDraw(const int loops, SkCanvas* canvas) SK_OVERRIDE {
+        static const char* gColors[] = { "#ff0000", "#00ff00", "#0000ff", "rgba(0,0,0,0.5)" };
+
+        CanvasContext2D context(canvas);
+        for (int loop = 0; loop < loops; ++loop) {
+            if (fBatched) {
+                context.executeCommands(fWriter.data(), fWriter.size());
+                continue;
+            }
+            for (int i = 0; i < kShapesPerFrame; ++i) {
+                float x = SkIntToScalar(i % 25) * 16;
+                float y = SkIntToScalar(i / 25) * 16;
+                // The bindings hand over a fresh string per call.
+                context.save();
+                context.translate(x, y);
+                context.setFillColor(std::string(gColors[i & 3]));
+                context.fillRect(0, 0, 12, 12);
+                context.setStrokeColor(std::string(gColors[(i + 1) & 3]));
+                context.setLineWidth(2);
+                context.beginPath();
+                context.moveTo(0, 0);
+                context.lineTo(12, 12);
+                context.stroke();
+                context.restore();
+            }
+        }
+    }
+
+private:
+    SkString            fName;
+    bool                fBatched;
+    CanvasCommandWriter fWriter;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new CanvasCommandBench(false); )
+DEF_BENCH( return new CanvasCommandBench(true); )
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "CanvasContext2D.h"
+#include "SkCanvas.h"
+#include "SkString.h"
+
+/**
+ * A typical game frame where little changes: a striped background, a handful
+ * of small moving sprites and a score counter. The full variant repaints the
+ * whole canvas every frame. The partial variant relies on the canvas keeping
+ * last frame's pixels, the way CanvasBackingStore does: it repairs the
+ * background only under each sprite's old position and under the score, then
+ * draws the sprites at their new positions.
+ *
+ * Both variants track damage and reset it every frame, so the bookkeeping
+ * is part of what is timed.
+ */
+class CanvasDamageBench : public Benchmark {
+public:
+    enum {
+        kSprites = 8,
+        kSpriteSize = 24,
+        kStripes = 16
+    };
+
+    CanvasDamageBench(bool partial) : fPartial(partial) {
+        fName.printf("canvas_damage_%s", partial ? "partial" : "full");
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onDraw(const int loops, SkCanvas* canvas) SK_OVERRIDE {
+        SkISize size = canvas->getBaseLayerSize();
+        CanvasContext2D context(canvas);
+        context.setFont("16px sans-serif");
+        context.setTracksDamage(true);
+
+        this->drawBackground(context, SkRect::MakeWH(SkIntToScalar(size.width()), SkIntToScalar(size.height())));
+        context.resetDamage();
+
+        for (int loop = 0; loop < loops; ++loop) {
+            if (fPartial) {
+                for (int i = 0; i < kSprites; ++i) {
+                    this->drawBackground(context, spriteRect(i, loop - 1, size));
+                }
+                this->drawBackground(context, SkRect::MakeXYWH(0, 0, 160, 24));
+            } else {
+                this->drawBackground(context, SkRect::MakeWH(SkIntToScalar(size.width()), SkIntToScalar(size.height())));
+            }
+
+            context.setFillColor(std::string("#ff8000"));
+            for (int i = 0; i < kSprites; ++i) {
+                SkRect r = spriteRect(i, loop, size);
+                context.fillRect(r.x(), r.y(), r.width(), r.height());
+            }
+            SkString score;
+            score.printf("SCORE %d", loop * 10);
+            context.setFillColor(std::string("#ffffff"));
+            context.fillText(score.c_str(), 4, 18);
+
+            context.flush();
+            context.resetDamage();
+        }
+    }
+
+private:
+    static SkRect spriteRect(int sprite, int frame, const SkISize& size) {
+        int rangeX = SkTMax(size.width() - kSpriteSize, 1);
+        int rangeY = SkTMax(size.height() - kSpriteSize, 1);
+        int x = (sprite * 97 + frame * (sprite + 1)) % rangeX;
+        int y = (sprite * 61 + frame * 2) % rangeY;
+        return SkRect::MakeXYWH(SkIntToScalar(x), SkIntToScalar(y),
+                                SkIntToScalar(kSpriteSize), SkIntToScalar(kSpriteSize));
+    }
+
+    // Repaints the background inside |area| only.
+    void drawBackground(CanvasContext2D& context, const SkRect& area) {
+        SkISize size = context.canvas()->getBaseLayerSize();
+        SkScalar stripe = SkIntToScalar(size.height()) / kStripes;
+
+        context.save();
+        context.beginPath();
+        context.rect(area.x(), area.y(), area.width(), area.height());
+        context.clip();
+        for (int i = 0; i < kStripes; ++i) {
+            SkRect r = SkRect::MakeXYWH(0, i * stripe, SkIntToScalar(size.width()), stripe);
+            if (!SkRect::Intersects(r, area)) {
+                continue;
+            }
+            context.setFillColor(std::string(i & 1 ? "#203040" : "#304050"));
+            context.fillRect(r.x(), r.y(), r.width(), r.height());
+        }
+        context.restore();
+    }
+
+    SkString fName;
+    bool     fPartial;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new CanvasDamageBench(false); )
+DEF_BENCH( return new CanvasDamageBench(true); )
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "CanvasContext2D.h"
+#include "CanvasGradient.h"
+#include "CanvasStyle.h"
+#include "SkCanvas.h"
+#include "SkString.h"
+
+/**
+ * The pattern scripts use for health bars and button highlights: every frame
+ * creates the same gradients again with createLinearGradient/addColorStop
+ * and fills with them. The cached variant lets the context's
+ * GradientShaderCache hand back last frame's shaders; the uncached variant
+ * clears the cache before each frame, so every fill builds a new shader.
+ */
+class CanvasGradientBench : public Benchmark {
+public:
+    enum {
+        kBars = 8,
+        kBarHeight = 16
+    };
+
+    CanvasGradientBench(bool cached) : fCached(cached) {
+        fName.printf("canvas_gradient_recreate%s", cached ? "" : "_uncached");
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onDraw(const int loops, SkCanvas* canvas) SK_OVERRIDE {
+        CanvasContext2D context(canvas);
+
+        for (int loop = 0; loop < loops; ++loop) {
+            if (!fCached) {
+                context.gradientCache().clear();
+            }
+            for (int i = 0; i < kBars; ++i) {
+                float y = SkIntToScalar(i * (kBarHeight + 4));
+                RefPtr<CanvasGradient> gradient = context.createLinearGradient(0, y, 0, y + kBarHeight);
+                gradient->addColorStop(0, std::string(i & 1 ? "#40ff40" : "#ff4040"));
+                gradient->addColorStop(0.5f, std::string("#ffffff"));
+                gradient->addColorStop(1, std::string(i & 1 ? "#008000" : "#800000"));
+                context.setFillStyle(CanvasStyle::createFromGradient(gradient.release()));
+                context.fillRect(0, y, 200, kBarHeight);
+            }
+            context.flush();
+        }
+    }
+
+private:
+    SkString fName;
+    bool     fCached;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new CanvasGradientBench(true); )
+DEF_BENCH( return new CanvasGradientBench(false); )
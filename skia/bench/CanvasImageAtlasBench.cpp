@@ -0,0 +1,75 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "BitmapImage.h"
+#include "CanvasContext2D.h"
+#include "SkCanvas.h"
+#include "SkString.h"
+
+/**
+ * A frame of sprites drawn from many small images in no particular order,
+ * as a scene graph walking its display list does. Without the atlas each
+ * image is its own texture and consecutive sprites rarely share a batch;
+ * with it they are packed into one page and the whole frame can be a single
+ * batch. The first frame packs the images; after that every draw is a hit.
+ */
+class CanvasImageAtlasBench : public Benchmark {
+public:
+    enum {
+        kImages = 32,
+        kImageSize = 48,
+        kSprites = 256
+    };
+
+    CanvasImageAtlasBench(bool atlas) : fAtlas(atlas) {
+        fName.printf("canvas_image_atlas_%s", atlas ? "on" : "off");
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        for (int i = 0; i < kImages; ++i) {
+            fImages[i] = BitmapImage::create();
+            SkBitmap& bitmap = fImages[i]->bitmap();
+            bitmap.allocN32Pixels(kImageSize, kImageSize);
+            bitmap.eraseColor(SkColorSetARGB(0xFF, i * 8, 255 - i * 8, 0x80));
+        }
+    }
+
+    virtual void onDraw(const int loops, SkCanvas* canvas) SK_OVERRIDE {
+        SkISize size = canvas->getBaseLayerSize();
+        CanvasContext2D context(canvas);
+        context.setUsesImageAtlas(fAtlas);
+
+        for (int loop = 0; loop < loops; ++loop) {
+            if (context.imageAtlas()) {
+                context.imageAtlas()->beginFrame();
+            }
+            for (int i = 0; i < kSprites; ++i) {
+                BitmapImage* image = fImages[(i * 7 + loop) % kImages].get();
+                float x = static_cast<float>((i * 37) % SkTMax(size.width() - kImageSize, 1));
+                float y = static_cast<float>((i * 23) % SkTMax(size.height() - kImageSize, 1));
+                context.drawImage(image, x, y);
+            }
+            context.flush();
+        }
+    }
+
+private:
+    SkString             fName;
+    bool                 fAtlas;
+    RefPtr<BitmapImage>  fImages[kImages];
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new CanvasImageAtlasBench(false); )
+DEF_BENCH( return new CanvasImageAtlasBench(true); )
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "CanvasContext2D.h"
+#include "SkCanvas.h"
+#include "SkString.h"
+
+/**
+ * Builds a 10k point path through CanvasContext2D, optionally calling
+ * rotate()/translate() between segments the way animated particle trails and
+ * charting code do. The path is never drawn, so the timing is the cost of
+ * building it; with transforms interleaved it should stay close to the
+ * untransformed case instead of growing with the length of the path.
+ */
+class CanvasPathBench : public Benchmark {
+public:
+    enum {
+        kPoints = 10000,
+        kPointsPerTransform = 10
+    };
+
+    CanvasPathBench(bool transform) : fTransform(transform) {
+        fName.printf("canvas_path_10k_%s", transform ? "transform" : "fixed");
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onDraw(const int loops, SkCanvas* canvas) SK_OVERRIDE {
+        CanvasContext2D context(canvas);
+        for (int loop = 0; loop < loops; ++loop) {
+            context.save();
+            context.beginPath();
+            context.moveTo(0, 0);
+            for (int i = 1; i < kPoints; ++i) {
+                if (fTransform && !(i % kPointsPerTransform)) {
+                    context.rotate(0.001f);
+                    context.translate(0.05f, 0);
+                }
+                context.lineTo(SkIntToScalar(i % 640), SkIntToScalar((i * 7) % 480));
+            }
+            context.restore();
+        }
+    }
+
+private:
+    SkString fName;
+    bool     fTransform;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new CanvasPathBench(true); )
+DEF_BENCH( return new CanvasPathBench(false); )
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "CanvasContext2D.h"
+#include "SkCanvas.h"
+#include "SkString.h"
+
+/**
+ * Draws a frame of HUD style text (labels and scores that repeat every frame)
+ * through CanvasContext2D::fillText. The warm variant keeps the text layout
+ * cache between frames, which is the normal case; the cold variant clears it
+ * before every frame so each string is converted to glyphs and measured again.
+ */
+class CanvasTextBench : public Benchmark {
+public:
+    CanvasTextBench(bool warm) : fWarm(warm) {
+        fName.printf("canvas_text_layout_%s", warm ? "warm" : "cold");
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onDraw(const int loops, SkCanvas* canvas) SK_OVERRIDE {
+        static const char* gLabels[] = {
+            "SCORE", "HIGH SCORE", "LIVES", "LEVEL", "TIME", "COMBO x4",
+            "Press START to continue", "Player 1", "Player 2", "GAME OVER",
+        };
+        static const int kLabelCount = SK_ARRAY_COUNT(gLabels);
+
+        CanvasContext2D context(canvas);
+        context.setFont("16px sans-serif");
+        context.setFillColor(std::string("#ffffff"));
+        context.setTextAlign(CenterTextAlign);
+
+        for (int loop = 0; loop < loops; ++loop) {
+            if (!fWarm) {
+                context.textLayoutCache().clear();
+            }
+            for (int i = 0; i < kLabelCount; ++i) {
+                context.fillText(gLabels[i], 320, SkIntToScalar(20 + i * 20));
+            }
+        }
+    }
+
+private:
+    SkString fName;
+    bool     fWarm;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new CanvasTextBench(true); )
+DEF_BENCH( return new CanvasTextBench(false); )
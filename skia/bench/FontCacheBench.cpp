@@ -7,10 +7,12 @@
 
 #include "Benchmark.h"
 #include "SkCanvas.h"
+#include "SkCountdown.h"
 #include "SkFontHost.h"
 #include "SkPaint.h"
 #include "SkString.h"
 #include "SkTemplates.h"
+#include "SkThreadPool.h"
 
 #include "gUniqueGlyphIDs.h"
 #define gUniqueGlyphIDs_Sentinel    0xFFFF
@@ -53,6 +55,86 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Measures the same glyphs from several threads at once, the way tiled raster
+// and thumbnail workers do, to show how glyph cache lookups scale. Every
+// thread cycles through the same text sizes, so they share strikes. With
+// perfect scaling the time per loop stays flat as threads are added. The
+// threads are started in onPreDraw so their creation is not timed.
+class FontCacheThreadedBench : public Benchmark {
+public:
+    FontCacheThreadedBench(int threads) : fThreads(threads), fWorkers(threads), fDone(0) {
+        fName.printf("fontcache_threads_%d", threads);
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        if (NULL == fPool.get()) {
+            fPool.reset(SkNEW_ARGS(SkThreadPool, (fThreads)));
+        }
+    }
+
+    virtual void onDraw(const int loops, SkCanvas*) SK_OVERRIDE {
+        fDone.reset(fThreads);
+        for (int i = 0; i < fThreads; ++i) {
+            fWorkers[i].fLoops = loops;
+            fWorkers[i].fFirstSize = i;
+            fWorkers[i].fDone = &fDone;
+            fPool->add(&fWorkers[i]);
+        }
+        fDone.wait();
+    }
+
+private:
+    enum { kSizeCount = 8 };
+
+    struct Worker : public SkRunnable {
+        int fLoops;
+        int fFirstSize;
+        SkCountdown* fDone;
+
+        virtual void run() SK_OVERRIDE {
+            Measure(fLoops, fFirstSize);
+            fDone->run();
+        }
+    };
+
+    static void Measure(int loops, int firstSize) {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+
+        for (int i = 0; i < loops; ++i) {
+            int size = (firstSize + i) % kSizeCount;
+            paint.setTextSize(SkIntToScalar(10 + 2 * size));
+            const uint16_t* array = gUniqueGlyphIDs;
+            while (*array != gUniqueGlyphIDs_Sentinel) {
+                int count = count_glyphs(array);
+                paint.measureText(array, count * sizeof(uint16_t));
+                array += count + 1;    // skip the sentinel
+            }
+        }
+    }
+
+    SkString fName;
+    int fThreads;
+    SkAutoTArray<Worker> fWorkers;
+    // The last worker may still be signalling fDone after wait() returns, so
+    // it outlives the draw and is destroyed only after the pool has joined.
+    SkCountdown fDone;
+    SkAutoTDelete<SkThreadPool> fPool;
+    typedef Benchmark INHERITED;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 static uint32_t rotr(uint32_t value, unsigned bits) {
     return (value >> bits) | (value << (32 - bits));
 }
@@ -153,6 +235,10 @@ private:
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new FontCacheBench(); )
+DEF_BENCH( return new FontCacheThreadedBench(1); )
+DEF_BENCH( return new FontCacheThreadedBench(2); )
+DEF_BENCH( return new FontCacheThreadedBench(4); )
+DEF_BENCH( return new FontCacheThreadedBench(8); )
 
 // undefine this to run the efficiency test
 //DEF_BENCH( return new FontCacheEfficiency(); )
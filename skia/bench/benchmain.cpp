@@ -226,6 +226,7 @@ DEFINE_bool(forceAA,        true,     "Force anti-aliasing?");
 DEFINE_bool(forceFilter,    false,    "Force bitmap filtering?");
 DEFINE_string(forceDither, "default", "Force dithering: true, false, or default?");
 DEFINE_bool(forceBlend,     false,    "Force alpha blending?");
+DEFINE_bool(analyticAA,     false,    "Fill AA paths with analytic coverage instead of supersampling?");
 
 DEFINE_int32(gpuCacheBytes, -1, "GPU cache size limit in bytes.  0 to disable cache.");
 DEFINE_int32(gpuCacheCount, -1, "GPU cache size limit in object count.  0 to disable cache.");
@@ -279,6 +280,7 @@ int tool_main(int argc, char** argv) {
     }
 #endif
     SkAutoGraphics ag;
+    SkGraphics::SetAnalyticAAEnabled(FLAGS_analyticAA);
 
     // First, parse some flags.
     BenchLogger logger;
@@ -380,6 +382,7 @@ int tool_main(int argc, char** argv) {
     writer.option("mode", FLAGS_mode[0]);
     writer.option("alpha", SkStringPrintf("0x%02X", alpha).c_str());
     writer.option("antialias", SkStringPrintf("%d", FLAGS_forceAA).c_str());
+    writer.option("analyticAA", SkStringPrintf("%d", FLAGS_analyticAA).c_str());
     writer.option("filter", SkStringPrintf("%d", FLAGS_forceFilter).c_str());
     writer.option("dither",  SkTriState::Name[dither]);
 
@@ -1417,6 +1417,7 @@ static SkString pdfRasterizerUsage() {
 #define TOSTRING(x) TOSTRING_INTERNAL(x)
 
 // Alphabetized ignoring "no" prefix ("readPath", "noreplay", "resourcePath").
+DEFINE_bool(analyticAA, false, "Fill AA paths with analytic coverage instead of supersampling.");
 DEFINE_string(config, "", configUsage().c_str());
 DEFINE_string(pdfRasterizers, "default", pdfRasterizerUsage().c_str());
 DEFINE_bool(deferred, false, "Exercise the deferred rendering test pass.");
@@ -2227,6 +2228,7 @@ int tool_main(int argc, char** argv) {
 #endif
 
     SkGraphics::Init();
+    SkGraphics::SetAnalyticAAEnabled(FLAGS_analyticAA);
 
     setSystemPreferences();
     GMMain gmmain;
@@ -121,10 +121,29 @@ public:
     static size_t GetImageCacheSingleAllocationByteLimit();
     static size_t SetImageCacheSingleAllocationByteLimit(size_t newLimit);
 
+    /**
+     *  Return true if anti-aliased path fills on the raster backend compute
+     *  exact pixel coverage, or false if they sample each pixel 4x4 times.
+     *  Analytic coverage is an opt-in experiment, off unless the build
+     *  defines SK_ANALYTIC_AA_DEFAULT to true: where a path overlaps itself,
+     *  as strokes do at their inner joins, it is only approximate.
+     */
+    static bool GetAnalyticAAEnabled();
+
+    /**
+     *  Choose how anti-aliased path fills compute coverage (see
+     *  GetAnalyticAAEnabled), returning the previous choice. Inverse fills
+     *  always use the supersampler. Glyph masks already in the font cache
+     *  keep the coverage they were made with; call PurgeFontCache() after
+     *  switching if text has to match.
+     */
+    static bool SetAnalyticAAEnabled(bool enabled);
+
     /**
      *  Applications with command line options may pass optional state, such
      *  as cache sizes, here, for instance:
      *  font-cache-limit=12345678
+     *  analytic-aa=0
      *
      *  The flags format is name=value[;name=value...] with no spaces.
      *  This format is subject to change.
@@ -150,6 +150,13 @@ public:
      */
     virtual bool asABlur(BlurRec*) const;
 
+    /**
+     *  If the mask this filter makes from a device-space mask depends only on that mask and a
+     *  blur, return true and fill in the BlurRec with the blur's sigma in device space under the
+     *  given CTM. Unlike asABlur, blurs that ignore the CTM qualify. SkMaskCache keys on this.
+     */
+    virtual bool asADeviceBlur(const SkMatrix& ctm, BlurRec*) const;
+
     SK_TO_STRING_PUREVIRT()
     SK_DEFINE_FLATTENABLE_TYPE(SkMaskFilter)
 
@@ -198,6 +205,7 @@ protected:
 
 private:
     friend class SkDraw;
+    friend class SkMaskCache;
 
     /** Helper method that, given a path in device space, will rasterize it into a kA8_Format mask
      and then call filterMask(). If this returns true, the specified blitter will be called
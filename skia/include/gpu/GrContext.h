@@ -104,6 +104,47 @@ public:
      */
     void contextDestroyed();
 
+    /**
+     * Keeps the compiled binaries of the programs the context builds in the file at path and
+     * loads the ones saved there by an earlier run, so that those programs are not compiled
+     * again. A file written by a different driver is ignored. Returns false if the backend cannot
+     * read programs back as binaries, in which case programs are always compiled.
+     */
+    bool setProgramBinaryCachePath(const char path[]);
+
+    /**
+     * Writes binaries of programs built since the last save to the file given to
+     * setProgramBinaryCachePath(). Also done when the context is destroyed; call this when the
+     * process may be killed without that happening (e.g. an Android app going to background).
+     */
+    void saveProgramBinaries();
+
+    /**
+     * Loads the programs that the session which saved the program binary file used, in the order
+     * it first used them, so that draws find them linked. The first draw to use each program still
+     * generates its shader source, which is what identifies the program; only the driver compile
+     * and link are skipped. Meant to run while a splash or loading screen is up, on the thread
+     * that owns the GL context: programs are linked into that context, and neither it nor the
+     * binary cache can be used from another thread. Stops once it has run for maxMSecs; the
+     * programs it did not get to are loaded from their binaries when a draw first asks for them.
+     * Returns the number of programs loaded, 0 if setProgramBinaryCachePath() was not called or
+     * returned false.
+     */
+    int warmUpPrograms(SkMSec maxMSecs);
+
+    /**
+     * How the programs requested by draws were obtained since the context was created.
+     */
+    struct ProgramStats {
+        int fCacheHits;     //!< the program had already been built by this context
+        int fWarmUpHits;    //!< built from a binary loaded by warmUpPrograms()
+        int fBinaryHits;    //!< built from a binary loaded when the draw asked for it
+        int fCompiles;      //!< compiled from source
+        int fWarmedUp;      //!< binaries loaded by warmUpPrograms(), used or not
+    };
+
+    void getProgramStats(ProgramStats* stats) const;
+
     ///////////////////////////////////////////////////////////////////////////
     // Resource Cache
 
@@ -214,6 +214,7 @@ public:
         GLPtr<GrGLGetQueryObjectui64vProc> fGetQueryObjectui64v;
         GLPtr<GrGLGetQueryObjectuivProc> fGetQueryObjectuiv;
         GLPtr<GrGLGetQueryivProc> fGetQueryiv;
+        GLPtr<GrGLGetProgramBinaryProc> fGetProgramBinary;
         GLPtr<GrGLGetProgramInfoLogProc> fGetProgramInfoLog;
         GLPtr<GrGLGetProgramivProc> fGetProgramiv;
         GLPtr<GrGLGetRenderbufferParameterivProc> fGetRenderbufferParameteriv;
@@ -240,6 +241,8 @@ public:
         GLPtr<GrGLMatrixLoadIdentityProc> fMatrixLoadIdentity;
         GLPtr<GrGLPixelStoreiProc> fPixelStorei;
         GLPtr<GrGLPopGroupMarkerProc> fPopGroupMarker;
+        GLPtr<GrGLProgramBinaryProc> fProgramBinary;
+        GLPtr<GrGLProgramParameteriProc> fProgramParameteri;
         GLPtr<GrGLPushGroupMarkerProc> fPushGroupMarker;
         GLPtr<GrGLQueryCounterProc> fQueryCounter;
         GLPtr<GrGLReadBufferProc> fReadBuffer;
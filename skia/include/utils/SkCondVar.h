@@ -8,18 +8,19 @@
 #ifndef SkCondVar_DEFINED
 #define SkCondVar_DEFINED
 
-#ifdef SK_USE_POSIX_THREADS
-#include <pthread.h>
-#elif defined(SK_BUILD_FOR_WIN32)
+#include "SkTypes.h"
+
+#ifdef SK_BUILD_FOR_WIN32
 #include <windows.h>
+#else
+#include <pthread.h>
 #endif
 
 /**
  * Condition variable for blocking access to shared data from other threads and
  * controlling which threads are awake.
  *
- * Currently only supported on platforms with posix threads and Windows Vista and
- * above.
+ * Uses posix threads everywhere except Windows, which needs Vista or above.
  */
 class SkCondVar {
 public:
@@ -56,12 +57,12 @@ public:
     void broadcast();
 
 private:
-#ifdef SK_USE_POSIX_THREADS
-    pthread_mutex_t  fMutex;
-    pthread_cond_t   fCond;
-#elif defined(SK_BUILD_FOR_WIN32)
+#ifdef SK_BUILD_FOR_WIN32
     CRITICAL_SECTION   fCriticalSection;
     CONDITION_VARIABLE fCondition;
+#else
+    pthread_mutex_t  fMutex;
+    pthread_cond_t   fCond;
 #endif
 };
 
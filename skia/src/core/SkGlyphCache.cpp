@@ -16,6 +16,7 @@
 #include "SkPath.h"
 #include "SkTemplates.h"
 #include "SkTLS.h"
+#include "SkTraceEvent.h"
 #include "SkTypeface.h"
 
 //#define SPEW_PURGE_STATUS
@@ -80,6 +81,7 @@ SkGlyphCache::SkGlyphCache(SkTypeface* typeface, const SkDescriptor* desc, SkSca
     SkASSERT(ctx);
 
     fPrev = fNext = NULL;
+    fLastUse = 0;
 
     fDesc = desc->copy();
     fScalerContext->getFontMetrics(&fFontMetrics);
@@ -315,6 +317,7 @@ SkGlyph* SkGlyphCache::lookupMetrics(uint32_t id, MetricsType mtype) {
     }
 
     // not found, but hi tells us where to inser the new glyph
+    TRACE_EVENT0("skia", "SkGlyphCache::lookupMetrics miss");
     fMemoryUsed += sizeof(SkGlyph);
 
     glyph = (SkGlyph*)fGlyphAlloc.alloc(sizeof(SkGlyph),
@@ -461,11 +464,12 @@ size_t SkGlyphCache_Globals::setCacheSizeLimit(size_t newLimit) {
         newLimit = minLimit;
     }
 
-    SkAutoMutexAcquire    ac(fMutex);
+    SkAutoMutexAcquire    ac(fPurgeMutex);
 
     size_t prevLimit = fCacheSizeLimit;
     fCacheSizeLimit = newLimit;
-    this->internalPurge();
+    ac.release();
+    this->purge();
     return prevLimit;
 }
 
@@ -474,34 +478,37 @@ int SkGlyphCache_Globals::setCacheCountLimit(int newCount) {
         newCount = 0;
     }
 
-    SkAutoMutexAcquire    ac(fMutex);
+    SkAutoMutexAcquire    ac(fPurgeMutex);
 
     int prevCount = fCacheCountLimit;
     fCacheCountLimit = newCount;
-    this->internalPurge();
+    ac.release();
+    this->purge();
     return prevCount;
 }
 
 void SkGlyphCache_Globals::purgeAll() {
-    SkAutoMutexAcquire    ac(fMutex);
-    this->internalPurge(fTotalMemoryUsed);
+    // Asks for more than can be used, so every strike goes.
+    this->purge(~static_cast<size_t>(0));
 }
 
 void SkGlyphCache::VisitAllCaches(bool (*proc)(SkGlyphCache*, void*),
                                   void* context) {
     SkGlyphCache_Globals& globals = getGlobals();
-    SkAutoMutexAcquire    ac(globals.fMutex);
-    SkGlyphCache*         cache;
 
-    globals.validate();
+    for (int i = 0; i < globals.shardCount(); ++i) {
+        SkGlyphCache_Globals::Shard& shard = globals.shard(i);
+        SkAutoMutexAcquire    ac(shard.fMutex);
+        SkGlyphCache*         cache;
 
-    for (cache = globals.internalGetHead(); cache != NULL; cache = cache->fNext) {
-        if (proc(cache, context)) {
-            break;
+        globals.validate(shard);
+
+        for (cache = shard.fHead; cache != NULL; cache = cache->fNext) {
+            if (proc(cache, context)) {
+                return;
+            }
         }
     }
-
-    globals.validate();
 }
 
 /*  This guy calls the visitor from within the mutext lock, so the visitor
@@ -520,15 +527,16 @@ SkGlyphCache* SkGlyphCache::VisitCache(SkTypeface* typeface,
     SkASSERT(desc);
 
     SkGlyphCache_Globals& globals = getGlobals();
-    SkAutoMutexAcquire    ac(globals.fMutex);
+    SkGlyphCache_Globals::Shard& shard = globals.shardFor(*desc);
+    SkAutoMutexAcquire    ac(shard.fMutex);
     SkGlyphCache*         cache;
     bool                  insideMutex = true;
 
-    globals.validate();
+    globals.validate(shard);
 
-    for (cache = globals.internalGetHead(); cache != NULL; cache = cache->fNext) {
+    for (cache = shard.fHead; cache != NULL; cache = cache->fNext) {
         if (cache->fDesc->equals(*desc)) {
-            globals.internalDetachCache(cache);
+            globals.internalDetachCache(shard, cache);
             goto FOUND_IT;
         }
     }
@@ -560,7 +568,7 @@ FOUND_IT:
 
     if (!proc(cache, context)) {   // need to reattach
         if (insideMutex) {
-            globals.internalAttachCacheToHead(cache);
+            globals.internalAttachCacheToHead(shard, cache);
         } else {
             globals.attachCacheToHead(cache);
         }
@@ -579,43 +587,43 @@ void SkGlyphCache::AttachCache(SkGlyphCache* cache) {
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkGlyphCache_Globals::attachCacheToHead(SkGlyphCache* cache) {
-    SkAutoMutexAcquire    ac(fMutex);
+    Shard& shard = this->shardFor(*cache->fDesc);
+    {
+        SkAutoMutexAcquire    ac(shard.fMutex);
 
-    this->validate();
-    cache->validate();
+        this->validate(shard);
+        cache->validate();
 
-    this->internalAttachCacheToHead(cache);
-    this->internalPurge();
-}
-
-SkGlyphCache* SkGlyphCache_Globals::internalGetTail() const {
-    SkGlyphCache* cache = fHead;
-    if (cache) {
-        while (cache->fNext) {
-            cache = cache->fNext;
-        }
+        this->internalAttachCacheToHead(shard, cache);
+    }
+    if (this->isOverBudget()) {
+        this->purge();
     }
-    return cache;
 }
 
-size_t SkGlyphCache_Globals::internalPurge(size_t minBytesNeeded) {
-    this->validate();
+size_t SkGlyphCache_Globals::purge(size_t minBytesNeeded) {
+    // One purge at a time, so two threads over budget do not both purge.
+    SkAutoMutexAcquire    ac(fPurgeMutex);
+
+    // The shards change the totals with atomics, without this mutex.
+    size_t totalMemoryUsed = this->getTotalMemoryUsed();
+    int cacheCount = this->getCacheCountUsed();
 
     size_t bytesNeeded = 0;
-    if (fTotalMemoryUsed > fCacheSizeLimit) {
-        bytesNeeded = fTotalMemoryUsed - fCacheSizeLimit;
+    if (totalMemoryUsed > fCacheSizeLimit) {
+        bytesNeeded = totalMemoryUsed - fCacheSizeLimit;
     }
     bytesNeeded = SkTMax(bytesNeeded, minBytesNeeded);
     if (bytesNeeded) {
         // no small purges!
-        bytesNeeded = SkTMax(bytesNeeded, fTotalMemoryUsed >> 2);
+        bytesNeeded = SkTMax(bytesNeeded, totalMemoryUsed >> 2);
     }
 
     int countNeeded = 0;
-    if (fCacheCount > fCacheCountLimit) {
-        countNeeded = fCacheCount - fCacheCountLimit;
+    if (cacheCount > fCacheCountLimit) {
+        countNeeded = cacheCount - fCacheCountLimit;
         // no small purges!
-        countNeeded = SkMax32(countNeeded, fCacheCount >> 2);
+        countNeeded = SkMax32(countNeeded, cacheCount >> 2);
     }
 
     // early exit
@@ -626,22 +634,16 @@ size_t SkGlyphCache_Globals::internalPurge(size_t minBytesNeeded) {
     size_t  bytesFreed = 0;
     int     countFreed = 0;
 
-    // we start at the tail and proceed backwards, as the linklist is in LRU
-    // order, with unimportant entries at the tail.
-    SkGlyphCache* cache = this->internalGetTail();
-    while (cache != NULL &&
-           (bytesFreed < bytesNeeded || countFreed < countNeeded)) {
-        SkGlyphCache* prev = cache->fPrev;
+    while (bytesFreed < bytesNeeded || countFreed < countNeeded) {
+        SkGlyphCache* cache = this->detachLeastRecentlyUsed();
+        if (NULL == cache) {
+            break;
+        }
         bytesFreed += cache->fMemoryUsed;
         countFreed += 1;
-
-        this->internalDetachCache(cache);
         SkDELETE(cache);
-        cache = prev;
     }
 
-    this->validate();
-
 #ifdef SPEW_PURGE_STATUS
     if (countFreed) {
         SkDebugf("purging %dK from font cache [%d entries]\n",
@@ -652,30 +654,69 @@ size_t SkGlyphCache_Globals::internalPurge(size_t minBytesNeeded) {
     return bytesFreed;
 }
 
-void SkGlyphCache_Globals::internalAttachCacheToHead(SkGlyphCache* cache) {
+SkGlyphCache* SkGlyphCache_Globals::detachLeastRecentlyUsed() {
+    // Each shard's list is in LRU order, so the least recently used strike in
+    // the whole cache is the oldest of the shard tails. Costs a lock per shard
+    // for every strike purged, which purges are rare enough to afford.
+    for (;;) {
+        Shard* oldestShard = NULL;
+        SkGlyphCache* oldest = NULL;
+        for (int i = 0; i < fShardCount; ++i) {
+            SkAutoMutexAcquire    shardLock(fShards[i].fMutex);
+            SkGlyphCache* tail = fShards[i].fTail;
+            // The clock may wrap, so compare the difference.
+            if (tail && (NULL == oldest || (int32_t)(tail->fLastUse - oldest->fLastUse) < 0)) {
+                oldestShard = &fShards[i];
+                oldest = tail;
+            }
+        }
+        if (NULL == oldest) {
+            return NULL;
+        }
+
+        // Strikes are only deleted by purges, which hold fPurgeMutex, so
+        // oldest is still alive; but a lookup may have moved it since the scan.
+        SkAutoMutexAcquire    shardLock(oldestShard->fMutex);
+        if (oldestShard->fTail == oldest) {
+            this->internalDetachCache(*oldestShard, oldest);
+            return oldest;
+        }
+    }
+}
+
+void SkGlyphCache_Globals::internalAttachCacheToHead(Shard& shard, SkGlyphCache* cache) {
     SkASSERT(NULL == cache->fPrev && NULL == cache->fNext);
-    if (fHead) {
-        fHead->fPrev = cache;
-        cache->fNext = fHead;
+    cache->fLastUse = (uint32_t)sk_atomic_inc(&fUseClock);
+    if (shard.fHead) {
+        shard.fHead->fPrev = cache;
+        cache->fNext = shard.fHead;
+    } else {
+        shard.fTail = cache;
     }
-    fHead = cache;
+    shard.fHead = cache;
 
-    fCacheCount += 1;
-    fTotalMemoryUsed += cache->fMemoryUsed;
+    shard.fCacheCount += 1;
+    shard.fMemoryUsed += cache->fMemoryUsed;
+    sk_atomic_inc(&fCacheCount);
+    sk_atomic_add(&fTotalMemoryUsed, (int32_t)cache->fMemoryUsed);
 }
 
-void SkGlyphCache_Globals::internalDetachCache(SkGlyphCache* cache) {
-    SkASSERT(fCacheCount > 0);
-    fCacheCount -= 1;
-    fTotalMemoryUsed -= cache->fMemoryUsed;
+void SkGlyphCache_Globals::internalDetachCache(Shard& shard, SkGlyphCache* cache) {
+    SkASSERT(shard.fCacheCount > 0);
+    shard.fCacheCount -= 1;
+    shard.fMemoryUsed -= cache->fMemoryUsed;
+    sk_atomic_dec(&fCacheCount);
+    sk_atomic_add(&fTotalMemoryUsed, -(int32_t)cache->fMemoryUsed);
 
     if (cache->fPrev) {
         cache->fPrev->fNext = cache->fNext;
     } else {
-        fHead = cache->fNext;
+        shard.fHead = cache->fNext;
     }
     if (cache->fNext) {
         cache->fNext->fPrev = cache->fPrev;
+    } else {
+        shard.fTail = cache->fPrev;
     }
     cache->fPrev = cache->fNext = NULL;
 }
@@ -701,19 +742,22 @@ void SkGlyphCache::validate() const {
 #endif
 }
 
-void SkGlyphCache_Globals::validate() const {
+void SkGlyphCache_Globals::validate(const Shard& shard) const {
     size_t computedBytes = 0;
     int computedCount = 0;
 
-    const SkGlyphCache* head = fHead;
+    const SkGlyphCache* head = shard.fHead;
+    const SkGlyphCache* tail = NULL;
     while (head != NULL) {
         computedBytes += head->fMemoryUsed;
         computedCount += 1;
+        tail = head;
         head = head->fNext;
     }
 
-    SkASSERT(fTotalMemoryUsed == computedBytes);
-    SkASSERT(fCacheCount == computedCount);
+    SkASSERT(shard.fMemoryUsed == computedBytes);
+    SkASSERT(shard.fCacheCount == computedCount);
+    SkASSERT(shard.fTail == tail);
 }
 
 #endif
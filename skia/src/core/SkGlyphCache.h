@@ -31,8 +31,9 @@ class SkGlyphCache_Globals;
     either instantly if it is already cached, or by first generating it and then
     adding it to the strike.
 
-    The strikes are held in a global list, available to all threads. To interact
-    with one, call either VisitCache() or DetachCache().
+    The strikes are held in a global cache, available to all threads, that is
+    split into shards by descriptor so threads using different strikes do not
+    contend. To interact with one, call either VisitCache() or DetachCache().
 */
 class SkGlyphCache {
 public:
@@ -202,6 +203,9 @@ private:
     static bool DetachProc(const SkGlyphCache*, void*) { return true; }
 
     SkGlyphCache*       fNext, *fPrev;
+    // SkGlyphCache_Globals' use clock when this was last attached; orders the
+    // tails of its shards for purging.
+    uint32_t            fLastUse;
     SkDescriptor*       fDesc;
     SkScalerContext*    fScalerContext;
     SkPaint::FontMetrics fFontMetrics;
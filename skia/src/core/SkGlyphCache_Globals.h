@@ -9,6 +9,7 @@
 #define SkGlyphCache_Globals_DEFINED
 
 #include "SkGlyphCache.h"
+#include "SkThread.h"
 #include "SkTLS.h"
 
 #ifndef SK_DEFAULT_FONT_CACHE_COUNT_LIMIT
@@ -23,6 +24,15 @@
 
 class SkMutex;
 
+/*  The strikes are spread over shards by descriptor checksum. Each shard is an
+    LRU list with its own mutex, so threads looking up different strikes do not
+    wait on each other. The budget is still global: the totals are kept with
+    atomics across all shards. Every attach stamps the strike from a shared
+    use clock, and a purge compares the shard tails' stamps so it still
+    evicts in global LRU order.
+
+    Lock order: fPurgeMutex, then at most one shard mutex at a time.
+*/
 class SkGlyphCache_Globals {
 public:
     enum UseMutex {
@@ -30,39 +40,66 @@ public:
         kYes_UseMutex  // shared cache
     };
 
+    enum {
+        kShardBits = 3,
+        kShardCount = 1 << kShardBits
+    };
+
     SkGlyphCache_Globals(UseMutex um) {
-        fHead = NULL;
         fTotalMemoryUsed = 0;
         fCacheSizeLimit = SK_DEFAULT_FONT_CACHE_LIMIT;
         fCacheCount = 0;
         fCacheCountLimit = SK_DEFAULT_FONT_CACHE_COUNT_LIMIT;
+        fUseClock = 0;
 
-        fMutex = (kYes_UseMutex == um) ? SkNEW(SkMutex) : NULL;
+        // A thread-local cache has no one to contend with, so it keeps a
+        // single list.
+        fShardCount = (kYes_UseMutex == um) ? kShardCount : 1;
+        for (int i = 0; i < fShardCount; ++i) {
+            fShards[i].fMutex = (kYes_UseMutex == um) ? SkNEW(SkMutex) : NULL;
+        }
+        fPurgeMutex = (kYes_UseMutex == um) ? SkNEW(SkMutex) : NULL;
     }
 
     ~SkGlyphCache_Globals() {
-        SkGlyphCache* cache = fHead;
-        while (cache) {
-            SkGlyphCache* next = cache->fNext;
-            SkDELETE(cache);
-            cache = next;
+        for (int i = 0; i < fShardCount; ++i) {
+            SkGlyphCache* cache = fShards[i].fHead;
+            while (cache) {
+                SkGlyphCache* next = cache->fNext;
+                SkDELETE(cache);
+                cache = next;
+            }
+            SkDELETE(fShards[i].fMutex);
         }
 
-        SkDELETE(fMutex);
+        SkDELETE(fPurgeMutex);
     }
 
-    SkMutex*        fMutex;
+    struct Shard {
+        Shard() : fMutex(NULL), fHead(NULL), fTail(NULL), fCacheCount(0), fMemoryUsed(0) {}
 
-    SkGlyphCache* internalGetHead() const { return fHead; }
-    SkGlyphCache* internalGetTail() const;
+        SkMutex*        fMutex;
+        SkGlyphCache*   fHead;
+        SkGlyphCache*   fTail;
+        int             fCacheCount;
+        size_t          fMemoryUsed;
+    };
 
-    size_t getTotalMemoryUsed() const { return fTotalMemoryUsed; }
-    int getCacheCountUsed() const { return fCacheCount; }
+    Shard& shardFor(const SkDescriptor& desc) {
+        return fShards[desc.getChecksum() & (fShardCount - 1)];
+    }
+    int shardCount() const { return fShardCount; }
+    Shard& shard(int index) { return fShards[index]; }
+
+    // Read without a lock while other threads change them.
+    size_t getTotalMemoryUsed() const { return sk_acquire_load(&fTotalMemoryUsed); }
+    int getCacheCountUsed() const { return sk_acquire_load(&fCacheCount); }
 
 #ifdef SK_DEBUG
-    void validate() const;
+    // can only be called when the shard's mutex is already held
+    void validate(const Shard&) const;
 #else
-    void validate() const {}
+    void validate(const Shard&) const {}
 #endif
 
     int getCacheCountLimit() const { return fCacheCountLimit; }
@@ -74,8 +111,8 @@ public:
     // returns true if this cache is over-budget either due to size limit
     // or count limit.
     bool isOverBudget() const {
-        return fCacheCount > fCacheCountLimit ||
-               fTotalMemoryUsed > fCacheSizeLimit;
+        return this->getCacheCountUsed() > fCacheCountLimit ||
+               this->getTotalMemoryUsed() > fCacheSizeLimit;
     }
 
     void purgeAll(); // does not change budget
@@ -83,9 +120,9 @@ public:
     // call when a glyphcache is available for caching (i.e. not in use)
     void attachCacheToHead(SkGlyphCache*);
 
-    // can only be called when the mutex is already held
-    void internalDetachCache(SkGlyphCache*);
-    void internalAttachCacheToHead(SkGlyphCache*);
+    // can only be called when the shard's mutex is already held
+    void internalDetachCache(Shard&, SkGlyphCache*);
+    void internalAttachCacheToHead(Shard&, SkGlyphCache*);
 
     // can return NULL
     static SkGlyphCache_Globals* FindTLS() {
@@ -99,16 +136,25 @@ public:
     static void DeleteTLS() { SkTLS::Delete(CreateTLS); }
 
 private:
-    SkGlyphCache* fHead;
-    size_t  fTotalMemoryUsed;
+    Shard   fShards[kShardCount];
+    int     fShardCount;
+    SkMutex* fPurgeMutex;
+    int32_t fUseClock;
+
+    // Updated with atomics, since the shards change them under their own
+    // mutexes.
+    int32_t fTotalMemoryUsed;
+    int32_t fCacheCount;
     size_t  fCacheSizeLimit;
     int32_t fCacheCountLimit;
-    int32_t fCacheCount;
 
     // Checkout budgets, modulated by the specified min-bytes-needed-to-purge,
     // and attempt to purge caches to match.
     // Returns number of bytes freed.
-    size_t internalPurge(size_t minBytesNeeded = 0);
+    size_t purge(size_t minBytesNeeded = 0);
+    // Detaches the least recently used strike of all shards, or returns NULL
+    // if they are empty. Called with fPurgeMutex held.
+    SkGlyphCache* detachLeastRecentlyUsed();
 
     static void* CreateTLS() {
         return SkNEW_ARGS(SkGlyphCache_Globals, (kNo_UseMutex));
@@ -136,12 +136,20 @@ void SkGraphics::Term() {
 static const char kFontCacheLimitStr[] = "font-cache-limit";
 static const size_t kFontCacheLimitLen = sizeof(kFontCacheLimitStr) - 1;
 
+static const char kAnalyticAAStr[] = "analytic-aa";
+static const size_t kAnalyticAALen = sizeof(kAnalyticAAStr) - 1;
+
+static size_t set_analytic_aa(size_t enabled) {
+    return SkGraphics::SetAnalyticAAEnabled(0 != enabled);
+}
+
 static const struct {
     const char* fStr;
     size_t fLen;
     size_t (*fFunc)(size_t);
 } gFlags[] = {
-    { kFontCacheLimitStr, kFontCacheLimitLen, SkGraphics::SetFontCacheLimit }
+    { kFontCacheLimitStr, kFontCacheLimitLen, SkGraphics::SetFontCacheLimit },
+    { kAnalyticAAStr, kAnalyticAALen, set_analytic_aa }
 };
 
 /* flags are of the form param; or param=value; */
@@ -0,0 +1,327 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkMaskCache.h"
+#include "SkChecksum.h"
+#include "SkDraw.h"
+#include "SkMaskFilter.h"
+#include "SkPath.h"
+#include "SkRRect.h"
+#include "SkTDynamicHash.h"
+#include "SkThread.h"
+
+// Paths with more points than this are rare for shadows and expensive to key.
+static const int kMaxPathPoints = 256;
+
+enum KeyType {
+    kPath_KeyType,
+    kRRectNine_KeyType,
+};
+
+void SkMaskCache::Key::finish() {
+    fHash = SkChecksum::Murmur3(fData.begin(), this->size());
+}
+
+bool SkMaskCache::Key::operator==(const Key& other) const {
+    return fHash == other.fHash &&
+           fData.count() == other.fData.count() &&
+           !memcmp(fData.begin(), other.fData.begin(), this->size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static int32_t gNextEntryID;
+
+SkMaskCache::Entry::Entry(const Key& key, const SkMask& mask, const SkIRect& outerRect,
+                          const SkIPoint& center)
+    : fKey(key)
+    , fMask(mask)
+    , fOuterRect(outerRect)
+    , fCenter(center)
+    , fUniqueID(sk_atomic_inc(&gNextEntryID) + 1) {
+}
+
+SkMaskCache::Entry::~Entry() {
+    SkMask::FreeImage(fMask.fImage);
+}
+
+size_t SkMaskCache::Entry::bytesUsed() const {
+    return sizeof(*this) + fKey.size() + fMask.computeTotalImageSize();
+}
+
+class SkMaskCache::Hash : public SkTDynamicHash<SkMaskCache::Entry, SkMaskCache::Key> {};
+
+SkMaskCache::SkMaskCache(size_t byteLimit)
+    : fHash(SkNEW(Hash))
+    , fBytesUsed(0)
+    , fByteLimit(byteLimit) {
+    sk_bzero(&fStats, sizeof(fStats));
+}
+
+SkMaskCache::~SkMaskCache() {
+    this->purgeAll();
+    SkDELETE(fHash);
+}
+
+SkMaskCache::Entry* SkMaskCache::findAndRef(const Key& key) {
+    Entry* entry = fHash->find(key);
+    if (NULL == entry) {
+        fStats.fMisses++;
+        return NULL;
+    }
+    fStats.fHits++;
+    this->moveToHead(entry);
+    entry->ref();
+    return entry;
+}
+
+SkMaskCache::Entry* SkMaskCache::addAndRef(const Key& key, const SkMask& mask,
+                                           const SkIRect& outerRect, const SkIPoint& center) {
+    Entry* entry = fHash->find(key);
+    if (entry) {
+        SkMask::FreeImage(mask.fImage);
+        this->moveToHead(entry);
+        entry->ref();
+        return entry;
+    }
+
+    entry = SkNEW_ARGS(Entry, (key, mask, outerRect, center));
+    if (entry->bytesUsed() > fByteLimit) {
+        return entry;
+    }
+    fHash->add(entry);
+    fLRU.addToHead(entry);
+    fBytesUsed += entry->bytesUsed();
+    // One ref for the cache, one for the caller.
+    entry->ref();
+    this->purgeAsNeeded();
+    return entry;
+}
+
+size_t SkMaskCache::setTotalByteLimit(size_t newLimit) {
+    size_t prevLimit = fByteLimit;
+    fByteLimit = newLimit;
+    if (newLimit < prevLimit) {
+        this->purgeAsNeeded();
+    }
+    return prevLimit;
+}
+
+void SkMaskCache::purgeAll() {
+    size_t limit = fByteLimit;
+    fByteLimit = 0;
+    this->purgeAsNeeded();
+    fByteLimit = limit;
+}
+
+void SkMaskCache::moveToHead(Entry* entry) {
+    if (fLRU.head() != entry) {
+        fLRU.remove(entry);
+        fLRU.addToHead(entry);
+    }
+}
+
+void SkMaskCache::purgeAsNeeded() {
+    while (fBytesUsed > fByteLimit) {
+        Entry* entry = fLRU.tail();
+        if (NULL == entry) {
+            break;
+        }
+        fLRU.remove(entry);
+        fHash->remove(Entry::GetKey(*entry));
+        fBytesUsed -= entry->bytesUsed();
+        fStats.fEvictions++;
+        entry->unref();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SK_DECLARE_STATIC_MUTEX(gMutex);
+static SkMaskCache* gMaskCache = NULL;
+static void cleanup_gMaskCache() {
+    // See cleanup_gScaledImageCache.
+#if SK_DEVELOPER
+    SkDELETE(gMaskCache);
+#endif
+}
+
+/** Must hold gMutex when calling. */
+static SkMaskCache* get_cache() {
+    gMutex.assertHeld();
+    if (NULL == gMaskCache) {
+        gMaskCache = SkNEW_ARGS(SkMaskCache, (SK_DEFAULT_MASK_CACHE_LIMIT));
+        atexit(cleanup_gMaskCache);
+    }
+    return gMaskCache;
+}
+
+static SkMaskCache::Entry* find_and_ref(const SkMaskCache::Key& key) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->findAndRef(key);
+}
+
+static SkMaskCache::Entry* add_and_ref(const SkMaskCache::Key& key, const SkMask& mask,
+                                       const SkIRect& outerRect, const SkIPoint& center) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->addAndRef(key, mask, outerRect, center);
+}
+
+static void add_blur(SkMaskCache::Key* key, const SkMaskFilter::BlurRec& blur) {
+    key->addScalar(blur.fSigma);
+    key->add(blur.fStyle);
+    key->add(blur.fQuality);
+}
+
+// The whole pixel the shape is moved by to put its top-left in [0,1).
+static SkIPoint origin_for(const SkRect& bounds) {
+    return SkIPoint::Make(SkScalarFloorToInt(bounds.fLeft), SkScalarFloorToInt(bounds.fTop));
+}
+
+SkMaskCache::Entry* SkMaskCache::FindOrCreatePathMask(const SkPath& devPath,
+                                                      SkPaint::Style style,
+                                                      const SkMaskFilter& filter,
+                                                      const SkMatrix& matrix,
+                                                      const SkIRect& clipBounds,
+                                                      SkIPoint* origin) {
+    SkMaskFilter::BlurRec blur;
+    if (devPath.isEmpty() || devPath.countPoints() > kMaxPathPoints ||
+        !filter.asADeviceBlur(matrix, &blur)) {
+        return NULL;
+    }
+    // SkDraw::DrawToMask trims the source mask to the clip; a mask made
+    // without the clip is only the same if nothing would have been trimmed.
+    SkRect pathBounds = devPath.getBounds();
+    pathBounds.outset(SK_Scalar1, SK_Scalar1);
+    SkIRect pathIBounds;
+    pathBounds.roundOut(&pathIBounds);
+    if (!clipBounds.contains(pathIBounds)) {
+        return NULL;
+    }
+
+    *origin = origin_for(devPath.getBounds());
+    SkScalar dx = -SkIntToScalar(origin->fX);
+    SkScalar dy = -SkIntToScalar(origin->fY);
+
+    Key key;
+    key.add(kPath_KeyType);
+    key.add(style);
+    key.add(devPath.getFillType());
+    add_blur(&key, blur);
+    SkPath::RawIter iter(devPath);
+    SkPath::Verb verb;
+    SkPoint pts[4];
+    while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+        key.add(verb);
+        int first = 1;
+        int last = 0;
+        switch (verb) {
+            case SkPath::kMove_Verb:  first = 0; last = 0; break;
+            case SkPath::kLine_Verb:  last = 1; break;
+            case SkPath::kQuad_Verb:  last = 2; break;
+            case SkPath::kConic_Verb: last = 2; key.addScalar(iter.conicWeight()); break;
+            case SkPath::kCubic_Verb: last = 3; break;
+            default: break;
+        }
+        for (int i = first; i <= last; ++i) {
+            key.addScalar(pts[i].fX + dx);
+            key.addScalar(pts[i].fY + dy);
+        }
+    }
+    key.finish();
+
+    Entry* entry = find_and_ref(key);
+    if (entry) {
+        return entry;
+    }
+
+    SkPath path;
+    devPath.offset(dx, dy, &path);
+    SkMask srcM, dstM;
+    if (!SkDraw::DrawToMask(path, NULL, &filter, &matrix, &srcM,
+                            SkMask::kComputeBoundsAndRenderImage_CreateMode, style)) {
+        return NULL;
+    }
+    SkAutoMaskFreeImage autoSrc(srcM.fImage);
+    if (!filter.filterMask(&dstM, srcM, matrix, NULL)) {
+        return NULL;
+    }
+    return add_and_ref(key, dstM, SkIRect::MakeEmpty(), SkIPoint::Make(0, 0));
+}
+
+SkMaskCache::Entry* SkMaskCache::FindOrCreateRRectNine(const SkRRect& devRRect,
+                                                       const SkMaskFilter& filter,
+                                                       const SkMatrix& matrix,
+                                                       const SkIRect& clipBounds,
+                                                       SkIPoint* origin) {
+    SkMaskFilter::BlurRec blur;
+    if (!filter.asADeviceBlur(matrix, &blur)) {
+        return NULL;
+    }
+
+    *origin = origin_for(devRRect.rect());
+    SkScalar dx = -SkIntToScalar(origin->fX);
+    SkScalar dy = -SkIntToScalar(origin->fY);
+    SkRRect rrect = devRRect;
+    rrect.offset(dx, dy);
+
+    Key key;
+    key.add(kRRectNine_KeyType);
+    add_blur(&key, blur);
+    const SkRect& r = rrect.rect();
+    key.addScalar(r.fLeft);
+    key.addScalar(r.fTop);
+    key.addScalar(r.fRight);
+    key.addScalar(r.fBottom);
+    for (int i = 0; i < 4; ++i) {
+        const SkVector& radii = rrect.radii((SkRRect::Corner)i);
+        key.addScalar(radii.fX);
+        key.addScalar(radii.fY);
+    }
+    key.finish();
+
+    Entry* entry = find_and_ref(key);
+    if (entry) {
+        return entry;
+    }
+
+    // filterRRectToNine ignores the clip, so the patch does not depend on it.
+    SkIRect clip = clipBounds;
+    clip.offset(-origin->fX, -origin->fY);
+    SkMaskFilter::NinePatch patch;
+    patch.fMask.fImage = NULL;
+    if (SkMaskFilter::kTrue_FilterReturn != filter.filterRRectToNine(rrect, matrix, clip, &patch)) {
+        SkASSERT(NULL == patch.fMask.fImage);
+        return NULL;
+    }
+    return add_and_ref(key, patch.fMask, patch.fOuterRect, patch.fCenter);
+}
+
+size_t SkMaskCache::GetTotalBytesUsed() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->getTotalBytesUsed();
+}
+
+size_t SkMaskCache::GetTotalByteLimit() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->getTotalByteLimit();
+}
+
+size_t SkMaskCache::SetTotalByteLimit(size_t newLimit) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->setTotalByteLimit(newLimit);
+}
+
+void SkMaskCache::GetStats(Stats* stats) {
+    SkAutoMutexAcquire am(gMutex);
+    *stats = get_cache()->getStats();
+}
+
+void SkMaskCache::Purge() {
+    SkAutoMutexAcquire am(gMutex);
+    get_cache()->purgeAll();
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMaskCache_DEFINED
+#define SkMaskCache_DEFINED
+
+#include "SkMask.h"
+#include "SkPaint.h"
+#include "SkRect.h"
+#include "SkRefCnt.h"
+#include "SkTDArray.h"
+#include "SkTInternalLList.h"
+
+class SkMaskFilter;
+class SkMatrix;
+class SkPath;
+class SkRRect;
+
+#ifndef SK_DEFAULT_MASK_CACHE_LIMIT
+    #define SK_DEFAULT_MASK_CACHE_LIMIT     (2 * 1024 * 1024)
+#endif
+
+/**
+ *  Process-wide cache of blurred masks, so a shape drawn again with the same
+ *  blur (a button shadow repeated down a list, or redrawn every frame) is
+ *  blitted from the cached mask instead of being rasterized and blurred again.
+ *
+ *  Shapes are keyed in device space, moved by a whole number of pixels so
+ *  their bounds start in the [0,1) pixel: the same shape at another integer
+ *  position hits, while a different sub-pixel phase does not. The blur is
+ *  keyed by its device-space sigma (SkMaskFilter::asADeviceBlur), so the CTM
+ *  only matters through the sigma it produces. Entries are evicted least
+ *  recently used first once the cache holds more than its byte limit.
+ *
+ *  All static methods are thread-safe.
+ */
+class SkMaskCache {
+public:
+    class Key {
+    public:
+        Key() : fHash(0) {}
+
+        void reset() { fData.rewind(); fHash = 0; }
+        void add(uint32_t value) { *fData.append() = value; }
+        void addScalar(SkScalar value) { this->add(SkFloat2Bits(value)); }
+        void finish();
+
+        uint32_t hash() const { return fHash; }
+        size_t size() const { return fData.count() * sizeof(uint32_t); }
+        bool operator==(const Key&) const;
+
+    private:
+        SkTDArray<uint32_t> fData;
+        uint32_t            fHash;
+    };
+
+    class Entry : public SkRefCnt {
+    public:
+        virtual ~Entry();
+
+        /** fBounds is relative to the origin returned with the entry. */
+        const SkMask& mask() const { return fMask; }
+        /** For nine-patch entries, how to stretch the mask; relative to the origin. */
+        const SkIRect& outerRect() const { return fOuterRect; }
+        const SkIPoint& center() const { return fCenter; }
+        /** Never reused, so it can key a texture made from this mask. */
+        uint32_t uniqueID() const { return fUniqueID; }
+
+        static const Key& GetKey(const Entry& entry) { return entry.fKey; }
+        static uint32_t Hash(const Key& key) { return key.hash(); }
+
+    private:
+        Entry(const Key&, const SkMask&, const SkIRect& outerRect, const SkIPoint& center);
+        size_t bytesUsed() const;
+
+        Key      fKey;
+        SkMask   fMask;
+        SkIRect  fOuterRect;
+        SkIPoint fCenter;
+        uint32_t fUniqueID;
+
+        SK_DECLARE_INTERNAL_LLIST_INTERFACE(Entry);
+        friend class SkMaskCache;
+
+        typedef SkRefCnt INHERITED;
+    };
+
+    /**
+     *  Returns the mask SkMaskFilter::filterPath would blit for devPath, from
+     *  the cache or rendered and added to it. The caller must unref the
+     *  entry. *origin is set to the offset to apply to the entry's bounds.
+     *
+     *  Returns NULL, having rendered nothing, if the draw cannot be cached:
+     *  the filter is not a blur, the path has too many points, or it is not
+     *  entirely inside clipBounds (the uncached mask would be clipped).
+     */
+    static Entry* FindOrCreatePathMask(const SkPath& devPath, SkPaint::Style,
+                                       const SkMaskFilter&, const SkMatrix&,
+                                       const SkIRect& clipBounds, SkIPoint* origin);
+
+    /**
+     *  Same, for the nine-patch SkMaskFilter::filterRRectToNine makes of
+     *  devRRect. Also returns NULL if the filter cannot make one.
+     */
+    static Entry* FindOrCreateRRectNine(const SkRRect& devRRect, const SkMaskFilter&,
+                                        const SkMatrix&, const SkIRect& clipBounds,
+                                        SkIPoint* origin);
+
+    struct Stats {
+        int fHits;
+        int fMisses;
+        int fEvictions;
+    };
+
+    static size_t GetTotalBytesUsed();
+    static size_t GetTotalByteLimit();
+    static size_t SetTotalByteLimit(size_t newLimit);
+    static void GetStats(Stats*);
+    static void Purge();
+
+    ///////////////////////////////////////////////////////////////////////////
+
+    explicit SkMaskCache(size_t byteLimit);
+    ~SkMaskCache();
+
+    /** Returns a ref'd entry, or NULL. */
+    Entry* findAndRef(const Key&);
+    /**
+     *  Takes ownership of mask.fImage and returns a ref'd entry for it. If
+     *  another thread added the key first, the existing entry is returned
+     *  and mask.fImage is freed. A mask larger than the byte limit is
+     *  returned without being kept.
+     */
+    Entry* addAndRef(const Key&, const SkMask& mask, const SkIRect& outerRect,
+                     const SkIPoint& center);
+
+    size_t getTotalBytesUsed() const { return fBytesUsed; }
+    size_t getTotalByteLimit() const { return fByteLimit; }
+    size_t setTotalByteLimit(size_t newLimit);
+    const Stats& getStats() const { return fStats; }
+    void purgeAll();
+
+private:
+    class Hash;
+
+    void moveToHead(Entry*);
+    void purgeAsNeeded();
+
+    SkTInternalLList<Entry> fLRU;
+    Hash*                   fHash;
+    size_t                  fBytesUsed;
+    size_t                  fByteLimit;
+    Stats                   fStats;
+};
+
+#endif
@@ -10,6 +10,7 @@
 #include "SkMaskFilter.h"
 #include "SkBlitter.h"
 #include "SkDraw.h"
+#include "SkMaskCache.h"
 #include "SkRasterClip.h"
 #include "SkRRect.h"
 #include "SkTypes.h"
@@ -29,6 +30,10 @@ bool SkMaskFilter::asABlur(BlurRec*) const {
     return false;
 }
 
+bool SkMaskFilter::asADeviceBlur(const SkMatrix&, BlurRec*) const {
+    return false;
+}
+
 static void extractMaskSubset(const SkMask& src, SkMask* dst) {
     SkASSERT(src.fBounds.contains(dst->fBounds));
 
@@ -207,6 +212,16 @@ static int countNestedRects(const SkPath& path, SkRect rects[2]) {
 bool SkMaskFilter::filterRRect(const SkRRect& devRRect, const SkMatrix& matrix,
                                const SkRasterClip& clip, SkBlitter* blitter,
                                SkPaint::Style style) const {
+    SkIPoint origin;
+    SkAutoTUnref<SkMaskCache::Entry> entry(
+            SkMaskCache::FindOrCreateRRectNine(devRRect, *this, matrix, clip.getBounds(), &origin));
+    if (entry) {
+        SkIRect outerRect = entry->outerRect();
+        outerRect.offset(origin.fX, origin.fY);
+        draw_nine(entry->mask(), outerRect, entry->center(), true, clip, blitter);
+        return true;
+    }
+
     // Attempt to speed up drawing by creating a nine patch. If a nine patch
     // cannot be used, return false to allow our caller to recover and perform
     // the drawing another way.
@@ -254,6 +269,24 @@ bool SkMaskFilter::filterPath(const SkPath& devPath, const SkMatrix& matrix,
         }
     }
 
+    SkIPoint origin;
+    SkAutoTUnref<SkMaskCache::Entry> entry(
+            SkMaskCache::FindOrCreatePathMask(devPath, style, *this, matrix, clip.getBounds(),
+                                              &origin));
+    if (entry) {
+        SkMask mask = entry->mask();
+        mask.fBounds.offset(origin.fX, origin.fY);
+
+        SkAAClipBlitterWrapper wrapper(clip, blitter);
+        blitter = wrapper.getBlitter();
+        SkRegion::Cliperator clipper(wrapper.getRgn(), mask.fBounds);
+        while (!clipper.done()) {
+            blitter->blitMask(mask, clipper.rect());
+            clipper.next();
+        }
+        return true;
+    }
+
     SkMask  srcM, dstM;
 
     if (!SkDraw::DrawToMask(devPath, &clip.getBounds(), this, &matrix, &srcM,
@@ -33,6 +33,15 @@ void sk_fill_path(const SkPath& path, const SkIRect* clipRect,
                   SkBlitter* blitter, int start_y, int stop_y, int shiftEdgesUp,
                   const SkRegion& clipRgn);
 
+// Fills path with exact-area coverage; see SkScan_AAAPath.cpp. bounds is the
+// path's bounds intersected with the clip, and no more than 32767 wide.
+// Does not handle inverse fills.
+void sk_fill_path_analytic(const SkPath& path, const SkIRect& bounds,
+                           SkBlitter* blitter);
+
+// Whether SkScan::AntiFillPath uses sk_fill_path_analytic or supersamples.
+bool sk_use_analytic_aa();
+
 // blit the rects above and below avoid, clipped to clip
 void sk_blit_above(SkBlitter*, const SkIRect& avoid, const SkRegion& clip);
 void sk_blit_below(SkBlitter*, const SkIRect& avoid, const SkRegion& clip);
@@ -0,0 +1,429 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkScanPriv.h"
+#include "SkBlitter.h"
+#include "SkGeometry.h"
+#include "SkGraphics.h"
+#include "SkPath.h"
+#include "SkTDArray.h"
+#include "SkTSort.h"
+#include "SkTemplates.h"
+
+/** @file
+    Analytic coverage for anti-aliased path fills.
+
+    Instead of sampling each pixel 4x4 times, every line segment adds the
+    exact signed area it sweeps to the right of itself into a per-row
+    accumulation buffer; a running sum along the row then gives each pixel
+    the exact area of the path inside it. Curves are flattened to within
+    kFlattenTolerance of a pixel first.
+
+    Everywhere a path does not overlap itself the coverage is exact, which
+    matters most for the thin strokes and small shapes the supersampler gets
+    visibly wrong. Where it does, the areas of the overlapping parts add up
+    instead of being unioned, so a pixel that two parts each cover only
+    partly comes out too dark (with either fill rule). Inside a fill the sum
+    is clamped to full coverage and is right again, so only pixels on both
+    parts' edges are affected. SkStroke's inner joins are the common case: a
+    2.5 pixel wide zigzag is off by up to 36/255 on a few pixels per join,
+    where the supersampler is within 15. tests/AnalyticAATest.cpp bounds this
+    error, and tools/analytic_aa_diff compares every GM with the supersampler.
+    Resolving it needs per-pixel winding for each edge crossing, which this
+    buffer does not keep.
+*/
+
+// An opt-in experiment until the overlap error above is resolved. It is also slower than the
+// supersampler on large fills (2-7x in PathBench's big circle, oval and rect fills) and only
+// wins on thin sawtooth shapes. Define this to true, or call SkGraphics::SetAnalyticAAEnabled(),
+// to use it.
+#ifndef SK_ANALYTIC_AA_DEFAULT
+    #define SK_ANALYTIC_AA_DEFAULT false
+#endif
+
+static bool gAnalyticAA = SK_ANALYTIC_AA_DEFAULT;
+
+bool sk_use_analytic_aa() {
+    return gAnalyticAA;
+}
+
+bool SkGraphics::GetAnalyticAAEnabled() {
+    return gAnalyticAA;
+}
+
+bool SkGraphics::SetAnalyticAAEnabled(bool enabled) {
+    bool prev = gAnalyticAA;
+    gAnalyticAA = enabled;
+    return prev;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Largest distance, in pixels, between a curve and the lines it is
+// flattened to.
+static const float kFlattenTolerance = 1.0f / 32;
+static const int kMaxFlattenLines = 256;
+
+namespace {
+
+// A segment in the rasterizer's coordinates, with fY0 < fY1.
+struct Line {
+    float fX0, fY0, fX1, fY1;
+    float fDir;     // +1 if the segment runs down, -1 if it runs up
+
+    bool operator<(const Line& other) const { return fY0 < other.fY0; }
+};
+
+class AnalyticRasterizer {
+public:
+    // bounds is in device coordinates; nothing outside it is drawn.
+    AnalyticRasterizer(const SkIRect& bounds)
+        : fBounds(bounds)
+        , fWidth(bounds.width())
+        , fHeight(bounds.height())
+        , fArea(fWidth + 2)
+        , fCoverage(fWidth)
+        , fAlpha(fWidth + 1)
+        , fRuns(fWidth + 1) {
+        sk_bzero(fArea.get(), (fWidth + 2) * sizeof(float));
+    }
+
+    void addPath(const SkPath&);
+    void blit(SkBlitter*, bool evenOdd);
+
+private:
+    void addLine(SkPoint p0, SkPoint p1);
+    void addQuad(const SkPoint pts[3]);
+    void addCubic(const SkPoint pts[4]);
+    void pushLine(float x0, float y0, float x1, float y1);
+    // Adds the area the line covers within row y, and widens the range of
+    // touched entries [*minX, *maxX).
+    void accumulate(const Line&, int y, int* minX, int* maxX);
+    void blitRow(SkBlitter*, int y, int minX, int maxX, bool evenOdd);
+
+    SkIRect fBounds;
+    int fWidth;
+    int fHeight;
+    SkTDArray<Line> fLines;
+    SkAutoTMalloc<float> fArea;     // fWidth + 2 entries, all zero between rows
+    SkAutoTMalloc<SkAlpha> fCoverage;
+    SkAutoTMalloc<SkAlpha> fAlpha;
+    SkAutoTMalloc<int16_t> fRuns;
+};
+
+static inline int flatten_count(float distance, float scale) {
+    int n = SkScalarCeilToInt(SkScalarSqrt(distance * scale / kFlattenTolerance));
+    return SkPin32(n, 1, kMaxFlattenLines);
+}
+
+void AnalyticRasterizer::addPath(const SkPath& path) {
+    SkPath::Iter iter(path, true);
+    SkPoint pts[4];
+    SkPath::Verb verb;
+    while ((verb = iter.next(pts, false)) != SkPath::kDone_Verb) {
+        switch (verb) {
+            case SkPath::kLine_Verb:
+                this->addLine(pts[0], pts[1]);
+                break;
+            case SkPath::kQuad_Verb:
+                this->addQuad(pts);
+                break;
+            case SkPath::kConic_Verb: {
+                SkAutoConicToQuads converter;
+                const SkPoint* quadPts = converter.computeQuads(pts, iter.conicWeight(),
+                                                                kFlattenTolerance);
+                for (int i = 0; i < converter.countQuads(); ++i) {
+                    this->addQuad(&quadPts[2 * i]);
+                }
+                break;
+            }
+            case SkPath::kCubic_Verb:
+                this->addCubic(pts);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void AnalyticRasterizer::addQuad(const SkPoint pts[3]) {
+    // Flattening with n lines is off by at most |p0 - 2p1 + p2| / (4n^2).
+    SkVector dd = pts[0] - pts[1] - pts[1] + pts[2];
+    int n = flatten_count(dd.length(), 0.25f);
+    SkPoint prev = pts[0];
+    for (int i = 1; i < n; ++i) {
+        SkPoint pt;
+        SkEvalQuadAt(pts, SkScalar(i) / n, &pt);
+        this->addLine(prev, pt);
+        prev = pt;
+    }
+    this->addLine(prev, pts[2]);
+}
+
+void AnalyticRasterizer::addCubic(const SkPoint pts[4]) {
+    // Flattening with n lines is off by at most 3 * max|second difference| / (4n^2).
+    SkVector dd0 = pts[0] - pts[1] - pts[1] + pts[2];
+    SkVector dd1 = pts[1] - pts[2] - pts[2] + pts[3];
+    int n = flatten_count(SkTMax(dd0.length(), dd1.length()), 0.75f);
+    SkPoint prev = pts[0];
+    for (int i = 1; i < n; ++i) {
+        SkPoint pt;
+        SkEvalCubicAt(pts, SkScalar(i) / n, &pt, NULL, NULL);
+        this->addLine(prev, pt);
+        prev = pt;
+    }
+    this->addLine(prev, pts[3]);
+}
+
+void AnalyticRasterizer::addLine(SkPoint p0, SkPoint p1) {
+    float x0 = p0.fX - fBounds.fLeft;
+    float y0 = p0.fY - fBounds.fTop;
+    float x1 = p1.fX - fBounds.fLeft;
+    float y1 = p1.fY - fBounds.fTop;
+
+    // Rows outside the bounds are not drawn, so the parts of the line above
+    // and below them do not matter.
+    if (y0 == y1 || SkTMax(y0, y1) <= 0 || SkTMin(y0, y1) >= fHeight) {
+        return;
+    }
+    float dxdy = (x1 - x0) / (y1 - y0);
+    if (y0 < 0) {
+        x0 += (0 - y0) * dxdy;
+        y0 = 0;
+    } else if (y0 > fHeight) {
+        x0 += (fHeight - y0) * dxdy;
+        y0 = SkIntToScalar(fHeight);
+    }
+    if (y1 < 0) {
+        x1 += (0 - y1) * dxdy;
+        y1 = 0;
+    } else if (y1 > fHeight) {
+        x1 += (fHeight - y1) * dxdy;
+        y1 = SkIntToScalar(fHeight);
+    }
+
+    // Everything right of the bounds only adds to entries past the last
+    // pixel, so drop it. Everything left of the bounds adds its full area to
+    // every pixel, the same as a vertical line on the left edge would.
+    float ys[4] = { y0, 0, 0, y1 };
+    float xs[4] = { x0, 0, 0, x1 };
+    int count = 1;
+    const float edges[2] = { 0, SkIntToScalar(fWidth) };
+    float dydx = (x1 != x0) ? (y1 - y0) / (x1 - x0) : 0;
+    // Visit the edge crossings in order along the line.
+    for (int i = 0; i < 2; ++i) {
+        float edge = edges[x0 <= x1 ? i : 1 - i];
+        if ((x0 < edge) != (x1 < edge) && x0 != edge && x1 != edge) {
+            xs[count] = edge;
+            ys[count] = y0 + (edge - x0) * dydx;
+            count += 1;
+        }
+    }
+    xs[count] = x1;
+    ys[count] = y1;
+
+    for (int i = 0; i < count; ++i) {
+        float mid = (xs[i] + xs[i + 1]) * 0.5f;
+        if (mid >= fWidth) {
+            continue;
+        }
+        if (mid <= 0) {
+            this->pushLine(0, ys[i], 0, ys[i + 1]);
+        } else {
+            this->pushLine(SkScalarPin(xs[i], 0, fWidth), ys[i],
+                           SkScalarPin(xs[i + 1], 0, fWidth), ys[i + 1]);
+        }
+    }
+}
+
+void AnalyticRasterizer::pushLine(float x0, float y0, float x1, float y1) {
+    if (y0 == y1) {
+        return;
+    }
+    Line* line = fLines.append();
+    if (y0 < y1) {
+        line->fX0 = x0;
+        line->fY0 = y0;
+        line->fX1 = x1;
+        line->fY1 = y1;
+        line->fDir = 1;
+    } else {
+        line->fX0 = x1;
+        line->fY0 = y1;
+        line->fX1 = x0;
+        line->fY1 = y0;
+        line->fDir = -1;
+    }
+}
+
+void AnalyticRasterizer::accumulate(const Line& line, int y, int* minX, int* maxX) {
+    float top = SkTMax<float>(SkIntToScalar(y), line.fY0);
+    float bottom = SkTMin<float>(SkIntToScalar(y + 1), line.fY1);
+    float dy = bottom - top;
+    if (dy <= 0) {
+        return;
+    }
+    float dxdy = (line.fX1 - line.fX0) / (line.fY1 - line.fY0);
+    float xa = line.fX0 + (top - line.fY0) * dxdy;
+    float xb = line.fX0 + (bottom - line.fY0) * dxdy;
+    xa = SkScalarPin(xa, 0, fWidth);
+    xb = SkScalarPin(xb, 0, fWidth);
+    float d = dy * line.fDir;
+
+    float x0 = SkTMin(xa, xb);
+    float x1 = SkTMax(xa, xb);
+    int x0i = (int)x0;
+    int x1i = SkTMax(SkScalarCeilToInt(x1), x0i);
+    float* area = fArea.get();
+
+    if (x1i <= x0i + 1) {
+        // Within one pixel: split d at the line's mean x.
+        float xm = (xa + xb) * 0.5f - x0i;
+        area[x0i] += d - d * xm;
+        area[x0i + 1] += d * xm;
+    } else {
+        // Across several pixels: the area to the right of the line grows
+        // quadratically in the end pixels and linearly in between.
+        float s = 1 / (x1 - x0);
+        float x0f = x0 - x0i;
+        float a0 = 0.5f * s * (1 - x0f) * (1 - x0f);
+        float x1f = x1 - x1i + 1;
+        float am = 0.5f * s * x1f * x1f;
+        area[x0i] += d * a0;
+        if (x1i == x0i + 2) {
+            area[x0i + 1] += d * (1 - a0 - am);
+        } else {
+            float a1 = s * (1.5f - x0f);
+            area[x0i + 1] += d * (a1 - a0);
+            for (int xi = x0i + 2; xi < x1i - 1; ++xi) {
+                area[xi] += d * s;
+            }
+            float a2 = a1 + (x1i - x0i - 3) * s;
+            area[x1i - 1] += d * (1 - a2 - am);
+        }
+        area[x1i] += d * am;
+    }
+    *minX = SkTMin(*minX, x0i);
+    *maxX = SkTMax(*maxX, x1i + 2);
+}
+
+static inline SkAlpha coverage_to_alpha(float coverage, bool evenOdd) {
+    coverage = SkScalarAbs(coverage);
+    if (evenOdd) {
+        coverage -= 2 * SkScalarFloorToScalar(coverage * 0.5f);
+        if (coverage > 1) {
+            coverage = 2 - coverage;
+        }
+    } else if (coverage > 1) {
+        coverage = 1;
+    }
+    return SkToU8((int)(coverage * 255 + 0.5f));
+}
+
+void AnalyticRasterizer::blitRow(SkBlitter* blitter, int y, int minX, int maxX,
+                                 bool evenOdd) {
+    float* area = fArea.get();
+    SkAlpha* coverage = fCoverage.get();
+    maxX = SkTMin(maxX, fWidth + 2);
+
+    int end = SkTMin(maxX, fWidth);
+    int first = end;
+    int last = minX;
+    float sum = 0;
+    for (int x = minX; x < end; ++x) {
+        sum += area[x];
+        coverage[x] = coverage_to_alpha(sum, evenOdd);
+        if (coverage[x]) {
+            first = SkTMin(first, x);
+            last = x + 1;
+        }
+    }
+    for (int x = end; x < maxX; ++x) {
+        sum += area[x];
+    }
+    sk_bzero(&area[minX], (maxX - minX) * sizeof(float));
+
+    // Past maxX the running sum no longer changes, so the rest of the row has
+    // the coverage the sum ended at.
+    SkAlpha tail = coverage_to_alpha(sum, evenOdd);
+    if (tail && end < fWidth) {
+        memset(&coverage[end], tail, fWidth - end);
+        first = SkTMin(first, end);
+        last = fWidth;
+    }
+    if (first >= last) {
+        return;
+    }
+
+    SkAlpha* alpha = fAlpha.get();
+    int16_t* runs = fRuns.get();
+    int x = first;
+    while (x < last) {
+        int runEnd = x + 1;
+        while (runEnd < last && coverage[runEnd] == coverage[x]) {
+            ++runEnd;
+        }
+        alpha[x - first] = coverage[x];
+        runs[x - first] = SkToS16(runEnd - x);
+        x = runEnd;
+    }
+    runs[last - first] = 0;
+    blitter->blitAntiH(fBounds.fLeft + first, fBounds.fTop + y, alpha, runs);
+}
+
+void AnalyticRasterizer::blit(SkBlitter* blitter, bool evenOdd) {
+    if (fLines.isEmpty()) {
+        return;
+    }
+    SkTQSort(fLines.begin(), fLines.end() - 1);
+
+    SkTDArray<const Line*> active;
+    int next = 0;
+    const int lineCount = fLines.count();
+    int y = (int)fLines[0].fY0;
+    while (y < fHeight) {
+        while (next < lineCount && fLines[next].fY0 < y + 1) {
+            *active.append() = &fLines[next++];
+        }
+        if (active.isEmpty()) {
+            if (next == lineCount) {
+                break;
+            }
+            y = (int)fLines[next].fY0;
+            continue;
+        }
+
+        int minX = fWidth + 2;
+        int maxX = 0;
+        for (int i = 0; i < active.count();) {
+            const Line* line = active[i];
+            this->accumulate(*line, y, &minX, &maxX);
+            if (line->fY1 <= y + 1) {
+                active.removeShuffle(i);
+            } else {
+                ++i;
+            }
+        }
+        if (minX < maxX) {
+            this->blitRow(blitter, y, minX, maxX, evenOdd);
+        }
+        ++y;
+    }
+}
+
+}  // namespace
+
+void sk_fill_path_analytic(const SkPath& path, const SkIRect& bounds,
+                           SkBlitter* blitter) {
+    SkASSERT(!path.isInverseFillType());
+    if (bounds.isEmpty()) {
+        return;
+    }
+    AnalyticRasterizer rasterizer(bounds);
+    rasterizer.addPath(path);
+    rasterizer.blit(blitter, SkPath::kEvenOdd_FillType == path.getFillType());
+}
@@ -633,7 +633,10 @@ void SkScan::AntiFillPath(const SkPath& path, const SkRegion& origClip,
            return;
        }
     }
-    if (rect_overflows_short_shift(clippedIR, SHIFT)) {
+    // The analytic scan converter does not shift coordinates up, so only the
+    // supersampler needs this limit.
+    const bool analytic = sk_use_analytic_aa() && !path.isInverseFillType();
+    if (!analytic && rect_overflows_short_shift(clippedIR, SHIFT)) {
         SkScan::FillPath(path, origClip, blitter);
         return;
     }
@@ -670,6 +673,16 @@ void SkScan::AntiFillPath(const SkPath& path, const SkRegion& origClip,
     // now use the (possibly wrapped) blitter
     blitter = clipper.getBlitter();
 
+    if (analytic) {
+        // Bounding the row width by the clip keeps it within the int16_t runs.
+        SkIRect bounds = ir;
+        if (!bounds.intersect(clipRect ? *clipRect : clipRgn->getBounds())) {
+            return;
+        }
+        sk_fill_path_analytic(path, bounds, blitter);
+        return;
+    }
+
     if (path.isInverseFillType()) {
         sk_blit_above(blitter, ir, *clipRgn);
     }
@@ -64,6 +64,7 @@ public:
 
     virtual void computeFastBounds(const SkRect&, SkRect*) const SK_OVERRIDE;
     virtual bool asABlur(BlurRec*) const SK_OVERRIDE;
+    virtual bool asADeviceBlur(const SkMatrix& ctm, BlurRec*) const SK_OVERRIDE;
 
     SK_TO_STRING_OVERRIDE()
     SK_DECLARE_PUBLIC_FLATTENABLE_DESERIALIZATION_PROCS(SkBlurMaskFilterImpl)
@@ -153,6 +154,15 @@ bool SkBlurMaskFilterImpl::asABlur(BlurRec* rec) const {
     return true;
 }
 
+bool SkBlurMaskFilterImpl::asADeviceBlur(const SkMatrix& ctm, BlurRec* rec) const {
+    if (rec) {
+        rec->fSigma = this->computeXformedSigma(ctm);
+        rec->fStyle = fBlurStyle;
+        rec->fQuality = this->getQuality();
+    }
+    return true;
+}
+
 bool SkBlurMaskFilterImpl::filterMask(SkMask* dst, const SkMask& src,
                                       const SkMatrix& matrix,
                                       SkIPoint* margin) const{
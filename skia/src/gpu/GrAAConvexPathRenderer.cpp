@@ -627,6 +627,7 @@ bool GrAAConvexPathRenderer::onDrawPath(const SkPath& origPath,
                                         const SkStrokeRec&,
                                         GrDrawTarget* target,
                                         bool antiAlias) {
+    TRACE_EVENT0("skia.gpu", "GrAAConvexPathRenderer::onDrawPath");
 
     const SkPath* path = &origPath;
     if (path->isEmpty()) {
@@ -18,6 +18,7 @@
 #include "SkGeometry.h"
 #include "SkStroke.h"
 #include "SkTemplates.h"
+#include "SkTraceEvent.h"
 
 #include "effects/GrBezierEffect.h"
 
@@ -888,6 +889,7 @@ bool GrAAHairLinePathRenderer::onDrawPath(const SkPath& path,
                                           const SkStrokeRec& stroke,
                                           GrDrawTarget* target,
                                           bool antiAlias) {
+    TRACE_EVENT0("skia.gpu", "GrAAHairLinePathRenderer::onDrawPath");
     GrDrawState* drawState = target->drawState();
 
     SkScalar hairlineCoverage;
@@ -211,6 +211,22 @@ void GrContext::resetContext(uint32_t state) {
     fGpu->markContextDirty(state);
 }
 
+bool GrContext::setProgramBinaryCachePath(const char path[]) {
+    return fGpu->setProgramBinaryCachePath(path);
+}
+
+void GrContext::saveProgramBinaries() {
+    fGpu->saveProgramBinaries();
+}
+
+int GrContext::warmUpPrograms(SkMSec maxMSecs) {
+    return fGpu->warmUpPrograms(maxMSecs);
+}
+
+void GrContext::getProgramStats(ProgramStats* stats) const {
+    fGpu->getProgramStats(stats);
+}
+
 void GrContext::freeGpuResources() {
     this->flush();
 
@@ -1304,6 +1320,7 @@ void GrContext::flush(int flagsBitfield) {
     if (NULL == fDrawBuffer) {
         return;
     }
+    TRACE_EVENT0("skia.gpu", "GrContext::flush");
 
     if (kDiscard_FlushBit & flagsBitfield) {
         fDrawBuffer->reset();
@@ -522,6 +522,7 @@ bool GrDefaultPathRenderer::onDrawPath(const SkPath& path,
                                        const SkStrokeRec& stroke,
                                        GrDrawTarget* target,
                                        bool antiAlias) {
+    TRACE_EVENT0("skia.gpu", "GrDefaultPathRenderer::onDrawPath");
     return this->internalDrawPath(path,
                                   stroke,
                                   target,
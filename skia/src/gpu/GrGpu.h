@@ -253,6 +253,28 @@ public:
      */
     void releaseResources();
 
+    /**
+     * Keeps the binaries of the programs this GrGpu links in the file at path, loading the ones
+     * that are there already. Returns false if the backend cannot do this.
+     */
+    virtual bool setProgramBinaryCachePath(const char path[]) { return false; }
+
+    /**
+     * Writes new program binaries to the file given to setProgramBinaryCachePath().
+     */
+    virtual void saveProgramBinaries() {}
+
+    /**
+     * Prepares the programs recorded with the binaries at the program binary cache path, stopping
+     * after maxMSecs. Returns the number prepared.
+     */
+    virtual int warmUpPrograms(SkMSec maxMSecs) { return 0; }
+
+    // See GrContext::getProgramStats().
+    virtual void getProgramStats(GrContext::ProgramStats* stats) const {
+        sk_bzero(stats, sizeof(*stats));
+    }
+
     /**
      * Add object to list of objects. Should only be called by GrGpuObject.
      * @param resource  the resource to add.
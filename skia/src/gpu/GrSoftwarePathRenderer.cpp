@@ -9,6 +9,7 @@
 #include "GrSoftwarePathRenderer.h"
 #include "GrContext.h"
 #include "GrSWMaskHelper.h"
+#include "SkTraceEvent.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 bool GrSoftwarePathRenderer::canDrawPath(const SkPath&,
@@ -117,6 +118,7 @@ bool GrSoftwarePathRenderer::onDrawPath(const SkPath& path,
                                         const SkStrokeRec& stroke,
                                         GrDrawTarget* target,
                                         bool antiAlias) {
+    TRACE_EVENT0("skia.gpu", "GrSoftwarePathRenderer::onDrawPath");
 
     if (NULL == fContext) {
         return false;
@@ -13,6 +13,7 @@
 #include "GrGpu.h"
 #include "GrPath.h"
 #include "SkStrokeRec.h"
+#include "SkTraceEvent.h"
 
 GrPathRenderer* GrStencilAndCoverPathRenderer::Create(GrContext* context) {
     SkASSERT(NULL != context);
@@ -63,6 +64,7 @@ bool GrStencilAndCoverPathRenderer::onDrawPath(const SkPath& path,
                                                const SkStrokeRec& stroke,
                                                GrDrawTarget* target,
                                                bool antiAlias) {
+    TRACE_EVENT0("skia.gpu", "GrStencilAndCoverPathRenderer::onDrawPath");
     SkASSERT(!antiAlias);
     SkASSERT(!stroke.isHairlineStyle());
 
@@ -10,6 +10,7 @@
 #include "GrTextStrike.h"
 #include "GrTextStrike_impl.h"
 #include "SkString.h"
+#include "SkTraceEvent.h"
 
 #include "SkDistanceFieldGen.h"
 
@@ -130,6 +131,7 @@ bool GrFontCache::freeUnusedPlot(GrTextStrike* preserveStrike) {
     if (NULL == plot) {
         return false;
     }
+    TRACE_EVENT_INSTANT0("skia.gpu", "GrFontCache::freeUnusedPlot", TRACE_EVENT_SCOPE_THREAD);
     plot->resetRects();
 
     GrTextStrike* strike = fHead;
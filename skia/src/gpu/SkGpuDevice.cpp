@@ -26,6 +26,7 @@
 #include "SkDrawProcs.h"
 #include "SkGlyphCache.h"
 #include "SkImageFilter.h"
+#include "SkMaskCache.h"
 #include "SkMaskFilter.h"
 #include "SkPathEffect.h"
 #include "SkPicture.h"
@@ -625,9 +626,50 @@ bool draw_mask(GrContext* context, const SkRect& maskRect,
     return true;
 }
 
+// Draws a mask from SkMaskCache. Its texture is cached too, keyed by the
+// entry, so a repeated shadow is one textured rect.
+bool draw_cached_mask(GrContext* context, const SkMaskCache::Entry& entry,
+                      const SkIPoint& origin, const SkRegion& clip, GrPaint* grp) {
+    const SkMask& mask = entry.mask();
+    SkIRect bounds = mask.fBounds;
+    bounds.offset(origin.fX, origin.fY);
+    if (clip.quickReject(bounds)) {
+        return false;
+    }
+
+    static const GrCacheID::Domain gMaskCacheDomain = GrCacheID::GenerateDomain();
+    GrCacheID::Key key;
+    memset(&key, 0, sizeof(key));
+    key.fData32[0] = entry.uniqueID();
+    GrCacheID maskID(gMaskCacheDomain, key);
+
+    GrTextureDesc desc;
+    desc.fWidth = mask.fBounds.width();
+    desc.fHeight = mask.fBounds.height();
+    desc.fConfig = kAlpha_8_GrPixelConfig;
+
+    GrTexture* texture = context->findAndRefTexture(desc, maskID, NULL);
+    if (NULL == texture) {
+        texture = context->createTexture(NULL, desc, maskID, mask.fImage, mask.fRowBytes);
+    }
+    SkAutoTUnref<GrTexture> textureUnref(texture);
+    if (NULL == texture) {
+        return false;
+    }
+    return draw_mask(context, SkRect::Make(bounds), grp, texture);
+}
+
 bool draw_with_mask_filter(GrContext* context, const SkPath& devPath,
                            SkMaskFilter* filter, const SkRegion& clip,
                            GrPaint* grp, SkPaint::Style style) {
+    SkIPoint origin;
+    SkAutoTUnref<SkMaskCache::Entry> entry(
+            SkMaskCache::FindOrCreatePathMask(devPath, style, *filter, context->getMatrix(),
+                                              clip.getBounds(), &origin));
+    if (entry) {
+        return draw_cached_mask(context, *entry, origin, clip, grp);
+    }
+
     SkMask  srcM, dstM;
 
     if (!SkDraw::DrawToMask(devPath, &clip.getBounds(), filter, &context->getMatrix(), &srcM,
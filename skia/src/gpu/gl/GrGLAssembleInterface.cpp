@@ -106,6 +106,11 @@ const GrGLInterface* GrGLAssembleGLInterface(void* ctx, GrGLGetProc get) {
     GET_PROC(GetQueryiv);
     GET_PROC(GetProgramInfoLog);
     GET_PROC(GetProgramiv);
+    if (glVer >= GR_GL_VER(4,1) || extensions.has("GL_ARB_get_program_binary")) {
+        GET_PROC(GetProgramBinary);
+        GET_PROC(ProgramBinary);
+        GET_PROC(ProgramParameteri);
+    }
     GET_PROC(GetShaderInfoLog);
     GET_PROC(GetShaderiv);
     GET_PROC(GetString);
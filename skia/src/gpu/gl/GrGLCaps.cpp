@@ -44,6 +44,7 @@ void GrGLCaps::reset() {
     fTwoFormatLimit = false;
     fFragCoordsConventionSupport = false;
     fVertexArrayObjectSupport = false;
+    fProgramBinarySupport = false;
     fUseNonVBOVertexAndIndexDynamicData = false;
     fIsCoreProfile = false;
     fFullClearIsFree = false;
@@ -82,6 +83,7 @@ GrGLCaps& GrGLCaps::operator= (const GrGLCaps& caps) {
     fTwoFormatLimit = caps.fTwoFormatLimit;
     fFragCoordsConventionSupport = caps.fFragCoordsConventionSupport;
     fVertexArrayObjectSupport = caps.fVertexArrayObjectSupport;
+    fProgramBinarySupport = caps.fProgramBinarySupport;
     fUseNonVBOVertexAndIndexDynamicData = caps.fUseNonVBOVertexAndIndexDynamicData;
     fIsCoreProfile = caps.fIsCoreProfile;
     fFullClearIsFree = caps.fFullClearIsFree;
@@ -231,6 +233,23 @@ bool GrGLCaps::init(const GrGLContextInfo& ctxInfo, const GrGLInterface* gli) {
                                     ctxInfo.hasExtension("GL_OES_vertex_array_object");
     }
 
+    if (kGL_GrGLStandard == standard) {
+        fProgramBinarySupport = version >= GR_GL_VER(4, 1) ||
+                                ctxInfo.hasExtension("GL_ARB_get_program_binary");
+    } else {
+        fProgramBinarySupport = version >= GR_GL_VER(3, 0) ||
+                                ctxInfo.hasExtension("GL_OES_get_program_binary");
+    }
+    // Some drivers expose the extension without any binary formats, and interfaces built by
+    // hand may not include the entry points.
+    if (fProgramBinarySupport) {
+        GrGLint formatCount = 0;
+        GR_GL_GetIntegerv(gli, GR_GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        fProgramBinarySupport = formatCount > 0 &&
+                                NULL != gli->fFunctions.fGetProgramBinary &&
+                                NULL != gli->fFunctions.fProgramBinary;
+    }
+
     if (kGLES_GrGLStandard == standard) {
         if (ctxInfo.hasExtension("GL_EXT_shader_framebuffer_fetch")) {
             fFBFetchType = kEXT_FBFetchType;
@@ -784,6 +803,7 @@ SkString GrGLCaps::dump() const {
     r.appendf("Fragment coord conventions support: %s\n",
              (fFragCoordsConventionSupport ? "YES": "NO"));
     r.appendf("Vertex array object support: %s\n", (fVertexArrayObjectSupport ? "YES": "NO"));
+    r.appendf("Program binary support: %s\n", (fProgramBinarySupport ? "YES": "NO"));
     r.appendf("Use non-VBO for dynamic data: %s\n",
              (fUseNonVBOVertexAndIndexDynamicData ? "YES" : "NO"));
     r.appendf("Full screen clear is free: %s\n", (fFullClearIsFree ? "YES" : "NO"));
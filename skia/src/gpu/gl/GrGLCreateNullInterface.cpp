@@ -346,6 +346,7 @@ const GrGLInterface* GrGLCreateNullInterface() {
     functions->fGetQueryObjectui64v = noOpGLGetQueryObjectui64v;
     functions->fGetQueryObjectuiv = noOpGLGetQueryObjectuiv;
     functions->fGetQueryiv = noOpGLGetQueryiv;
+    functions->fGetProgramBinary = noOpGLGetProgramBinary;
     functions->fGetProgramInfoLog = noOpGLGetInfoLog;
     functions->fGetProgramiv = noOpGLGetShaderOrProgramiv;
     functions->fGetShaderInfoLog = noOpGLGetInfoLog;
@@ -362,6 +363,8 @@ const GrGLInterface* GrGLCreateNullInterface() {
     functions->fPixelStorei = nullGLPixelStorei;
     functions->fPopGroupMarker = noOpGLPopGroupMarker;
     functions->fPushGroupMarker = noOpGLPushGroupMarker;
+    functions->fProgramBinary = noOpGLProgramBinary;
+    functions->fProgramParameteri = noOpGLProgramParameteri;
     functions->fQueryCounter = noOpGLQueryCounter;
     functions->fReadBuffer = noOpGLReadBuffer;
     functions->fReadPixels = nullGLReadPixels;
@@ -411,6 +411,12 @@
 #define GR_GL_MAX_FRAGMENT_UNIFORM_COMPONENTS  0x8B49
 #define GR_GL_MAX_VERTEX_UNIFORM_COMPONENTS    0x8B4A
 
+/* Program binaries (GL_ARB/OES_get_program_binary) */
+#define GR_GL_PROGRAM_BINARY_RETRIEVABLE_HINT  0x8257
+#define GR_GL_PROGRAM_BINARY_LENGTH            0x8741
+#define GR_GL_NUM_PROGRAM_BINARY_FORMATS       0x87FE
+#define GR_GL_PROGRAM_BINARY_FORMATS           0x87FF
+
 /* StencilFunction */
 #define GR_GL_NEVER                          0x0200
 #define GR_GL_LESS                           0x0201
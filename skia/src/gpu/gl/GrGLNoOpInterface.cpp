@@ -21,12 +21,16 @@ static const GrGLint kDefaultMaxVertexAttribs = 8;
 // the OpenGLES 2.0 spec says this must be >= 8
 static const GrGLint kDefaultMaxVaryingVectors = 8;
 
+// the only program binary format we report; not a real format
+static const GrGLenum kNoOpProgramBinaryFormat = 0x1;
+
 static const char* kExtensions[] = {
     "GL_ARB_framebuffer_object",
     "GL_ARB_blend_func_extended",
     "GL_ARB_timer_query",
     "GL_ARB_draw_buffers",
     "GL_ARB_occlusion_query",
+    "GL_ARB_get_program_binary",
     "GL_EXT_blend_color",
     "GL_EXT_stencil_wrap"
 };
@@ -181,6 +185,17 @@ GrGLvoid GR_GL_FUNCTION_TYPE noOpGLMatrixLoadf(GrGLenum, const GrGLfloat*) {
 GrGLvoid GR_GL_FUNCTION_TYPE noOpGLMatrixLoadIdentity(GrGLenum) {
 }
 
+GrGLvoid GR_GL_FUNCTION_TYPE noOpGLProgramBinary(GrGLuint program,
+                                                 GrGLenum binaryFormat,
+                                                 const GrGLvoid* binary,
+                                                 GrGLsizei length) {
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE noOpGLProgramParameteri(GrGLuint program,
+                                                     GrGLenum pname,
+                                                     GrGLint value) {
+}
+
 GrGLvoid GR_GL_FUNCTION_TYPE noOpGLQueryCounter(GrGLuint id, GrGLenum target) {
 }
 
@@ -510,6 +525,12 @@ GrGLvoid GR_GL_FUNCTION_TYPE noOpGLGetIntegerv(GrGLenum pname, GrGLint* params)
         case GR_GL_NUM_EXTENSIONS:
             *params = SK_ARRAY_COUNT(kExtensions);
             break;
+        case GR_GL_NUM_PROGRAM_BINARY_FORMATS:
+            *params = 1;
+            break;
+        case GR_GL_PROGRAM_BINARY_FORMATS:
+            *params = kNoOpProgramBinaryFormat;
+            break;
         default:
             SkFAIL("Unexpected pname to GetIntegerv");
    }
@@ -527,6 +548,22 @@ GrGLvoid GR_GL_FUNCTION_TYPE noOpGLGetInfoLog(GrGLuint program,
    }
 }
 
+GrGLvoid GR_GL_FUNCTION_TYPE noOpGLGetProgramBinary(GrGLuint program,
+                                                    GrGLsizei bufsize,
+                                                    GrGLsizei* length,
+                                                    GrGLenum* binaryFormat,
+                                                    GrGLvoid* binary) {
+    GrGLsizei written = 0;
+    if (bufsize >= (GrGLsizei)sizeof(GrGLuint)) {
+        memcpy(binary, &program, sizeof(GrGLuint));
+        written = sizeof(GrGLuint);
+    }
+    if (length) {
+        *length = written;
+    }
+    *binaryFormat = kNoOpProgramBinaryFormat;
+}
+
 GrGLvoid GR_GL_FUNCTION_TYPE noOpGLGetShaderOrProgramiv(GrGLuint program,
                                                         GrGLenum pname,
                                                         GrGLint* params) {
@@ -538,6 +575,9 @@ GrGLvoid GR_GL_FUNCTION_TYPE noOpGLGetShaderOrProgramiv(GrGLuint program,
         case GR_GL_INFO_LOG_LENGTH:
             *params = 0;
             break;
+        case GR_GL_PROGRAM_BINARY_LENGTH:
+            *params = sizeof(GrGLuint);
+            break;
         // we don't expect any other pnames
         default:
             SkFAIL("Unexpected pname to GetProgramiv");
@@ -114,6 +114,15 @@ GrGLvoid GR_GL_FUNCTION_TYPE noOpGLLineWidth(GrGLfloat width);
 
 GrGLvoid GR_GL_FUNCTION_TYPE noOpGLLinkProgram(GrGLuint program);
 
+GrGLvoid GR_GL_FUNCTION_TYPE noOpGLProgramBinary(GrGLuint program,
+                                                 GrGLenum binaryFormat,
+                                                 const GrGLvoid* binary,
+                                                 GrGLsizei length);
+
+GrGLvoid GR_GL_FUNCTION_TYPE noOpGLProgramParameteri(GrGLuint program,
+                                                     GrGLenum pname,
+                                                     GrGLint value);
+
 GrGLvoid GR_GL_FUNCTION_TYPE noOpGLQueryCounter(GrGLuint id,
                                                 GrGLenum target);
 
@@ -336,6 +345,13 @@ GrGLvoid GR_GL_FUNCTION_TYPE noOpGLGetInfoLog(GrGLuint program,
                                               GrGLsizei* length,
                                               char* infolog);
 
+// Returns the program's id as its binary, in a made-up format.
+GrGLvoid GR_GL_FUNCTION_TYPE noOpGLGetProgramBinary(GrGLuint program,
+                                                    GrGLsizei bufsize,
+                                                    GrGLsizei* length,
+                                                    GrGLenum* binaryFormat,
+                                                    GrGLvoid* binary);
+
 // can be used for both the program and shader params
 GrGLvoid GR_GL_FUNCTION_TYPE noOpGLGetShaderOrProgramiv(GrGLuint program,
                                                         GrGLenum pname,
@@ -0,0 +1,368 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrGLProgramBinaryCache.h"
+
+#include "GrGLContext.h"
+#include "GrGLUtil.h"
+#include "SkBuffer.h"
+#include "SkChecksum.h"
+#include "SkData.h"
+#include "SkStream.h"
+#include "SkTSearch.h"
+#include "SkTSort.h"
+#include "SkTime.h"
+
+#define GL_CALL(X) GR_GL_CALL(fGLContext.interface(), X)
+#define GL_CALL_RET(R, X) GR_GL_CALL_RET(fGLContext.interface(), R, X)
+
+namespace {
+
+// File layout, all values 32 bit and native endian:
+//   kMagic, kVersion
+//   driver signature length, signature bytes padded to 4
+//   entry count
+//   per entry: key length, key bytes, binary format, use order, binary length, binary bytes
+//              padded to 4
+//   Murmur3 of everything above
+// The use order is the entry's 1-based position in the order the saving session first used its
+// programs, or 0 if that session did not use it.
+static const uint32_t kMagic = 0x42504c47;     // 'GLPB'
+static const uint32_t kVersion = 3;
+
+size_t pad4(size_t size) { return SkAlign4(size) - size; }
+
+void write_padded(SkWStream* stream, const void* data, size_t size) {
+    static const uint32_t kZero = 0;
+    stream->write32(SkToU32(size));
+    stream->write(data, size);
+    stream->write(&kZero, pad4(size));
+}
+
+// Returns a view of the next padded block in data, or NULL if the block runs past its end.
+SkData* read_padded(SkRBufferWithSizeCheck* buffer, const SkData* data) {
+    uint32_t size;
+    if (!buffer->readU32(&size) || size > data->size() - buffer->pos()) {
+        return NULL;
+    }
+    size_t offset = buffer->pos();
+    if (!buffer->read(NULL, SkAlign4(size))) {
+        return NULL;
+    }
+    return SkData::NewSubset(data, offset, size);
+}
+
+void append_gl_string(const GrGLInterface* gl, GrGLenum name, SkString* str) {
+    const GrGLubyte* value;
+    GR_GL_CALL_RET(gl, value, GetString(name));
+    if (NULL != value) {
+        str->append(reinterpret_cast<const char*>(value));
+    }
+    str->append("|");
+}
+
+}
+
+struct GrGLProgramBinaryCache::Key {
+    const void* fData;
+    size_t      fSize;
+};
+
+struct GrGLProgramBinaryCache::Entry {
+    Entry(SkData* key, GrGLenum format, SkData* binary, uint32_t lastUseOrder)
+        : fKey(SkRef(key))
+        , fFormat(format)
+        , fBinary(SkRef(binary))
+        , fLastUseOrder(lastUseOrder)
+        , fUseOrder(0)
+        , fProgramID(0) {}
+
+    SkAutoTUnref<SkData>    fKey;
+    GrGLenum                fFormat;
+    SkAutoTUnref<SkData>    fBinary;
+    uint32_t                fLastUseOrder;  // as loaded from the file
+    uint32_t                fUseOrder;      // in this session, 0 until used
+    GrGLuint                fProgramID;     // created by warmUp() and not handed out yet
+};
+
+struct GrGLProgramBinaryCache::LastUseLess {
+    bool operator()(const Entry* a, const Entry* b) const {
+        return a->fLastUseOrder < b->fLastUseOrder;
+    }
+};
+
+// Orders keys by length first, so most comparisons never look at the key bytes.
+struct GrGLProgramBinaryCache::KeyLess {
+    static int Compare(const SkData* a, const Key& b) {
+        if (a->size() != b.fSize) {
+            return a->size() < b.fSize ? -1 : 1;
+        }
+        return memcmp(a->data(), b.fData, b.fSize);
+    }
+    bool operator()(const Entry* entry, const Key& key) const {
+        return Compare(entry->fKey.get(), key) < 0;
+    }
+    bool operator()(const Key& key, const Entry* entry) const {
+        return Compare(entry->fKey.get(), key) > 0;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+GrGLProgramBinaryCache::GrGLProgramBinaryCache(const GrGLContext& ctx)
+    : fGLContext(ctx)
+    , fUseCount(0)
+    , fWarmUpHits(0)
+    , fBinaryHits(0)
+    , fDirty(false) {
+    SkASSERT(ctx.caps()->programBinarySupport());
+    const GrGLInterface* gl = ctx.interface();
+    append_gl_string(gl, GR_GL_VENDOR, &fDriverSignature);
+    append_gl_string(gl, GR_GL_RENDERER, &fDriverSignature);
+    append_gl_string(gl, GR_GL_VERSION, &fDriverSignature);
+    append_gl_string(gl, GR_GL_SHADING_LANGUAGE_VERSION, &fDriverSignature);
+}
+
+GrGLProgramBinaryCache::~GrGLProgramBinaryCache() {
+    this->reset();
+}
+
+void GrGLProgramBinaryCache::reset() {
+    for (int i = 0; i < fEntries.count(); ++i) {
+        if (0 != fEntries[i]->fProgramID) {
+            GL_CALL(DeleteProgram(fEntries[i]->fProgramID));
+        }
+    }
+    fEntries.deleteAll();
+    fUseCount = 0;
+}
+
+void GrGLProgramBinaryCache::abandon() {
+    for (int i = 0; i < fEntries.count(); ++i) {
+        fEntries[i]->fProgramID = 0;
+    }
+}
+
+void GrGLProgramBinaryCache::removeEntry(int index) {
+    Entry* entry = fEntries[index];
+    if (0 != entry->fProgramID) {
+        GL_CALL(DeleteProgram(entry->fProgramID));
+    }
+    SkDELETE(entry);
+    fEntries.remove(index);
+    fDirty = true;
+}
+
+void GrGLProgramBinaryCache::markUsed(Entry* entry) {
+    if (0 == entry->fUseOrder) {
+        entry->fUseOrder = ++fUseCount;
+        fDirty = true;
+    }
+}
+
+int GrGLProgramBinaryCache::search(const Key& key) const {
+    KeyLess less;
+    return SkTSearch<Entry*, Key, KeyLess>(fEntries.begin(), fEntries.count(), key,
+                                           sizeof(Entry*), less);
+}
+
+bool GrGLProgramBinaryCache::load(const char path[]) {
+    SkAutoTUnref<SkData> data(SkData::NewFromFileName(path));
+    if (NULL == data.get() || data->size() < 4 || SkAlign4(data->size()) != data->size()) {
+        return false;
+    }
+    size_t bodySize = data->size() - sizeof(uint32_t);
+    uint32_t checksum;
+    memcpy(&checksum, data->bytes() + bodySize, sizeof(uint32_t));
+    if (checksum != SkChecksum::Murmur3(static_cast<const uint32_t*>(data->data()), bodySize)) {
+        return false;
+    }
+
+    SkRBufferWithSizeCheck buffer(data->data(), bodySize);
+    uint32_t magic, version, count;
+    if (!buffer.readU32(&magic) || kMagic != magic ||
+        !buffer.readU32(&version) || kVersion != version) {
+        return false;
+    }
+    SkAutoTUnref<SkData> signature(read_padded(&buffer, data));
+    Key driverKey = { fDriverSignature.c_str(), fDriverSignature.size() };
+    if (NULL == signature.get() || 0 != KeyLess::Compare(signature, driverKey)) {
+        // Saved by another driver. Its binaries would be rejected anyway.
+        return false;
+    }
+    if (!buffer.readU32(&count) || count > kMaxEntries) {
+        return false;
+    }
+
+    this->reset();
+    bool valid = true;
+    for (uint32_t i = 0; i < count && valid; ++i) {
+        SkAutoTUnref<SkData> key(read_padded(&buffer, data));
+        uint32_t format, useOrder;
+        valid = NULL != key.get() && buffer.readU32(&format) && buffer.readU32(&useOrder);
+        if (valid) {
+            SkAutoTUnref<SkData> binary(read_padded(&buffer, data));
+            valid = NULL != binary.get() && binary->size() > 0;
+            if (valid) {
+                Key entryKey = { key->data(), key->size() };
+                int index = this->search(entryKey);
+                if (index < 0) {
+                    *fEntries.insert(~index) = SkNEW_ARGS(Entry, (key, format, binary,
+                                                                  useOrder));
+                }
+            }
+        }
+    }
+    if (!valid || buffer.pos() != bodySize) {
+        this->reset();
+        return false;
+    }
+    fDirty = false;
+    return true;
+}
+
+bool GrGLProgramBinaryCache::save(const char path[]) {
+    if (!fDirty) {
+        return true;
+    }
+    SkDynamicMemoryWStream stream;
+    stream.write32(kMagic);
+    stream.write32(kVersion);
+    write_padded(&stream, fDriverSignature.c_str(), fDriverSignature.size());
+    stream.write32(fEntries.count());
+    for (int i = 0; i < fEntries.count(); ++i) {
+        const Entry* entry = fEntries[i];
+        write_padded(&stream, entry->fKey->data(), entry->fKey->size());
+        stream.write32(entry->fFormat);
+        // A session that used nothing (e.g. one closed during the splash screen) keeps the
+        // previous order.
+        stream.write32(fUseCount > 0 ? entry->fUseOrder : entry->fLastUseOrder);
+        write_padded(&stream, entry->fBinary->data(), entry->fBinary->size());
+    }
+    SkAutoTUnref<SkData> body(stream.copyToData());
+
+    SkFILEWStream file(path);
+    if (!file.isValid()) {
+        return false;
+    }
+    uint32_t checksum = SkChecksum::Murmur3(static_cast<const uint32_t*>(body->data()),
+                                            body->size());
+    if (!file.write(body->data(), body->size()) || !file.write32(checksum)) {
+        return false;
+    }
+    fDirty = false;
+    return true;
+}
+
+GrGLuint GrGLProgramBinaryCache::createProgram(const SkString& linkKey) {
+    Key key = { linkKey.c_str(), linkKey.size() };
+    int index = this->search(key);
+    if (index < 0) {
+        return 0;
+    }
+    Entry* entry = fEntries[index];
+
+    GrGLuint programID = entry->fProgramID;
+    if (0 != programID) {
+        entry->fProgramID = 0;
+        ++fWarmUpHits;
+    } else {
+        programID = this->loadBinary(entry);
+        if (0 == programID) {
+            this->removeEntry(index);
+            return 0;
+        }
+        ++fBinaryHits;
+    }
+    this->markUsed(entry);
+    return programID;
+}
+
+int GrGLProgramBinaryCache::warmUp(SkMSec maxMSecs) {
+    SkTDArray<Entry*> used;
+    for (int i = 0; i < fEntries.count(); ++i) {
+        if (fEntries[i]->fLastUseOrder > 0 && 0 == fEntries[i]->fProgramID) {
+            *used.append() = fEntries[i];
+        }
+    }
+    if (used.isEmpty()) {
+        return 0;
+    }
+    SkTQSort<Entry*>(used.begin(), used.end() - 1, LastUseLess());
+
+    SkMSec start = SkTime::GetMSecs();
+    int created = 0;
+    for (int i = 0; i < used.count() && SkTime::GetMSecs() - start < maxMSecs; ++i) {
+        Entry* entry = used[i];
+        entry->fProgramID = this->loadBinary(entry);
+        if (0 != entry->fProgramID) {
+            ++created;
+        } else {
+            Key key = { entry->fKey->data(), entry->fKey->size() };
+            this->removeEntry(this->search(key));
+        }
+    }
+    return created;
+}
+
+GrGLuint GrGLProgramBinaryCache::loadBinary(const Entry* entry) {
+    GrGLuint programID;
+    GL_CALL_RET(programID, CreateProgram());
+    if (0 == programID) {
+        return 0;
+    }
+    // The driver is free to reject a binary (e.g. after a driver update that kept the version
+    // string), so errors are expected here and must not trip the checked GL calls.
+    GrGLClearErr(fGLContext.interface());
+    GR_GL_CALL_NOERRCHECK(fGLContext.interface(),
+                          ProgramBinary(programID, entry->fFormat, entry->fBinary->data(),
+                                        SkToInt(entry->fBinary->size())));
+    GrGLint linked = GR_GL_INIT_ZERO;
+    GR_GL_CALL_NOERRCHECK(fGLContext.interface(),
+                          GetProgramiv(programID, GR_GL_LINK_STATUS, &linked));
+    if (!linked) {
+        GL_CALL(DeleteProgram(programID));
+        GrGLClearErr(fGLContext.interface());
+        return 0;
+    }
+    return programID;
+}
+
+void GrGLProgramBinaryCache::willLinkProgram(GrGLuint programID) const {
+    // Desktop GL needs the hint to keep the binary around; ES2 OES_get_program_binary has no
+    // glProgramParameteri and always keeps it.
+    if (NULL != fGLContext.interface()->fFunctions.fProgramParameteri) {
+        GL_CALL(ProgramParameteri(programID, GR_GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GR_GL_TRUE));
+    }
+}
+
+void GrGLProgramBinaryCache::add(const SkString& linkKey, GrGLuint programID) {
+    Key key = { linkKey.c_str(), linkKey.size() };
+    int index = this->search(key);
+    if (index >= 0 || fEntries.count() >= kMaxEntries) {
+        return;
+    }
+
+    GrGLint length = 0;
+    GL_CALL(GetProgramiv(programID, GR_GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0) {
+        return;
+    }
+    SkAutoMalloc storage(length);
+    GrGLsizei written = 0;
+    GrGLenum format = 0;
+    GL_CALL(GetProgramBinary(programID, length, &written, &format, storage.get()));
+    if (written <= 0 || written > length) {
+        return;
+    }
+
+    SkAutoTUnref<SkData> keyData(SkData::NewWithCopy(key.fData, key.fSize));
+    SkAutoTUnref<SkData> binary(SkData::NewWithCopy(storage.get(), written));
+    Entry* entry = SkNEW_ARGS(Entry, (keyData, format, binary, 0));
+    *fEntries.insert(~index) = entry;
+    this->markUsed(entry);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrGLProgramBinaryCache_DEFINED
+#define GrGLProgramBinaryCache_DEFINED
+
+#include "gl/GrGLFunctions.h"
+#include "SkString.h"
+#include "SkTDArray.h"
+
+class GrGLContext;
+
+/**
+ * Keeps the binaries of linked programs, keyed by their shader sources and bindings (see
+ * GrGLShaderBuilder::appendLinkKey()), so that a later run on the same driver can load them with
+ * glProgramBinary instead of compiling shaders. GrGLProgramDesc bytes would not do as the key:
+ * the effect IDs in them depend on the order effects were first used, which differs per run.
+ * A binary is read back right after its program links; load() and save() move the whole set to
+ * and from a file. All GL work goes through the context's GrGLInterface, so the cache also runs
+ * against the null interface, which hands out one made-up binary format.
+ *
+ * The cache also records the order in which a session first used its programs. That list is
+ * saved with the binaries and lets warmUp() load the programs the previous session needed before
+ * any draw asks for them.
+ */
+class GrGLProgramBinaryCache : public SkNoncopyable {
+public:
+    /** The context must support program binaries (GrGLCaps::programBinarySupport()). */
+    GrGLProgramBinaryCache(const GrGLContext& ctx);
+    ~GrGLProgramBinaryCache();
+
+    /**
+     * Replaces the cached binaries with the ones saved at path. A file written for another
+     * driver, driver version or file format, or one that is damaged, is ignored. Returns true
+     * if the file was read.
+     */
+    bool load(const char path[]);
+
+    /**
+     * Writes the cached binaries to path if any were added or dropped since the last load() or
+     * save(). Returns false if the file could not be written.
+     */
+    bool save(const char path[]);
+
+    /**
+     * Creates a linked program from the binary cached for key, or hands over the one warmUp()
+     * already created. Returns 0 if there is none or the driver rejects it. A rejected binary is
+     * dropped, so the caller compiles the program from source and add()s it again.
+     */
+    GrGLuint createProgram(const SkString& key);
+
+    /**
+     * Creates programs from the binaries the session that saved the file used, in the order it
+     * first used them, and keeps them for createProgram(). Stops once it has run for maxMSecs,
+     * leaving the rest to be loaded on demand. Returns the number created.
+     */
+    int warmUp(SkMSec maxMSecs);
+
+    /**
+     * Forgets the programs created by warmUp() without deleting them. Used when the GL context
+     * has been lost.
+     */
+    void abandon();
+
+    /** Call before linking a program built from source, so that its binary can be read back. */
+    void willLinkProgram(GrGLuint programID) const;
+
+    /** Reads back the binary of a program that just linked and caches it under key. */
+    void add(const SkString& key, GrGLuint programID);
+
+    int count() const { return fEntries.count(); }
+
+    /** Number of createProgram() calls answered by a program created in warmUp(). */
+    int warmUpHits() const { return fWarmUpHits; }
+    /** Number of createProgram() calls that loaded a binary on demand. */
+    int binaryHits() const { return fBinaryHits; }
+
+    /** Binaries saved for a different driver signature are not loaded. */
+    const SkString& driverSignature() const { return fDriverSignature; }
+
+private:
+    enum {
+        // A run uses far fewer programs than this. Binaries past the limit are not kept, which
+        // favours the ones needed first.
+        kMaxEntries = 256,
+    };
+
+    struct Entry;
+    struct Key;
+    struct KeyLess;
+    struct LastUseLess;
+
+    // Binary search for the entry with the given key. Returns its index into fEntries, or ~ of
+    // the index where it should be inserted.
+    int search(const Key& key) const;
+    // Returns a program linked from entry's binary, or 0 if the driver rejects it.
+    GrGLuint loadBinary(const Entry* entry);
+    void removeEntry(int index);
+    void markUsed(Entry* entry);
+    void reset();
+
+    const GrGLContext&  fGLContext;
+    SkString            fDriverSignature;
+    SkTDArray<Entry*>   fEntries;   // sorted by key
+    int                 fUseCount;  // entries used so far by this session
+    int                 fWarmUpHits;
+    int                 fBinaryHits;
+    bool                fDirty;
+};
+
+#endif
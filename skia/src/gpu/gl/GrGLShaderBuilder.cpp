@@ -7,6 +7,7 @@
 
 #include "gl/GrGLShaderBuilder.h"
 #include "gl/GrGLProgram.h"
+#include "gl/GrGLProgramBinaryCache.h"
 #include "gl/GrGLUniformHandle.h"
 #include "GrCoordTransform.h"
 #include "GrDrawEffect.h"
@@ -659,6 +660,19 @@ const char* GrGLShaderBuilder::enableSecondaryOutput() {
 
 bool GrGLShaderBuilder::finish() {
     SkASSERT(0 == fOutput.fProgramID);
+    GrGLProgramBinaryCache* binaryCache = fGpu->programBinaryCache();
+    SkString linkKey;
+    if (NULL != binaryCache) {
+        // The binary keeps the attribute and uniform bindings it was linked with, so only the
+        // uniform locations need to be filled in.
+        this->appendLinkKey(&linkKey);
+        fOutput.fProgramID = binaryCache->createProgram(linkKey);
+        if (fOutput.fProgramID) {
+            fUniformManager->getUniformLocations(fOutput.fProgramID, fUniforms);
+            return true;
+        }
+    }
+
     GL_CALL_RET(fOutput.fProgramID, CreateProgram());
     if (!fOutput.fProgramID) {
         return false;
@@ -676,6 +690,9 @@ bool GrGLShaderBuilder::finish() {
         fUniformManager->getUniformLocations(fOutput.fProgramID, fUniforms);
     }
 
+    if (NULL != binaryCache) {
+        binaryCache->willLinkProgram(fOutput.fProgramID);
+    }
     GL_CALL(LinkProgram(fOutput.fProgramID));
 
     // Calling GetProgramiv is expensive in Chromium. Assume success in release builds.
@@ -711,6 +728,10 @@ bool GrGLShaderBuilder::finish() {
         fUniformManager->getUniformLocations(fOutput.fProgramID, fUniforms);
     }
 
+    if (NULL != binaryCache) {
+        binaryCache->add(linkKey, fOutput.fProgramID);
+    }
+
     for (int i = 0; i < shadersToDelete.count(); ++i) {
       GL_CALL(DeleteShader(shadersToDelete[i]));
     }
@@ -778,21 +799,26 @@ static GrGLuint attach_shader(const GrGLContext& glCtx,
     return shaderId;
 }
 
-bool GrGLShaderBuilder::compileAndAttachShaders(GrGLuint programId, SkTDArray<GrGLuint>* shaderIds) const {
-    SkString fragShaderSrc(GrGetGLSLVersionDecl(this->ctxInfo()));
-    fragShaderSrc.append(fFSExtensions);
+void GrGLShaderBuilder::fragmentShaderSource(SkString* out) const {
+    out->append(GrGetGLSLVersionDecl(this->ctxInfo()));
+    out->append(fFSExtensions);
     append_default_precision_qualifier(kDefaultFragmentPrecision,
                                        fGpu->glStandard(),
-                                       &fragShaderSrc);
-    this->appendUniformDecls(kFragment_Visibility, &fragShaderSrc);
-    this->appendDecls(fFSInputs, &fragShaderSrc);
+                                       out);
+    this->appendUniformDecls(kFragment_Visibility, out);
+    this->appendDecls(fFSInputs, out);
     // We shouldn't have declared outputs on 1.10
     SkASSERT(k110_GrGLSLGeneration != fGpu->glslGeneration() || fFSOutputs.empty());
-    this->appendDecls(fFSOutputs, &fragShaderSrc);
-    fragShaderSrc.append(fFSFunctions);
-    fragShaderSrc.append("void main() {\n");
-    fragShaderSrc.append(fFSCode);
-    fragShaderSrc.append("}\n");
+    this->appendDecls(fFSOutputs, out);
+    out->append(fFSFunctions);
+    out->append("void main() {\n");
+    out->append(fFSCode);
+    out->append("}\n");
+}
+
+bool GrGLShaderBuilder::compileAndAttachShaders(GrGLuint programId, SkTDArray<GrGLuint>* shaderIds) const {
+    SkString fragShaderSrc;
+    this->fragmentShaderSource(&fragShaderSrc);
 
     GrGLuint fragShaderId = attach_shader(fGpu->glContext(), programId, GR_GL_FRAGMENT_SHADER, fragShaderSrc);
     if (!fragShaderId) {
@@ -813,6 +839,20 @@ void GrGLShaderBuilder::bindProgramLocations(GrGLuint programId) const {
     }
 }
 
+void GrGLShaderBuilder::appendLinkKey(SkString* key) const {
+    this->fragmentShaderSource(key);
+    if (fHasCustomColorOutput) {
+        key->appendf("frag data 0: %s\n", declared_color_output_name());
+    }
+    if (fHasSecondaryOutput) {
+        key->appendf("frag data 0 index 1: %s\n", dual_source_output_name());
+    }
+    // With bound uniforms a uniform's location is its index, which the sources alone don't show.
+    for (int i = 0; i < fUniforms.count(); ++i) {
+        key->appendf("uniform %d: %s\n", i, fUniforms[i].fVariable.c_str());
+    }
+}
+
 const GrGLContextInfo& GrGLShaderBuilder::ctxInfo() const {
     return fGpu->ctxInfo();
 }
@@ -983,16 +1023,48 @@ GrGLProgramEffects* GrGLFullShaderBuilder::createAndEmitEffects(
     return programEffectsBuilder.finish();
 }
 
+void GrGLFullShaderBuilder::vertexShaderSource(SkString* out) const {
+    out->append(GrGetGLSLVersionDecl(this->ctxInfo()));
+    this->appendUniformDecls(kVertex_Visibility, out);
+    this->appendDecls(fVSAttrs, out);
+    this->appendDecls(fVSOutputs, out);
+    out->append("void main() {\n");
+    out->append(fVSCode);
+    out->append("}\n");
+}
+
+#if GR_GL_EXPERIMENTAL_GS
+void GrGLFullShaderBuilder::geometryShaderSource(SkString* out) const {
+    SkASSERT(this->ctxInfo().glslGeneration() >= k150_GrGLSLGeneration);
+    out->append(GrGetGLSLVersionDecl(this->ctxInfo()));
+    out->append("layout(triangles) in;\n"
+                "layout(triangle_strip, max_vertices = 6) out;\n");
+    this->appendDecls(fGSInputs, out);
+    this->appendDecls(fGSOutputs, out);
+    out->append("void main() {\n");
+    out->append("\tfor (int i = 0; i < 3; ++i) {\n"
+                "\t\tgl_Position = gl_in[i].gl_Position;\n");
+    if (this->desc().getHeader().fEmitsPointSize) {
+        out->append("\t\tgl_PointSize = 1.0;\n");
+    }
+    SkASSERT(fGSInputs.count() == fGSOutputs.count());
+    for (int i = 0; i < fGSInputs.count(); ++i) {
+        out->appendf("\t\t%s = %s[i];\n",
+                     fGSOutputs[i].getName().c_str(),
+                     fGSInputs[i].getName().c_str());
+    }
+    out->append("\t\tEmitVertex();\n"
+                "\t}\n"
+                "\tEndPrimitive();\n");
+    out->append("}\n");
+}
+#endif
+
 bool GrGLFullShaderBuilder::compileAndAttachShaders(GrGLuint programId,
                                                     SkTDArray<GrGLuint>* shaderIds) const {
     const GrGLContext& glCtx = this->gpu()->glContext();
-    SkString vertShaderSrc(GrGetGLSLVersionDecl(this->ctxInfo()));
-    this->appendUniformDecls(kVertex_Visibility, &vertShaderSrc);
-    this->appendDecls(fVSAttrs, &vertShaderSrc);
-    this->appendDecls(fVSOutputs, &vertShaderSrc);
-    vertShaderSrc.append("void main() {\n");
-    vertShaderSrc.append(fVSCode);
-    vertShaderSrc.append("}\n");
+    SkString vertShaderSrc;
+    this->vertexShaderSource(&vertShaderSrc);
     GrGLuint vertShaderId = attach_shader(glCtx, programId, GR_GL_VERTEX_SHADER, vertShaderSrc);
     if (!vertShaderId) {
         return false;
@@ -1001,28 +1073,8 @@ bool GrGLFullShaderBuilder::compileAndAttachShaders(GrGLuint programId,
 
 #if GR_GL_EXPERIMENTAL_GS
     if (this->desc().getHeader().fExperimentalGS) {
-        SkASSERT(this->ctxInfo().glslGeneration() >= k150_GrGLSLGeneration);
-        SkString geomShaderSrc(GrGetGLSLVersionDecl(this->ctxInfo()));
-        geomShaderSrc.append("layout(triangles) in;\n"
-                             "layout(triangle_strip, max_vertices = 6) out;\n");
-        this->appendDecls(fGSInputs, &geomShaderSrc);
-        this->appendDecls(fGSOutputs, &geomShaderSrc);
-        geomShaderSrc.append("void main() {\n");
-        geomShaderSrc.append("\tfor (int i = 0; i < 3; ++i) {\n"
-                             "\t\tgl_Position = gl_in[i].gl_Position;\n");
-        if (this->desc().getHeader().fEmitsPointSize) {
-            geomShaderSrc.append("\t\tgl_PointSize = 1.0;\n");
-        }
-        SkASSERT(fGSInputs.count() == fGSOutputs.count());
-        for (int i = 0; i < fGSInputs.count(); ++i) {
-            geomShaderSrc.appendf("\t\t%s = %s[i];\n",
-                                  fGSOutputs[i].getName().c_str(),
-                                  fGSInputs[i].getName().c_str());
-        }
-        geomShaderSrc.append("\t\tEmitVertex();\n"
-                             "\t}\n"
-                             "\tEndPrimitive();\n");
-        geomShaderSrc.append("}\n");
+        SkString geomShaderSrc;
+        this->geometryShaderSource(&geomShaderSrc);
         GrGLuint geomShaderId = attach_shader(glCtx, programId, GR_GL_GEOMETRY_SHADER, geomShaderSrc);
         if (!geomShaderId) {
             return false;
@@ -1066,6 +1118,35 @@ void GrGLFullShaderBuilder::bindProgramLocations(GrGLuint programId) const {
     }
 }
 
+void GrGLFullShaderBuilder::appendLinkKey(SkString* key) const {
+    this->vertexShaderSource(key);
+#if GR_GL_EXPERIMENTAL_GS
+    if (this->desc().getHeader().fExperimentalGS) {
+        this->geometryShaderSource(key);
+    }
+#endif
+    this->INHERITED::appendLinkKey(key);
+
+    // Must match bindProgramLocations().
+    const GrGLProgramDesc::KeyHeader& header = this->desc().getHeader();
+    key->appendf("attrib %d: %s\n", header.fPositionAttributeIndex, fPositionVar->c_str());
+    if (-1 != header.fLocalCoordAttributeIndex) {
+        key->appendf("attrib %d: %s\n", header.fLocalCoordAttributeIndex,
+                     fLocalCoordsVar->c_str());
+    }
+    if (-1 != header.fColorAttributeIndex) {
+        key->appendf("attrib %d: %s\n", header.fColorAttributeIndex, color_attribute_name());
+    }
+    if (-1 != header.fCoverageAttributeIndex) {
+        key->appendf("attrib %d: %s\n", header.fCoverageAttributeIndex,
+                     coverage_attribute_name());
+    }
+    const AttributePair* attribEnd = fEffectAttributes.end();
+    for (const AttributePair* attrib = fEffectAttributes.begin(); attrib != attribEnd; ++attrib) {
+        key->appendf("attrib %d: %s\n", attrib->fIndex, attrib->fName.c_str());
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 GrGLFragmentOnlyShaderBuilder::GrGLFragmentOnlyShaderBuilder(GrGpuGL* gpu,
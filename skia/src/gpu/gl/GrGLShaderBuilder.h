@@ -266,6 +266,14 @@ protected:
 
     virtual void bindProgramLocations(GrGLuint programId) const;
 
+    // Appends the shader sources and the attribute, uniform and output bindings: everything that
+    // goes into linking the program. Equal keys give the same program in any process, unlike
+    // GrGLProgramDesc keys, whose effect IDs depend on the order effects were first used. Keys
+    // the program binary cache.
+    virtual void appendLinkKey(SkString* key) const;
+
+    void fragmentShaderSource(SkString* out) const;
+
     void appendDecls(const VarArray&, SkString*) const;
     void appendUniformDecls(ShaderVisibility, SkString*) const;
 
@@ -476,6 +484,13 @@ private:
 
     virtual void bindProgramLocations(GrGLuint programId) const SK_OVERRIDE;
 
+    virtual void appendLinkKey(SkString* key) const SK_OVERRIDE;
+
+    void vertexShaderSource(SkString* out) const;
+#if GR_GL_EXPERIMENTAL_GS
+    void geometryShaderSource(SkString* out) const;
+#endif
+
     VarArray                            fVSAttrs;
     VarArray                            fVSOutputs;
     VarArray                            fGSInputs;
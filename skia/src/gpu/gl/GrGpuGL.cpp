@@ -10,11 +10,13 @@
 #include "GrGLNameAllocator.h"
 #include "GrGLStencilBuffer.h"
 #include "GrGLPath.h"
+#include "GrGLProgramBinaryCache.h"
 #include "GrGLShaderBuilder.h"
 #include "GrTemplates.h"
 #include "GrTypes.h"
 #include "SkStrokeRec.h"
 #include "SkTemplates.h"
+#include "SkTraceEvent.h"
 
 #define GL_CALL(X) GR_GL_CALL(this->glInterface(), X)
 #define GL_CALL_RET(RET, X) GR_GL_CALL_RET(this->glInterface(), RET, X)
@@ -150,6 +152,7 @@ GrGpuGL::GrGpuGL(const GrGLContext& ctx, GrContext* context)
 
     fLastSuccessfulStencilFmtIdx = 0;
     fHWProgramID = 0;
+    fProgramsWarmedUp = 0;
 }
 
 GrGpuGL::~GrGpuGL() {
@@ -161,6 +164,7 @@ GrGpuGL::~GrGpuGL() {
     }
 
     delete fProgramCache;
+    this->saveProgramBinaries();
 
     // This must be called by before the GrDrawTarget destructor
     this->releaseGeometry();
@@ -541,6 +545,7 @@ bool GrGpuGL::uploadTexData(const GrGLTexture::Desc& desc,
                             const void* data,
                             size_t rowBytes) {
     SkASSERT(NULL != data || isNewTexture);
+    TRACE_EVENT2("skia.gpu", "GrGpuGL::uploadTexData", "width", width, "height", height);
 
     // If we're uploading compressed data then we should be using uploadCompressedTexData
     SkASSERT(!GrPixelConfigIsCompressed(dataConfig));
@@ -722,6 +727,7 @@ bool GrGpuGL::uploadCompressedTexData(const GrGLTexture::Desc& desc,
                                       bool isNewTexture,
                                       int left, int top, int width, int height) {
     SkASSERT(NULL != data || isNewTexture);
+    TRACE_EVENT2("skia.gpu", "GrGpuGL::uploadCompressedTexData", "width", width, "height", height);
 
     // No support for software flip y, yet...
     SkASSERT(kBottomLeft_GrSurfaceOrigin != desc.fOrigin);
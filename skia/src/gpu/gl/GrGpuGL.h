@@ -27,6 +27,7 @@
 #endif
 
 class GrGLNameAllocator;
+class GrGLProgramBinaryCache;
 
 class GrGpuGL : public GrGpu {
 public:
@@ -82,6 +83,14 @@ public:
 
     virtual void abandonResources() SK_OVERRIDE;
 
+    virtual bool setProgramBinaryCachePath(const char path[]) SK_OVERRIDE;
+    virtual void saveProgramBinaries() SK_OVERRIDE;
+    virtual int warmUpPrograms(SkMSec maxMSecs) SK_OVERRIDE;
+    virtual void getProgramStats(GrContext::ProgramStats* stats) const SK_OVERRIDE;
+
+    // NULL unless setProgramBinaryCachePath() succeeded. Used by GrGLShaderBuilder.
+    GrGLProgramBinaryCache* programBinaryCache() { return fProgramBinaryCache.get(); }
+
     // These functions should be used to bind GL objects. They track the GL state and skip redundant
     // bindings. Making the equivalent glBind calls directly will confuse the state tracking.
     void bindVertexArray(GrGLuint id) {
@@ -206,6 +215,9 @@ private:
                                 const GrEffectStage* colorStages[],
                                 const GrEffectStage* coverageStages[]);
 
+        int totalRequests() const { return fTotalRequests; }
+        int cacheMisses() const { return fCacheMisses; }
+
     private:
         enum {
             // We may actually have kMaxEntries+1 shaders in the GL context because we create a new
@@ -231,9 +243,9 @@ private:
         int                         fCount;
         unsigned int                fCurrLRUStamp;
         GrGpuGL*                    fGpu;
-#ifdef PROGRAM_CACHE_STATS
         int                         fTotalRequests;
         int                         fCacheMisses;
+#ifdef PROGRAM_CACHE_STATS
         int                         fHashMisses; // cache hit but hash table missed
 #endif
     };
@@ -293,8 +305,11 @@ private:
     GrGLContext fGLContext;
 
     // GL program-related state
-    ProgramCache*               fProgramCache;
-    SkAutoTUnref<GrGLProgram>   fCurrentProgram;
+    ProgramCache*                           fProgramCache;
+    SkAutoTUnref<GrGLProgram>               fCurrentProgram;
+    SkAutoTDelete<GrGLProgramBinaryCache>   fProgramBinaryCache;
+    SkString                                fProgramBinaryCachePath;
+    int                                     fProgramsWarmedUp;
 
     ///////////////////////////////////////////////////////////////////////////
     ///@name Caching of GL State
@@ -11,6 +11,7 @@
 #include "GrGLEffect.h"
 #include "SkRTConf.h"
 #include "GrGLNameAllocator.h"
+#include "GrGLProgramBinaryCache.h"
 #include "SkTSearch.h"
 
 #ifdef PROGRAM_CACHE_STATS
@@ -44,9 +45,9 @@ GrGpuGL::ProgramCache::ProgramCache(GrGpuGL* gpu)
     : fCount(0)
     , fCurrLRUStamp(0)
     , fGpu(gpu)
-#ifdef PROGRAM_CACHE_STATS
     , fTotalRequests(0)
     , fCacheMisses(0)
+#ifdef PROGRAM_CACHE_STATS
     , fHashMisses(0)
 #endif
 {
@@ -92,9 +93,7 @@ int GrGpuGL::ProgramCache::search(const GrGLProgramDesc& desc) const {
 GrGLProgram* GrGpuGL::ProgramCache::getProgram(const GrGLProgramDesc& desc,
                                                const GrEffectStage* colorStages[],
                                                const GrEffectStage* coverageStages[]) {
-#ifdef PROGRAM_CACHE_STATS
     ++fTotalRequests;
-#endif
 
     Entry* entry = NULL;
 
@@ -123,9 +122,7 @@ GrGLProgram* GrGpuGL::ProgramCache::getProgram(const GrGLProgramDesc& desc,
 
     if (NULL == entry) {
         // We have a cache miss
-#ifdef PROGRAM_CACHE_STATS
         ++fCacheMisses;
-#endif
         GrGLProgram* program = GrGLProgram::Create(fGpu, desc, colorStages, coverageStages);
         if (NULL == program) {
             return NULL;
@@ -202,10 +199,56 @@ GrGLProgram* GrGpuGL::ProgramCache::getProgram(const GrGLProgramDesc& desc,
 void GrGpuGL::abandonResources(){
     INHERITED::abandonResources();
     fProgramCache->abandon();
+    if (NULL != fProgramBinaryCache.get()) {
+        fProgramBinaryCache->abandon();
+    }
     fHWProgramID = 0;
     fPathNameAllocator.reset(NULL);
 }
 
+bool GrGpuGL::setProgramBinaryCachePath(const char path[]) {
+    if (!this->glCaps().programBinarySupport()) {
+        return false;
+    }
+    if (NULL == fProgramBinaryCache.get()) {
+        fProgramBinaryCache.reset(SkNEW_ARGS(GrGLProgramBinaryCache, (fGLContext)));
+    } else {
+        this->saveProgramBinaries();
+    }
+    fProgramBinaryCachePath.set(path);
+    // A missing or stale file just means the programs get compiled and saved again.
+    fProgramBinaryCache->load(path);
+    return true;
+}
+
+void GrGpuGL::saveProgramBinaries() {
+    if (NULL != fProgramBinaryCache.get() && !fProgramBinaryCachePath.isEmpty()) {
+        fProgramBinaryCache->save(fProgramBinaryCachePath.c_str());
+    }
+}
+
+int GrGpuGL::warmUpPrograms(SkMSec maxMSecs) {
+    if (NULL == fProgramBinaryCache.get()) {
+        return 0;
+    }
+    int count = fProgramBinaryCache->warmUp(maxMSecs);
+    fProgramsWarmedUp += count;
+    return count;
+}
+
+void GrGpuGL::getProgramStats(GrContext::ProgramStats* stats) const {
+    stats->fCacheHits = fProgramCache->totalRequests() - fProgramCache->cacheMisses();
+    stats->fWarmUpHits = 0;
+    stats->fBinaryHits = 0;
+    if (NULL != fProgramBinaryCache.get()) {
+        stats->fWarmUpHits = fProgramBinaryCache->warmUpHits();
+        stats->fBinaryHits = fProgramBinaryCache->binaryHits();
+    }
+    // Includes programs that failed to build.
+    stats->fCompiles = fProgramCache->cacheMisses() - stats->fWarmUpHits - stats->fBinaryHits;
+    stats->fWarmedUp = fProgramsWarmedUp;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 #define GL_CALL(X) GR_GL_CALL(this->glInterface(), X)
@@ -892,6 +892,7 @@ const GrGLInterface* GrGLCreateDebugInterface() {
     functions->fGetQueryObjectui64v = noOpGLGetQueryObjectui64v;
     functions->fGetQueryObjectuiv = noOpGLGetQueryObjectuiv;
     functions->fGetQueryiv = noOpGLGetQueryiv;
+    functions->fGetProgramBinary = noOpGLGetProgramBinary;
     functions->fGetProgramInfoLog = noOpGLGetInfoLog;
     functions->fGetProgramiv = noOpGLGetShaderOrProgramiv;
     functions->fGetShaderInfoLog = noOpGLGetInfoLog;
@@ -906,6 +907,8 @@ const GrGLInterface* GrGLCreateDebugInterface() {
     functions->fMapBuffer = debugGLMapBuffer;
     functions->fMapBufferRange = debugGLMapBufferRange;
     functions->fPixelStorei = debugGLPixelStorei;
+    functions->fProgramBinary = noOpGLProgramBinary;
+    functions->fProgramParameteri = noOpGLProgramParameteri;
     functions->fQueryCounter = noOpGLQueryCounter;
     functions->fReadBuffer = noOpGLReadBuffer;
     functions->fReadPixels = debugGLReadPixels;
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <immintrin.h>
+#include "SkBitmapProcState_opts_AVX2.h"
+
+namespace {
+
+// Filters 4 destination pixels at once: the 16 source pixels are gathered and
+// each row is weighted before the columns are, which gives the same sums as
+// S32_opaque_D32_filter_DX_SSE2 since nothing is rounded in between.
+template <bool hasAlpha>
+void filter_DX(const char* srcAddr, size_t rb, unsigned alphaScale,
+               const uint32_t* xy, int count, uint32_t* colors) {
+    SkASSERT(count > 0 && (count & 3) == 0 && colors != NULL);
+    SkASSERT(hasAlpha ? alphaScale < 256 : alphaScale == 256);
+
+    const uint32_t XY = *xy;
+    unsigned y0 = XY >> 14;
+    const int* row0 = reinterpret_cast<const int*>(srcAddr + (y0 >> 4) * rb);
+    const int* row1 = reinterpret_cast<const int*>(srcAddr + (XY & 0x3FFF) * rb);
+    unsigned subY = y0 & 0xF;
+
+    const __m256i allY = _mm256_set1_epi16(subY);
+    const __m256i negY = _mm256_set1_epi16(16 - subY);
+    const __m256i sixteen = _mm256_set1_epi16(16);
+    const __m256i alpha = _mm256_set1_epi16(alphaScale);
+
+    const uint32_t* xx = xy + 1;
+    while (count >= 4) {
+        // x0:14 | 4 | x1:14 for 4 pixels
+        __m128i XX = _mm_loadu_si128(reinterpret_cast<const __m128i*>(xx));
+        __m128i x0 = _mm_srli_epi32(XX, 18);
+        __m128i x1 = _mm_and_si128(XX, _mm_set1_epi32(0x3FFF));
+
+        // Each pixel's subX in all 4 of its bytes, then in 4 words.
+        __m128i subX = _mm_and_si128(_mm_srli_epi32(XX, 14), _mm_set1_epi32(0xF));
+        subX = _mm_mullo_epi32(subX, _mm_set1_epi32(0x01010101));
+        __m256i allX = _mm256_cvtepu8_epi16(subX);
+        __m256i negX = _mm256_sub_epi16(sixteen, allX);
+
+        // Load 16 samples (pixels), expanded to 16 bits per component.
+        __m256i a00 = _mm256_cvtepu8_epi16(_mm_i32gather_epi32(row0, x0, 4));
+        __m256i a01 = _mm256_cvtepu8_epi16(_mm_i32gather_epi32(row0, x1, 4));
+        __m256i a10 = _mm256_cvtepu8_epi16(_mm_i32gather_epi32(row1, x0, 4));
+        __m256i a11 = _mm256_cvtepu8_epi16(_mm_i32gather_epi32(row1, x1, 4));
+
+        // (a00 * (16-y) + a10 * y), (a01 * (16-y) + a11 * y)
+        __m256i left = _mm256_add_epi16(_mm256_mullo_epi16(a00, negY),
+                                        _mm256_mullo_epi16(a10, allY));
+        __m256i right = _mm256_add_epi16(_mm256_mullo_epi16(a01, negY),
+                                         _mm256_mullo_epi16(a11, allY));
+
+        // left * (16-x) + right * x
+        __m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(left, negX),
+                                       _mm256_mullo_epi16(right, allX));
+
+        // Divide each 16 bit component by 256.
+        sum = _mm256_srli_epi16(sum, 8);
+
+        if (hasAlpha) {
+            // Multiply by alpha and divide by 256.
+            sum = _mm256_srli_epi16(_mm256_mullo_epi16(sum, alpha), 8);
+        }
+
+        // Pack to bytes; each lane holds 2 pixels, so gather the low halves.
+        sum = _mm256_packus_epi16(sum, sum);
+        sum = _mm256_permute4x64_epi64(sum, 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(colors),
+                         _mm256_castsi256_si128(sum));
+
+        xx += 4;
+        colors += 4;
+        count -= 4;
+    }
+}
+
+}  // namespace
+
+void S32_D32_filter_DX_AVX2(const void* srcAddr, size_t rowBytes, unsigned alphaScale,
+                            const uint32_t* xy, int count, uint32_t* colors) {
+    if (alphaScale < 256) {
+        filter_DX<true>(static_cast<const char*>(srcAddr), rowBytes, alphaScale,
+                        xy, count, colors);
+    } else {
+        filter_DX<false>(static_cast<const char*>(srcAddr), rowBytes, alphaScale,
+                         xy, count, colors);
+    }
+}
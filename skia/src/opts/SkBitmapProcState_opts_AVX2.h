@@ -0,0 +1,20 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkBitmapProcState_opts_AVX2_DEFINED
+#define SkBitmapProcState_opts_AVX2_DEFINED
+
+#include "SkTypes.h"
+
+// Bilinear filters count pixels, a multiple of 4, from a 32-bit source whose
+// rows are rowBytes apart. xy is laid out as for the DX filter procs and
+// alphaScale is SkBitmapProcState::fAlphaScale, 256 when opaque.
+// opts_check_x86.cpp wraps it into SkBitmapProcState sample procs.
+void S32_D32_filter_DX_AVX2(const void* srcAddr, size_t rowBytes, unsigned alphaScale,
+                            const uint32_t* xy, int count, uint32_t* colors);
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <immintrin.h>
+#include "SkBlitRow_opts_AVX2.h"
+#include "SkColorPriv.h"
+
+/* These are the SSE2 blit rows of SkBlitRow_opts_SSE2.cpp widened to 8 pixels,
+ * and give the same results. This file must be compiled with -mavx2
+ * (/arch:AVX2); opts_check_x86.cpp only calls it on CPUs that have AVX2.
+ * Only SkColorPriv's static inlines may be called here; see opts_check_x86.cpp.
+ */
+
+// Spreads each pixel's alpha byte into the low byte of both of its words:
+// (0, a0, 0, a0, 0, a1, 0, a1, ...) in each 128-bit lane.
+static inline __m256i alpha_words_AVX2(const __m256i& pixels) {
+    const __m256i shuffle = _mm256_setr_epi8(
+         3, -1,  3, -1,  7, -1,  7, -1, 11, -1, 11, -1, 15, -1, 15, -1,
+         3, -1,  3, -1,  7, -1,  7, -1, 11, -1, 11, -1, 15, -1, 15, -1);
+    return _mm256_shuffle_epi8(pixels, shuffle);
+}
+
+void S32A_Opaque_BlitRow32_AVX2(SkPMColor* SK_RESTRICT dst,
+                                const SkPMColor* SK_RESTRICT src,
+                                int count, U8CPU alpha) {
+    SkASSERT(alpha == 255);
+    (void)alpha;  // Only read by the assert.
+    SkASSERT(SK_A32_SHIFT == 24);
+    if (count <= 0) {
+        return;
+    }
+
+    if (count >= 8) {
+        SkASSERT(((size_t)dst & 0x03) == 0);
+        while (((size_t)dst & 0x1F) != 0) {
+            *dst = SkPMSrcOver(*src, *dst);
+            src++;
+            dst++;
+            count--;
+        }
+
+        const __m256i* s = reinterpret_cast<const __m256i*>(src);
+        __m256i* d = reinterpret_cast<__m256i*>(dst);
+        __m256i rb_mask = _mm256_set1_epi32(0x00FF00FF);
+        __m256i alpha_mask = _mm256_set1_epi32(0xFF000000);
+        __m256i c_256 = _mm256_set1_epi16(0x0100);  // 16 copies of 256 (16-bit)
+        while (count >= 8) {
+            // Load 8 pixels
+            __m256i src_pixel = _mm256_loadu_si256(s);
+
+            // Sprites are mostly opaque or clear, and those need no math.
+            // All zero bits means every alpha is 0 (the pixels are premultiplied).
+            if (_mm256_testz_si256(src_pixel, src_pixel)) {
+                s++;
+                d++;
+                count -= 8;
+                continue;
+            }
+            // All alpha bits set means every alpha is 255.
+            if (_mm256_testc_si256(src_pixel, alpha_mask)) {
+                _mm256_store_si256(d, src_pixel);
+                s++;
+                d++;
+                count -= 8;
+                continue;
+            }
+
+            __m256i dst_pixel = _mm256_load_si256(d);
+
+            __m256i dst_rb = _mm256_and_si256(rb_mask, dst_pixel);
+            __m256i dst_ag = _mm256_srli_epi16(dst_pixel, 8);
+
+            // Subtract alphas from 256, to get 1..256
+            __m256i alpha = _mm256_sub_epi16(c_256, alpha_words_AVX2(src_pixel));
+
+            // Multiply by red and blue by src alpha.
+            dst_rb = _mm256_mullo_epi16(dst_rb, alpha);
+            // Multiply by alpha and green by src alpha.
+            dst_ag = _mm256_mullo_epi16(dst_ag, alpha);
+
+            // Divide by 256.
+            dst_rb = _mm256_srli_epi16(dst_rb, 8);
+
+            // Mask out high bits (already in the right place)
+            dst_ag = _mm256_andnot_si256(rb_mask, dst_ag);
+
+            // Combine back into RGBA.
+            dst_pixel = _mm256_or_si256(dst_rb, dst_ag);
+
+            // Add result
+            __m256i result = _mm256_add_epi8(src_pixel, dst_pixel);
+            _mm256_store_si256(d, result);
+            s++;
+            d++;
+            count -= 8;
+        }
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<SkPMColor*>(d);
+    }
+
+    while (count > 0) {
+        *dst = SkPMSrcOver(*src, *dst);
+        src++;
+        dst++;
+        count--;
+    }
+}
+
+void S32A_Blend_BlitRow32_AVX2(SkPMColor* SK_RESTRICT dst,
+                               const SkPMColor* SK_RESTRICT src,
+                               int count, U8CPU alpha) {
+    SkASSERT(alpha <= 255);
+    SkASSERT(SK_A32_SHIFT == 24);
+    if (count <= 0) {
+        return;
+    }
+
+    if (count >= 8) {
+        while (((size_t)dst & 0x1F) != 0) {
+            *dst = SkBlendARGB32(*src, *dst, alpha);
+            src++;
+            dst++;
+            count--;
+        }
+
+        uint32_t src_scale = SkAlpha255To256(alpha);
+
+        const __m256i* s = reinterpret_cast<const __m256i*>(src);
+        __m256i* d = reinterpret_cast<__m256i*>(dst);
+        __m256i src_scale_wide = _mm256_set1_epi16(src_scale << 8);
+        __m256i rb_mask = _mm256_set1_epi32(0x00FF00FF);
+        __m256i c_256 = _mm256_set1_epi16(256);  // 16 copies of 256 (16-bit)
+        while (count >= 8) {
+            // Load 8 pixels each of src and dest.
+            __m256i src_pixel = _mm256_loadu_si256(s);
+            __m256i dst_pixel = _mm256_load_si256(d);
+
+            // Get red and blue pixels into lower byte of each word.
+            __m256i dst_rb = _mm256_and_si256(rb_mask, dst_pixel);
+            __m256i src_rb = _mm256_and_si256(rb_mask, src_pixel);
+
+            // Get alpha and green into lower byte of each word.
+            __m256i dst_ag = _mm256_srli_epi16(dst_pixel, 8);
+            __m256i src_ag = _mm256_srli_epi16(src_pixel, 8);
+
+            // dst_alpha = src alpha * src_scale, already divided by 256
+            // because src_scale is in the higher byte of each word.
+            __m256i dst_alpha = _mm256_mulhi_epu16(alpha_words_AVX2(src_pixel), src_scale_wide);
+
+            // Subtract alphas from 256, to get 1..256
+            dst_alpha = _mm256_sub_epi16(c_256, dst_alpha);
+
+            // Multiply red and blue by dst pixel alpha.
+            dst_rb = _mm256_mullo_epi16(dst_rb, dst_alpha);
+            // Multiply alpha and green by dst pixel alpha.
+            dst_ag = _mm256_mullo_epi16(dst_ag, dst_alpha);
+
+            // Multiply red, blue, alpha and green by global alpha; the results
+            // are already divided by 256.
+            src_rb = _mm256_mulhi_epu16(src_rb, src_scale_wide);
+            src_ag = _mm256_mulhi_epu16(src_ag, src_scale_wide);
+
+            // Divide by 256.
+            dst_rb = _mm256_srli_epi16(dst_rb, 8);
+
+            // Mask out low bits (goodies already in the right place; no need to divide)
+            dst_ag = _mm256_andnot_si256(rb_mask, dst_ag);
+            // Shift alpha and green to higher byte of each word.
+            src_ag = _mm256_slli_epi16(src_ag, 8);
+
+            // Combine back into RGBA.
+            dst_pixel = _mm256_or_si256(dst_rb, dst_ag);
+            src_pixel = _mm256_or_si256(src_rb, src_ag);
+
+            // Add two pixels into result.
+            __m256i result = _mm256_add_epi8(src_pixel, dst_pixel);
+            _mm256_store_si256(d, result);
+            s++;
+            d++;
+            count -= 8;
+        }
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<SkPMColor*>(d);
+    }
+
+    while (count > 0) {
+        *dst = SkBlendARGB32(*src, *dst, alpha);
+        src++;
+        dst++;
+        count--;
+    }
+}
@@ -0,0 +1,267 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <immintrin.h>
+#include "SkColorPriv.h"
+#include "SkXfermode_opts_AVX2.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// 8 pixels AVX2 version functions, ports of the SSE2 ones in
+// SkXfermode_opts_SSE2.cpp, with the same results.
+////////////////////////////////////////////////////////////////////////////////
+
+static inline __m256i SkGetPackedA32_AVX2(const __m256i& src) {
+    __m256i a = _mm256_slli_epi32(src, (24 - SK_A32_SHIFT));
+    return _mm256_srli_epi32(a, 24);
+}
+
+static inline __m256i SkGetPackedR32_AVX2(const __m256i& src) {
+    __m256i r = _mm256_slli_epi32(src, (24 - SK_R32_SHIFT));
+    return _mm256_srli_epi32(r, 24);
+}
+
+static inline __m256i SkGetPackedG32_AVX2(const __m256i& src) {
+    __m256i g = _mm256_slli_epi32(src, (24 - SK_G32_SHIFT));
+    return _mm256_srli_epi32(g, 24);
+}
+
+static inline __m256i SkGetPackedB32_AVX2(const __m256i& src) {
+    __m256i b = _mm256_slli_epi32(src, (24 - SK_B32_SHIFT));
+    return _mm256_srli_epi32(b, 24);
+}
+
+static inline __m256i SkPackARGB32_AVX2(const __m256i& a, const __m256i& r,
+                                        const __m256i& g, const __m256i& b) {
+    __m256i da = _mm256_slli_epi32(a, SK_A32_SHIFT);
+    __m256i dr = _mm256_slli_epi32(r, SK_R32_SHIFT);
+    __m256i dg = _mm256_slli_epi32(g, SK_G32_SHIFT);
+    __m256i db = _mm256_slli_epi32(b, SK_B32_SHIFT);
+
+    __m256i c = _mm256_or_si256(da, dr);
+    c = _mm256_or_si256(c, dg);
+    return _mm256_or_si256(c, db);
+}
+
+static inline __m256i SkAlpha255To256_AVX2(const __m256i& alpha) {
+    return _mm256_add_epi32(alpha, _mm256_set1_epi32(1));
+}
+
+// See SkAlphaMulAlpha_SSE2() in SkColor_opts_SSE2.h.
+static inline __m256i SkAlphaMulAlpha_AVX2(const __m256i& a, const __m256i& b) {
+    __m256i prod = _mm256_mullo_epi16(a, b);
+    prod = _mm256_add_epi32(prod, _mm256_set1_epi32(128));
+    prod = _mm256_add_epi32(prod, _mm256_srli_epi32(prod, 8));
+    prod = _mm256_srli_epi32(prod, 8);
+
+    return prod;
+}
+
+// See SkAlphaMulQ_SSE2() in SkColor_opts_SSE2.h.
+static inline __m256i SkAlphaMulQ_AVX2(const __m256i& c, const __m256i& scale) {
+    __m256i mask = _mm256_set1_epi32(0xFF00FF);
+    __m256i s = _mm256_or_si256(_mm256_slli_epi32(scale, 16), scale);
+
+    // uint32_t rb = ((c & mask) * scale) >> 8
+    __m256i rb = _mm256_and_si256(mask, c);
+    rb = _mm256_mullo_epi16(rb, s);
+    rb = _mm256_srli_epi16(rb, 8);
+
+    // uint32_t ag = ((c >> 8) & mask) * scale
+    __m256i ag = _mm256_srli_epi16(c, 8);
+    ag = _mm256_and_si256(ag, mask);
+    ag = _mm256_mullo_epi16(ag, s);
+
+    // (rb & mask) | (ag & ~mask)
+    rb = _mm256_and_si256(mask, rb);
+    ag = _mm256_andnot_si256(mask, ag);
+    return _mm256_or_si256(rb, ag);
+}
+
+static inline __m256i saturated_add_AVX2(const __m256i& a, const __m256i& b) {
+    return _mm256_min_epi32(_mm256_add_epi32(a, b), _mm256_set1_epi32(255));
+}
+
+static __m256i srcover_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i isa = _mm256_sub_epi32(_mm256_set1_epi32(256), SkGetPackedA32_AVX2(src));
+    return _mm256_add_epi32(src, SkAlphaMulQ_AVX2(dst, isa));
+}
+
+static __m256i dstover_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i ida = _mm256_sub_epi32(_mm256_set1_epi32(256), SkGetPackedA32_AVX2(dst));
+    return _mm256_add_epi32(dst, SkAlphaMulQ_AVX2(src, ida));
+}
+
+static __m256i srcin_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i da = SkGetPackedA32_AVX2(dst);
+    return SkAlphaMulQ_AVX2(src, SkAlpha255To256_AVX2(da));
+}
+
+static __m256i dstin_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    return SkAlphaMulQ_AVX2(dst, SkAlpha255To256_AVX2(sa));
+}
+
+static __m256i srcout_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i ida = _mm256_sub_epi32(_mm256_set1_epi32(256), SkGetPackedA32_AVX2(dst));
+    return SkAlphaMulQ_AVX2(src, ida);
+}
+
+static __m256i dstout_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i isa = _mm256_sub_epi32(_mm256_set1_epi32(256), SkGetPackedA32_AVX2(src));
+    return SkAlphaMulQ_AVX2(dst, isa);
+}
+
+static __m256i srcatop_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    __m256i da = SkGetPackedA32_AVX2(dst);
+    __m256i isa = _mm256_sub_epi32(_mm256_set1_epi32(255), sa);
+
+    __m256i a = da;
+
+    __m256i r1 = SkAlphaMulAlpha_AVX2(da, SkGetPackedR32_AVX2(src));
+    __m256i r2 = SkAlphaMulAlpha_AVX2(isa, SkGetPackedR32_AVX2(dst));
+    __m256i r = _mm256_add_epi32(r1, r2);
+
+    __m256i g1 = SkAlphaMulAlpha_AVX2(da, SkGetPackedG32_AVX2(src));
+    __m256i g2 = SkAlphaMulAlpha_AVX2(isa, SkGetPackedG32_AVX2(dst));
+    __m256i g = _mm256_add_epi32(g1, g2);
+
+    __m256i b1 = SkAlphaMulAlpha_AVX2(da, SkGetPackedB32_AVX2(src));
+    __m256i b2 = SkAlphaMulAlpha_AVX2(isa, SkGetPackedB32_AVX2(dst));
+    __m256i b = _mm256_add_epi32(b1, b2);
+
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static __m256i dstatop_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    __m256i da = SkGetPackedA32_AVX2(dst);
+    __m256i ida = _mm256_sub_epi32(_mm256_set1_epi32(255), da);
+
+    __m256i a = sa;
+
+    __m256i r1 = SkAlphaMulAlpha_AVX2(ida, SkGetPackedR32_AVX2(src));
+    __m256i r2 = SkAlphaMulAlpha_AVX2(sa, SkGetPackedR32_AVX2(dst));
+    __m256i r = _mm256_add_epi32(r1, r2);
+
+    __m256i g1 = SkAlphaMulAlpha_AVX2(ida, SkGetPackedG32_AVX2(src));
+    __m256i g2 = SkAlphaMulAlpha_AVX2(sa, SkGetPackedG32_AVX2(dst));
+    __m256i g = _mm256_add_epi32(g1, g2);
+
+    __m256i b1 = SkAlphaMulAlpha_AVX2(ida, SkGetPackedB32_AVX2(src));
+    __m256i b2 = SkAlphaMulAlpha_AVX2(sa, SkGetPackedB32_AVX2(dst));
+    __m256i b = _mm256_add_epi32(b1, b2);
+
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static __m256i xor_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    __m256i da = SkGetPackedA32_AVX2(dst);
+    __m256i isa = _mm256_sub_epi32(_mm256_set1_epi32(255), sa);
+    __m256i ida = _mm256_sub_epi32(_mm256_set1_epi32(255), da);
+
+    __m256i a1 = _mm256_add_epi32(sa, da);
+    __m256i a2 = SkAlphaMulAlpha_AVX2(sa, da);
+    a2 = _mm256_slli_epi32(a2, 1);
+    __m256i a = _mm256_sub_epi32(a1, a2);
+
+    __m256i r1 = SkAlphaMulAlpha_AVX2(ida, SkGetPackedR32_AVX2(src));
+    __m256i r2 = SkAlphaMulAlpha_AVX2(isa, SkGetPackedR32_AVX2(dst));
+    __m256i r = _mm256_add_epi32(r1, r2);
+
+    __m256i g1 = SkAlphaMulAlpha_AVX2(ida, SkGetPackedG32_AVX2(src));
+    __m256i g2 = SkAlphaMulAlpha_AVX2(isa, SkGetPackedG32_AVX2(dst));
+    __m256i g = _mm256_add_epi32(g1, g2);
+
+    __m256i b1 = SkAlphaMulAlpha_AVX2(ida, SkGetPackedB32_AVX2(src));
+    __m256i b2 = SkAlphaMulAlpha_AVX2(isa, SkGetPackedB32_AVX2(dst));
+    __m256i b = _mm256_add_epi32(b1, b2);
+
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static __m256i plus_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    // Every channel saturates at 255, so this is a bytewise saturated add.
+    return _mm256_adds_epu8(src, dst);
+}
+
+static __m256i modulate_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i a = SkAlphaMulAlpha_AVX2(SkGetPackedA32_AVX2(src),
+                                     SkGetPackedA32_AVX2(dst));
+    __m256i r = SkAlphaMulAlpha_AVX2(SkGetPackedR32_AVX2(src),
+                                     SkGetPackedR32_AVX2(dst));
+    __m256i g = SkAlphaMulAlpha_AVX2(SkGetPackedG32_AVX2(src),
+                                     SkGetPackedG32_AVX2(dst));
+    __m256i b = SkAlphaMulAlpha_AVX2(SkGetPackedB32_AVX2(src),
+                                     SkGetPackedB32_AVX2(dst));
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static inline __m256i srcover_byte_AVX2(const __m256i& a, const __m256i& b) {
+    // a + b - SkAlphaMulAlpha(a, b);
+    return _mm256_sub_epi32(_mm256_add_epi32(a, b), SkAlphaMulAlpha_AVX2(a, b));
+}
+
+static __m256i screen_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i a = srcover_byte_AVX2(SkGetPackedA32_AVX2(src),
+                                  SkGetPackedA32_AVX2(dst));
+    __m256i r = srcover_byte_AVX2(SkGetPackedR32_AVX2(src),
+                                  SkGetPackedR32_AVX2(dst));
+    __m256i g = srcover_byte_AVX2(SkGetPackedG32_AVX2(src),
+                                  SkGetPackedG32_AVX2(dst));
+    __m256i b = srcover_byte_AVX2(SkGetPackedB32_AVX2(src),
+                                  SkGetPackedB32_AVX2(dst));
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+typedef __m256i (*SkXfermodeProcAVX2)(const __m256i& src, const __m256i& dst);
+
+// 8 pixels modeprocs with AVX2. Overlay and the modes after it branch per
+// channel and stay on SSE2.
+static const SkXfermodeProcAVX2 gAVX2XfermodeProcs[] = {
+    NULL, // kClear_Mode
+    NULL, // kSrc_Mode
+    NULL, // kDst_Mode
+    srcover_modeproc_AVX2,
+    dstover_modeproc_AVX2,
+    srcin_modeproc_AVX2,
+    dstin_modeproc_AVX2,
+    srcout_modeproc_AVX2,
+    dstout_modeproc_AVX2,
+    srcatop_modeproc_AVX2,
+    dstatop_modeproc_AVX2,
+    xor_modeproc_AVX2,
+    plus_modeproc_AVX2,
+    modulate_modeproc_AVX2,
+    screen_modeproc_AVX2,
+};
+
+bool SkXfermodeHasProc_AVX2(int mode) {
+    return mode >= 0 && mode < static_cast<int>(SK_ARRAY_COUNT(gAVX2XfermodeProcs)) &&
+           NULL != gAVX2XfermodeProcs[mode];
+}
+
+void SkXfermodeXfer32_AVX2(int mode, SkPMColor dst[], const SkPMColor src[], int count) {
+    SkASSERT(SkXfermodeHasProc_AVX2(mode));
+    SkASSERT((count & 7) == 0 && ((size_t)dst & 0x1F) == 0);
+
+    SkXfermodeProcAVX2 procAVX2 = gAVX2XfermodeProcs[mode];
+    const __m256i* s = reinterpret_cast<const __m256i*>(src);
+    __m256i* d = reinterpret_cast<__m256i*>(dst);
+
+    while (count >= 8) {
+        __m256i src_pixel = _mm256_loadu_si256(s++);
+        __m256i dst_pixel = _mm256_load_si256(d);
+
+        dst_pixel = procAVX2(src_pixel, dst_pixel);
+        _mm256_store_si256(d++, dst_pixel);
+        count -= 8;
+    }
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkXfermode_opts_AVX2_DEFINED
+#define SkXfermode_opts_AVX2_DEFINED
+
+#include "SkColor.h"
+
+// SkAVX2ProcCoeffXfermode, which calls these, lives in SkXfermode_opts_SSE2.cpp
+// so that no class code is built with -mavx2; see opts_check_x86.cpp.
+
+// Returns true if the SkXfermode::Mode mode has an AVX2 proc.
+bool SkXfermodeHasProc_AVX2(int mode);
+
+// Blends count pixels of src into dst with mode's AVX2 proc. count must be a
+// multiple of 8 and dst 32-byte aligned.
+void SkXfermodeXfer32_AVX2(int mode, SkPMColor dst[], const SkPMColor src[], int count);
+
+#endif // SkXfermode_opts_AVX2_DEFINED
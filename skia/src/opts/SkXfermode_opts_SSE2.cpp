@@ -10,6 +10,7 @@
 #include "SkMathPriv.h"
 #include "SkMath_opts_SSE2.h"
 #include "SkXfermode.h"
+#include "SkXfermode_opts_AVX2.h"
 #include "SkXfermode_opts_SSE2.h"
 #include "SkXfermode_proccoeff.h"
 
@@ -817,3 +818,54 @@ SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl_SSE2(const ProcCoeff& rec,
     }
     return NULL;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Blends 8 pixels at a time in xfer32() with SkXfermode_opts_AVX2.cpp and
+// leaves everything else, including flattening, to the SSE2 xfermode: a
+// flattened AVX2 xfermode is read back as an SSE2 one, so pictures do not
+// depend on the CPU that recorded them. It lives here so that none of its
+// code is built with AVX2.
+class SkAVX2ProcCoeffXfermode : public SkSSE2ProcCoeffXfermode {
+public:
+    SkAVX2ProcCoeffXfermode(const ProcCoeff& rec, SkXfermode::Mode mode,
+                            void* procSSE2)
+        : INHERITED(rec, mode, procSSE2) {}
+
+    virtual void xfer32(SkPMColor dst[], const SkPMColor src[], int count,
+                        const SkAlpha aa[]) const SK_OVERRIDE {
+        SkASSERT(dst && src && count >= 0);
+
+        if (NULL != aa || count < 8) {
+            this->INHERITED::xfer32(dst, src, count, aa);
+            return;
+        }
+
+        SkXfermodeProc proc = this->getProc();
+        while (((size_t)dst & 0x1F) != 0) {
+            *dst = proc(*src, *dst);
+            dst++;
+            src++;
+            count--;
+        }
+
+        int blocks = count & ~7;
+        SkXfermodeXfer32_AVX2(this->getMode(), dst, src, blocks);
+
+        for (int i = blocks; i < count; ++i) {
+            dst[i] = proc(src[i], dst[i]);
+        }
+    }
+
+private:
+    typedef SkSSE2ProcCoeffXfermode INHERITED;
+};
+
+SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl_AVX2(const ProcCoeff& rec,
+                                                         SkXfermode::Mode mode) {
+    void* procSSE2 = reinterpret_cast<void*>(gSSE2XfermodeProcs[mode]);
+    if (SkXfermodeHasProc_AVX2(mode) && procSSE2 != NULL) {
+        return SkNEW_ARGS(SkAVX2ProcCoeffXfermode, (rec, mode, procSSE2));
+    }
+    return NULL;
+}
@@ -35,4 +35,10 @@ private:
 SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl_SSE2(const ProcCoeff& rec,
                                                          SkXfermode::Mode mode);
 
+// Returns an SSE2 xfermode that blends with AVX2 when there are no coverage
+// values, or NULL for modes without an AVX2 proc. Only call it on CPUs that
+// have AVX2.
+SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl_AVX2(const ProcCoeff& rec,
+                                                         SkXfermode::Mode mode);
+
 #endif // SkXfermode_opts_SSE2_DEFINED
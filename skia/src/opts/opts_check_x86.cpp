@@ -6,11 +6,13 @@
  */
 
 #include "SkBitmapFilter_opts_SSE2.h"
+#include "SkBitmapProcState_opts_AVX2.h"
 #include "SkBitmapProcState_opts_SSE2.h"
 #include "SkBitmapProcState_opts_SSSE3.h"
 #include "SkBlitMask.h"
 #include "SkBlitRect_opts_SSE2.h"
 #include "SkBlitRow.h"
+#include "SkBlitRow_opts_AVX2.h"
 #include "SkBlitRow_opts_SSE2.h"
 #include "SkBlurImage_opts_SSE2.h"
 #include "SkMorphology_opts.h"
@@ -20,6 +22,7 @@
 #include "SkUtils_opts_SSE2.h"
 #include "SkXfermode.h"
 #include "SkXfermode_proccoeff.h"
+#include <string.h>
 
 #if defined(_MSC_VER) && defined(_WIN64)
 #include <intrin.h>
@@ -29,17 +32,21 @@
    extension, otherwise gcc may generate SIMD instructions even for scalar ops
    (and thus give an invalid instruction on Pentium3 on the code below).
    For example, only files named *_SSE2.cpp in this directory should be
-   compiled with -msse2 or higher. */
+   compiled with -msse2 or higher, and only *_AVX2.cpp with -mavx2.
+   The *_AVX2.cpp files export plain functions only and are wrapped into Skia
+   procs and classes here or in the *_SSE2.cpp files, so no inline function
+   the linker might share with other files is ever built with AVX2. */
 
 
 /* Function to get the CPU SSE-level in runtime, for different compilers. */
 #ifdef _MSC_VER
 static inline void getcpuid(int info_type, int info[4]) {
 #if defined(_WIN64)
-    __cpuid(info, info_type);
+    __cpuidex(info, info_type, 0);
 #else
     __asm {
         mov    eax, [info_type]
+        xor    ecx, ecx
         cpuid
         mov    edi, [info]
         mov    [edi], eax
@@ -54,7 +61,7 @@ static inline void getcpuid(int info_type, int info[4]) {
     asm volatile (
         "cpuid \n\t"
         : "=a"(info[0]), "=b"(info[1]), "=c"(info[2]), "=d"(info[3])
-        : "a"(info_type)
+        : "a"(info_type), "c"(0)
     );
 }
 #else
@@ -66,11 +73,42 @@ static inline void getcpuid(int info_type, int info[4]) {
         "movl %%ebx, %1   \n\t"
         "popl %%ebx       \n\t"
         : "=a"(info[0]), "=r"(info[1]), "=c"(info[2]), "=d"(info[3])
-        : "a"(info_type)
+        : "a"(info_type), "c"(0)
     );
 }
 #endif
 
+/* Read the XCR0 register, which says which register states the OS saves.
+   Only call this when cpuid says OSXSAVE is set. */
+#ifdef _MSC_VER
+static inline uint64_t getxcr0() {
+#if defined(_WIN64)
+    return _xgetbv(0);
+#else
+    uint32_t lo, hi;
+    __asm {
+        xor    ecx, ecx
+        _emit  0x0f  // xgetbv
+        _emit  0x01
+        _emit  0xd0
+        mov    [lo], eax
+        mov    [hi], edx
+    }
+    return ((uint64_t)hi << 32) | lo;
+#endif
+}
+#else
+static inline uint64_t getxcr0() {
+    uint32_t lo, hi;
+    asm volatile (
+        ".byte 0x0f, 0x01, 0xd0 \n\t"  // xgetbv
+        : "=a"(lo), "=d"(hi)
+        : "c"(0)
+    );
+    return ((uint64_t)hi << 32) | lo;
+}
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 
 /* Fetch the SIMD level directly from the CPU, at run-time.
@@ -81,6 +119,18 @@ static int get_SIMD_level() {
 
     getcpuid(1, cpu_info);
     if ((cpu_info[2] & (1<<20)) != 0) {
+        // AVX2 also needs the OS to save the YMM registers (OSXSAVE, AVX, and
+        // the SSE and AVX state bits of XCR0).
+        const int kOSXSAVE_AVX = (1<<27) | (1<<28);
+        if ((cpu_info[2] & kOSXSAVE_AVX) == kOSXSAVE_AVX && (getxcr0() & 6) == 6) {
+            getcpuid(0, cpu_info);
+            if (cpu_info[0] >= 7) {
+                getcpuid(7, cpu_info);
+                if ((cpu_info[1] & (1<<5)) != 0) {
+                    return SK_CPU_SSE_LEVEL_AVX2;
+                }
+            }
+        }
         return SK_CPU_SSE_LEVEL_SSE42;
     } else if ((cpu_info[2] & (1<<9)) != 0) {
         return SK_CPU_SSE_LEVEL_SSSE3;
@@ -119,6 +169,44 @@ static inline bool supports_simd(int minLevel) {
 ////////////////////////////////////////////////////////////////////////////////
 
 SK_CONF_DECLARE( bool, c_hqfilter_sse, "bitmap.filter.highQualitySSE", false, "Use SSE optimized version of high quality image filters");
+SK_CONF_DECLARE( bool, c_avx2, "opts.useAVX2", true, "Use AVX2 blit rows, xfermodes and bilinear filters on CPUs that have AVX2");
+
+static inline bool use_avx2() {
+    return c_avx2 && supports_simd(SK_CPU_SSE_LEVEL_AVX2);
+}
+
+// The AVX2 filter does 4 pixels at a time; the last 1 to 3 go to the SSE2 one.
+static void filter_DX_AVX2(const SkBitmapProcState& s, const uint32_t* xy,
+                           int count, uint32_t* colors,
+                           SkBitmapProcState::SampleProc32 tailProc) {
+    SkASSERT(count > 0 && colors != NULL);
+    SkASSERT(s.fFilterLevel != SkPaint::kNone_FilterLevel);
+    SkASSERT(kN32_SkColorType == s.fBitmap->colorType());
+
+    int blocks = count & ~3;
+    if (blocks > 0) {
+        S32_D32_filter_DX_AVX2(s.fBitmap->getPixels(), s.fBitmap->rowBytes(),
+                               s.fAlphaScale, xy, blocks, colors);
+    }
+    if (count > blocks) {
+        uint32_t tail[4];
+        tail[0] = xy[0];
+        memcpy(&tail[1], xy + 1 + blocks, (count - blocks) * sizeof(uint32_t));
+        tailProc(s, tail, count - blocks, colors + blocks);
+    }
+}
+
+static void S32_opaque_D32_filter_DX_AVX2(const SkBitmapProcState& s,
+                                          const uint32_t* xy,
+                                          int count, uint32_t* colors) {
+    filter_DX_AVX2(s, xy, count, colors, S32_opaque_D32_filter_DX_SSE2);
+}
+
+static void S32_alpha_D32_filter_DX_AVX2(const SkBitmapProcState& s,
+                                         const uint32_t* xy,
+                                         int count, uint32_t* colors) {
+    filter_DX_AVX2(s, xy, count, colors, S32_alpha_D32_filter_DX_SSE2);
+}
 
 void SkBitmapProcState::platformConvolutionProcs(SkConvolutionProcs* procs) {
     if (supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
@@ -140,7 +228,9 @@ void SkBitmapProcState::platformProcs() {
 
     /* Check fSampleProc32 */
     if (fSampleProc32 == S32_opaque_D32_filter_DX) {
-        if (supports_simd(SK_CPU_SSE_LEVEL_SSSE3)) {
+        if (use_avx2()) {
+            fSampleProc32 = S32_opaque_D32_filter_DX_AVX2;
+        } else if (supports_simd(SK_CPU_SSE_LEVEL_SSSE3)) {
             fSampleProc32 = S32_opaque_D32_filter_DX_SSSE3;
         } else {
             fSampleProc32 = S32_opaque_D32_filter_DX_SSE2;
@@ -150,7 +240,9 @@ void SkBitmapProcState::platformProcs() {
             fSampleProc32 = S32_opaque_D32_filter_DXDY_SSSE3;
         }
     } else if (fSampleProc32 == S32_alpha_D32_filter_DX) {
-        if (supports_simd(SK_CPU_SSE_LEVEL_SSSE3)) {
+        if (use_avx2()) {
+            fSampleProc32 = S32_alpha_D32_filter_DX_AVX2;
+        } else if (supports_simd(SK_CPU_SSE_LEVEL_SSSE3)) {
             fSampleProc32 = S32_alpha_D32_filter_DX_SSSE3;
         } else {
             fSampleProc32 = S32_alpha_D32_filter_DX_SSE2;
@@ -213,8 +305,21 @@ static SkBlitRow::Proc32 platform_32_procs[] = {
     S32A_Blend_BlitRow32_SSE2,          // S32A_Blend,
 };
 
+static SkBlitRow::Proc32 platform_32_procs_AVX2[] = {
+    NULL,                               // S32_Opaque,
+    S32_Blend_BlitRow32_SSE2,           // S32_Blend,
+#ifdef SK_USE_ACCURATE_BLENDING
+    S32A_Opaque_BlitRow32_SSE2,         // S32A_Opaque
+#else
+    S32A_Opaque_BlitRow32_AVX2,         // S32A_Opaque
+#endif
+    S32A_Blend_BlitRow32_AVX2,          // S32A_Blend,
+};
+
 SkBlitRow::Proc32 SkBlitRow::PlatformProcs32(unsigned flags) {
-    if (supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
+    if (use_avx2()) {
+        return platform_32_procs_AVX2[flags];
+    } else if (supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
         return platform_32_procs[flags];
     } else {
         return NULL;
@@ -351,6 +456,8 @@ bool SkBoxBlurGetPlatformProcs(SkBoxBlurProc* boxBlurX,
 
 extern SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl_SSE2(const ProcCoeff& rec,
                                                                 SkXfermode::Mode mode);
+extern SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl_AVX2(const ProcCoeff& rec,
+                                                                SkXfermode::Mode mode);
 
 SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl(const ProcCoeff& rec,
                                                     SkXfermode::Mode mode);
@@ -365,6 +472,12 @@ SkProcCoeffXfermode* SkPlatformXfermodeFactory(const ProcCoeff& rec,
 
 SkProcCoeffXfermode* SkPlatformXfermodeFactory(const ProcCoeff& rec,
                                                SkXfermode::Mode mode) {
+    if (use_avx2()) {
+        SkProcCoeffXfermode* xfermode = SkPlatformXfermodeFactory_impl_AVX2(rec, mode);
+        if (NULL != xfermode) {
+            return xfermode;
+        }
+    }
     if (supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
         return SkPlatformXfermodeFactory_impl_SSE2(rec, mode);
     } else {
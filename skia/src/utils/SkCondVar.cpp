@@ -8,61 +8,61 @@
 #include "SkCondVar.h"
 
 SkCondVar::SkCondVar() {
-#ifdef SK_USE_POSIX_THREADS
-    pthread_mutex_init(&fMutex, NULL /* default mutex attr */);
-    pthread_cond_init(&fCond, NULL /* default cond attr */);
-#elif defined(SK_BUILD_FOR_WIN32)
+#ifdef SK_BUILD_FOR_WIN32
     InitializeCriticalSection(&fCriticalSection);
     InitializeConditionVariable(&fCondition);
+#else
+    pthread_mutex_init(&fMutex, NULL /* default mutex attr */);
+    pthread_cond_init(&fCond, NULL /* default cond attr */);
 #endif
 }
 
 SkCondVar::~SkCondVar() {
-#ifdef SK_USE_POSIX_THREADS
-    pthread_mutex_destroy(&fMutex);
-    pthread_cond_destroy(&fCond);
-#elif defined(SK_BUILD_FOR_WIN32)
+#ifdef SK_BUILD_FOR_WIN32
     DeleteCriticalSection(&fCriticalSection);
     // No need to clean up fCondition.
+#else
+    pthread_mutex_destroy(&fMutex);
+    pthread_cond_destroy(&fCond);
 #endif
 }
 
 void SkCondVar::lock() {
-#ifdef SK_USE_POSIX_THREADS
-    pthread_mutex_lock(&fMutex);
-#elif defined(SK_BUILD_FOR_WIN32)
+#ifdef SK_BUILD_FOR_WIN32
     EnterCriticalSection(&fCriticalSection);
+#else
+    pthread_mutex_lock(&fMutex);
 #endif
 }
 
 void SkCondVar::unlock() {
-#ifdef SK_USE_POSIX_THREADS
-    pthread_mutex_unlock(&fMutex);
-#elif defined(SK_BUILD_FOR_WIN32)
+#ifdef SK_BUILD_FOR_WIN32
     LeaveCriticalSection(&fCriticalSection);
+#else
+    pthread_mutex_unlock(&fMutex);
 #endif
 }
 
 void SkCondVar::wait() {
-#ifdef SK_USE_POSIX_THREADS
-    pthread_cond_wait(&fCond, &fMutex);
-#elif defined(SK_BUILD_FOR_WIN32)
+#ifdef SK_BUILD_FOR_WIN32
     SleepConditionVariableCS(&fCondition, &fCriticalSection, INFINITE);
+#else
+    pthread_cond_wait(&fCond, &fMutex);
 #endif
 }
 
 void SkCondVar::signal() {
-#ifdef SK_USE_POSIX_THREADS
-    pthread_cond_signal(&fCond);
-#elif defined(SK_BUILD_FOR_WIN32)
+#ifdef SK_BUILD_FOR_WIN32
     WakeConditionVariable(&fCondition);
+#else
+    pthread_cond_signal(&fCond);
 #endif
 }
 
 void SkCondVar::broadcast() {
-#ifdef SK_USE_POSIX_THREADS
-    pthread_cond_broadcast(&fCond);
-#elif defined(SK_BUILD_FOR_WIN32)
+#ifdef SK_BUILD_FOR_WIN32
     WakeAllConditionVariable(&fCondition);
+#else
+    pthread_cond_broadcast(&fCond);
 #endif
 }
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
+#include "SkGraphics.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+#include "SkTemplates.h"
+#include "Test.h"
+
+static const int kSize = 64;
+
+// The reference draws the path without anti-aliasing at kScale times the
+// size and averages each kScale x kScale block, which is itself only within
+// about 8 of the exact area. Analytic AA must be within kTolerance of it.
+static const int kScale = 16;
+static const int kTolerance = 12;
+
+// Where a path overlaps itself the areas of both parts add up, so a pixel
+// that both parts only partly cover comes out too dark. Those pixels must be
+// within kOverlapTolerance, and at most kMaxOverlapPixels may need it.
+static const int kOverlapTolerance = 48;
+static const int kMaxOverlapPixels = 8;
+
+static void draw(const SkPath& path, const SkPaint& paint, bool analytic, SkBitmap* bitmap) {
+    bitmap->allocN32Pixels(kSize, kSize);
+    bitmap->eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas canvas(*bitmap);
+    bool prev = SkGraphics::SetAnalyticAAEnabled(analytic);
+    canvas.drawPath(path, paint);
+    SkGraphics::SetAnalyticAAEnabled(prev);
+}
+
+static U8CPU alpha(const SkBitmap& bitmap, int x, int y) {
+    SkAutoLockPixels alp(bitmap);
+    return SkGetPackedA32(*bitmap.getAddr32(x, y));
+}
+
+static void draw_reference(const SkPath& path, const SkPaint& paint, uint8_t coverage[]) {
+    SkBitmap big;
+    big.allocN32Pixels(kSize * kScale, kSize * kScale);
+    big.eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas canvas(big);
+    canvas.scale(kScale, kScale);
+    SkPaint aliased(paint);
+    aliased.setAntiAlias(false);
+    canvas.drawPath(path, aliased);
+
+    SkAutoLockPixels alp(big);
+    for (int y = 0; y < kSize; ++y) {
+        for (int x = 0; x < kSize; ++x) {
+            int sum = 0;
+            for (int j = 0; j < kScale; ++j) {
+                for (int i = 0; i < kScale; ++i) {
+                    sum += SkGetPackedA32(*big.getAddr32(x * kScale + i, y * kScale + j));
+                }
+            }
+            coverage[y * kSize + x] = SkToU8((sum + kScale * kScale / 2) / (kScale * kScale));
+        }
+    }
+}
+
+static void check(skiatest::Reporter* reporter, const char* name,
+                  const SkPath& path, const SkPaint& paint, bool overlaps) {
+    SkBitmap analytic;
+    draw(path, paint, true, &analytic);
+    SkAutoTMalloc<uint8_t> reference(kSize * kSize);
+    draw_reference(path, paint, reference.get());
+
+    int maxDiff = 0;
+    int over = 0;
+    for (int y = 0; y < kSize; ++y) {
+        for (int x = 0; x < kSize; ++x) {
+            int diff = SkAbs32((int)alpha(analytic, x, y) - (int)reference[y * kSize + x]);
+            maxDiff = SkMax32(maxDiff, diff);
+            if (diff > kTolerance) {
+                over++;
+            }
+        }
+    }
+    if (!overlaps && over > 0) {
+        ERRORF(reporter, "%s: analytic AA is off by up to %d", name, maxDiff);
+    }
+    if (overlaps && (maxDiff > kOverlapTolerance || over > kMaxOverlapPixels)) {
+        ERRORF(reporter, "%s: analytic AA is off by up to %d, %d pixels by more than %d",
+               name, maxDiff, over, kTolerance);
+    }
+}
+
+static SkPath zigzag() {
+    SkPath path;
+    path.moveTo(4, 56);
+    path.lineTo(16, 8);
+    path.lineTo(24, 56);
+    path.lineTo(34, 20);
+    path.lineTo(40, 56);
+    path.lineTo(60, 10);
+    return path;
+}
+
+static SkPath star(SkPath::FillType fillType) {
+    SkPath path;
+    path.moveTo(32, 4);
+    path.lineTo(48.5f, 58);
+    path.lineTo(5.5f, 24);
+    path.lineTo(58.5f, 24);
+    path.lineTo(15.5f, 58);
+    path.close();
+    path.setFillType(fillType);
+    return path;
+}
+
+// Edges at quarter and half pixels, and a diagonal through pixel corners,
+// come out as their exact areas.
+static void test_exact(skiatest::Reporter* reporter) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    SkBitmap bitmap;
+
+    SkPath rect;
+    rect.addRect(SkRect::MakeLTRB(10.25f, 10.5f, 20.75f, 20));
+    draw(rect, paint, true, &bitmap);
+    REPORTER_ASSERT(reporter, 0xFF == alpha(bitmap, 15, 15));
+    REPORTER_ASSERT(reporter, 0xBF == alpha(bitmap, 10, 15));     // 3/4
+    REPORTER_ASSERT(reporter, 0xBF == alpha(bitmap, 20, 15));     // 3/4
+    REPORTER_ASSERT(reporter, 0x80 == alpha(bitmap, 15, 10));     // 1/2
+    REPORTER_ASSERT(reporter, 0x60 == alpha(bitmap, 10, 10));     // 3/8
+    REPORTER_ASSERT(reporter, 0 == alpha(bitmap, 9, 15));
+    REPORTER_ASSERT(reporter, 0 == alpha(bitmap, 15, 20));
+
+    SkPath triangle;
+    triangle.moveTo(0, 0);
+    triangle.lineTo(kSize, 0);
+    triangle.lineTo(kSize, kSize);
+    triangle.close();
+    draw(triangle, paint, true, &bitmap);
+    for (int i = 0; i < kSize; ++i) {
+        REPORTER_ASSERT(reporter, 0x80 == alpha(bitmap, i, i));
+        if (i > 0) {
+            REPORTER_ASSERT(reporter, 0xFF == alpha(bitmap, i, i - 1));
+            REPORTER_ASSERT(reporter, 0 == alpha(bitmap, i - 1, i));
+        }
+    }
+}
+
+static void test_matches_reference(skiatest::Reporter* reporter) {
+    SkPaint fill;
+    fill.setAntiAlias(true);
+
+    SkPath circle;
+    circle.addCircle(32, 32, 27.3f);
+    check(reporter, "circle", circle, fill, false);
+
+    SkPath rotated;
+    rotated.addRect(SkRect::MakeLTRB(12, 20, 52, 44));
+    SkMatrix matrix;
+    matrix.setRotate(17, 32, 32);
+    rotated.transform(matrix);
+    check(reporter, "rotated rect", rotated, fill, false);
+
+    SkPath cubic;
+    cubic.moveTo(6, 58);
+    cubic.cubicTo(6, 2, 58, 62, 58, 6);
+    cubic.lineTo(40, 58);
+    cubic.close();
+    check(reporter, "cubic", cubic, fill, false);
+
+    check(reporter, "even-odd star", star(SkPath::kEvenOdd_FillType), fill, false);
+    // The points of the star cover its middle twice, which is clamped to
+    // full coverage. The edges cross at single points, so no pixel is
+    // partly covered by both.
+    check(reporter, "winding star", star(SkPath::kWinding_FillType), fill, false);
+
+    // SkStroke's inner joins overlap the stroke itself. Strokes of width 1
+    // or less are drawn as hairlines and never get here.
+    static const SkPaint::Join kJoins[] = {
+        SkPaint::kMiter_Join, SkPaint::kRound_Join, SkPaint::kBevel_Join,
+    };
+    static const SkScalar kWidths[] = { 2.5f, 6 };
+    SkPaint stroke(fill);
+    stroke.setStyle(SkPaint::kStroke_Style);
+    for (size_t j = 0; j < SK_ARRAY_COUNT(kJoins); ++j) {
+        for (size_t w = 0; w < SK_ARRAY_COUNT(kWidths); ++w) {
+            stroke.setStrokeJoin(kJoins[j]);
+            stroke.setStrokeWidth(kWidths[w]);
+            SkString name;
+            name.printf("zigzag join %d width %g", kJoins[j], kWidths[w]);
+            check(reporter, name.c_str(), zigzag(), stroke, true);
+        }
+    }
+}
+
+DEF_TEST(AnalyticAA, reporter) {
+    test_exact(reporter);
+    test_matches_reference(reporter);
+}
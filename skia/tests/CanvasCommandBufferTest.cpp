@@ -0,0 +1,161 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "CanvasCommandBuffer.h"
+#include "CanvasContext2D.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "Test.h"
+
+using namespace Canvas2D;
+
+static void test_reader_truncation(skiatest::Reporter* reporter) {
+    CanvasCommandWriter writer;
+    writer.writeFloat(1.5f);
+    writer.writeUInt(7);
+    writer.writeString("nonzero", 7);
+
+    {
+        CanvasCommandReader reader(writer.data(), writer.size());
+        REPORTER_ASSERT(reporter, 1.5f == reader.readFloat());
+        REPORTER_ASSERT(reporter, 7 == reader.readUInt());
+        std::string s;
+        reader.readString(s);
+        REPORTER_ASSERT(reporter, "nonzero" == s);
+        REPORTER_ASSERT(reporter, !reader.failed());
+        REPORTER_ASSERT(reporter, reader.atEnd());
+    }
+
+    // Every prefix of the buffer must fail somewhere instead of reading past it.
+    for (size_t length = 0; length < writer.size(); ++length) {
+        CanvasCommandReader reader(writer.data(), length);
+        reader.readFloat();
+        reader.readUInt();
+        uint32_t stringLength;
+        const char* chars = reader.readString(stringLength);
+        REPORTER_ASSERT(reporter, reader.failed());
+        REPORTER_ASSERT(reporter, NULL == chars || 0 == stringLength);
+    }
+
+    // Reads after a failure keep returning zeros.
+    CanvasCommandReader reader(writer.data(), 2);
+    REPORTER_ASSERT(reporter, 0 == reader.readFloat());
+    REPORTER_ASSERT(reporter, 0 == reader.readUInt());
+    REPORTER_ASSERT(reporter, reader.failed());
+
+    // A string whose length runs past the buffer fails.
+    CanvasCommandWriter longString;
+    longString.writeUInt(100);
+    longString.writeBool(true);
+    CanvasCommandReader stringReader(longString.data(), longString.size());
+    uint32_t stringLength;
+    stringReader.readString(stringLength);
+    REPORTER_ASSERT(reporter, stringReader.failed());
+}
+
+static void test_handle_reuse(skiatest::Reporter* reporter) {
+    CanvasCommandObjectTable table;
+    REPORTER_ASSERT(reporter, NULL == table.style(0));
+
+    RefPtr<CanvasStyle> red = CanvasStyle::createFromRGBA(0xFFFF0000);
+    uint32_t styleHandle = table.add(red);
+    REPORTER_ASSERT(reporter, 0 != styleHandle);
+    REPORTER_ASSERT(reporter, red.get() == table.style(styleHandle));
+    // A handle only resolves as the kind of object put there.
+    REPORTER_ASSERT(reporter, NULL == table.image(styleHandle));
+    REPORTER_ASSERT(reporter, NULL == table.path(styleHandle));
+
+    RefPtr<ImageData> imageData = ImageData::create(2, 2);
+    uint32_t imageDataHandle = table.add(imageData);
+    REPORTER_ASSERT(reporter, imageDataHandle != styleHandle);
+
+    // A released handle resolves to null until it is issued again, and the
+    // next object gets it back.
+    table.remove(styleHandle);
+    REPORTER_ASSERT(reporter, NULL == table.style(styleHandle));
+    RefPtr<CanvasPath> path = CanvasPath::create();
+    uint32_t pathHandle = table.add(path);
+    REPORTER_ASSERT(reporter, styleHandle == pathHandle);
+    REPORTER_ASSERT(reporter, path.get() == table.path(pathHandle));
+    REPORTER_ASSERT(reporter, NULL == table.style(pathHandle));
+    REPORTER_ASSERT(reporter, imageData.get() == table.imageData(imageDataHandle));
+
+    // Handles never issued resolve to null.
+    REPORTER_ASSERT(reporter, NULL == table.style(table.handleLimit()));
+    REPORTER_ASSERT(reporter, NULL == table.style(0xFFFFFFFF));
+
+    table.clear();
+    REPORTER_ASSERT(reporter, NULL == table.imageData(imageDataHandle));
+}
+
+static SkPMColor pixel(const SkBitmap& bitmap, int x, int y) {
+    SkAutoLockPixels alp(bitmap);
+    return *bitmap.getAddr32(x, y);
+}
+
+static void test_execute(skiatest::Reporter* reporter) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(16, 16);
+    bitmap.eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas canvas(bitmap);
+    CanvasContext2D context(&canvas);
+
+    RefPtr<CanvasStyle> red = CanvasStyle::createFromRGBA(0xFFFF0000);
+    uint32_t redHandle = context.commandObjects().add(red);
+
+    CanvasCommandWriter writer;
+    writer.setStrokeStyle(redHandle);
+    REPORTER_ASSERT(reporter, context.executeCommands(writer.data(), writer.size()));
+    REPORTER_ASSERT(reporter, red.get() == context.strokeStyle());
+
+    // A released handle is ignored, as a null style is.
+    context.commandObjects().remove(redHandle);
+    REPORTER_ASSERT(reporter, context.executeCommands(writer.data(), writer.size()));
+    REPORTER_ASSERT(reporter, red.get() == context.strokeStyle());
+
+    // Clip once with no save pending and once inside a save, with a
+    // transform on top, then reset: the whole canvas fills again.
+    writer.reset();
+    writer.rect(0, 0, 8, 8);
+    writer.writeOpcode(CanvasOpClip);
+    writer.writeString("nonzero", 7);
+    writer.save();
+    writer.translate(2, 2);
+    writer.beginPath();
+    writer.rect(0, 0, 2, 2);
+    writer.writeOpcode(CanvasOpClip);
+    writer.writeString("nonzero", 7);
+    writer.setStrokeStyle(context.commandObjects().add(red));
+    writer.fillRect(-2, -2, 16, 16);
+    REPORTER_ASSERT(reporter, context.executeCommands(writer.data(), writer.size()));
+    REPORTER_ASSERT(reporter, SK_ColorBLACK == pixel(bitmap, 2, 2));
+    REPORTER_ASSERT(reporter, 0 == pixel(bitmap, 4, 4));
+    REPORTER_ASSERT(reporter, 0 == pixel(bitmap, 12, 12));
+
+    writer.reset();
+    writer.writeOpcode(CanvasOpReset);
+    writer.fillRect(0, 0, 16, 16);
+    REPORTER_ASSERT(reporter, context.executeCommands(writer.data(), writer.size()));
+    REPORTER_ASSERT(reporter, SK_ColorBLACK == pixel(bitmap, 0, 0));
+    REPORTER_ASSERT(reporter, SK_ColorBLACK == pixel(bitmap, 15, 15));
+    REPORTER_ASSERT(reporter, SK_ColorBLACK == context.strokeStyle()->getRgba());
+    REPORTER_ASSERT(reporter, 1 == canvas.getSaveCount());
+    REPORTER_ASSERT(reporter, canvas.getTotalMatrix().isIdentity());
+
+    // A truncated command and an unknown opcode stop the buffer.
+    writer.reset();
+    writer.fillRect(0, 0, 1, 1);
+    REPORTER_ASSERT(reporter, !context.executeCommands(writer.data(), writer.size() - 1));
+    uint8_t unknown = 255;
+    REPORTER_ASSERT(reporter, !context.executeCommands(&unknown, 1));
+}
+
+DEF_TEST(CanvasCommandBuffer, reporter) {
+    test_reader_truncation(reporter);
+    test_handle_reuse(reporter);
+    test_execute(reporter);
+}
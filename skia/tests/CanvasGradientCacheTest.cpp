@@ -0,0 +1,113 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Color.h"
+#include "Gradient.h"
+#include "GradientShaderCache.h"
+#include "SkGradientShader.h"
+#include "Test.h"
+
+using namespace Canvas2D;
+
+static GradientShaderCache::Key make_key(uint32_t value) {
+    GradientShaderCache::Key key;
+    key.add(value);
+    return key;
+}
+
+static void test_hit_and_miss(skiatest::Reporter* reporter) {
+    GradientShaderCache cache;
+    SkPoint pts[2] = { { 0, 0 }, { 10, 0 } };
+    SkColor colors[2] = { SK_ColorRED, SK_ColorBLUE };
+    SkAutoTUnref<SkShader> shader(SkGradientShader::CreateLinear(pts, colors, NULL, 2,
+                                                                 SkShader::kClamp_TileMode));
+
+    GradientShaderCache::Key key = make_key(1);
+    REPORTER_ASSERT(reporter, NULL == cache.find(key));
+    cache.add(key, shader.get());
+    REPORTER_ASSERT(reporter, shader.get() == cache.find(key));
+    REPORTER_ASSERT(reporter, NULL == cache.find(make_key(2)));
+    REPORTER_ASSERT(reporter, 1 == cache.stats().m_hits);
+    REPORTER_ASSERT(reporter, 2 == cache.stats().m_misses);
+    REPORTER_ASSERT(reporter, 0 == cache.stats().m_evictions);
+
+    // +0 and -0 make the same key.
+    GradientShaderCache::Key positive, negative;
+    positive.addFloat(0.0f);
+    negative.addFloat(-0.0f);
+    REPORTER_ASSERT(reporter, positive == negative);
+    REPORTER_ASSERT(reporter, positive.hash() == negative.hash());
+
+    cache.clear();
+    REPORTER_ASSERT(reporter, NULL == cache.find(key));
+}
+
+static void test_eviction(skiatest::Reporter* reporter) {
+    GradientShaderCache cache;
+    SkPoint pts[2] = { { 0, 0 }, { 10, 0 } };
+    SkColor colors[2] = { SK_ColorRED, SK_ColorBLUE };
+    SkAutoTUnref<SkShader> shader(SkGradientShader::CreateLinear(pts, colors, NULL, 2,
+                                                                 SkShader::kClamp_TileMode));
+
+    // Collect one more key than a set holds, all landing in the same set.
+    const int kCount = GradientShaderCache::kWays + 1;
+    GradientShaderCache::Key keys[kCount];
+    int found = 0;
+    unsigned set = make_key(0).hash() % GradientShaderCache::kSetCount;
+    for (uint32_t value = 0; found < kCount; ++value) {
+        GradientShaderCache::Key key = make_key(value);
+        if (key.hash() % GradientShaderCache::kSetCount == set) {
+            keys[found++] = key;
+        }
+    }
+
+    for (int i = 0; i < GradientShaderCache::kWays; ++i) {
+        cache.add(keys[i], shader.get());
+    }
+    REPORTER_ASSERT(reporter, 0 == cache.stats().m_evictions);
+
+    // Touch the oldest entry so the second oldest is the one evicted.
+    REPORTER_ASSERT(reporter, NULL != cache.find(keys[0]));
+    cache.add(keys[kCount - 1], shader.get());
+    REPORTER_ASSERT(reporter, 1 == cache.stats().m_evictions);
+    REPORTER_ASSERT(reporter, NULL != cache.find(keys[0]));
+    REPORTER_ASSERT(reporter, NULL == cache.find(keys[1]));
+    REPORTER_ASSERT(reporter, NULL != cache.find(keys[kCount - 1]));
+}
+
+static PassRefPtr<Gradient> make_gradient(const Color& end) {
+    RefPtr<Gradient> gradient = adoptRef(Gradient::create(SkPoint::Make(0, 0),
+                                                          SkPoint::Make(100, 0)));
+    gradient->addColorStop(0, Color(255, 0, 0));
+    gradient->addColorStop(1, end);
+    return gradient.release();
+}
+
+static void test_shared_shader(skiatest::Reporter* reporter) {
+    GradientShaderCache cache;
+
+    // Identical gradients share one shader; a different stop gets its own.
+    RefPtr<Gradient> first = make_gradient(Color(0, 0, 255));
+    RefPtr<Gradient> second = make_gradient(Color(0, 0, 255));
+    RefPtr<Gradient> other = make_gradient(Color(0, 255, 0));
+    SkShader* shader = first->shader(&cache);
+    REPORTER_ASSERT(reporter, NULL != shader);
+    REPORTER_ASSERT(reporter, shader == second->shader(&cache));
+    REPORTER_ASSERT(reporter, shader != other->shader(&cache));
+    REPORTER_ASSERT(reporter, 1 == cache.stats().m_hits);
+    REPORTER_ASSERT(reporter, 2 == cache.stats().m_misses);
+
+    // Without a cache every gradient builds its own shader.
+    RefPtr<Gradient> uncached = make_gradient(Color(0, 0, 255));
+    REPORTER_ASSERT(reporter, shader != uncached->shader());
+}
+
+DEF_TEST(CanvasGradientCache, reporter) {
+    test_hit_and_miss(reporter);
+    test_eviction(reporter);
+    test_shared_shader(reporter);
+}
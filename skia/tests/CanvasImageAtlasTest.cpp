@@ -0,0 +1,163 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "CanvasImageAtlas.h"
+#include "GrContext.h"
+#include "SkBitmap.h"
+#include "SkPixelRef.h"
+#include "Test.h"
+#include "gl/GrGLInterface.h"
+
+using namespace Canvas2D;
+
+static SkPMColor pixel(const SkBitmap& bitmap, int x, int y) {
+    SkAutoLockPixels alp(bitmap);
+    return *bitmap.getAddr32(x, y);
+}
+
+// A width x height image whose left column is red, right column blue and the
+// rest green.
+static void make_image(SkBitmap* image, int width, int height) {
+    image->allocN32Pixels(width, height);
+    image->eraseColor(SK_ColorGREEN);
+    image->eraseArea(SkIRect::MakeWH(1, height), SK_ColorRED);
+    image->eraseArea(SkIRect::MakeXYWH(width - 1, 0, 1, height), SK_ColorBLUE);
+}
+
+static void test_add_and_find(skiatest::Reporter* reporter) {
+    CanvasImageAtlas atlas;
+    SkBitmap image;
+    make_image(&image, 4, 3);
+
+    SkBitmap page;
+    SkIPoint offset;
+    REPORTER_ASSERT(reporter, atlas.find(image, &page, &offset));
+    REPORTER_ASSERT(reporter, CanvasImageAtlas::kPageSize == page.width());
+    REPORTER_ASSERT(reporter, SK_ColorRED == pixel(page, offset.fX, offset.fY));
+    REPORTER_ASSERT(reporter, SK_ColorGREEN == pixel(page, offset.fX + 1, offset.fY + 2));
+    REPORTER_ASSERT(reporter, SK_ColorBLUE == pixel(page, offset.fX + 3, offset.fY + 2));
+    // The padding repeats the edges, corners included.
+    REPORTER_ASSERT(reporter, SK_ColorRED == pixel(page, offset.fX - 1, offset.fY - 1));
+    REPORTER_ASSERT(reporter, SK_ColorGREEN == pixel(page, offset.fX + 1, offset.fY - 1));
+    REPORTER_ASSERT(reporter, SK_ColorGREEN == pixel(page, offset.fX + 2, offset.fY + 3));
+    REPORTER_ASSERT(reporter, SK_ColorBLUE == pixel(page, offset.fX + 4, offset.fY + 3));
+
+    SkBitmap again;
+    SkIPoint againOffset;
+    REPORTER_ASSERT(reporter, atlas.find(image, &again, &againOffset));
+    REPORTER_ASSERT(reporter, againOffset == offset);
+    REPORTER_ASSERT(reporter, again.pixelRef() == page.pixelRef());
+    REPORTER_ASSERT(reporter, 1 == atlas.stats().m_packed);
+    REPORTER_ASSERT(reporter, 1 == atlas.stats().m_hits);
+
+    // New pixels make a new image.
+    image.eraseColor(SK_ColorWHITE);
+    REPORTER_ASSERT(reporter, atlas.find(image, &again, &againOffset));
+    REPORTER_ASSERT(reporter, againOffset != offset);
+    REPORTER_ASSERT(reporter, SK_ColorWHITE == pixel(again, againOffset.fX, againOffset.fY));
+    REPORTER_ASSERT(reporter, 2 == atlas.stats().m_packed);
+
+    SkBitmap large;
+    large.allocN32Pixels(CanvasImageAtlas::kMaxImageSize + 1, 1);
+    REPORTER_ASSERT(reporter, !atlas.find(large, &page, &offset));
+}
+
+static void test_copy_on_write(skiatest::Reporter* reporter) {
+    CanvasImageAtlas atlas;
+    SkBitmap first, second, third;
+    make_image(&first, 8, 8);
+    make_image(&second, 8, 8);
+    make_image(&third, 8, 8);
+
+    // A frame recorded with the page still holds it, so adding an image
+    // moves the atlas onto new pixels and leaves the held ones alone.
+    SkBitmap held;
+    SkIPoint offset;
+    REPORTER_ASSERT(reporter, atlas.find(first, &held, &offset));
+    uint32_t heldID = held.getGenerationID();
+    SkBitmap page;
+    REPORTER_ASSERT(reporter, atlas.find(second, &page, &offset));
+    REPORTER_ASSERT(reporter, 1 == atlas.stats().m_copiedPages);
+    REPORTER_ASSERT(reporter, page.pixelRef() != held.pixelRef());
+    REPORTER_ASSERT(reporter, heldID == held.getGenerationID());
+    REPORTER_ASSERT(reporter, 0 == pixel(held, offset.fX, offset.fY));
+    REPORTER_ASSERT(reporter, SK_ColorRED == pixel(page, offset.fX, offset.fY));
+
+    // Once nothing else holds the page it is written in place.
+    SkPixelRef* pixelRef = page.pixelRef();
+    page.reset();
+    held.reset();
+    REPORTER_ASSERT(reporter, atlas.find(third, &page, &offset));
+    REPORTER_ASSERT(reporter, 1 == atlas.stats().m_copiedPages);
+    REPORTER_ASSERT(reporter, pixelRef == page.pixelRef());
+    REPORTER_ASSERT(reporter, SK_ColorRED == pixel(page, offset.fX, offset.fY));
+}
+
+static void test_eviction(skiatest::Reporter* reporter) {
+    CanvasImageAtlas atlas(1);
+    const int kSize = CanvasImageAtlas::kMaxImageSize;
+    const int kPerRow = CanvasImageAtlas::kPageSize / (kSize + 2 * CanvasImageAtlas::kPadding);
+    SkBitmap page;
+    SkIPoint offset;
+    SkBitmap image;
+    for (int i = 0; i < kPerRow * kPerRow; ++i) {
+        make_image(&image, kSize, kSize);
+        REPORTER_ASSERT(reporter, atlas.find(image, &page, &offset));
+    }
+    page.reset();
+
+    // The page is full and was drawn from in this frame and the one before,
+    // either of which may still be playing back.
+    make_image(&image, kSize, kSize);
+    REPORTER_ASSERT(reporter, !atlas.find(image, &page, &offset));
+    atlas.beginFrame();
+    REPORTER_ASSERT(reporter, !atlas.find(image, &page, &offset));
+    REPORTER_ASSERT(reporter, 0 == atlas.stats().m_evictedPages);
+    atlas.beginFrame();
+    REPORTER_ASSERT(reporter, atlas.find(image, &page, &offset));
+    REPORTER_ASSERT(reporter, 1 == atlas.stats().m_evictedPages);
+    REPORTER_ASSERT(reporter, 1 == atlas.pageCount());
+    REPORTER_ASSERT(reporter, SK_ColorRED == pixel(page, offset.fX, offset.fY));
+}
+
+static void test_texture_upload(skiatest::Reporter* reporter) {
+    SkAutoTUnref<const GrGLInterface> gl(GrGLCreateNullInterface());
+    SkAutoTUnref<GrContext> context(GrContext::Create(reinterpret_cast<GrBackendContext>(gl.get())));
+    if (NULL == context.get()) {
+        return;
+    }
+    CanvasImageAtlas atlas;
+    atlas.setGrContext(context.get());
+    SkBitmap first, second;
+    make_image(&first, 8, 8);
+    make_image(&second, 16, 4);
+
+    // The page is uploaded whole once; after that only new rects are, and
+    // the page keeps its pixels and generation ID even while held.
+    SkBitmap held;
+    SkIPoint offset;
+    REPORTER_ASSERT(reporter, atlas.find(first, &held, &offset));
+    REPORTER_ASSERT(reporter, 0 == atlas.stats().m_uploadedPixels);
+    uint32_t heldID = held.getGenerationID();
+    SkBitmap page;
+    REPORTER_ASSERT(reporter, atlas.find(second, &page, &offset));
+    REPORTER_ASSERT(reporter, 18 * 6 == atlas.stats().m_uploadedPixels);
+    REPORTER_ASSERT(reporter, 0 == atlas.stats().m_copiedPages);
+    REPORTER_ASSERT(reporter, page.pixelRef() == held.pixelRef());
+    REPORTER_ASSERT(reporter, heldID == page.getGenerationID());
+    REPORTER_ASSERT(reporter, SK_ColorRED == pixel(page, offset.fX, offset.fY));
+
+    atlas.setGrContext(NULL);
+    REPORTER_ASSERT(reporter, 0 == atlas.pageCount());
+}
+
+DEF_TEST(CanvasImageAtlas, reporter) {
+    test_add_and_find(reporter);
+    test_copy_on_write(reporter);
+    test_eviction(reporter);
+    test_texture_upload(reporter);
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "CanvasCommandBuffer.h"
+#include "CanvasContext2D.h"
+#include "CanvasSession.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkOSFile.h"
+#include "Test.h"
+
+using namespace Canvas2D;
+
+static void test_dirty_handles(skiatest::Reporter* reporter) {
+    CanvasCommandObjectTable table;
+    std::vector<uint32_t> dirty;
+    table.takeDirtyHandles(dirty);
+    REPORTER_ASSERT(reporter, dirty.empty());
+
+    uint32_t style = table.add(CanvasStyle::createFromRGBA(0xFFFF0000));
+    uint32_t path = table.add(CanvasPath::create());
+    table.takeDirtyHandles(dirty);
+    REPORTER_ASSERT(reporter, 2 == dirty.size());
+    table.takeDirtyHandles(dirty);
+    REPORTER_ASSERT(reporter, dirty.empty());
+
+    // A handle is listed once however often it changes.
+    table.markDirty(path);
+    table.markDirty(path);
+    table.set(path, CanvasPath::create());
+    table.takeDirtyHandles(dirty);
+    REPORTER_ASSERT(reporter, 1 == dirty.size() && path == dirty[0]);
+
+    table.remove(style);
+    table.takeDirtyHandles(dirty);
+    REPORTER_ASSERT(reporter, 1 == dirty.size() && style == dirty[0]);
+
+    // Clearing marks every handle the table had, all past its new limit.
+    table.clear();
+    table.takeDirtyHandles(dirty);
+    REPORTER_ASSERT(reporter, 2 == dirty.size());
+    REPORTER_ASSERT(reporter, dirty[0] >= table.handleLimit() && dirty[1] >= table.handleLimit());
+}
+
+static void put_image_data(CanvasCommandWriter* writer, uint32_t imageData, float dx, float dy) {
+    writer->writeOpcode(CanvasOpPutImageData);
+    writer->writeUInt(imageData);
+    writer->writeFloat(dx);
+    writer->writeFloat(dy);
+}
+
+static void fill_image_data(ImageData* imageData, uint32_t rgba) {
+    for (int i = 0; i < imageData->length(); i += 4) {
+        imageData->data()[i + 0] = (rgba >> 24) & 0xFF;
+        imageData->data()[i + 1] = (rgba >> 16) & 0xFF;
+        imageData->data()[i + 2] = (rgba >> 8) & 0xFF;
+        imageData->data()[i + 3] = rgba & 0xFF;
+    }
+}
+
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels lockA(a), lockB(b);
+    return a.getSize() == b.getSize() && !memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+static void test_record_and_replay(skiatest::Reporter* reporter) {
+    SkString tmpDir = skiatest::Test::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString path = SkOSPath::SkPathJoin(tmpDir.c_str(), "CanvasSessionTest.cnvs");
+
+    SkBitmap recorded;
+    recorded.allocN32Pixels(16, 16);
+    recorded.eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas canvas(recorded);
+    CanvasContext2D context(&canvas);
+
+    // Objects added before recording starts are written with the first buffer.
+    RefPtr<ImageData> imageData = ImageData::create(2, 2);
+    fill_image_data(imageData.get(), 0xFF0000FF);
+    uint32_t imageDataHandle = context.commandObjects().add(imageData);
+    RefPtr<CanvasPath> retained = CanvasPath::create();
+    retained->rect(0, 0, 4, 4);
+    uint32_t pathHandle = context.commandObjects().add(retained);
+
+    CanvasSessionRecorder* recorder = CanvasSessionRecorder::create(path.c_str(), 16, 16);
+    REPORTER_ASSERT(reporter, NULL != recorder);
+    if (!recorder) {
+        return;
+    }
+    context.setSessionRecorder(recorder);
+
+    CanvasCommandWriter writer;
+    writer.setFillStyle(context.commandObjects().add(CanvasStyle::createFromRGBA(0xFF00FF00)));
+    writer.fillPath(pathHandle);
+    put_image_data(&writer, imageDataHandle, 8, 8);
+    REPORTER_ASSERT(reporter, context.executeCommands(writer.data(), writer.size()));
+    recorder->endFrame();
+
+    // Changes made in place are recorded once they are marked.
+    fill_image_data(imageData.get(), 0x0000FFFF);
+    retained->rect(4, 4, 2, 2);
+    context.commandObjects().markDirty(imageDataHandle);
+    context.commandObjects().markDirty(pathHandle);
+    writer.reset();
+    writer.fillPath(pathHandle);
+    put_image_data(&writer, imageDataHandle, 12, 12);
+    REPORTER_ASSERT(reporter, context.executeCommands(writer.data(), writer.size()));
+    recorder->endFrame();
+    context.setSessionRecorder(NULL);
+    delete recorder;
+
+    CanvasSessionPlayer player;
+    REPORTER_ASSERT(reporter, player.load(path.c_str()));
+    REPORTER_ASSERT(reporter, 2 == player.frameCount());
+    REPORTER_ASSERT(reporter, 16 == player.width() && 16 == player.height());
+
+    SkBitmap replayed;
+    replayed.allocN32Pixels(16, 16);
+    SkCanvas replayCanvas(replayed);
+    CanvasContext2D replayContext(&replayCanvas);
+    // Each pass starts over as bench_canvas_replay does and draws the same.
+    for (int pass = 0; pass < 2; ++pass) {
+        replayContext.reset();
+        replayContext.commandObjects().clear();
+        replayed.eraseColor(SK_ColorTRANSPARENT);
+        for (int frame = 0; frame < player.frameCount(); ++frame) {
+            REPORTER_ASSERT(reporter, player.playFrame(frame, &replayContext));
+        }
+        REPORTER_ASSERT(reporter, same_pixels(recorded, replayed));
+    }
+    ImageData* replayedData = replayContext.commandObjects().imageData(imageDataHandle);
+    REPORTER_ASSERT(reporter, NULL != replayedData && replayedData->checksum() == imageData->checksum());
+}
+
+DEF_TEST(CanvasSession, reporter) {
+    test_dirty_handles(reporter);
+    test_record_and_replay(reporter);
+}
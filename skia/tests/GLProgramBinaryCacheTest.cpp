@@ -0,0 +1,215 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#if SK_SUPPORT_GPU
+
+#include "SkData.h"
+#include "SkOSFile.h"
+#include "SkStream.h"
+#include "Test.h"
+#include "gl/GrGLContext.h"
+#include "gl/GrGLInterface.h"
+#include "gl/GrGLProgramBinaryCache.h"
+#include "gl/GrGLUtil.h"
+
+// The null interface hands back a program's ID as its binary and accepts every binary. These
+// stand in for a different driver and for one that rejects binaries.
+static GrGLGetStringProc gNullGetString;
+static GrGLGetProgramivProc gNullGetProgramiv;
+
+static const GrGLubyte* GR_GL_FUNCTION_TYPE other_renderer_get_string(GrGLenum name) {
+    if (GR_GL_RENDERER == name) {
+        return reinterpret_cast<const GrGLubyte*>("Another Renderer");
+    }
+    return gNullGetString(name);
+}
+
+static GrGLvoid GR_GL_FUNCTION_TYPE reject_get_programiv(GrGLuint program, GrGLenum pname,
+                                                         GrGLint* params) {
+    if (GR_GL_LINK_STATUS == pname) {
+        *params = GR_GL_FALSE;
+    } else {
+        gNullGetProgramiv(program, pname, params);
+    }
+}
+
+static GrGLuint create_program(const GrGLInterface* gl) {
+    GrGLuint programID;
+    GR_GL_CALL_RET(gl, programID, CreateProgram());
+    return programID;
+}
+
+static SkString key(int i) {
+    SkString key;
+    key.printf("void main() {}\nattrib %d: aPosition\n", i);
+    return key;
+}
+
+static void test_add_and_create(skiatest::Reporter* reporter, const GrGLContext& ctx) {
+    GrGLProgramBinaryCache cache(ctx);
+    REPORTER_ASSERT(reporter, 0 == cache.createProgram(key(0)));
+
+    GrGLuint programID = create_program(ctx.interface());
+    cache.add(key(0), programID);
+    cache.add(key(0), programID + 1);
+    REPORTER_ASSERT(reporter, 1 == cache.count());
+    REPORTER_ASSERT(reporter, 0 != cache.createProgram(key(0)));
+    REPORTER_ASSERT(reporter, 0 == cache.createProgram(key(1)));
+    REPORTER_ASSERT(reporter, 1 == cache.binaryHits());
+    REPORTER_ASSERT(reporter, 0 == cache.warmUpHits());
+}
+
+static void test_save_and_load(skiatest::Reporter* reporter, const GrGLContext& ctx,
+                               const char path[]) {
+    {
+        GrGLProgramBinaryCache cache(ctx);
+        for (int i = 0; i < 3; ++i) {
+            cache.add(key(i), create_program(ctx.interface()));
+        }
+        REPORTER_ASSERT(reporter, cache.save(path));
+    }
+
+    GrGLProgramBinaryCache cache(ctx);
+    REPORTER_ASSERT(reporter, cache.load(path));
+    REPORTER_ASSERT(reporter, 3 == cache.count());
+    for (int i = 0; i < 3; ++i) {
+        REPORTER_ASSERT(reporter, 0 != cache.createProgram(key(i)));
+    }
+    REPORTER_ASSERT(reporter, 0 == cache.createProgram(key(3)));
+    REPORTER_ASSERT(reporter, 3 == cache.binaryHits());
+
+    REPORTER_ASSERT(reporter, !cache.load("/nonexistent/GLProgramBinaryCacheTest.bin"));
+}
+
+static void test_rejects_other_files(skiatest::Reporter* reporter, const GrGLContext& ctx,
+                                     const char path[]) {
+    // A file saved for another renderer is not loaded, and the cache keeps what it has.
+    SkAutoTUnref<GrGLInterface> otherGL(GrGLInterface::NewClone(ctx.interface()));
+    gNullGetString = ctx.interface()->fFunctions.fGetString;
+    otherGL->fFunctions.fGetString = other_renderer_get_string;
+    GrGLContext otherCtx(otherGL);
+    REPORTER_ASSERT(reporter, otherCtx.isInitialized());
+    GrGLProgramBinaryCache other(otherCtx);
+    REPORTER_ASSERT(reporter, other.driverSignature() !=
+                              GrGLProgramBinaryCache(ctx).driverSignature());
+    other.add(key(7), create_program(otherGL));
+    REPORTER_ASSERT(reporter, !other.load(path));
+    REPORTER_ASSERT(reporter, 1 == other.count());
+
+    // A file that does not match its checksum is not loaded either.
+    SkAutoTUnref<SkData> data(SkData::NewFromFileName(path));
+    REPORTER_ASSERT(reporter, NULL != data.get());
+    if (NULL == data.get()) {
+        return;
+    }
+    SkAutoTMalloc<uint8_t> damaged(data->size());
+    memcpy(damaged.get(), data->data(), data->size());
+    damaged[data->size() / 2] ^= 0x55;
+    {
+        SkFILEWStream file(path);
+        file.write(damaged.get(), data->size());
+    }
+    GrGLProgramBinaryCache cache(ctx);
+    REPORTER_ASSERT(reporter, !cache.load(path));
+    REPORTER_ASSERT(reporter, 0 == cache.count());
+    REPORTER_ASSERT(reporter, 0 == cache.createProgram(key(0)));
+}
+
+static void test_drops_rejected_binaries(skiatest::Reporter* reporter,
+                                         const GrGLContext& ctx, const char path[]) {
+    {
+        GrGLProgramBinaryCache cache(ctx);
+        cache.add(key(0), create_program(ctx.interface()));
+        REPORTER_ASSERT(reporter, cache.save(path));
+    }
+
+    // Same driver signature, but every binary fails to link, as after a driver update that
+    // kept its version string.
+    SkAutoTUnref<GrGLInterface> rejectGL(GrGLInterface::NewClone(ctx.interface()));
+    gNullGetProgramiv = ctx.interface()->fFunctions.fGetProgramiv;
+    rejectGL->fFunctions.fGetProgramiv = reject_get_programiv;
+    GrGLContext rejectCtx(rejectGL);
+    GrGLProgramBinaryCache cache(rejectCtx);
+    REPORTER_ASSERT(reporter, cache.load(path));
+    REPORTER_ASSERT(reporter, 1 == cache.count());
+    REPORTER_ASSERT(reporter, 0 == cache.createProgram(key(0)));
+    REPORTER_ASSERT(reporter, 0 == cache.count());
+    REPORTER_ASSERT(reporter, 0 == cache.binaryHits());
+
+    // The caller compiles the program instead and adds its binary back.
+    cache.add(key(0), create_program(rejectGL));
+    REPORTER_ASSERT(reporter, 1 == cache.count());
+}
+
+static void test_warm_up(skiatest::Reporter* reporter, const GrGLContext& ctx,
+                         const char path[]) {
+    // The first session uses its programs in the order 2, 0, 1.
+    {
+        GrGLProgramBinaryCache cache(ctx);
+        REPORTER_ASSERT(reporter, 0 == cache.warmUp(SK_MSecMax));
+        cache.add(key(2), create_program(ctx.interface()));
+        cache.add(key(0), create_program(ctx.interface()));
+        cache.add(key(1), create_program(ctx.interface()));
+        REPORTER_ASSERT(reporter, cache.save(path));
+    }
+
+    // The next one links them all up front, in that order, and hands each out once. After that
+    // the same key loads its binary again.
+    {
+        GrGLProgramBinaryCache cache(ctx);
+        REPORTER_ASSERT(reporter, cache.load(path));
+        REPORTER_ASSERT(reporter, 3 == cache.warmUp(SK_MSecMax));
+        REPORTER_ASSERT(reporter, 0 == cache.warmUp(SK_MSecMax));
+        GrGLuint program2 = cache.createProgram(key(2));
+        GrGLuint program0 = cache.createProgram(key(0));
+        REPORTER_ASSERT(reporter, 0 != program2 && program2 < program0);
+        GrGLuint again = cache.createProgram(key(0));
+        REPORTER_ASSERT(reporter, 0 != again && again != program0);
+        REPORTER_ASSERT(reporter, 2 == cache.warmUpHits());
+        REPORTER_ASSERT(reporter, 1 == cache.binaryHits());
+        // Program 1 stays linked until the cache goes away; this session only used 2 and 0.
+        REPORTER_ASSERT(reporter, cache.save(path));
+    }
+
+    // Out of time before the first program: nothing is warmed up and every program falls back
+    // to loading its binary on demand. Only what the last session used is warmed up next time.
+    {
+        GrGLProgramBinaryCache cache(ctx);
+        REPORTER_ASSERT(reporter, cache.load(path));
+        REPORTER_ASSERT(reporter, 0 == cache.warmUp(0));
+        REPORTER_ASSERT(reporter, 0 != cache.createProgram(key(1)));
+        REPORTER_ASSERT(reporter, 0 == cache.warmUpHits());
+        REPORTER_ASSERT(reporter, 1 == cache.binaryHits());
+
+        GrGLProgramBinaryCache next(ctx);
+        REPORTER_ASSERT(reporter, next.load(path));
+        REPORTER_ASSERT(reporter, 2 == next.warmUp(SK_MSecMax));
+    }
+}
+
+DEF_TEST(GLProgramBinaryCache, reporter) {
+    SkString tmpDir = skiatest::Test::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString path = SkOSPath::SkPathJoin(tmpDir.c_str(), "GLProgramBinaryCacheTest.bin");
+
+    SkAutoTUnref<const GrGLInterface> gl(GrGLCreateNullInterface());
+    GrGLContext ctx(gl);
+    REPORTER_ASSERT(reporter, ctx.isInitialized());
+    if (!ctx.isInitialized() || !ctx.caps()->programBinarySupport()) {
+        return;
+    }
+
+    test_add_and_create(reporter, ctx);
+    test_save_and_load(reporter, ctx, path.c_str());
+    test_rejects_other_files(reporter, ctx, path.c_str());
+    test_drops_rejected_binaries(reporter, ctx, path.c_str());
+    test_warm_up(reporter, ctx, path.c_str());
+}
+
+#endif
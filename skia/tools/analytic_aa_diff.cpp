@@ -0,0 +1,142 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
+#include "SkCommandLineFlags.h"
+#include "SkForceLinking.h"
+#include "SkGraphics.h"
+#include "SkImageEncoder.h"
+#include "SkOSFile.h"
+#include "SkString.h"
+
+#include "gm.h"
+
+#include <stdio.h>
+#include <string.h>
+
+__SK_FORCE_IMAGE_DECODER_LINKING;
+
+// Draws every raster GM twice, once with the 4x4 supersampler and once with
+// analytic AA (SkGraphics::SetAnalyticAAEnabled), and fails if they differ by
+// more than the tolerance below. This is the check to run before turning
+// analytic AA on by default. Anti-aliased edges are expected to move by a
+// little, so a pixel only counts as different when one of its channels is
+// off by more than --threshold, and a GM only fails when more than
+// --maxPercent of its pixels are different.
+
+DEFINE_string(match, "", "The usual filters on GM names.");
+DEFINE_int32(threshold, 32, "Ignore channel differences up to this much.");
+DEFINE_double(maxPercent, 0.5, "Fail a GM if more of its pixels than this differ.");
+DEFINE_string(out, "", "If set, write both images of each failing GM here.");
+
+using skiagm::GM;
+using skiagm::GMRegistry;
+
+static void draw(GM* gm, bool analytic, SkBitmap* bitmap) {
+    SkISize size = gm->getISize();
+    bitmap->allocN32Pixels(size.width(), size.height());
+    bitmap->eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas canvas(*bitmap);
+    canvas.concat(gm->getInitialTransform());
+
+    // Glyph masks are cached with whichever coverage made them first.
+    SkGraphics::PurgeFontCache();
+    bool prev = SkGraphics::SetAnalyticAAEnabled(analytic);
+    gm->draw(&canvas);
+    SkGraphics::SetAnalyticAAEnabled(prev);
+}
+
+static int channel_diff(SkPMColor a, SkPMColor b) {
+    int da = SkAbs32((int)SkGetPackedA32(a) - (int)SkGetPackedA32(b));
+    int dr = SkAbs32((int)SkGetPackedR32(a) - (int)SkGetPackedR32(b));
+    int dg = SkAbs32((int)SkGetPackedG32(a) - (int)SkGetPackedG32(b));
+    int db = SkAbs32((int)SkGetPackedB32(a) - (int)SkGetPackedB32(b));
+    return SkMax32(SkMax32(da, dr), SkMax32(dg, db));
+}
+
+static bool same(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels lockA(a), lockB(b);
+    return a.getSize() == b.getSize() && 0 == memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+static void write(const SkBitmap& bitmap, const char* name, const char* suffix) {
+    SkString path = SkOSPath::SkPathJoin(FLAGS_out[0], name);
+    path.append(suffix);
+    if (!SkImageEncoder::EncodeFile(path.c_str(), bitmap, SkImageEncoder::kPNG_Type, 100)) {
+        SkDebugf("Could not write %s.\n", path.c_str());
+    }
+}
+
+// Returns false if the GM differs by more than the tolerance.
+static bool check(GM* gm) {
+    SkBitmap supersampled, again, analytic;
+    draw(gm, false, &supersampled);
+    draw(gm, false, &again);
+    if (!same(supersampled, again)) {
+        // Random or time dependent, so any difference would be noise.
+        printf("skip\t\t\t%s does not draw the same twice\n", gm->getName());
+        return true;
+    }
+    draw(gm, true, &analytic);
+
+    SkAutoLockPixels lockS(supersampled), lockA(analytic);
+    int maxDiff = 0;
+    int different = 0;
+    for (int y = 0; y < supersampled.height(); y++) {
+        for (int x = 0; x < supersampled.width(); x++) {
+            int diff = channel_diff(*supersampled.getAddr32(x, y), *analytic.getAddr32(x, y));
+            maxDiff = SkMax32(maxDiff, diff);
+            if (diff > FLAGS_threshold) {
+                different++;
+            }
+        }
+    }
+    double percent = 100.0 * different / (supersampled.width() * supersampled.height());
+    bool ok = percent <= FLAGS_maxPercent;
+    printf("%s\t%d\t%.3f%%\t%s\n", ok ? "ok" : "FAIL", maxDiff, percent, gm->getName());
+
+    if (!ok && !FLAGS_out.isEmpty()) {
+        write(supersampled, gm->getName(), "_supersampled.png");
+        write(analytic, gm->getName(), "_analytic.png");
+    }
+    return ok;
+}
+
+int tool_main(int argc, char** argv);
+int tool_main(int argc, char** argv) {
+    SkCommandLineFlags::SetUsage("Compares analytic AA with supersampling on every GM.");
+    SkCommandLineFlags::Parse(argc, argv);
+    SkAutoGraphics autoGraphics;
+
+    printf("result\tmax\tover %d\tgm\n", FLAGS_threshold);
+    int count = 0;
+    int failed = 0;
+    for (const GMRegistry* reg = GMRegistry::Head(); reg != NULL; reg = reg->next()) {
+        SkAutoTDelete<GM> gm(reg->factory()(NULL));
+        if (gm->getFlags() & GM::kGPUOnly_Flag) {
+            continue;
+        }
+        if (SkCommandLineFlags::ShouldSkip(FLAGS_match, gm->getName())) {
+            continue;
+        }
+        count++;
+        if (!check(gm.get())) {
+            failed++;
+        }
+    }
+    printf("%d of %d GMs differ by more than %g%% of pixels over %d\n",
+           failed, count, FLAGS_maxPercent, FLAGS_threshold);
+    return failed ? 1 : 0;
+}
+
+#if !defined SK_BUILD_FOR_IOS
+int main(int argc, char * const argv[]) {
+    return tool_main(argc, (char**) argv);
+}
+#endif
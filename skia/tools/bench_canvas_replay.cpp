@@ -0,0 +1,188 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCanvas.h"
+#include "SkCommandLineFlags.h"
+#include "SkForceLinking.h"
+#include "SkGraphics.h"
+#include "SkOSFile.h"
+#include "SkString.h"
+#include "SkSurface.h"
+#include "SkTArray.h"
+#include "SkTSort.h"
+#include "SkThreadUtils.h"
+
+#if SK_SUPPORT_GPU
+#include "GrContext.h"
+#include "gl/GrGLInterface.h"
+#endif
+
+#include "CanvasContext2D.h"
+#include "CanvasSession.h"
+
+#include "BenchTimer.h"
+
+typedef WallTimer Timer;
+
+__SK_FORCE_IMAGE_DECODER_LINKING;
+
+// Replays Canvas2D sessions recorded with CanvasSessionRecorder, without a
+// window or a device, and prints percentiles of the per-frame times. Each
+// thread replays the session on its own context and surface. The GPU configs
+// run Skia's GPU backend against a GL interface that does no drawing, so
+// they time the CPU side of the GPU path on any machine.
+
+DEFINE_string2(sessions, r, "sessions", "Directory containing recorded sessions (.cnvs) to replay.");
+DEFINE_string(resources, "", "Directory that relative image paths in the sessions are resolved against.");
+DEFINE_string(config, "raster", "Where to draw: raster, or with a GPU build null or debug GL.");
+DEFINE_int32(repeat, 5, "Replay each session this many times after a warm-up pass.");
+DEFINE_int32(threads, 1, "Replay each session on this many threads at once.");
+DEFINE_string(match, "", "The usual filters on file names of sessions to replay.");
+
+struct Replay {
+    Replay() : fPath(NULL), fFailed(false) {}
+
+    const char* fPath;
+    SkTArray<double> fFrameMs;
+    bool fFailed;
+};
+
+#if SK_SUPPORT_GPU
+static GrContext* make_gr_context() {
+    SkAutoTUnref<const GrGLInterface> gl(FLAGS_config.contains("debug") ? GrGLCreateDebugInterface()
+                                                                       : GrGLCreateNullInterface());
+    return gl ? GrContext::Create(reinterpret_cast<GrBackendContext>(gl.get())) : NULL;
+}
+#endif
+
+static void replay(void* data) {
+    Replay* replay = static_cast<Replay*>(data);
+    Canvas2D::CanvasSessionPlayer player;
+    if (!player.load(replay->fPath, FLAGS_resources.isEmpty() ? NULL : FLAGS_resources[0])) {
+        SkDebugf("Could not read %s as a Canvas2D session.\n", replay->fPath);
+        replay->fFailed = true;
+        return;
+    }
+
+    SkImageInfo info = SkImageInfo::MakeN32Premul(player.width(), player.height());
+    SkAutoTUnref<SkSurface> surface;
+#if SK_SUPPORT_GPU
+    // GrContexts are not shared between threads.
+    SkAutoTUnref<GrContext> grContext;
+    if (!FLAGS_config.contains("raster")) {
+        grContext.reset(make_gr_context());
+        if (grContext) {
+            surface.reset(SkSurface::NewRenderTarget(grContext, info));
+        }
+    } else
+#endif
+    {
+        surface.reset(SkSurface::NewRaster(info));
+    }
+    if (!surface) {
+        SkDebugf("Could not create a %dx%d %s surface for %s.\n",
+                 player.width(), player.height(), FLAGS_config[0], replay->fPath);
+        replay->fFailed = true;
+        return;
+    }
+    SkCanvas* canvas = surface->getCanvas();
+    CanvasContext2D context(canvas);
+
+    // The first pass decodes images and warms the glyph, path and texture caches.
+    // Each pass starts from a new context's state, an empty object table and a
+    // clear surface, so no pass draws on top of what the one before left.
+    Timer timer;
+    for (int pass = 0; pass <= FLAGS_repeat; pass++) {
+        context.reset();
+        context.commandObjects().clear();
+        canvas->clear(SK_ColorTRANSPARENT);
+        canvas->flush();
+        for (int frame = 0; frame < player.frameCount(); frame++) {
+            timer.start();
+            if (!player.playFrame(frame, &context)) {
+                replay->fFailed = true;
+            }
+            canvas->flush();
+            timer.end();
+            if (pass > 0) {
+                replay->fFrameMs.push_back(timer.fWall);
+            }
+        }
+    }
+}
+
+static double percentile(const SkTArray<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    int index = SkTMin(sorted.count() - 1, static_cast<int>(p * sorted.count()));
+    return sorted[index];
+}
+
+int tool_main(int argc, char** argv);
+int tool_main(int argc, char** argv) {
+    SkCommandLineFlags::Parse(argc, argv);
+    SkAutoGraphics autoGraphics;
+
+    if (FLAGS_repeat < 1) {
+        FLAGS_repeat = 1;
+    }
+    if (FLAGS_threads < 1) {
+        FLAGS_threads = 1;
+    }
+
+    printf("p50\tp90\tp99\tmax\tframes\tthreads\tsession\n");
+
+    SkOSFile::Iter it(FLAGS_sessions[0], ".cnvs");
+    SkString filename;
+    bool failed = false;
+    while (it.next(&filename)) {
+        if (SkCommandLineFlags::ShouldSkip(FLAGS_match, filename.c_str())) {
+            continue;
+        }
+
+        const SkString path = SkOSPath::SkPathJoin(FLAGS_sessions[0], filename.c_str());
+
+        SkTArray<Replay> replays(FLAGS_threads);
+        SkTArray<SkThread*> threads;
+        for (int i = 0; i < FLAGS_threads; i++) {
+            replays.push_back().fPath = path.c_str();
+        }
+        for (int i = 0; i < FLAGS_threads; i++) {
+            threads.push_back(SkNEW_ARGS(SkThread, (replay, &replays[i])));
+            threads.back()->start();
+        }
+
+        SkTArray<double> frameMs;
+        bool sessionFailed = false;
+        for (int i = 0; i < FLAGS_threads; i++) {
+            threads[i]->join();
+            SkDELETE(threads[i]);
+            frameMs.push_back_n(replays[i].fFrameMs.count(), replays[i].fFrameMs.begin());
+            sessionFailed |= replays[i].fFailed;
+        }
+        if (sessionFailed) {
+            failed = true;
+            continue;
+        }
+
+        if (!frameMs.empty()) {
+            SkTQSort(frameMs.begin(), frameMs.end() - 1);
+        }
+        printf("%.3f\t%.3f\t%.3f\t%.3f\t%d\t%d\t%s\n",
+               percentile(frameMs, 0.5), percentile(frameMs, 0.9), percentile(frameMs, 0.99),
+               frameMs.empty() ? 0 : frameMs.back(), frameMs.count(), FLAGS_threads,
+               filename.c_str());
+    }
+    return failed ? 1 : 0;
+}
+
+#if !defined SK_BUILD_FOR_IOS
+int main(int argc, char * const argv[]) {
+    return tool_main(argc, (char**) argv);
+}
+#endif
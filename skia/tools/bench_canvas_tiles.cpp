@@ -0,0 +1,122 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCommandLineFlags.h"
+#include "SkForceLinking.h"
+#include "SkGraphics.h"
+#include "SkOSFile.h"
+#include "SkPicture.h"
+#include "SkRecord.h"
+#include "SkRecordOpts.h"
+#include "SkRecorder.h"
+#include "SkStream.h"
+#include "SkString.h"
+
+#include "CanvasTileRenderer.h"
+
+#include "BenchTimer.h"
+#include "Stats.h"
+
+typedef WallTimer Timer;
+
+__SK_FORCE_IMAGE_DECODER_LINKING;
+
+// Times CanvasTileRenderer on recorded game frames at several thread counts,
+// so we can see how CPU-only rendering scales with cores.
+
+DEFINE_string2(skps, r, "skps", "Directory containing recorded frames (SKPs) to play back.");
+DEFINE_string(threads, "1 2 4 8", "Thread counts to compare. 0 draws on the main thread.");
+DEFINE_int32(tileWidth, 256, "Tile width in pixels.");
+DEFINE_int32(tileHeight, 256, "Tile height in pixels.");
+DEFINE_int32(samples, 10, "Gather this many samples of each frame at each thread count.");
+DEFINE_string(match, "", "The usual filters on file names of SKPs to bench.");
+
+static SkRecord* rerecord(SkPicture& src) {
+    SkRecord* record = SkNEW(SkRecord);
+    SkRecorder recorder(record, src.width(), src.height());
+    src.draw(&recorder);
+    SkRecordOptimize(record);
+    return record;
+}
+
+static double bench(const SkRecord& record, const SkBitmap& bitmap, int threads) {
+    Canvas2D::CanvasTileRenderer renderer(bitmap, threads, FLAGS_tileWidth, FLAGS_tileHeight);
+
+    // Draw once to warm the glyph and bitmap caches.
+    renderer.draw(record);
+
+    Timer timer;
+    SkAutoTMalloc<double> samples(FLAGS_samples);
+    for (int i = 0; i < FLAGS_samples; i++) {
+        timer.start();
+        renderer.draw(record);
+        timer.end();
+        samples[i] = timer.fWall;
+    }
+    Stats stats(samples.get(), FLAGS_samples);
+    return stats.min;
+}
+
+int tool_main(int argc, char** argv);
+int tool_main(int argc, char** argv) {
+    SkCommandLineFlags::Parse(argc, argv);
+    SkAutoGraphics autoGraphics;
+
+    if (FLAGS_samples < 1) {
+        FLAGS_samples = 1;
+    }
+
+    SkOSFile::Iter it(FLAGS_skps[0], ".skp");
+    SkString filename;
+    bool failed = false;
+    while (it.next(&filename)) {
+        if (SkCommandLineFlags::ShouldSkip(FLAGS_match, filename.c_str())) {
+            continue;
+        }
+
+        const SkString path = SkOSPath::SkPathJoin(FLAGS_skps[0], filename.c_str());
+
+        SkAutoTUnref<SkStream> stream(SkStream::NewFromFile(path.c_str()));
+        if (!stream) {
+            SkDebugf("Could not read %s.\n", path.c_str());
+            failed = true;
+            continue;
+        }
+        SkAutoTUnref<SkPicture> src(SkPicture::CreateFromStream(stream));
+        if (!src) {
+            SkDebugf("Could not read %s as an SkPicture.\n", path.c_str());
+            failed = true;
+            continue;
+        }
+
+        SkAutoTDelete<SkRecord> record(rerecord(*src));
+        SkBitmap bitmap;
+        if (!bitmap.allocN32Pixels(src->width(), src->height())) {
+            SkDebugf("Could not allocate %dx%d for %s.\n", src->width(), src->height(), path.c_str());
+            failed = true;
+            continue;
+        }
+
+        // The first thread count is the baseline the others are compared to.
+        double baseline = 0;
+        for (int i = 0; i < FLAGS_threads.count(); i++) {
+            int threads = atoi(FLAGS_threads[i]);
+            double ms = bench(*record, bitmap, threads);
+            if (0 == i) {
+                baseline = ms;
+            }
+            printf("%g\t%.2fx\t%d threads\t%s\n", ms, ms > 0 ? baseline / ms : 0, threads, filename.c_str());
+        }
+    }
+    return failed ? 1 : 0;
+}
+
+#if !defined SK_BUILD_FOR_IOS
+int main(int argc, char * const argv[]) {
+    return tool_main(argc, (char**) argv);
+}
+#endif
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkColorPriv.h"
+#include "SkCommandLineFlags.h"
+#include "SkData.h"
+#include "SkForceLinking.h"
+#include "SkGraphics.h"
+#include "SkImageDecoder.h"
+#include "SkOSFile.h"
+#include "SkStream.h"
+#include "SkString.h"
+
+#include "CanvasETC1.h"
+
+#include "BenchTimer.h"
+
+#include <math.h>
+
+typedef WallTimer Timer;
+
+__SK_FORCE_IMAGE_DECODER_LINKING;
+
+// Runs CanvasETC1's encoder over images and decodes the result again, to
+// check quality and size before shipping compressed assets. With --out it
+// also writes the .pkm files that BitmapImage loads without decoding. With
+// no --images it checks a generated image, so it needs no assets to run.
+
+DEFINE_string(images, "", "Directory of opaque images to compress.");
+DEFINE_string(out, "", "If set, write a .pkm for each image here.");
+DEFINE_double(minPSNR, 30, "Fail if any image comes back worse than this, in dB.");
+DEFINE_string(match, "", "The usual filters on file names of images.");
+
+// Peak signal to noise ratio of the RGB channels of two N32 bitmaps.
+static double psnr(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels lockA(a), lockB(b);
+    double sum = 0;
+    for (int y = 0; y < a.height(); y++) {
+        for (int x = 0; x < a.width(); x++) {
+            SkPMColor ca = *a.getAddr32(x, y);
+            SkPMColor cb = *b.getAddr32(x, y);
+            int dr = SkGetPackedR32(ca) - SkGetPackedR32(cb);
+            int dg = SkGetPackedG32(ca) - SkGetPackedG32(cb);
+            int db = SkGetPackedB32(ca) - SkGetPackedB32(cb);
+            sum += dr * dr + dg * dg + db * db;
+        }
+    }
+    double mse = sum / (3.0 * a.width() * a.height());
+    return mse > 0 ? 10 * log10(255.0 * 255.0 / mse) : 99;
+}
+
+static bool check(const char* name, const SkBitmap& bitmap) {
+    if (!bitmap.isOpaque()) {
+        printf("skipped\t%s has alpha\n", name);
+        return true;
+    }
+    Timer timer;
+    timer.start();
+    SkAutoTUnref<SkData> pkm(Canvas2D::CanvasETC1::encode(bitmap));
+    timer.end();
+    if (!pkm) {
+        SkDebugf("Could not encode %s.\n", name);
+        return false;
+    }
+
+    SkBitmap decoded;
+    if (!Canvas2D::CanvasETC1::decode(pkm, &decoded)) {
+        SkDebugf("Could not decode the ETC1 data of %s.\n", name);
+        return false;
+    }
+    SkBitmap original;
+    bitmap.copyTo(&original, kN32_SkColorType);
+    double db = psnr(original, decoded);
+    size_t rawBytes = bitmap.width() * bitmap.height() * 4;
+    printf("%.1fdB\t%.1fx\t%gms\t%dx%d\t%s\n", db, (double)rawBytes / pkm->size(), timer.fWall,
+           bitmap.width(), bitmap.height(), name);
+
+    if (!FLAGS_out.isEmpty()) {
+        SkString base = SkOSPath::SkBasename(name);
+        SkString path = SkOSPath::SkPathJoin(FLAGS_out[0], base.c_str());
+        path.append(".pkm");
+        SkFILEWStream file(path.c_str());
+        if (!file.isValid() || !file.write(pkm->data(), pkm->size())) {
+            SkDebugf("Could not write %s.\n", path.c_str());
+            return false;
+        }
+    }
+    return db >= FLAGS_minPSNR;
+}
+
+int tool_main(int argc, char** argv);
+int tool_main(int argc, char** argv) {
+    SkCommandLineFlags::Parse(argc, argv);
+    SkAutoGraphics autoGraphics;
+
+    if (FLAGS_images.isEmpty()) {
+        // Smooth gradients with a few hard edges, like a game background.
+        SkBitmap bitmap;
+        bitmap.allocN32Pixels(250, 130, true);
+        SkAutoLockPixels lock(bitmap);
+        for (int y = 0; y < bitmap.height(); y++) {
+            for (int x = 0; x < bitmap.width(); x++) {
+                U8CPU edge = ((x / 50) & 1) ? 0x40 : 0;
+                *bitmap.getAddr32(x, y) = SkPackARGB32(0xFF, x & 0xFF, y * 2 & 0xFF, (x + y) / 2 ^ edge);
+            }
+        }
+        return check("generated", bitmap) ? 0 : 1;
+    }
+
+    SkOSFile::Iter it(FLAGS_images[0]);
+    SkString filename;
+    bool failed = false;
+    while (it.next(&filename)) {
+        if (SkCommandLineFlags::ShouldSkip(FLAGS_match, filename.c_str())) {
+            continue;
+        }
+        const SkString path = SkOSPath::SkPathJoin(FLAGS_images[0], filename.c_str());
+        SkBitmap bitmap;
+        if (!SkImageDecoder::DecodeFile(path.c_str(), &bitmap, kN32_SkColorType,
+                                        SkImageDecoder::kDecodePixels_Mode)) {
+            continue;
+        }
+        if (!check(path.c_str(), bitmap)) {
+            failed = true;
+        }
+    }
+    return failed ? 1 : 0;
+}
+
+#if !defined SK_BUILD_FOR_IOS
+int main(int argc, char * const argv[]) {
+    return tool_main(argc, (char**) argv);
+}
+#endif